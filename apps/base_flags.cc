@@ -199,3 +199,82 @@ ABSL_FLAG(bool, should_dump_heap_allocator_statistics_on_exit, false,
           "should dump heap allocator statistics on exit or not.  Included a "
           "some process info, like system/user elapsed time, peak working "
           "set size, hard page faults, etc.");
+
+ABSL_FLAG(bool, should_use_large_os_pages, false,
+          "should heap allocator use large (2MiB) OS pages or not.  Reduces "
+          "TLB misses on large working sets.  Needs SeLockMemoryPrivilege on "
+          "Windows.  Falls back to regular pages when not available.");
+
+ABSL_FLAG(std::uint32_t, huge_os_pages_count, 0U,
+          "how many 1GiB huge OS pages heap allocator should reserve at "
+          "startup.  On Linux pages should be preallocated via "
+          "/sys/kernel/mm/hugepages.  Falls back to regular pages when not "
+          "available.  0 means no reservation.");
+
+ABSL_FLAG(std::uint32_t, heap_reserve_mib, 0U,
+          "how many MiBs heap allocator should reserve as memory pool at "
+          "startup.  All heaps and arenas allocate from pool first, so mmap "
+          "costs are paid on startup.  0 means no reservation.");
+
+ABSL_FLAG(bool, should_prefault_heap_reserve, false,
+          "should heap allocator pre-fault reserved memory pool at startup or "
+          "not.  Moves page faults from gameplay to loading, but makes pool "
+          "resident.  Needs --heap_reserve_mib.");
+
+ABSL_FLAG(std::uint32_t, heap_profile_sampling_interval_kib, 0U,
+          "mean KiBs allocated between heap profiler samples.  Heap profiler "
+          "captures sampled allocations stacks and logs top allocation sites "
+          "by live bytes and by allocation rate on exit.  0 means heap "
+          "profiler is off.");
+
+ABSL_FLAG(std::string, startup_trace_path, "",
+          "startup timeline trace file path.  Trace is in Chrome trace event "
+          "format, open it in chrome://tracing or ui.perfetto.dev.  Empty "
+          "means no trace file, only log summary.");
+
+ABSL_FLAG(bool, should_profile_lock_contention, false,
+          "should profile lock contention and log most contended locks by wait "
+          "time on exit or not.  Profiles absl::Mutex and posix::ScopedMutex.");
+
+ABSL_FLAG(std::string, metrics_export_path, "",
+          "metrics export path.  Metrics are written in OpenMetrics text "
+          "format to the file every --metrics_export_interval_ms, or served "
+          "to each connection of the unix:<socket path> Unix socket.  Empty "
+          "means no export.");
+
+ABSL_FLAG(std::uint32_t, metrics_export_interval_ms, 1000U,
+          "metrics export file rewrite interval in milliseconds.");
+
+#ifdef WB_OS_POSIX
+ABSL_FLAG(bool, should_publish_frame_telemetry, false,
+          "should publish live frame telemetry to the shared memory object "
+          "/whitebox-frame-telemetry-<pid> or not.  Use whitebox-telemetry-top "
+          "to watch it.");
+
+ABSL_FLAG(std::string, frame_benchmark_results_path, "",
+          "frame benchmark results file path.  When set, app runs offscreen "
+          "with scripted input for --frame_benchmark_frames_count frames, "
+          "writes frame time, allocations and RSS as JSON and exits.  Compare "
+          "results via whitebox-frame-bench-compare.  Empty means no "
+          "benchmark.");
+
+ABSL_FLAG(std::uint32_t, frame_benchmark_frames_count, 1000U,
+          "how many frames to run in frame benchmark.");
+
+ABSL_FLAG(std::int32_t, first_frame_signal_fd, -1,
+          "inherited file descriptor to write single byte to and close when "
+          "first frame is done.  Used by whitebox-startup-bench to measure "
+          "time to first frame.  -1 means no signal.");
+#endif  // WB_OS_POSIX
+
+#ifdef WB_OS_LINUX
+ABSL_FLAG(std::string, cpu_profile_path, "",
+          "folded stacks file path of the CPU profile.  When set, main thread "
+          "and workers stacks are sampled and written on exit in folded "
+          "format for flamegraph.pl, inferno or speedscope.  Empty means CPU "
+          "profiler is off.");
+
+ABSL_FLAG(std::uint32_t, cpu_profile_frequency_hz, 99U,
+          "how many CPU profiler samples to take per second of each thread CPU "
+          "time.");
+#endif  // WB_OS_LINUX
@@ -179,4 +179,54 @@ ABSL_DECLARE_FLAG(wb::apps::flags::PeriodicTimerResolution,
 // faults, etc.
 ABSL_DECLARE_FLAG(bool, should_dump_heap_allocator_statistics_on_exit);
 
+// Should heap allocator use large (2MiB) OS pages or not.
+ABSL_DECLARE_FLAG(bool, should_use_large_os_pages);
+
+// How many 1GiB huge OS pages heap allocator should reserve at startup.
+ABSL_DECLARE_FLAG(std::uint32_t, huge_os_pages_count);
+
+// How many MiBs heap allocator should reserve as memory pool at startup.
+ABSL_DECLARE_FLAG(std::uint32_t, heap_reserve_mib);
+
+// Should heap allocator pre-fault reserved memory pool at startup or not.
+ABSL_DECLARE_FLAG(bool, should_prefault_heap_reserve);
+
+// Mean KiBs allocated between heap profiler samples.  0 means heap profiler is
+// off.
+ABSL_DECLARE_FLAG(std::uint32_t, heap_profile_sampling_interval_kib);
+
+// Startup timeline trace file path.  Empty means no trace file.
+ABSL_DECLARE_FLAG(std::string, startup_trace_path);
+
+// Should profile lock contention and log most contended locks on exit or not.
+ABSL_DECLARE_FLAG(bool, should_profile_lock_contention);
+
+// Metrics export file path or unix:<socket path>.  Empty means no export.
+ABSL_DECLARE_FLAG(std::string, metrics_export_path);
+
+// Metrics export file rewrite interval in milliseconds.
+ABSL_DECLARE_FLAG(std::uint32_t, metrics_export_interval_ms);
+
+#ifdef WB_OS_POSIX
+// Should publish live frame telemetry to the shared memory or not.
+ABSL_DECLARE_FLAG(bool, should_publish_frame_telemetry);
+
+// Frame benchmark results file path.  Empty means no benchmark.
+ABSL_DECLARE_FLAG(std::string, frame_benchmark_results_path);
+
+// Frame benchmark frames count.
+ABSL_DECLARE_FLAG(std::uint32_t, frame_benchmark_frames_count);
+
+// Inherited file descriptor to signal first frame to.  -1 means no signal.
+ABSL_DECLARE_FLAG(std::int32_t, first_frame_signal_fd);
+#endif  // WB_OS_POSIX
+
+#ifdef WB_OS_LINUX
+// CPU profile folded stacks file path.  Empty means CPU profiler is off.
+ABSL_DECLARE_FLAG(std::string, cpu_profile_path);
+
+// CPU profiler samples per second of each thread CPU time.
+ABSL_DECLARE_FLAG(std::uint32_t, cpu_profile_frequency_hz);
+#endif  // WB_OS_LINUX
+
 #endif  // !WB_APPS_BASE_FLAGS_H_
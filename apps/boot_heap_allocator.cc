@@ -6,15 +6,19 @@
 
 #include "boot_heap_allocator.h"
 
-#include <cerrno>   // EFAULT
+#include <cerrno>  // EFAULT
+#include <chrono>
+#include <cstddef>
 #include <cstdlib>  // std::strstr
 #include <cstring>  // std::abort
+#include <utility>  // std::move
 
 #include "base/deps/g3log/g3log.h"
 #include "build/compiler_config.h"  // WB_COMPILER_
 
 #ifdef WB_MI_MALLOC
 #include "base/deps/mimalloc/mimalloc.h"
+#include "base/memory/virtual_memory.h"
 #include "base/std2/system_error_ext.h"
 
 #ifdef WB_COMPILER_MSVC
@@ -26,6 +30,63 @@
 #include "base/win/memory/memory_utils.h"
 #endif
 
+#ifdef WB_OS_LINUX
+#include <sys/mman.h>
+
+#include "base/resource_usage_unix.h"
+
+#ifndef MADV_POPULATE_WRITE
+// Linux 5.14+, older headers do not define it.
+#define MADV_POPULATE_WRITE 23
+#endif
+#endif
+
+namespace {
+
+/**
+ * @brief mimalloc huge OS page size.
+ */
+constexpr std::uint64_t kHugeOsPageSize{1024U * 1024U * 1024U};
+
+/**
+ * @brief Reserved huge OS pages bytes.
+ */
+std::uint64_t reserved_huge_os_pages_bytes{0};
+
+#ifdef WB_MI_MALLOC
+/**
+ * @brief Pre-faults memory, so first writes later do not page fault.  May
+ * write zeroes, so memory should not be used by anyone yet.
+ * @param memory Memory.  Should be committed and zeroed.
+ * @param size Memory size.
+ * @return Error code.
+ */
+[[nodiscard]] std::error_code PrefaultMemory(void* memory,
+                                             std::size_t size) noexcept {
+  using namespace wb::base;
+
+#ifdef WB_OS_LINUX
+  // Populates page tables in one call.
+  if (::madvise(memory, size, MADV_POPULATE_WRITE) == 0) [[likely]] {
+    return std2::ok_code;
+  }
+  if (errno != EINVAL) [[unlikely]] return std2::posix_last_error_code();
+  // Kernel is older than 5.14, touch pages.
+#endif
+
+  // Smallest OS page, so each page is touched on any OS.
+  constexpr std::size_t kMinOsPageSize{4096U};
+  auto* bytes = static_cast<volatile std::byte*>(memory);
+  for (std::size_t i{0}; i < size; i += kMinOsPageSize) {
+    bytes[i] = std::byte{0};
+  }
+
+  return std2::ok_code;
+}
+#endif  // WB_MI_MALLOC
+
+}  // namespace
+
 namespace wb::apps {
 
 #ifdef WB_MI_MALLOC
@@ -111,4 +172,141 @@ void BootHeapAllocator() noexcept {
 #endif  // WB_MI_MALLOC
 }
 
+void BootHeapAllocatorOsPages(bool should_use_large_os_pages,
+                              std::uint32_t huge_os_pages_count) noexcept {
+#ifdef WB_MI_MALLOC
+  if (should_use_large_os_pages) {
+    // mimalloc silently falls back to regular pages when large ones are not
+    // available (no privilege / no free large pages).
+    ::mi_option_enable(mi_option_large_os_pages);
+    G3LOG(INFO) << "Mi-malloc uses large OS pages when available.";
+  }
+
+  if (huge_os_pages_count > 0) {
+    // Pages are spread over NUMA nodes.  Kernel zeroes huge page, which takes
+    // up to ~0.5s per page.
+    const int rc{::mi_reserve_huge_os_pages_interleave(
+        huge_os_pages_count, 0, huge_os_pages_count * 500U)};
+    if (rc == 0) [[likely]] {
+      reserved_huge_os_pages_bytes = huge_os_pages_count * kHugeOsPageSize;
+
+      G3LOG(INFO) << "Mi-malloc reserved " << huge_os_pages_count
+                  << " huge OS pages (" << reserved_huge_os_pages_bytes
+                  << " bytes).";
+    } else {
+      // Some pages may be reserved on timeout, still they are used.
+      const auto error_code{base::std2::system_last_error_code(rc)};
+      G3PLOG_E(WARNING, error_code)
+          << "Mi-malloc can't reserve " << huge_os_pages_count
+          << " huge OS pages, continue with regular pages: ";
+    }
+  }
+#else
+  G3LOG_IF(WARNING, should_use_large_os_pages || huge_os_pages_count > 0)
+      << "Large / huge OS pages need mi-malloc heap allocator, continue with "
+         "regular pages.";
+#endif  // WB_MI_MALLOC
+}
+
+void BootHeapAllocatorReserve(std::uint64_t reserve_bytes,
+                              bool should_prefault) noexcept {
+  if (reserve_bytes == 0) return;
+
+#ifdef WB_MI_MALLOC
+  if (!should_prefault) {
+    // Not exclusive, so all heaps and arenas take memory from pool first.
+    mi_arena_id_t arena_id;
+    const int rc{::mi_reserve_os_memory_ex(
+        static_cast<std::size_t>(reserve_bytes), true,
+        ::mi_option_is_enabled(mi_option_large_os_pages), false, &arena_id)};
+    if (rc != 0) [[unlikely]] {
+      const auto error_code{base::std2::system_last_error_code(rc)};
+      G3PLOG_E(WARNING, error_code)
+          << "Mi-malloc can't reserve " << reserve_bytes
+          << " bytes memory pool, continue without it: ";
+      return;
+    }
+
+    G3LOG(INFO) << "Mi-malloc reserved " << reserve_bytes
+                << " bytes memory pool.";
+    return;
+  }
+
+  // Pool is pre-faulted before mimalloc sees it, as touching pages may write
+  // to them, and other threads allocate from pool as soon as it is managed.
+  auto pool = base::memory::VirtualMemory::Reserve(
+      static_cast<std::size_t>(reserve_bytes));
+  if (!pool.has_value()) [[unlikely]] {
+    G3PLOG_E(WARNING, pool.error())
+        << "Can't reserve " << reserve_bytes
+        << " bytes memory pool, continue without it: ";
+    return;
+  }
+
+  const std::error_code commit_rc{pool->Commit(0, pool->size())};
+  if (commit_rc) [[unlikely]] {
+    G3PLOG_E(WARNING, commit_rc)
+        << "Can't commit " << pool->size()
+        << " bytes memory pool, continue without it: ";
+    return;
+  }
+
+  const auto prefault_start = std::chrono::steady_clock::now();
+  const std::error_code prefault_rc{
+      PrefaultMemory(pool->data(), pool->size())};
+  const auto prefault_duration =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - prefault_start);
+
+  if (!prefault_rc) [[likely]] {
+    G3LOG(INFO) << "Pre-faulted " << pool->size()
+                << " bytes memory pool in " << prefault_duration.count()
+                << "ms.";
+  } else {
+    G3PLOG_E(WARNING, prefault_rc)
+        << "Can't pre-fault memory pool, continue with page faults on first "
+           "use: ";
+  }
+
+  // Not exclusive, so all heaps and arenas take memory from pool first.
+  // Fresh committed pages are zeroed.
+  mi_arena_id_t arena_id;
+  if (!::mi_manage_os_memory_ex(pool->data(), pool->size(), true, false, true,
+                                -1, false, &arena_id)) [[unlikely]] {
+    G3LOG(WARNING) << "Mi-malloc can't manage " << pool->size()
+                   << " bytes memory pool, continue without it.";
+    return;
+  }
+
+  // Managed by mimalloc till process exit, so never released.
+  static_cast<void>(new base::memory::VirtualMemory{std::move(*pool)});
+
+  G3LOG(INFO) << "Mi-malloc reserved " << reserve_bytes
+              << " bytes pre-faulted memory pool.";
+#else
+  G3LOG(WARNING) << "Memory pool of " << reserve_bytes << " bytes"
+                 << (should_prefault ? " with pre-faulting" : "")
+                 << " needs mi-malloc heap allocator, continue without it.";
+#endif  // WB_MI_MALLOC
+}
+
+void LogHeapAllocatorOsPagesUsage() noexcept {
+#ifdef WB_OS_LINUX
+  const auto huge_pages_backed_bytes = base::GetHugePagesBackedBytes();
+  if (huge_pages_backed_bytes.has_value()) [[likely]] {
+    G3LOG(INFO) << "Heap reserved huge OS pages "
+                << reserved_huge_os_pages_bytes
+                << " bytes, process memory backed by huge pages "
+                << *huge_pages_backed_bytes << " bytes.";
+  } else {
+    G3PLOG_E(WARNING, huge_pages_backed_bytes.error())
+        << "Heap reserved huge OS pages " << reserved_huge_os_pages_bytes
+        << " bytes, can't get process memory backed by huge pages: ";
+  }
+#else
+  G3LOG(INFO) << "Heap reserved huge OS pages " << reserved_huge_os_pages_bytes
+              << " bytes.";
+#endif  // WB_OS_LINUX
+}
+
 }  // namespace wb::apps
@@ -7,6 +7,8 @@
 #ifndef WB_APPS_BOOT_HEAP_ALLOCATOR_H_
 #define WB_APPS_BOOT_HEAP_ALLOCATOR_H_
 
+#include <cstdint>
+
 #include "build/compiler_config.h"
 
 namespace wb::apps {
@@ -16,6 +18,38 @@ namespace wb::apps {
  */
 void BootHeapAllocator() noexcept;
 
+/**
+ * @brief Setup heap allocator large / huge OS pages to reduce TLB misses on
+ * large working sets.  Call as soon as command line is parsed, as options
+ * apply to OS memory allocated after the call.  Falls back to regular pages
+ * when large / huge pages are not available.
+ * @param should_use_large_os_pages Should use large (2MiB) OS pages or not.
+ * @param huge_os_pages_count 1GiB huge OS pages count to reserve upfront.
+ * @return void.
+ */
+void BootHeapAllocatorOsPages(bool should_use_large_os_pages,
+                              std::uint32_t huge_os_pages_count) noexcept;
+
+/**
+ * @brief Reserves heap allocator memory pool up front and optionally pre-faults
+ * it, so mmap and page fault costs are paid on loading screen instead of
+ * gameplay.  Pool is shared by all heaps and arenas.  Pre-faulted pool is
+ * touched before heap allocator manages it, so uses regular OS pages.  Call
+ * after BootHeapAllocatorOsPages.
+ * @param reserve_bytes Pool size in bytes.  0 means no reservation.
+ * @param should_prefault Should touch pool pages now or not.
+ * @return void.
+ */
+void BootHeapAllocatorReserve(std::uint64_t reserve_bytes,
+                              bool should_prefault) noexcept;
+
+/**
+ * @brief Logs how much heap allocator memory is in reserved huge OS pages and
+ * how much process memory is actually backed by huge pages.
+ * @return void.
+ */
+void LogHeapAllocatorOsPagesUsage() noexcept;
+
 }  // namespace wb::apps
 
 #endif  // !WB_APPS_BOOT_HEAP_ALLOCATOR_H_
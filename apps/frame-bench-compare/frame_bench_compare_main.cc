@@ -0,0 +1,152 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Compares frame benchmark results of two WhiteBox app runs.
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "app_version_config.h"
+#include "apps/parse_command_line.h"
+#include "base/deps/abseil/flags/flag.h"
+#include "base/deps/fmt/core.h"
+#include "base/deps/g3log/scoped_g3log_initializer.h"
+#include "base/std2/system_error_ext.h"
+#include "base/telemetry/frame_benchmark.h"
+#include "build/static_settings_config.h"
+
+ABSL_FLAG(std::string, baseline, "", "baseline frame benchmark results path.");
+
+ABSL_FLAG(std::string, candidate, "",
+          "candidate frame benchmark results path.");
+
+ABSL_FLAG(double, threshold_percent, 3.0,
+          "min significant relative change in percents.  Tail frame times use "
+          "scaled up threshold as they are noisier.");
+
+namespace {
+
+/**
+ * @brief Usage message.
+ */
+constexpr char kUsageMessage[] =
+    "Compares frame benchmark results of the WhiteBox app started with "
+    "--frame_benchmark_results_path.  Exits with 0 when candidate is same or "
+    "better than baseline, 2 when worse and 1 on error.\n\nSample usage:\n";
+
+/**
+ * @brief Exit code when candidate is worse than baseline.
+ */
+constexpr int kRegressionExitCode{2};
+
+/**
+ * @brief Reads frame benchmark results.
+ * @param path Results path.
+ * @return Results.
+ */
+[[nodiscard]] wb::base::std2::result<
+    wb::base::telemetry::FrameBenchmarkResults>
+ReadResults(const std::string& path) {
+  std::ifstream file{path, std::ios::in | std::ios::binary};
+  if (!file) [[unlikely]] {
+    return wb::base::std2::result<wb::base::telemetry::FrameBenchmarkResults>{
+        std::unexpect, wb::base::std2::posix_last_error_code(ENOENT)};
+  }
+
+  std::stringstream json;
+  json << file.rdbuf();
+  return wb::base::telemetry::ParseFrameBenchmarkResults(json.str());
+}
+
+/**
+ * @brief Gets verdict name.
+ * @param verdict Verdict.
+ * @return Verdict name.
+ */
+[[nodiscard]] constexpr const char* GetVerdictName(
+    wb::base::telemetry::FrameBenchmarkVerdict verdict) noexcept {
+  using wb::base::telemetry::FrameBenchmarkVerdict;
+
+  switch (verdict) {
+    case FrameBenchmarkVerdict::kSame:
+      return "same";
+    case FrameBenchmarkVerdict::kBetter:
+      return "better";
+    case FrameBenchmarkVerdict::kWorse:
+      return "WORSE";
+  }
+  return "unknown";
+}
+
+/**
+ * @brief Prints comparisons and gets exit code.
+ * @param comparisons Metrics comparisons.
+ * @return App exit code.
+ */
+int PrintComparisons(
+    const std::vector<wb::base::telemetry::FrameBenchmarkMetricComparison>&
+        comparisons) {
+  using wb::base::telemetry::FrameBenchmarkVerdict;
+
+  fmt::print("{:<28} {:>16} {:>16} {:>10} {:>10} {:>8}\n", "metric",
+             "baseline", "candidate", "change %", "noise %", "verdict");
+
+  bool is_worse{false};
+  for (const auto& comparison : comparisons) {
+    fmt::print("{:<28} {:>16.3f} {:>16.3f} {:>+10.2f} {:>10.2f} {:>8}\n",
+               comparison.name, comparison.baseline, comparison.candidate,
+               comparison.change_percent, comparison.threshold_percent,
+               GetVerdictName(comparison.verdict));
+
+    is_worse |= comparison.verdict == FrameBenchmarkVerdict::kWorse;
+  }
+
+  fmt::print("\nCandidate is {0} than baseline.\n",
+             is_worse ? "worse" : "same or better");
+  return is_worse ? kRegressionExitCode : 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  // Initialize g3log logging library first as logs are used extensively.
+  const wb::base::deps::g3log::ScopedG3LogInitializer scoped_g3log_initializer{
+      argv[0], wb::build::settings::kPathToMainLogFile};
+
+  [[maybe_unused]] const std::vector<char*> positional_flags{
+      wb::apps::ParseCommandLine(
+          argc, argv,
+          {.app_name = WB_PRODUCT_FILE_DESCRIPTION_STRING,
+           .app_version = WB_PRODUCT_FILE_VERSION_INFO_STRING,
+           .app_usage = kUsageMessage})};
+
+  const std::string baseline_path{absl::GetFlag(FLAGS_baseline)};
+  const std::string candidate_path{absl::GetFlag(FLAGS_candidate)};
+  if (baseline_path.empty() || candidate_path.empty()) [[unlikely]] {
+    fmt::print(stderr,
+               "Please, specify results paths via --baseline and "
+               "--candidate.\n");
+    return 1;
+  }
+
+  const auto baseline = ReadResults(baseline_path);
+  if (!baseline.has_value()) [[unlikely]] {
+    fmt::print(stderr, "Unable to read baseline results {0}: {1}.\n",
+               baseline_path, baseline.error().message());
+    return 1;
+  }
+
+  const auto candidate = ReadResults(candidate_path);
+  if (!candidate.has_value()) [[unlikely]] {
+    fmt::print(stderr, "Unable to read candidate results {0}: {1}.\n",
+               candidate_path, candidate.error().message());
+    return 1;
+  }
+
+  return PrintComparisons(wb::base::telemetry::CompareFrameBenchmarkResults(
+      *baseline, *candidate, absl::GetFlag(FLAGS_threshold_percent)));
+}
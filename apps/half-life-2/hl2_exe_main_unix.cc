@@ -4,6 +4,8 @@
 //
 // The entry point for *nix Half-Life 2 process.
 
+#include <algorithm>
+#include <chrono>
 #include <string_view>
 
 #include "app_version_config.h"
@@ -18,9 +20,11 @@
 #include "base/deps/g3log/scoped_g3log_initializer.h"
 #include "base/intl/l18n.h"
 #include "base/intl/scoped_process_locale.h"
+#include "base/memory/heap_profiler.h"
 #include "base/scoped_new_handler.h"
 #include "base/scoped_shared_library.h"
 #include "base/std2/filesystem_ext.h"
+#include "base/telemetry/startup_timeline.h"
 #include "boot-manager/main.h"
 #include "build/static_settings_config.h"
 #include "hl2_exe_flags.h"
@@ -42,23 +46,55 @@ int BootManagerStartup(int argc, char** argv) noexcept {
   using namespace wb::base;
   using namespace wb::ui;
 
+  telemetry::ScopedStartupPhase parse_command_line_phase{"ParseCommandLine"};
   // Setup command line flags as they are used early.
   std::vector<char*> positional_flags{wb::apps::ParseCommandLine(
       argc, argv,
       {.app_name = WB_PRODUCT_FILE_DESCRIPTION_STRING,
        .app_version = WB_PRODUCT_FILE_VERSION_INFO_STRING,
        .app_usage = wb::apps::half_life_2::kUsageMessage})};
+  parse_command_line_phase.End();
 
+  telemetry::ScopedStartupPhase boot_heap_allocator_os_pages_phase{
+      "BootHeapAllocatorOsPages"};
+  // Large / huge OS pages should be set up before working set grows.
+  wb::apps::BootHeapAllocatorOsPages(
+      absl::GetFlag(FLAGS_should_use_large_os_pages),
+      absl::GetFlag(FLAGS_huge_os_pages_count));
+  boot_heap_allocator_os_pages_phase.End();
+
+  telemetry::ScopedStartupPhase boot_heap_allocator_reserve_phase{
+      "BootHeapAllocatorReserve"};
+  // Pay mmap / page faults costs before first frame.
+  wb::apps::BootHeapAllocatorReserve(
+      static_cast<std::uint64_t>(absl::GetFlag(FLAGS_heap_reserve_mib)) *
+          1024U * 1024U,
+      absl::GetFlag(FLAGS_should_prefault_heap_reserve));
+  boot_heap_allocator_reserve_phase.End();
+
+  // Sample heap allocations to find top allocation sites.
+  if (const std::uint32_t heap_profile_sampling_interval_kib{
+          absl::GetFlag(FLAGS_heap_profile_sampling_interval_kib)};
+      heap_profile_sampling_interval_kib != 0U) {
+    wb::base::memory::EnableHeapProfiling(
+        static_cast<std::uint64_t>(heap_profile_sampling_interval_kib) * 1024U);
+  }
+
+  telemetry::ScopedStartupPhase create_intl_phase{"CreateIntl"};
   // Start with specifying UTF-8 locale for all user-facing data.
   const intl::ScopedProcessLocale scoped_process_locale{
       intl::ScopedProcessLocaleCategory::kAll, intl::locales::kUtf8Locale};
   const auto l18n = wb::apps::CreateIntl(WB_PRODUCT_FILE_DESCRIPTION_STRING,
                                          scoped_process_locale);
+  create_intl_phase.End();
 
+  telemetry::ScopedStartupPhase query_cpu_features_phase{
+      "QueryRequiredCpuFeatures"};
   // Query CPU support for required features.  In case any required feature is
   // missed we return all required features with support state.
   const std::vector<wb::apps::CpuFeature> cpu_features_support{
       wb::apps::QueryRequiredCpuFeatures()};
+  query_cpu_features_phase.End();
   if (!cpu_features_support.empty()) [[unlikely]] {
     const std::string cpu_features_support_state{absl::StrJoin(
         cpu_features_support, "\n",
@@ -99,8 +135,10 @@ int BootManagerStartup(int argc, char** argv) noexcept {
   app_path /= "libwhitebox-boot-manager.so." WB_PRODUCT_VERSION_INFO_STRING;
 
   const std::string boot_manager_path{app_path.string()};
+  telemetry::ScopedStartupPhase load_boot_manager_phase{"LoadBootManager"};
   const auto boot_manager_library = ScopedSharedLibrary::FromLibraryOnPath(
       boot_manager_path, RTLD_LAZY | RTLD_LOCAL);
+  load_boot_manager_phase.End();
   if (boot_manager_library.has_value()) [[likely]] {
     using BootManagerMain = decltype(&BootManagerMain);
     // NOLINTNEXTLINE(modernize-avoid-c-arrays)
@@ -113,25 +151,55 @@ int BootManagerStartup(int argc, char** argv) noexcept {
         boot_manager.GetAddressAs<BootManagerMain>(kBootManagerMainName);
     if (boot_manager_entry.has_value()) [[likely]] {
       wb::apps::flags::AssetsPath assets_path{absl::GetFlag(FLAGS_assets_path)};
+      std::string startup_trace_path{absl::GetFlag(FLAGS_startup_trace_path)};
+      std::string metrics_export_path{absl::GetFlag(FLAGS_metrics_export_path)};
+      const std::uint32_t metrics_export_interval_ms{
+          absl::GetFlag(FLAGS_metrics_export_interval_ms)};
+      std::string frame_benchmark_results_path{
+          absl::GetFlag(FLAGS_frame_benchmark_results_path)};
+      std::string cpu_profile_path{absl::GetFlag(FLAGS_cpu_profile_path)};
+      const std::uint32_t cpu_profile_frequency_hz{
+          std::max(absl::GetFlag(FLAGS_cpu_profile_frequency_hz), 1U)};
 
       const std::uint32_t attempts_to_retry_allocate_memory{
           absl::GetFlag(FLAGS_attempts_to_retry_allocate_memory)};
+      const std::uint32_t frame_benchmark_frames_count{
+          absl::GetFlag(FLAGS_frame_benchmark_frames_count)};
+      const std::int32_t first_frame_signal_fd{
+          absl::GetFlag(FLAGS_first_frame_signal_fd)};
       const wb::apps::flags::WindowWidth main_window_width{
           absl::GetFlag(FLAGS_main_window_width)};
       const wb::apps::flags::WindowHeight main_window_height{
           absl::GetFlag(FLAGS_main_window_height)};
       const bool should_dump_heap_allocator_statistics_on_exit{
           absl::GetFlag(FLAGS_should_dump_heap_allocator_statistics_on_exit)};
+      const bool should_publish_frame_telemetry{
+          absl::GetFlag(FLAGS_should_publish_frame_telemetry)};
+      const bool should_profile_lock_contention{
+          absl::GetFlag(FLAGS_should_profile_lock_contention)};
       const wb::boot_manager::CommandLineFlags command_line_flags{
           .positional_flags = std::move(positional_flags),
           .assets_path = std::move(assets_path.value),
+          .startup_trace_path = std::move(startup_trace_path),
+          .metrics_export_path = std::move(metrics_export_path),
+          .metrics_export_interval =
+              std::chrono::milliseconds{metrics_export_interval_ms},
+          .frame_benchmark_results_path =
+              std::move(frame_benchmark_results_path),
+          .cpu_profile_path = std::move(cpu_profile_path),
+          .cpu_profile_sampling_interval =
+              std::chrono::microseconds{1'000'000U / cpu_profile_frequency_hz},
           .attempts_to_retry_allocate_memory =
               attempts_to_retry_allocate_memory,
+          .frame_benchmark_frames_count = frame_benchmark_frames_count,
+          .first_frame_signal_fd = first_frame_signal_fd,
           .main_window_width = main_window_width.size,
           .main_window_height = main_window_height.size,
           .insecure_allow_unsigned_module_target = false,
           .should_dump_heap_allocator_statistics_on_exit =
-              should_dump_heap_allocator_statistics_on_exit};
+              should_dump_heap_allocator_statistics_on_exit,
+          .should_publish_frame_telemetry = should_publish_frame_telemetry,
+          .should_profile_lock_contention = should_profile_lock_contention};
 
 #ifdef WB_MI_MALLOC
       // Dumps mimalloc stats on exit?
@@ -150,9 +218,21 @@ int BootManagerStartup(int argc, char** argv) noexcept {
       const auto boot_manager_main = *boot_manager_entry;
       G3CHECK(!!boot_manager_main);
 
-      return (*boot_manager_main)(
+      const int exit_code{(*boot_manager_main)(
           {std::string_view{WB_PRODUCT_FILE_DESCRIPTION_STRING},
-           command_line_flags, l18n});
+           command_line_flags, l18n})};
+
+      // How much of working set ended up in huge pages?
+      if (should_dump_heap_allocator_statistics_on_exit) {
+        wb::apps::LogHeapAllocatorOsPagesUsage();
+      }
+
+      // Which allocation sites hold / churn most heap?
+      if (wb::base::memory::IsHeapProfilingEnabled()) {
+        wb::base::memory::LogHeapProfile(16U);
+      }
+
+      return exit_code;
     }
 
     return FatalDialog(
@@ -180,12 +260,20 @@ int BootManagerStartup(int argc, char** argv) noexcept {
 }  // namespace
 
 int main(int argc, char* argv[]) {
+  using wb::base::telemetry::ScopedStartupPhase;
+
+  // Startup timeline starts here.
+  ScopedStartupPhase g3log_initializer_phase{"ScopedG3LogInitializer"};
   // Initialize g3log logging library first as logs are used extensively.
   const wb::base::deps::g3log::ScopedG3LogInitializer scoped_g3log_initializer{
       argv[0], wb::build::settings::kPathToMainLogFile};
+  g3log_initializer_phase.End();
 
-  // Install heap allocator tracing / set options.
-  wb::apps::BootHeapAllocator();
+  {
+    const ScopedStartupPhase boot_heap_allocator_phase{"BootHeapAllocator"};
+    // Install heap allocator tracing / set options.
+    wb::apps::BootHeapAllocator();
+  }
 
   return BootManagerStartup(argc, argv);
 }
\ No newline at end of file
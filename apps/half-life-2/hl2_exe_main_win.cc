@@ -19,8 +19,10 @@
 #include "base/intl/l18n.h"
 #include "base/intl/lookup.h"
 #include "base/intl/scoped_process_locale.h"
+#include "base/memory/heap_profiler.h"
 #include "base/scoped_new_handler.h"
 #include "base/scoped_shared_library.h"
+#include "base/telemetry/startup_timeline.h"
 #include "base/win/com/scoped_com_fatal_exception_handler.h"
 #include "base/win/com/scoped_com_strong_unmarshalling_policy.h"
 #include "base/win/com/scoped_thread_com_initializer.h"
@@ -82,6 +84,10 @@ namespace {
 [[nodiscard]] wb::boot_manager::CommandLineFlags MakeCommandLineFlags(
     std::vector<char*> positional_flags) noexcept {
   wb::apps::flags::AssetsPath assets_path{absl::GetFlag(FLAGS_assets_path)};
+  std::string startup_trace_path{absl::GetFlag(FLAGS_startup_trace_path)};
+  std::string metrics_export_path{absl::GetFlag(FLAGS_metrics_export_path)};
+  const std::uint32_t metrics_export_interval_ms{
+      absl::GetFlag(FLAGS_metrics_export_interval_ms)};
   const std::uint32_t attempts_to_retry_allocate_memory{
       absl::GetFlag(FLAGS_attempts_to_retry_allocate_memory)};
   const wb::apps::flags::PeriodicTimerResolution periodic_timer_resolution{
@@ -94,18 +100,28 @@ namespace {
       absl::GetFlag(FLAGS_insecure_allow_unsigned_module_target)};
   const bool should_dump_heap_allocator_statistics_on_exit{
       absl::GetFlag(FLAGS_should_dump_heap_allocator_statistics_on_exit)};
+  const bool should_profile_lock_contention{
+      absl::GetFlag(FLAGS_should_profile_lock_contention)};
 
   return {
       .positional_flags = std::move(positional_flags),
       .assets_path = std::move(assets_path.value),
+      .startup_trace_path = std::move(startup_trace_path),
+      .metrics_export_path = std::move(metrics_export_path),
+      .metrics_export_interval =
+          std::chrono::milliseconds{metrics_export_interval_ms},
+      .frame_benchmark_results_path = {},
       .attempts_to_retry_allocate_memory = attempts_to_retry_allocate_memory,
+      .frame_benchmark_frames_count = 0U,
       .periodic_timer_resolution_ms = periodic_timer_resolution.ms,
       .main_window_width = main_window_width.size,
       .main_window_height = main_window_height.size,
       .insecure_allow_unsigned_module_target =
           insecure_allow_unsigned_module_target,
       .should_dump_heap_allocator_statistics_on_exit =
-          should_dump_heap_allocator_statistics_on_exit};
+          should_dump_heap_allocator_statistics_on_exit,
+      .should_publish_frame_telemetry = false,
+      .should_profile_lock_contention = should_profile_lock_contention};
 }
 
 /**
@@ -169,8 +185,10 @@ int BootManagerStartup(
   // state into void(void), so need global variable to access state in handler.
   InstallGlobalScopedNewHandler(std::move(scoped_new_handler));
 
+  telemetry::ScopedStartupPhase load_boot_manager_phase{"LoadBootManager"};
   const auto boot_manager_library = ScopedSharedLibrary::FromLibraryOnPath(
       boot_manager_path, boot_manager_flags);
+  load_boot_manager_phase.End();
   if (const std::error_code& error =
           boot_manager_library.error_or(std2::ok_code)) [[unlikely]] {
     return wb::ui::FatalDialog(
@@ -210,10 +228,22 @@ int BootManagerStartup(
   const auto boot_manager_main = *boot_manager_entry;
   G3CHECK(!!boot_manager_main);
 
-  return (*boot_manager_main)(
+  const int exit_code{(*boot_manager_main)(
       {instance, std::string_view{WB_PRODUCT_FILE_DESCRIPTION_STRING},
        show_window_flags, WB_HALF_LIFE_2_IDI_MAIN_ICON,
-       WB_HALF_LIFE_2_IDI_SMALL_ICON, command_line_flags, intl});
+       WB_HALF_LIFE_2_IDI_SMALL_ICON, command_line_flags, intl})};
+
+  // How much of working set ended up in huge pages?
+  if (command_line_flags.should_dump_heap_allocator_statistics_on_exit) {
+    wb::apps::LogHeapAllocatorOsPagesUsage();
+  }
+
+  // Which allocation sites hold / churn most heap?
+  if (wb::base::memory::IsHeapProfilingEnabled()) {
+    wb::base::memory::LogHeapProfile(16U);
+  }
+
+  return exit_code;
 }
 
 }  // namespace
@@ -234,12 +264,18 @@ int WINAPI WinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE,
   const char* full_command_line_ansi{::GetCommandLineA()};
   const wchar_t* full_command_line_wide{::GetCommandLineW()};
 
+  // Startup timeline starts here.
+  telemetry::ScopedStartupPhase g3log_initializer_phase{
+      "ScopedG3LogInitializer"};
   // Initialize g3log logging library first as logs are used extensively.
   const deps::g3log::ScopedG3LogInitializer scoped_g3log_initializer{
       full_command_line_ansi, wb::build::settings::kPathToMainLogFile};
+  g3log_initializer_phase.End();
 
+  telemetry::ScopedStartupPhase boot_heap_allocator_phase{"BootHeapAllocator"};
   // Install heap allocator tracing / set options.
   wb::apps::BootHeapAllocator();
+  boot_heap_allocator_phase.End();
 
   // Remove current directory from default DLL search order to reduce chances
   // of DLL planting attacks.
@@ -252,11 +288,13 @@ int WINAPI WinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE,
       << "Can't set remove current directory from default DLL search order.  "
          "DLL planting attacks are still possible.";
 
+  telemetry::ScopedStartupPhase create_intl_phase{"CreateIntl"};
   // Start with specifying UTF-8 locale for all user-facing data.
   const intl::ScopedProcessLocale scoped_process_locale{
       intl::ScopedProcessLocaleCategory::kAll, intl::locales::kUtf8Locale};
   const auto l18n = wb::apps::CreateIntl(WB_PRODUCT_FILE_DESCRIPTION_STRING,
                                          scoped_process_locale);
+  create_intl_phase.End();
 
   // Initialize COM.  Required as ui::ShowDialogBox may call ShellExecute which
   // can delegate execution to shell extensions that are activated using COM.
@@ -270,8 +308,11 @@ int WINAPI WinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE,
 
   // Query CPU support for required features.  In case any required feature is
   // missed we return all required features with support state.
+  telemetry::ScopedStartupPhase query_cpu_features_phase{
+      "QueryRequiredCpuFeatures"};
   const std::vector<wb::apps::CpuFeature> cpu_features_support{
       wb::apps::QueryRequiredCpuFeatures()};
+  query_cpu_features_phase.End();
   if (!cpu_features_support.empty()) [[unlikely]] {
     const std::string cpu_features_support_state{absl::StrJoin(
         cpu_features_support, "\n",
@@ -309,11 +350,38 @@ int WINAPI WinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE,
 
   const wb::apps::win::Args& args = args_parse_result.value();
   // Setup command line flags as they are used early.
+  telemetry::ScopedStartupPhase parse_command_line_phase{"ParseCommandLine"};
   std::vector<char*> positional_flags{wb::apps::ParseCommandLine(
       args.count(), args.values(),
       {.app_name = WB_PRODUCT_FILE_DESCRIPTION_STRING,
        .app_version = WB_PRODUCT_FILE_VERSION_INFO_STRING,
        .app_usage = wb::apps::half_life_2::kUsageMessage})};
+  parse_command_line_phase.End();
+
+  telemetry::ScopedStartupPhase boot_heap_allocator_os_pages_phase{
+      "BootHeapAllocatorOsPages"};
+  // Large / huge OS pages should be set up before working set grows.
+  wb::apps::BootHeapAllocatorOsPages(
+      absl::GetFlag(FLAGS_should_use_large_os_pages),
+      absl::GetFlag(FLAGS_huge_os_pages_count));
+  boot_heap_allocator_os_pages_phase.End();
+
+  telemetry::ScopedStartupPhase boot_heap_allocator_reserve_phase{
+      "BootHeapAllocatorReserve"};
+  // Pay mmap / page faults costs before first frame.
+  wb::apps::BootHeapAllocatorReserve(
+      static_cast<std::uint64_t>(absl::GetFlag(FLAGS_heap_reserve_mib)) *
+          1024U * 1024U,
+      absl::GetFlag(FLAGS_should_prefault_heap_reserve));
+  boot_heap_allocator_reserve_phase.End();
+
+  // Sample heap allocations to find top allocation sites.
+  if (const std::uint32_t heap_profile_sampling_interval_kib{
+          absl::GetFlag(FLAGS_heap_profile_sampling_interval_kib)};
+      heap_profile_sampling_interval_kib != 0U) {
+    wb::base::memory::EnableHeapProfiling(
+        static_cast<std::uint64_t>(heap_profile_sampling_interval_kib) * 1024U);
+  }
 
   // Calling thread will handle critical errors, does not show general
   // protection fault error box and message box when OpenFile failed to find
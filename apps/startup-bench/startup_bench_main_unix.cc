@@ -0,0 +1,381 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Measures time to first frame of WhiteBox app over warm and cold starts.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "app_version_config.h"
+#include "apps/parse_command_line.h"
+#include "base/deps/abseil/flags/flag.h"
+#include "base/deps/fmt/core.h"
+#include "base/deps/g3log/scoped_g3log_initializer.h"
+#include "base/std2/system_error_ext.h"
+#include "build/static_settings_config.h"
+
+extern char** environ;
+
+ABSL_FLAG(std::string, app_path, "",
+          "path to the WhiteBox app executable to start, ex. half-life-2.");
+
+ABSL_FLAG(std::uint32_t, runs, 10U, "how many starts to measure per mode.");
+
+ABSL_FLAG(std::string, mode, "both",
+          "starts to measure: warm, cold or both.  Cold start drops page "
+          "cache before each run, which requires root.");
+
+ABSL_FLAG(std::uint32_t, timeout_ms, 60000U,
+          "max time to wait for the first frame in milliseconds.");
+
+namespace {
+
+/**
+ * @brief Usage message.
+ */
+constexpr char kUsageMessage[] =
+    "Starts the WhiteBox app repeatedly and measures time from exec to the "
+    "first frame.  App signals first frame via pipe passed as "
+    "--first_frame_signal_fd.  App flags can be passed after --.\n\nSample "
+    "usage:\n";
+
+/**
+ * @brief File descriptor of first frame signal pipe in app.  High enough to
+ * not clash with app descriptors.
+ */
+constexpr int kAppFirstFrameSignalFd{100};
+
+/**
+ * @brief How long to wait for app exit after SIGTERM before SIGKILL.
+ */
+constexpr std::chrono::seconds kAppExitTimeout{5};
+
+/**
+ * @brief Start times distribution.
+ */
+struct StartTimeStats {
+  /**
+   * @brief Min, ms.
+   */
+  double min_ms;
+  /**
+   * @brief Median, ms.
+   */
+  double p50_ms;
+  /**
+   * @brief 90th percentile, ms.
+   */
+  double p90_ms;
+  /**
+   * @brief Max, ms.
+   */
+  double max_ms;
+  /**
+   * @brief Mean, ms.
+   */
+  double mean_ms;
+  /**
+   * @brief Standard deviation, ms.
+   */
+  double stddev_ms;
+};
+
+/**
+ * @brief Drops Linux page, dentries and inodes caches, so next start is cold.
+ * @return Error code.
+ */
+[[nodiscard]] std::error_code DropPageCache() noexcept {
+  using namespace wb::base;
+
+  ::sync();
+
+  const int fd{::open("/proc/sys/vm/drop_caches", O_WRONLY | O_CLOEXEC)};
+  if (fd == -1) [[unlikely]] {
+    return std2::posix_last_error_code();
+  }
+
+  constexpr char kDropAllCaches[]{"3"};
+  const std::error_code rc{
+      ::write(fd, kDropAllCaches, sizeof(kDropAllCaches) - 1) == -1
+          ? std2::posix_last_error_code()
+          : std2::ok_code};
+  ::close(fd);
+  return rc;
+}
+
+/**
+ * @brief Stops app.  Sends SIGTERM and SIGKILL if app is not exited in time.
+ * @param pid App process id.
+ * @return void.
+ */
+void StopApp(pid_t pid) noexcept {
+  ::kill(pid, SIGTERM);
+
+  const auto deadline = std::chrono::steady_clock::now() + kAppExitTimeout;
+  int status;
+  while (::waitpid(pid, &status, WNOHANG) == 0) {
+    if (std::chrono::steady_clock::now() >= deadline) [[unlikely]] {
+      ::kill(pid, SIGKILL);
+      ::waitpid(pid, &status, 0);
+      return;
+    }
+
+    using namespace std::chrono_literals;
+    std::this_thread::sleep_for(10ms);
+  }
+}
+
+/**
+ * @brief Starts app and measures time to first frame.
+ * @param app_args App arguments, null terminated.
+ * @param timeout Max time to wait for first frame.
+ * @return Time to first frame.
+ */
+[[nodiscard]] wb::base::std2::result<std::chrono::nanoseconds> MeasureStart(
+    const std::vector<char*>& app_args,
+    std::chrono::milliseconds timeout) noexcept {
+  using namespace wb::base;
+
+  int signal_fds[2];
+  if (::pipe2(signal_fds, O_CLOEXEC) == -1) [[unlikely]] {
+    return std2::result<std::chrono::nanoseconds>{
+        std::unexpect, std2::posix_last_error_code()};
+  }
+
+  const int read_fd{signal_fds[0]}, write_fd{signal_fds[1]};
+
+  // dup2 clears close on exec flag, so app inherits only this one.
+  posix_spawn_file_actions_t file_actions;
+  ::posix_spawn_file_actions_init(&file_actions);
+  ::posix_spawn_file_actions_adddup2(&file_actions, write_fd,
+                                     kAppFirstFrameSignalFd);
+
+  const auto start_time = std::chrono::steady_clock::now();
+
+  pid_t pid;
+  const int spawn_rc{::posix_spawn(&pid, app_args[0], &file_actions, nullptr,
+                                   app_args.data(), environ)};
+  ::posix_spawn_file_actions_destroy(&file_actions);
+  // Now only app holds write end, so app exit is EOF.
+  ::close(write_fd);
+
+  if (spawn_rc != 0) [[unlikely]] {
+    ::close(read_fd);
+    return std2::result<std::chrono::nanoseconds>{
+        std::unexpect, std2::posix_last_error_code(spawn_rc)};
+  }
+
+  pollfd poll_fd{.fd = read_fd, .events = POLLIN, .revents = 0};
+  int poll_rc;
+  do {
+    poll_rc = ::poll(&poll_fd, 1, static_cast<int>(timeout.count()));
+  } while (poll_rc == -1 && errno == EINTR);
+
+  const auto first_frame_time = std::chrono::steady_clock::now();
+
+  std::error_code rc;
+  if (poll_rc == -1) [[unlikely]] {
+    rc = std2::posix_last_error_code();
+  } else if (poll_rc == 0) [[unlikely]] {
+    rc = std2::posix_last_error_code(ETIMEDOUT);
+  } else {
+    char signal;
+    // EOF means app exited without first frame.
+    if (::read(read_fd, &signal, sizeof(signal)) != 1) [[unlikely]] {
+      rc = std2::posix_last_error_code(ECHILD);
+    }
+  }
+
+  ::close(read_fd);
+  StopApp(pid);
+
+  if (rc) [[unlikely]] {
+    return std2::result<std::chrono::nanoseconds>{std::unexpect, rc};
+  }
+
+  return first_frame_time - start_time;
+}
+
+/**
+ * @brief Gets nearest rank percentile of sorted values.
+ * @param sorted_values Sorted values.
+ * @param percentile Percentile, [0..100].
+ * @return Percentile value.
+ */
+[[nodiscard]] double GetPercentile(const std::vector<double>& sorted_values,
+                                   double percentile) noexcept {
+  const auto rank = static_cast<std::size_t>(std::ceil(
+      percentile / 100.0 * static_cast<double>(sorted_values.size())));
+  return sorted_values[std::clamp(rank, std::size_t{1}, sorted_values.size()) -
+                       1U];
+}
+
+/**
+ * @brief Computes start times distribution.
+ * @param start_times_ms Start times, ms.  Non empty.
+ * @return Distribution.
+ */
+[[nodiscard]] StartTimeStats ComputeStats(std::vector<double> start_times_ms) {
+  std::sort(start_times_ms.begin(), start_times_ms.end());
+
+  const auto count = static_cast<double>(start_times_ms.size());
+  const double mean_ms{
+      std::accumulate(start_times_ms.begin(), start_times_ms.end(), 0.0) /
+      count};
+
+  double variance_ms{0.0};
+  for (const double start_time_ms : start_times_ms) {
+    variance_ms += (start_time_ms - mean_ms) * (start_time_ms - mean_ms);
+  }
+
+  return {.min_ms = start_times_ms.front(),
+          .p50_ms = GetPercentile(start_times_ms, 50.0),
+          .p90_ms = GetPercentile(start_times_ms, 90.0),
+          .max_ms = start_times_ms.back(),
+          .mean_ms = mean_ms,
+          .stddev_ms = std::sqrt(variance_ms / count)};
+}
+
+/**
+ * @brief Measures app starts and prints distribution.
+ * @param mode_name Mode name.
+ * @param app_args App arguments, null terminated.
+ * @param runs_count Starts count.
+ * @param timeout Max time to wait for first frame.
+ * @param is_cold Should drop page cache before each start or not.
+ * @return true on success.
+ */
+[[nodiscard]] bool MeasureStarts(std::string_view mode_name,
+                                 const std::vector<char*>& app_args,
+                                 std::uint32_t runs_count,
+                                 std::chrono::milliseconds timeout,
+                                 bool is_cold) {
+  if (is_cold) {
+    const std::error_code rc{DropPageCache()};
+    if (rc) [[unlikely]] {
+      fmt::print(stderr,
+                 "Unable to drop page cache: {0}.  Skipping cold starts, run "
+                 "as root to measure them.\n",
+                 rc.message());
+      // Not permitted is not an error.
+      return true;
+    }
+  } else {
+    // Warm up page cache, dynamic loader & GPU driver caches.
+    const auto warm_up = MeasureStart(app_args, timeout);
+    if (!warm_up.has_value()) [[unlikely]] {
+      fmt::print(stderr, "Warm up start failed: {0}.\n",
+                 warm_up.error().message());
+      return false;
+    }
+  }
+
+  std::vector<double> start_times_ms;
+  start_times_ms.reserve(runs_count);
+
+  for (std::uint32_t i{0}; i < runs_count; ++i) {
+    if (is_cold) {
+      const std::error_code rc{DropPageCache()};
+      if (rc) [[unlikely]] {
+        fmt::print(stderr, "Unable to drop page cache: {0}.\n", rc.message());
+        return false;
+      }
+    }
+
+    const auto start_time = MeasureStart(app_args, timeout);
+    if (!start_time.has_value()) [[unlikely]] {
+      fmt::print(stderr, "{0} start #{1} failed: {2}.\n", mode_name, i + 1,
+                 start_time.error().message());
+      return false;
+    }
+
+    start_times_ms.emplace_back(
+        std::chrono::duration<double, std::milli>{*start_time}.count());
+  }
+
+  const StartTimeStats stats{ComputeStats(std::move(start_times_ms))};
+  fmt::print(
+      "{:<6} {:>6} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} "
+      "{:>10.1f}\n",
+      mode_name, runs_count, stats.min_ms, stats.p50_ms, stats.p90_ms,
+      stats.max_ms, stats.mean_ms, stats.stddev_ms);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  // Initialize g3log logging library first as logs are used extensively.
+  const wb::base::deps::g3log::ScopedG3LogInitializer scoped_g3log_initializer{
+      argv[0], wb::build::settings::kPathToMainLogFile};
+
+  const std::vector<char*> positional_flags{wb::apps::ParseCommandLine(
+      argc, argv,
+      {.app_name = WB_PRODUCT_FILE_DESCRIPTION_STRING,
+       .app_version = WB_PRODUCT_FILE_VERSION_INFO_STRING,
+       .app_usage = kUsageMessage})};
+
+  std::string app_path{absl::GetFlag(FLAGS_app_path)};
+  if (app_path.empty()) [[unlikely]] {
+    fmt::print(stderr, "Please, specify app executable via --app_path.\n");
+    return 1;
+  }
+
+  const std::string mode{absl::GetFlag(FLAGS_mode)};
+  const bool should_measure_warm{mode == "warm" || mode == "both"};
+  const bool should_measure_cold{mode == "cold" || mode == "both"};
+  if (!should_measure_warm && !should_measure_cold) [[unlikely]] {
+    fmt::print(stderr, "Unknown --mode {0}, use warm, cold or both.\n", mode);
+    return 1;
+  }
+
+  const std::uint32_t runs_count{absl::GetFlag(FLAGS_runs)};
+  if (runs_count == 0) [[unlikely]] {
+    fmt::print(stderr, "Please, specify at least one run via --runs.\n");
+    return 1;
+  }
+
+  std::string first_frame_signal_fd_flag{
+      fmt::format("--first_frame_signal_fd={0}", kAppFirstFrameSignalFd)};
+
+  std::vector<char*> app_args;
+  app_args.reserve(positional_flags.size() + 2U);
+  app_args.emplace_back(app_path.data());
+  app_args.emplace_back(first_frame_signal_fd_flag.data());
+  // First positional flag is this app path.
+  for (std::size_t i{1}; i < positional_flags.size(); ++i) {
+    app_args.emplace_back(positional_flags[i]);
+  }
+  app_args.emplace_back(nullptr);
+
+  const std::chrono::milliseconds timeout{absl::GetFlag(FLAGS_timeout_ms)};
+
+  fmt::print("{:<6} {:>6} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}\n",
+             "mode", "runs", "min ms", "p50 ms", "p90 ms", "max ms",
+             "mean ms", "stddev ms");
+
+  bool is_ok{true};
+  if (should_measure_warm) {
+    is_ok = MeasureStarts("warm", app_args, runs_count, timeout, false);
+  }
+  if (is_ok && should_measure_cold) {
+    is_ok = MeasureStarts("cold", app_args, runs_count, timeout, true);
+  }
+
+  return is_ok ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Watches live frame telemetry of running WhiteBox app.
+
+#include <signal.h>  // kill
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+
+#include "app_version_config.h"
+#include "apps/parse_command_line.h"
+#include "base/deps/abseil/flags/flag.h"
+#include "base/deps/fmt/core.h"
+#include "base/deps/g3log/scoped_g3log_initializer.h"
+#include "base/perf_event_counters_unix.h"
+#include "base/posix/frame_telemetry_shared_memory.h"
+#include "build/static_settings_config.h"
+
+ABSL_FLAG(std::int32_t, pid, 0, "process id of the WhiteBox app to watch.");
+
+ABSL_FLAG(std::uint32_t, interval_ms, 500U,
+          "telemetry refresh interval in milliseconds.");
+
+ABSL_FLAG(std::uint32_t, samples, 0U,
+          "how many telemetry samples to print before exit.  0 means until "
+          "app exits.");
+
+namespace {
+
+/**
+ * @brief Usage message.
+ */
+constexpr char kUsageMessage[] =
+    "Watches live frame telemetry of the WhiteBox app started with "
+    "--should_publish_frame_telemetry.  Task ms, flt and csw are frame "
+    "thread task clock, page faults and context switches of the last frame.  "
+    "Other page faults columns are process faults since previous sample, max "
+    "flt is page faults of the slowest frame.  CPU % of workers is CPU time "
+    "of their lifetime, so busy % well above it with high ivcsw/s means "
+    "workers are descheduled, not idle.  Other context switches are per "
+    "second.\n\nSample usage:\n";
+
+/**
+ * @brief Bytes in mebibyte.
+ */
+constexpr double kBytesInMiB{1024.0 * 1024.0};
+
+/**
+ * @brief Prints telemetry header.
+ * @return void.
+ */
+void PrintHeader() {
+  fmt::print(
+      "{:>10} {:>8} {:>10} {:>10} {:>12} {:>12} {:>7} {:>8} {:>10} {:>8} "
+      "{:>8} {:>10} {:>8} {:>6} {:>10} {:>8} {:>8} {:>7} {:>7} {:>9} {:>9} "
+      "{:>9} {:>9} {:>9} {:>9} {:>10} {:>9} {:>10} {:>9}\n",
+      "frame", "fps", "frame ms", "max ms", "heap MiB", "peak MiB", "input",
+      "workers", "tasks", "busy %", "allocs", "alloc KiB", "frees", "IPC",
+      "cache MPKI", "br MPKI", "task ms", "flt", "csw", "minflt", "majflt",
+      "max flt", "RSS MiB",
+      "peak RSS", "main CPU%", "main icsw/s", "wrk CPU%", "wrk vcsw/s",
+      "wrk icsw/s");
+}
+
+/**
+ * @brief Prints telemetry sample.
+ * @param telemetry Telemetry.
+ * @param previous Previous telemetry sample.
+ * @param interval Time since previous telemetry sample.
+ * @return void.
+ */
+void PrintTelemetry(const wb::base::telemetry::FrameTelemetry& telemetry,
+                    const wb::base::telemetry::FrameTelemetry& previous,
+                    std::chrono::nanoseconds interval) {
+  const double interval_ns{static_cast<double>(interval.count())};
+  const double fps{
+      interval_ns > 0.0
+          ? static_cast<double>(telemetry.frame_index - previous.frame_index) *
+                1e9 / interval_ns
+          : 0.0};
+  // Workers utilization since previous sample.
+  const std::int64_t workers_lifetime_ns{telemetry.workers_lifetime_ns -
+                                         previous.workers_lifetime_ns};
+  const double workers_busy_percent{
+      workers_lifetime_ns > 0
+          ? 100.0 *
+                static_cast<double>(telemetry.workers_busy_time_ns -
+                                    previous.workers_busy_time_ns) /
+                static_cast<double>(workers_lifetime_ns)
+          : 0.0};
+  // Workers CPU time of their lifetime, comparable with busy %.
+  const double workers_cpu_percent{
+      workers_lifetime_ns > 0
+          ? 100.0 *
+                static_cast<double>(telemetry.workers_cpu_time_ns -
+                                    previous.workers_cpu_time_ns) /
+                static_cast<double>(workers_lifetime_ns)
+          : 0.0};
+  const double main_thread_cpu_percent{
+      interval_ns > 0.0
+          ? 100.0 *
+                static_cast<double>(telemetry.main_thread_cpu_time_ns -
+                                    previous.main_thread_cpu_time_ns) /
+                interval_ns
+          : 0.0};
+  const auto per_second = [interval_ns](std::uint64_t count) {
+    return interval_ns > 0.0 ? static_cast<double>(count) * 1e9 / interval_ns
+                             : 0.0;
+  };
+  // Frame thread perf counters, hardware ones are zeros when PMU is
+  // unavailable.
+  const wb::base::PerfEventCountersSample frame_perf_counters{
+      .cycles = telemetry.frame_cycles,
+      .instructions = telemetry.frame_instructions,
+      .cache_misses = telemetry.frame_cache_misses,
+      .branch_misses = telemetry.frame_branch_misses,
+      .task_clock_ns = telemetry.frame_task_clock_ns,
+      .page_faults = telemetry.frame_perf_page_faults,
+      .context_switches = telemetry.frame_context_switches};
+
+  fmt::print(
+      "{:>10} {:>8.1f} {:>10.3f} {:>10.3f} {:>12.1f} {:>12.1f} {:>7} {:>8} "
+      "{:>10} {:>8.2f} {:>8} {:>10.1f} {:>8} {:>6.2f} {:>10.2f} {:>8.2f} "
+      "{:>8.3f} {:>7} {:>7} {:>9} {:>9} {:>9} {:>9.1f} {:>9.1f} {:>9.1f} "
+      "{:>10.1f} {:>9.1f} {:>10.1f} {:>9.1f}\n",
+      telemetry.frame_index, fps,
+      static_cast<double>(telemetry.frame_time_ns) / 1'000'000.0,
+      static_cast<double>(telemetry.max_frame_time_ns) / 1'000'000.0,
+      static_cast<double>(telemetry.heap_current_commit_bytes) / kBytesInMiB,
+      static_cast<double>(telemetry.heap_peak_commit_bytes) / kBytesInMiB,
+      telemetry.input_events_count, telemetry.workers_count,
+      telemetry.workers_tasks_executed - previous.workers_tasks_executed,
+      workers_busy_percent, telemetry.frame_allocations_count,
+      static_cast<double>(telemetry.frame_allocated_bytes) / 1024.0,
+      telemetry.frame_frees_count,
+      wb::base::GetInstructionsPerCycle(frame_perf_counters),
+      wb::base::GetCacheMissesPerKiloInstructions(frame_perf_counters),
+      wb::base::GetBranchMissesPerKiloInstructions(frame_perf_counters),
+      static_cast<double>(frame_perf_counters.task_clock_ns) / 1'000'000.0,
+      frame_perf_counters.page_faults, frame_perf_counters.context_switches,
+      telemetry.process_minor_page_faults - previous.process_minor_page_faults,
+      telemetry.process_major_page_faults - previous.process_major_page_faults,
+      telemetry.max_frame_time_page_faults,
+      static_cast<double>(telemetry.resident_set_bytes) / kBytesInMiB,
+      static_cast<double>(telemetry.peak_resident_set_bytes) / kBytesInMiB,
+      main_thread_cpu_percent,
+      per_second(telemetry.main_thread_involuntary_context_switches -
+                 previous.main_thread_involuntary_context_switches),
+      workers_cpu_percent,
+      per_second(telemetry.workers_voluntary_context_switches -
+                 previous.workers_voluntary_context_switches),
+      per_second(telemetry.workers_involuntary_context_switches -
+                 previous.workers_involuntary_context_switches));
+}
+
+/**
+ * @brief Is process still running.
+ * @param pid Process id.
+ * @return true if running.
+ */
+[[nodiscard]] bool IsProcessRunning(std::int32_t pid) noexcept {
+  // EPERM means process exists, but we can't signal it.
+  return ::kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+/**
+ * @brief Watches telemetry of the app.
+ * @param reader Telemetry reader.
+ * @param pid App process id.
+ * @param interval Refresh interval.
+ * @param samples_count Samples to print, 0 means infinite.
+ * @return App exit code.
+ */
+int WatchTelemetry(const wb::base::posix::FrameTelemetryReader& reader,
+                   std::int32_t pid, std::chrono::milliseconds interval,
+                   std::uint32_t samples_count) {
+  PrintHeader();
+
+  std::optional<wb::base::telemetry::FrameTelemetry> previous;
+  std::chrono::steady_clock::time_point previous_time;
+
+  for (std::uint32_t i{0}; samples_count == 0 || i < samples_count;) {
+    // Publisher is gone when shared memory object is unlinked, but mapping
+    // stays valid, so check process itself.
+    if (!IsProcessRunning(pid)) [[unlikely]] {
+      fmt::print("App stopped publishing telemetry.\n");
+      return 0;
+    }
+
+    const auto telemetry = reader.Read();
+    // Interval can be shorter than frame time, wait for next frame then.
+    if (telemetry.has_value() &&
+        (!previous.has_value() ||
+         telemetry->frame_index != previous->frame_index)) [[likely]] {
+      const std::chrono::steady_clock::time_point now{
+          std::chrono::steady_clock::now()};
+      PrintTelemetry(*telemetry, previous.value_or(*telemetry),
+                     previous.has_value() ? now - previous_time
+                                          : std::chrono::nanoseconds{0});
+
+      previous = telemetry;
+      previous_time = now;
+      ++i;
+    }
+
+    std::this_thread::sleep_for(interval);
+  }
+
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  // Initialize g3log logging library first as logs are used extensively.
+  const wb::base::deps::g3log::ScopedG3LogInitializer scoped_g3log_initializer{
+      argv[0], wb::build::settings::kPathToMainLogFile};
+
+  [[maybe_unused]] const std::vector<char*> positional_flags{
+      wb::apps::ParseCommandLine(
+          argc, argv,
+          {.app_name = WB_PRODUCT_FILE_DESCRIPTION_STRING,
+           .app_version = WB_PRODUCT_FILE_VERSION_INFO_STRING,
+           .app_usage = kUsageMessage})};
+
+  const std::int32_t pid{absl::GetFlag(FLAGS_pid)};
+  if (pid <= 0) [[unlikely]] {
+    fmt::print(stderr, "Please, specify app process id via --pid.\n");
+    return 1;
+  }
+
+  const auto reader = wb::base::posix::FrameTelemetryReader::New(pid);
+  if (!reader.has_value()) [[unlikely]] {
+    fmt::print(stderr,
+               "Unable to open frame telemetry of process {0}: {1}.  Is app "
+               "started with --should_publish_frame_telemetry?\n",
+               pid, reader.error().message());
+    return 1;
+  }
+
+  return WatchTelemetry(
+      *reader, pid,
+      std::chrono::milliseconds{absl::GetFlag(FLAGS_interval_ms)},
+      absl::GetFlag(FLAGS_samples));
+}
@@ -8,6 +8,7 @@
 
 #include <cerrno>  // ENOMEM.
 #include <chrono>
+#include <cstddef>
 #include <cstdlib>  // std::exit.
 #include <thread>
 
@@ -15,8 +16,10 @@
 #include "base/deps/g3log/g3log.h"
 #include "base/deps/mimalloc/mimalloc.h"
 #include "base/internals/scoped_new_handler_internal.h"
+#include "base/memory/memory_reclaimer.h"
 #include "base/scoped_new_handler.h"
 #include "base/std2/thread_ext.h"
+#include "base/telemetry/metrics.h"
 #include "build/compiler_config.h"
 
 #ifdef WB_OS_WIN
@@ -25,6 +28,21 @@
 
 namespace {
 
+/**
+ * @brief Memory allocation retries count.  Registered on startup, so counting
+ * never allocates.
+ */
+wb::base::telemetry::Counter new_failure_retries_counter{
+    "whitebox_new_failure_retries",
+    "Retries of failed memory allocations via new."};
+
+/**
+ * @brief Bytes released by reclaimers on failed allocations.
+ */
+wb::base::telemetry::Counter new_failure_reclaimed_bytes_counter{
+    "whitebox_new_failure_reclaimed_bytes",
+    "Bytes released by memory reclaimers on failed allocations via new."};
+
 /**
  * @brief Get current thread name.
  * @return Thread name.
@@ -65,9 +83,23 @@ WB_BASE_API void DefaultNewFailureHandler() {
 
   if (actual_new_retries_count < max_new_retries_count) [[likely]] {
     ++actual_new_retries_count;
+    new_failure_retries_counter.Increment();
+
+    // Failed allocation size is unknown here, so ask for enough to cover
+    // typical large allocation.  Reclaimers drop caches, pools, etc.
+    constexpr std::size_t kWantedReclaimBytes{16U * 1024U * 1024U};
+    const std::size_t reclaimed_bytes{
+        memory::ReclaimMemory(kWantedReclaimBytes)};
+    new_failure_reclaimed_bytes_counter.Increment(reclaimed_bytes);
 
     ::mi_collect(false);
 
+    if (reclaimed_bytes > 0) {
+      // Failed allocation may fit already, retry it immediately.  Next
+      // failure reclaims more.
+      return;
+    }
+
 #ifdef WB_OS_WIN
     const auto rc = win::memory::OptimizeHeapResourcesNow();
     G3PLOGE2_IF(WARNING, rc)
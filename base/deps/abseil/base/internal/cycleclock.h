@@ -0,0 +1,17 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// CycleClock, which yields the value and frequency of a cycle counter that
+// increments at a rate that is approximately constant.
+
+#ifndef WB_BASE_DEPS_ABSEIL_BASE_INTERNAL_CYCLECLOCK_H_
+#define WB_BASE_DEPS_ABSEIL_BASE_INTERNAL_CYCLECLOCK_H_
+
+#include "base/deps/abseil/abseil_config.h"
+
+WB_BEGIN_ABSEIL_WARNING_OVERRIDE_SCOPE()
+#include "deps/abseil/absl/base/internal/cycleclock.h"
+WB_END_ABSEIL_WARNING_OVERRIDE_SCOPE()
+
+#endif  // !WB_BASE_DEPS_ABSEIL_BASE_INTERNAL_CYCLECLOCK_H_
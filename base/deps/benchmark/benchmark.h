@@ -0,0 +1,16 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Google Benchmark entry point.
+
+#ifndef WB_BASE_DEPS_BENCHMARK_BENCHMARK_H_
+#define WB_BASE_DEPS_BENCHMARK_BENCHMARK_H_
+
+#include "benchmark_config.h"
+
+WB_BEGIN_BENCHMARK_WARNING_OVERRIDE_SCOPE()
+#include <benchmark/benchmark.h>
+WB_END_BENCHMARK_WARNING_OVERRIDE_SCOPE()
+
+#endif  // !WB_BASE_DEPS_BENCHMARK_BENCHMARK_H_
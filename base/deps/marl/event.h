@@ -12,5 +12,21 @@
 WB_BEGIN_MARL_WARNING_OVERRIDE_SCOPE()
 #include "deps/marl/include/marl/waitgroup.h"
 WB_END_MARL_WARNING_OVERRIDE_SCOPE()
+#include "base/deps/marl/scheduler_stats.h"
+
+namespace wb::base::deps::marl {
+
+/**
+ * @brief Blocks until wait group counter drops to zero.  Worker busy time is
+ * not charged while task waits.
+ * @param wait_group Wait group.
+ * @return void.
+ */
+inline void Wait(const ::marl::WaitGroup& wait_group) {
+  const ScopedWorkerTaskSuspension scoped_worker_task_suspension;
+  wait_group.wait();
+}
+
+}  // namespace wb::base::deps::marl
 
 #endif  // !WB_BASE_DEPS_MARL_WAITGROUP_H_
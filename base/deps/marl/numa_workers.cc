@@ -0,0 +1,246 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// NUMA aware marl workers.
+
+#include "numa_workers.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/deps/g3log/g3log.h"
+#include "base/deps/mimalloc/mimalloc.h"
+#include "base/numa_topology.h"
+#include "base/std2/system_error_ext.h"
+#include "build/build_config.h"
+
+#ifdef WB_OS_LINUX
+#include <sched.h>
+#endif
+
+namespace {
+
+/**
+ * @brief No mimalloc arena.
+ */
+constexpr mi_arena_id_t kNoArena{-1};
+
+/**
+ * @brief Workers placement over NUMA nodes.  Written once before scheduler
+ * starts workers, read only after.
+ */
+struct NumaWorkersLayout {
+  /**
+   * @brief NUMA nodes with CPUs.
+   */
+  std::vector<wb::base::NumaNode> nodes;
+  /**
+   * @brief Node index per logical CPU slot, nodes CPUs in order.  Worker N
+   * lands on node of slot N modulo slots count, so workers are spread like
+   * CPUs are.
+   */
+  std::vector<std::uint32_t> cpu_slot_nodes;
+  /**
+   * @brief Arena per node or kNoArena when node arena reservation failed.
+   */
+  std::vector<mi_arena_id_t> node_arenas;
+
+  /**
+   * @brief Gets worker node index.
+   * @param worker_id Worker id.
+   * @return Node index.
+   */
+  [[nodiscard]] std::uint32_t GetWorkerNode(
+      std::uint32_t worker_id) const noexcept {
+    return cpu_slot_nodes[worker_id % cpu_slot_nodes.size()];
+  }
+};
+
+/**
+ * @brief Workers layout.  Empty when workers are not NUMA aware.
+ */
+NumaWorkersLayout numa_workers_layout;
+
+/**
+ * @brief Current worker thread NUMA node arena heap.
+ */
+thread_local mi_heap_t* current_numa_node_heap{nullptr};
+
+#ifdef WB_OS_LINUX
+/**
+ * @brief CPU set deleter.
+ */
+struct CpuSetDeleter {
+  /**
+   * @brief Frees CPU set.
+   * @param cpu_set CPU set.
+   * @return void.
+   */
+  void operator()(cpu_set_t* cpu_set) const noexcept { CPU_FREE(cpu_set); }
+};
+
+/**
+ * @brief Pins worker to all CPUs of its NUMA node allowed for process, so OS
+ * still balances workers within node and cgroup / taskset limits are honored.
+ */
+class NumaNodeAffinityPolicy final
+    : public ::marl::Thread::Affinity::Policy {
+ public:
+  /**
+   * @brief Gets worker affinity.
+   * @param thread_id Worker id.
+   * @param allocator Allocator.
+   * @return Worker affinity.
+   */
+  ::marl::Thread::Affinity get(uint32_t thread_id,
+                               ::marl::Allocator* allocator) const override {
+    using Affinity = ::marl::Thread::Affinity;
+
+    const wb::base::NumaNode& node{
+        numa_workers_layout
+            .nodes[numa_workers_layout.GetWorkerNode(thread_id)]};
+
+    const std::unique_ptr<cpu_set_t, CpuSetDeleter> allowed_cpus{
+        CPU_ALLOC(wb::base::kMaxCpusCount)};
+    const std::size_t allowed_cpus_size{
+        CPU_ALLOC_SIZE(wb::base::kMaxCpusCount)};
+    std::error_code rc{wb::base::std2::ok_code};
+    if (!allowed_cpus) [[unlikely]] {
+      rc = wb::base::std2::posix_last_error_code(ENOMEM);
+    } else if (::sched_getaffinity(0, allowed_cpus_size,
+                                   allowed_cpus.get()) != 0) [[unlikely]] {
+      rc = wb::base::std2::posix_last_error_code();
+    }
+    G3PLOGE2_IF(WARNING, rc)
+        << "Unable to get process CPUs affinity, pin worker #" << thread_id
+        << " to all NUMA node " << node.id << " CPUs.";
+
+    Affinity affinity{allocator};
+    for (const std::uint32_t cpu : node.cpus) {
+      if (!rc && !CPU_ISSET_S(cpu, allowed_cpus_size, allowed_cpus.get())) {
+        continue;
+      }
+
+      Affinity::Core core{};
+      core.pthread.index = static_cast<int>(cpu);
+      affinity.add(Affinity{{core}, allocator});
+    }
+    // No allowed CPUs on node, so let OS place worker on allowed ones.
+    if (affinity.count() == 0) [[unlikely]] return Affinity::all(allocator);
+
+    return affinity;
+  }
+};
+#endif
+
+}  // namespace
+
+namespace wb::base::deps::marl {
+
+WB_BASE_API std::size_t ConfigureNumaAwareWorkers(
+    ::marl::Scheduler::Config& config) {
+  G3DCHECK(numa_workers_layout.nodes.empty())
+      << "NUMA aware workers should be configured once.";
+
+  auto nodes = GetNumaTopology();
+  if (!nodes.has_value()) {
+    G3PLOG_E(INFO, nodes.error())
+        << "NUMA topology is unknown, workers are not NUMA aware.";
+    return 1U;
+  }
+
+  if (nodes->size() < 2U) {
+    G3LOG(INFO) << "Single NUMA node machine, workers are not NUMA aware.";
+    return 1U;
+  }
+
+#ifdef WB_OS_LINUX
+  NumaWorkersLayout layout;
+  layout.nodes = std::move(*nodes);
+
+  for (std::uint32_t i{0}; i < layout.nodes.size(); ++i) {
+    const NumaNode& node{layout.nodes[i]};
+    layout.cpu_slot_nodes.insert(layout.cpu_slot_nodes.end(),
+                                 node.cpus.size(), i);
+
+    // Uncommitted, so pages are placed on node of first touching worker, and
+    // workers are pinned to node.  Exclusive, so other heaps do not spill to
+    // it.  Node heaps never fall back to OS memory, so they are opt-in.
+    mi_arena_id_t arena_id{kNoArena};
+    if (kNumaNodeArenaReserveSize > 0U &&
+        ::mi_reserve_os_memory_ex(kNumaNodeArenaReserveSize, false, false,
+                                  true, &arena_id) != 0) [[unlikely]] {
+      arena_id = kNoArena;
+    }
+    G3LOG_IF(WARNING, arena_id == kNoArena)
+        << "Unable to reserve NUMA node " << node.id
+        << " arena, node workers use default heaps.";
+
+    layout.node_arenas.emplace_back(arena_id);
+
+    G3LOG(INFO) << "NUMA node " << node.id << " has " << node.cpus.size()
+                << " logical CPUs.";
+  }
+
+  numa_workers_layout = std::move(layout);
+
+  config.setWorkerThreadAffinityPolicy(
+      std::make_shared<NumaNodeAffinityPolicy>());
+
+  return numa_workers_layout.nodes.size();
+#else
+  static_cast<void>(config);
+  return 1U;
+#endif
+}
+
+[[nodiscard]] WB_BASE_API void* AllocateNumaNodeLocal(
+    std::size_t size, std::size_t alignment) noexcept {
+  if (current_numa_node_heap) {
+    void* memory{
+        ::mi_heap_malloc_aligned(current_numa_node_heap, size, alignment)};
+    if (memory) [[likely]] return memory;
+  }
+
+  // Node arena is full or absent, so use OS backed default heap.
+  return ::mi_malloc_aligned(size, alignment);
+}
+
+WB_BASE_API void FreeNumaNodeLocal(void* memory) noexcept {
+  ::mi_free(memory);
+}
+
+WB_BASE_API ScopedNumaNodeWorker::ScopedNumaNodeWorker(int worker_id) noexcept
+    : heap_{nullptr}, previous_heap_{nullptr} {
+  if (numa_workers_layout.nodes.empty()) return;
+
+  G3DCHECK(worker_id >= 0);
+
+  const mi_arena_id_t arena_id{
+      numa_workers_layout.node_arenas[numa_workers_layout.GetWorkerNode(
+          static_cast<std::uint32_t>(worker_id))]};
+  if (arena_id == kNoArena) return;
+
+  heap_ = ::mi_heap_new_in_arena(arena_id);
+  if (!heap_) [[unlikely]] {
+    G3LOG(WARNING) << "Unable to create NUMA node heap for worker #"
+                   << worker_id << ", continue with default heap.";
+    return;
+  }
+
+  previous_heap_ = std::exchange(current_numa_node_heap, heap_);
+}
+
+WB_BASE_API ScopedNumaNodeWorker::~ScopedNumaNodeWorker() noexcept {
+  if (!heap_) return;
+
+  current_numa_node_heap = previous_heap_;
+  // Live blocks are moved to thread default heap.
+  ::mi_heap_delete(heap_);
+}
+
+}  // namespace wb::base::deps::marl
@@ -0,0 +1,107 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// NUMA aware marl workers.  On multi node machines workers are pinned to NUMA
+// nodes, and can place long lived task data in node local mimalloc arenas, so
+// it does not travel across sockets.  Single node machines are unaffected.
+//
+// Usage example:
+//
+// auto config = marl::Scheduler::Config().setWorkerThreadCount(count);
+// ConfigureNumaAwareWorkers(config);
+// ...
+// // Worker thread start state.
+// const ScopedNumaNodeWorker scoped_numa_node_worker{worker_id};
+// ...
+// // Worker task.
+// void* cells{AllocateNumaNodeLocal(cells_size, alignof(Cell))};
+// ...
+// FreeNumaNodeLocal(cells);
+
+#ifndef WB_BASE_DEPS_MARL_NUMA_WORKERS_H_
+#define WB_BASE_DEPS_MARL_NUMA_WORKERS_H_
+
+#include <cstddef>
+
+#include "base/config.h"
+#include "base/deps/marl/scheduler.h"
+#include "base/macroses.h"
+
+extern "C" {
+struct mi_heap_s;
+}
+
+namespace wb::base::deps::marl {
+
+/**
+ * @brief Address space reserved per NUMA node arena.  Committed on demand, so
+ * only allocated memory is backed.
+ */
+inline constexpr std::size_t kNumaNodeArenaReserveSize{
+    sizeof(void*) == 8 ? static_cast<std::size_t>(16) << 30U : 0U};
+
+/**
+ * @brief Discovers NUMA topology and, on multi node machines, sets workers
+ * affinity per node and reserves node local arenas.  Call once before
+ * scheduler is created.
+ * @param config Scheduler config.
+ * @return NUMA nodes count workers are spread over.  1 when machine is single
+ * node or topology is unknown.
+ */
+WB_BASE_API std::size_t ConfigureNumaAwareWorkers(
+    ::marl::Scheduler::Config& config);
+
+/**
+ * @brief Allocates from current worker NUMA node arena.  Node arena heap is
+ * opt-in, not worker default one, as arena bound heaps never fall back to OS
+ * memory.  Falls back to default heap when thread has no node heap or node
+ * arena is full.
+ * @param size Size.
+ * @param alignment Alignment, power of 2.
+ * @return Memory or nullptr when out of memory.
+ */
+[[nodiscard]] WB_BASE_API void* AllocateNumaNodeLocal(
+    std::size_t size, std::size_t alignment) noexcept;
+
+/**
+ * @brief Frees memory allocated by AllocateNumaNodeLocal.  Can be called on
+ * any thread.
+ * @param memory Memory or nullptr.
+ * @return void.
+ */
+WB_BASE_API void FreeNumaNodeLocal(void* memory) noexcept;
+
+/**
+ * @brief Gives current worker thread its NUMA node arena heap for
+ * AllocateNumaNodeLocal in scope.  No-op when workers are not NUMA aware.
+ */
+class WB_BASE_API ScopedNumaNodeWorker {
+ public:
+  /**
+   * @brief Creates worker node arena heap for current thread.
+   * @param worker_id Worker id.
+   */
+  explicit ScopedNumaNodeWorker(int worker_id) noexcept;
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(ScopedNumaNodeWorker);
+
+  /**
+   * @brief Restores previous node heap for current thread.
+   */
+  ~ScopedNumaNodeWorker() noexcept;
+
+ private:
+  /**
+   * @brief Node arena heap.
+   */
+  mi_heap_s* heap_;
+  /**
+   * @brief Previous current thread node heap.
+   */
+  mi_heap_s* previous_heap_;
+};
+
+}  // namespace wb::base::deps::marl
+
+#endif  // !WB_BASE_DEPS_MARL_NUMA_WORKERS_H_
@@ -19,6 +19,7 @@ WB_BEGIN_MARL_WARNING_OVERRIDE_SCOPE()
 #include "deps/marl/include/marl/scheduler.h"
 WB_END_MARL_WARNING_OVERRIDE_SCOPE()
 #include "base/deps/abseil/cleanup/cleanup.h"
+#include "base/deps/marl/scheduler_stats.h"
 
 namespace wb::base::deps::marl {
 
@@ -28,6 +29,8 @@ template <typename Tuple, size_t... Indices>
 static void Invoke(void* raw_values) noexcept {
   const std::unique_ptr<Tuple> fn_values{static_cast<Tuple*>(raw_values)};
   Tuple& tuple{*fn_values.get()};
+  // Account worker busy time.
+  const ScopedWorkerTaskStats scoped_worker_task_stats;
   std::invoke(std::move(std::get<Indices>(tuple))...);
 }
 
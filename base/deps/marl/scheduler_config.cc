@@ -8,8 +8,15 @@
 
 #include "base/deps/abseil/strings/str_cat.h"
 #include "base/deps/g3log/g3log.h"
+#include "base/deps/marl/numa_workers.h"
+#include "base/deps/marl/scheduler_stats.h"
+#include "base/memory/frame_arena.h"
 #include "base/std2/thread_ext.h"
 
+#ifdef WB_OS_LINUX
+#include "base/stack_sampling_profiler_unix.h"
+#endif
+
 #ifdef WB_OS_WIN
 #include "base/win/com/scoped_thread_com_initializer.h"
 #include "base/win/error_handling/scoped_thread_error_mode.h"
@@ -25,7 +32,15 @@ class WhiteboxThreadStartState::Impl final {
  public:
   Impl(int workerId) noexcept
       : scoped_thread_name_{std2::this_thread::ScopedThreadName::New(
-            absl::StrCat(kThreadNamePrefix, workerId))}
+            absl::StrCat(kThreadNamePrefix, workerId))},
+        scoped_numa_node_worker_{workerId},
+        scoped_worker_stats_registration_{workerId},
+        scoped_frame_arena_worker_{workerId}
+#ifdef WB_OS_LINUX
+        ,
+        scoped_stack_sampling_thread_{
+            absl::StrCat(kThreadNamePrefix, workerId).c_str()}
+#endif
 #ifdef WB_OS_WIN
         ,
         scoped_thread_error_mode_{
@@ -76,6 +91,16 @@ class WhiteboxThreadStartState::Impl final {
   using r = std2::result<T>;
 
   const r<std2::this_thread::ScopedThreadName> scoped_thread_name_;
+  // Opt-in NUMA node local arena heap on multi node machines.
+  const ScopedNumaNodeWorker scoped_numa_node_worker_;
+  // Collect worker utilization stats.
+  const ScopedWorkerStatsRegistration scoped_worker_stats_registration_;
+  // Use own frame arena sub-arena for transient frame data.
+  const memory::ScopedFrameArenaWorker scoped_frame_arena_worker_;
+#ifdef WB_OS_LINUX
+  // Sample worker stacks when CPU profiler is running.
+  const ScopedStackSamplingThread scoped_stack_sampling_thread_;
+#endif
 
 #ifdef WB_OS_WIN
   // Calling thread will handle critical errors, does not show general
@@ -0,0 +1,424 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// marl scheduler workers utilization stats.
+
+#include "base/deps/marl/scheduler_stats.h"
+
+#include <array>
+#include <atomic>
+#include <string>
+
+#include "base/deps/fmt/core.h"
+#include "base/deps/g3log/g3log.h"
+#include "base/high_resolution_clock.h"
+
+#ifdef WB_OS_LINUX
+#include <pthread.h>
+#include <unistd.h>  // gettid
+#endif
+
+namespace {
+
+/**
+ * @brief Worker stats slot.  Written by single worker thread only, read by
+ * anyone.  Cache line sized to prevent false sharing between workers.
+ */
+struct alignas(64) WorkerStatsSlot {
+  /**
+   * @brief Is slot ever used.
+   */
+  std::atomic_bool is_used;
+  /**
+   * @brief Is worker running.
+   */
+  std::atomic_bool is_running;
+  /**
+   * @brief Tasks executed.
+   */
+  std::atomic_uint64_t tasks_executed;
+  /**
+   * @brief Time spent executing tasks, ns.
+   */
+  std::atomic_int64_t busy_time_ns;
+  /**
+   * @brief Worker start time since clock epoch, ns.
+   */
+  std::atomic_int64_t start_time_ns;
+  /**
+   * @brief Worker stop time since clock epoch, ns.
+   */
+  std::atomic_int64_t stop_time_ns;
+#ifdef WB_OS_LINUX
+  /**
+   * @brief Worker thread id.
+   */
+  std::atomic<pid_t> thread_id;
+  /**
+   * @brief Worker thread CPU clock id.
+   */
+  std::atomic<clockid_t> cpu_clock_id;
+  /**
+   * @brief Worker thread CPU time at stop, ns.  Thread is gone after stop, so
+   * can't be queried.
+   */
+  std::atomic_int64_t stop_cpu_time_ns;
+  /**
+   * @brief Worker thread voluntary context switches at stop.
+   */
+  std::atomic_uint64_t stop_voluntary_context_switches;
+  /**
+   * @brief Worker thread involuntary context switches at stop.
+   */
+  std::atomic_uint64_t stop_involuntary_context_switches;
+#endif
+};
+
+/**
+ * @brief All workers stats.
+ */
+std::array<WorkerStatsSlot, wb::base::deps::marl::kMaxStatsWorkersCount>
+    workers_stats_slots;
+
+/**
+ * @brief Current worker stats slot.  nullptr for non-worker threads.
+ */
+thread_local WorkerStatsSlot* current_worker_stats_slot{nullptr};
+
+/**
+ * @brief Tasks started but not finished on current worker.  Task blocked on
+ * fiber stays in progress while worker runs other tasks.
+ */
+thread_local std::uint32_t current_worker_tasks_in_progress{0};
+
+/**
+ * @brief Tasks in progress on current worker which are suspended in
+ * ScopedWorkerTaskSuspension.  Worker is busy only when some task in progress
+ * is not suspended.
+ */
+thread_local std::uint32_t current_worker_tasks_suspended{0};
+
+/**
+ * @brief Time since which current worker busy time is not charged yet, ns.
+ */
+thread_local std::int64_t current_worker_busy_since_ns{0};
+
+/**
+ * @brief Now since clock epoch, ns.
+ * @return Now.
+ */
+[[nodiscard]] std::int64_t NowNs() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             wb::base::HighResolutionClock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief Adds busy time to worker slot.
+ * @param slot Slot.
+ * @param busy_time_ns Busy time, ns.
+ * @return void.
+ */
+void AddWorkerBusyTime(WorkerStatsSlot& slot,
+                       std::int64_t busy_time_ns) noexcept {
+  // Single writer, so no need for atomic RMW.
+  slot.busy_time_ns.store(
+      slot.busy_time_ns.load(std::memory_order_relaxed) + busy_time_ns,
+      std::memory_order_relaxed);
+}
+
+/**
+ * @brief Charges current worker busy time till |now_ns| if some task runs.
+ * @param now_ns Now, ns.
+ * @return void.
+ */
+void ChargeCurrentWorkerBusyTime(std::int64_t now_ns) noexcept {
+  if (current_worker_tasks_in_progress > current_worker_tasks_suspended) {
+    AddWorkerBusyTime(*current_worker_stats_slot,
+                      now_ns - current_worker_busy_since_ns);
+  }
+
+  current_worker_busy_since_ns = now_ns;
+}
+
+#ifdef WB_OS_LINUX
+/**
+ * @brief Get worker thread scheduling from slot.
+ * @param slot Slot.
+ * @param is_running Is worker running.
+ * @return Worker thread scheduling or zeros on failure.
+ */
+[[nodiscard]] wb::base::ThreadSchedulingSample GetWorkerScheduling(
+    const WorkerStatsSlot& slot, bool is_running) noexcept {
+  using namespace wb::base;
+
+  if (is_running) {
+    const pid_t thread_id{slot.thread_id.load(std::memory_order_relaxed)};
+    if (thread_id == 0) [[unlikely]] return {};
+
+    // Worker may stop right now, so thread is gone, zeros then.
+    return GetThreadScheduling(
+               thread_id, slot.cpu_clock_id.load(std::memory_order_relaxed))
+        .value_or(ThreadSchedulingSample{});
+  }
+
+  return {.cpu_time = std::chrono::nanoseconds{slot.stop_cpu_time_ns.load(
+              std::memory_order_relaxed)},
+          .voluntary_context_switches =
+              slot.stop_voluntary_context_switches.load(
+                  std::memory_order_relaxed),
+          .involuntary_context_switches =
+              slot.stop_involuntary_context_switches.load(
+                  std::memory_order_relaxed)};
+}
+#endif
+
+/**
+ * @brief Get worker stats from slot.
+ * @param worker_id Worker id.
+ * @param slot Slot.
+ * @param now_ns Now since clock epoch, ns.
+ * @return Worker stats.
+ */
+[[nodiscard]] wb::base::deps::marl::WorkerStats GetWorkerStats(
+    int worker_id, const WorkerStatsSlot& slot, std::int64_t now_ns) noexcept {
+  const bool is_running{slot.is_running.load(std::memory_order_acquire)};
+  const std::int64_t end_time_ns{
+      is_running ? now_ns : slot.stop_time_ns.load(std::memory_order_relaxed)};
+
+  return {.worker_id = worker_id,
+          .is_running = is_running,
+          .tasks_executed = slot.tasks_executed.load(std::memory_order_relaxed),
+          .busy_time = std::chrono::nanoseconds{slot.busy_time_ns.load(
+              std::memory_order_relaxed)},
+          .lifetime = std::chrono::nanoseconds{
+              end_time_ns - slot.start_time_ns.load(std::memory_order_relaxed)},
+#ifdef WB_OS_LINUX
+          .scheduling = GetWorkerScheduling(slot, is_running)
+#endif
+  };
+}
+
+/**
+ * @brief Busy time percent of lifetime.
+ * @param busy_time Busy time.
+ * @param lifetime Lifetime.
+ * @return Busy percent.
+ */
+[[nodiscard]] double BusyPercent(std::chrono::nanoseconds busy_time,
+                                 std::chrono::nanoseconds lifetime) noexcept {
+  return lifetime.count() > 0 ? 100.0 * static_cast<double>(busy_time.count()) /
+                                    static_cast<double>(lifetime.count())
+                              : 0.0;
+}
+
+}  // namespace
+
+namespace wb::base::deps::marl {
+
+[[nodiscard]] WB_BASE_API SchedulerStats GetSchedulerStats() noexcept {
+  const std::int64_t now_ns{NowNs()};
+  SchedulerStats stats{.running_workers_count = 0,
+                       .tasks_executed = 0,
+                       .busy_time = std::chrono::nanoseconds::zero(),
+                       .lifetime = std::chrono::nanoseconds::zero()};
+
+  int worker_id{0};
+  for (const auto& slot : workers_stats_slots) {
+    if (slot.is_used.load(std::memory_order_acquire)) {
+      const WorkerStats worker{GetWorkerStats(worker_id, slot, now_ns)};
+
+      stats.running_workers_count += worker.is_running ? 1U : 0U;
+      stats.tasks_executed += worker.tasks_executed;
+      stats.busy_time += worker.busy_time;
+      stats.lifetime += worker.lifetime;
+    }
+
+    ++worker_id;
+  }
+
+  return stats;
+}
+
+#ifdef WB_OS_LINUX
+[[nodiscard]] WB_BASE_API ThreadSchedulingSample
+GetWorkersScheduling() noexcept {
+  ThreadSchedulingSample scheduling{};
+
+  for (const auto& slot : workers_stats_slots) {
+    if (slot.is_used.load(std::memory_order_acquire)) {
+      scheduling += GetWorkerScheduling(
+          slot, slot.is_running.load(std::memory_order_acquire));
+    }
+  }
+
+  return scheduling;
+}
+#endif
+
+[[nodiscard]] WB_BASE_API std::vector<WorkerStats> GetWorkersStats() {
+  const std::int64_t now_ns{NowNs()};
+  std::vector<WorkerStats> stats;
+
+  int worker_id{0};
+  for (const auto& slot : workers_stats_slots) {
+    if (slot.is_used.load(std::memory_order_acquire)) {
+      stats.emplace_back(GetWorkerStats(worker_id, slot, now_ns));
+    }
+
+    ++worker_id;
+  }
+
+  return stats;
+}
+
+WB_BASE_API void LogSchedulerStats() {
+  const std::vector<WorkerStats> workers_stats{GetWorkersStats()};
+  if (workers_stats.empty()) return;
+
+  std::string table{fmt::format("{:>8} {:>12} {:>14} {:>14} {:>8}", "worker",
+                                "tasks", "busy ms", "lifetime ms", "busy %")};
+#ifdef WB_OS_LINUX
+  // CPU time well below busy time with involuntary switches means worker is
+  // descheduled.
+  table += fmt::format(" {:>14} {:>10} {:>10}", "cpu ms", "vol csw",
+                       "invol csw");
+#endif
+  table += '\n';
+
+  for (const auto& worker : workers_stats) {
+    table += fmt::format(
+        "{:>8} {:>12} {:>14.3f} {:>14.3f} {:>8.2f}", worker.worker_id,
+        worker.tasks_executed,
+        static_cast<double>(worker.busy_time.count()) / 1'000'000.0,
+        static_cast<double>(worker.lifetime.count()) / 1'000'000.0,
+        BusyPercent(worker.busy_time, worker.lifetime));
+#ifdef WB_OS_LINUX
+    table += fmt::format(
+        " {:>14.3f} {:>10} {:>10}",
+        static_cast<double>(worker.scheduling.cpu_time.count()) / 1'000'000.0,
+        worker.scheduling.voluntary_context_switches,
+        worker.scheduling.involuntary_context_switches);
+#endif
+    table += '\n';
+  }
+
+  const SchedulerStats stats{GetSchedulerStats()};
+  table += fmt::format(
+      "{:>8} {:>12} {:>14.3f} {:>14.3f} {:>8.2f}", "total",
+      stats.tasks_executed,
+      static_cast<double>(stats.busy_time.count()) / 1'000'000.0,
+      static_cast<double>(stats.lifetime.count()) / 1'000'000.0,
+      BusyPercent(stats.busy_time, stats.lifetime));
+
+  G3LOG(INFO) << "Marl scheduler workers stats:\n" << table;
+}
+
+namespace internal {
+
+WB_BASE_API void RegisterCurrentWorker(int worker_id) noexcept {
+  if (worker_id < 0 || worker_id >= kMaxStatsWorkersCount) [[unlikely]] {
+    G3LOG(WARNING) << "Worker #" << worker_id
+                   << " is out of stats range, stats are not collected.";
+    return;
+  }
+
+  auto& slot = workers_stats_slots[static_cast<std::size_t>(worker_id)];
+  slot.tasks_executed.store(0, std::memory_order_relaxed);
+  slot.busy_time_ns.store(0, std::memory_order_relaxed);
+  slot.start_time_ns.store(NowNs(), std::memory_order_relaxed);
+  slot.stop_time_ns.store(0, std::memory_order_relaxed);
+#ifdef WB_OS_LINUX
+  clockid_t cpu_clock_id{0};
+  const int rc{::pthread_getcpuclockid(::pthread_self(), &cpu_clock_id)};
+  G3LOG_IF(WARNING, rc != 0)
+      << "Worker #" << worker_id
+      << " CPU clock is unavailable, scheduling stats are not collected: "
+      << rc;
+  // No thread id means no scheduling stats.
+  slot.thread_id.store(rc == 0 ? ::gettid() : 0, std::memory_order_relaxed);
+  slot.cpu_clock_id.store(cpu_clock_id, std::memory_order_relaxed);
+#endif
+  slot.is_running.store(true, std::memory_order_release);
+  slot.is_used.store(true, std::memory_order_release);
+
+  current_worker_stats_slot = &slot;
+  current_worker_tasks_in_progress = 0;
+  current_worker_tasks_suspended = 0;
+}
+
+WB_BASE_API void UnregisterCurrentWorker() noexcept {
+  if (!current_worker_stats_slot) [[unlikely]] return;
+
+  current_worker_stats_slot->stop_time_ns.store(NowNs(),
+                                                std::memory_order_relaxed);
+#ifdef WB_OS_LINUX
+  // Thread is gone after stop, so save final scheduling.
+  const ThreadSchedulingSample scheduling{
+      GetCurrentThreadScheduling().value_or(ThreadSchedulingSample{})};
+  current_worker_stats_slot->stop_cpu_time_ns.store(
+      scheduling.cpu_time.count(), std::memory_order_relaxed);
+  current_worker_stats_slot->stop_voluntary_context_switches.store(
+      scheduling.voluntary_context_switches, std::memory_order_relaxed);
+  current_worker_stats_slot->stop_involuntary_context_switches.store(
+      scheduling.involuntary_context_switches, std::memory_order_relaxed);
+#endif
+  current_worker_stats_slot->is_running.store(false,
+                                              std::memory_order_release);
+
+  current_worker_stats_slot = nullptr;
+}
+
+WB_BASE_API void OnWorkerTaskStarted() noexcept {
+  // Tasks can be executed on the bound non-worker thread, skip them.
+  if (!current_worker_stats_slot) [[unlikely]] return;
+
+  // Other task in progress is blocked on fiber without
+  // ScopedWorkerTaskSuspension, charge it till now.
+  ChargeCurrentWorkerBusyTime(NowNs());
+  ++current_worker_tasks_in_progress;
+}
+
+WB_BASE_API void OnWorkerTaskFinished() noexcept {
+  if (!current_worker_stats_slot || current_worker_tasks_in_progress == 0)
+      [[unlikely]] {
+    return;
+  }
+
+  ChargeCurrentWorkerBusyTime(NowNs());
+  --current_worker_tasks_in_progress;
+
+  auto& slot = *current_worker_stats_slot;
+  // Single writer, so no need for atomic RMW.
+  slot.tasks_executed.store(
+      slot.tasks_executed.load(std::memory_order_relaxed) + 1,
+      std::memory_order_relaxed);
+}
+
+WB_BASE_API void OnWorkerTaskSuspended() noexcept {
+  // Not in task, nothing is charged anyway.
+  if (!current_worker_stats_slot ||
+      current_worker_tasks_in_progress == current_worker_tasks_suspended)
+      [[unlikely]] {
+    return;
+  }
+
+  ChargeCurrentWorkerBusyTime(NowNs());
+  ++current_worker_tasks_suspended;
+}
+
+WB_BASE_API void OnWorkerTaskResumed() noexcept {
+  if (!current_worker_stats_slot || current_worker_tasks_suspended == 0)
+      [[unlikely]] {
+    return;
+  }
+
+  // Tasks run while this one was suspended are finished or suspended too.
+  ChargeCurrentWorkerBusyTime(NowNs());
+  --current_worker_tasks_suspended;
+}
+
+}  // namespace internal
+
+}  // namespace wb::base::deps::marl
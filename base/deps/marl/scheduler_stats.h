@@ -0,0 +1,212 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// marl scheduler workers utilization stats.
+
+#ifndef WB_BASE_DEPS_MARL_SCHEDULER_STATS_H_
+#define WB_BASE_DEPS_MARL_SCHEDULER_STATS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "base/config.h"
+#include "base/macroses.h"
+#include "build/build_config.h"
+
+#ifdef WB_OS_LINUX
+#include "base/resource_usage_unix.h"
+#endif
+
+namespace wb::base::deps::marl {
+
+/**
+ * @brief Max workers count stats are collected for.
+ */
+inline constexpr int kMaxStatsWorkersCount{256};
+
+/**
+ * @brief Single worker stats.
+ */
+struct WorkerStats {
+  /**
+   * @brief Worker id.
+   */
+  int worker_id;
+  /**
+   * @brief Is worker still running.
+   */
+  bool is_running;
+  /**
+   * @brief Tasks executed by worker.
+   */
+  std::uint64_t tasks_executed;
+  /**
+   * @brief Time spent with any task running.  Task suspended in
+   * ScopedWorkerTaskSuspension is not counted, so worker idling meanwhile is
+   * not busy.  Other tasks run meanwhile are not double counted.
+   */
+  std::chrono::nanoseconds busy_time;
+  /**
+   * @brief Time since worker start till now or worker stop.
+   */
+  std::chrono::nanoseconds lifetime;
+#ifdef WB_OS_LINUX
+  /**
+   * @brief Worker thread OS scheduling since worker start till now or worker
+   * stop.  Busy time well above CPU time with many involuntary context switches
+   * means worker is descheduled, not idle.
+   */
+  ThreadSchedulingSample scheduling;
+#endif
+};
+
+/**
+ * @brief All workers aggregated stats.
+ */
+struct SchedulerStats {
+  /**
+   * @brief Running workers count.
+   */
+  std::uint32_t running_workers_count;
+  /**
+   * @brief Tasks executed by all workers.
+   */
+  std::uint64_t tasks_executed;
+  /**
+   * @brief Time all workers spent executing tasks.
+   */
+  std::chrono::nanoseconds busy_time;
+  /**
+   * @brief Sum of all workers lifetimes.
+   */
+  std::chrono::nanoseconds lifetime;
+};
+
+/**
+ * @brief Gets all workers aggregated stats.  Does not allocate, so can be
+ * called each frame.
+ * @return Scheduler stats.
+ */
+[[nodiscard]] WB_BASE_API SchedulerStats GetSchedulerStats() noexcept;
+
+#ifdef WB_OS_LINUX
+/**
+ * @brief Gets all workers OS scheduling summed.  Reads /proc for each running
+ * worker, so do not call each frame.  Does not allocate.
+ * @return Workers scheduling.
+ */
+[[nodiscard]] WB_BASE_API ThreadSchedulingSample
+GetWorkersScheduling() noexcept;
+#endif
+
+/**
+ * @brief Gets per worker stats.
+ * @return Workers stats.
+ */
+[[nodiscard]] WB_BASE_API std::vector<WorkerStats> GetWorkersStats();
+
+/**
+ * @brief Logs per worker and aggregated stats.  Busy percent close to 100 for
+ * all workers means more workers needed, close to 0 means less.
+ * @return void.
+ */
+WB_BASE_API void LogSchedulerStats();
+
+namespace internal {
+
+/**
+ * @brief Register current thread as worker.
+ * @param worker_id Worker id.
+ * @return void.
+ */
+WB_BASE_API void RegisterCurrentWorker(int worker_id) noexcept;
+
+/**
+ * @brief Unregister current thread as worker.
+ * @return void.
+ */
+WB_BASE_API void UnregisterCurrentWorker() noexcept;
+
+/**
+ * @brief Account task started on current worker.  Charges busy time of task
+ * which is blocked on fiber without ScopedWorkerTaskSuspension so worker runs
+ * this one.
+ * @return void.
+ */
+WB_BASE_API void OnWorkerTaskStarted() noexcept;
+
+/**
+ * @brief Account task finished on current worker.
+ * @return void.
+ */
+WB_BASE_API void OnWorkerTaskFinished() noexcept;
+
+/**
+ * @brief Account current task suspended on fiber.  Busy time is not charged
+ * till task is resumed, unless worker runs other tasks meanwhile.
+ * @return void.
+ */
+WB_BASE_API void OnWorkerTaskSuspended() noexcept;
+
+/**
+ * @brief Account current task resumed after suspension.
+ * @return void.
+ */
+WB_BASE_API void OnWorkerTaskResumed() noexcept;
+
+}  // namespace internal
+
+/**
+ * @brief Registers current thread as worker in scope.
+ */
+class ScopedWorkerStatsRegistration {
+ public:
+  /**
+   * @brief Registers current thread as worker.
+   * @param worker_id Worker id.
+   */
+  explicit ScopedWorkerStatsRegistration(int worker_id) noexcept {
+    internal::RegisterCurrentWorker(worker_id);
+  }
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(ScopedWorkerStatsRegistration);
+
+  ~ScopedWorkerStatsRegistration() noexcept {
+    internal::UnregisterCurrentWorker();
+  }
+};
+
+/**
+ * @brief Accounts task execution time on current worker in scope.  Tasks
+ * blocked on fibers nest on worker thread, so busy time is charged between
+ * task starts / finishes and each moment is charged once.  Busy time never
+ * exceeds lifetime.  Wrap task waits in ScopedWorkerTaskSuspension, otherwise
+ * blocked task is charged while worker idles.
+ */
+class ScopedWorkerTaskStats {
+ public:
+  ScopedWorkerTaskStats() noexcept { internal::OnWorkerTaskStarted(); }
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(ScopedWorkerTaskStats);
+
+  ~ScopedWorkerTaskStats() noexcept { internal::OnWorkerTaskFinished(); }
+};
+
+/**
+ * @brief Stops charging current task busy time in scope.  Use around blocking
+ * waits in tasks, as marl suspends task fiber there and worker may idle.
+ */
+class ScopedWorkerTaskSuspension {
+ public:
+  ScopedWorkerTaskSuspension() noexcept { internal::OnWorkerTaskSuspended(); }
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(ScopedWorkerTaskSuspension);
+
+  ~ScopedWorkerTaskSuspension() noexcept { internal::OnWorkerTaskResumed(); }
+};
+
+}  // namespace wb::base::deps::marl
+
+#endif  // !WB_BASE_DEPS_MARL_SCHEDULER_STATS_H_
@@ -0,0 +1,210 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// marl scheduler workers utilization stats.
+
+#include "scheduler_stats.h"
+//
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <thread>
+
+#include "base/deps/googletest/gtest/gtest.h"
+#include "build/build_config.h"
+
+namespace {
+
+/**
+ * @brief Find worker stats by id.
+ * @param worker_id Worker id.
+ * @return Worker stats.
+ */
+[[nodiscard]] std::optional<wb::base::deps::marl::WorkerStats> FindWorkerStats(
+    int worker_id) {
+  const auto workers_stats = wb::base::deps::marl::GetWorkersStats();
+  const auto it = std::find_if(
+      workers_stats.begin(), workers_stats.end(),
+      [=](const auto& stats) { return stats.worker_id == worker_id; });
+  return it != workers_stats.end() ? std::optional{*it} : std::nullopt;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SchedulerStatsTest, TasksOnNonWorkerThreadAreNotAccounted) {
+  using namespace wb::base::deps::marl;
+
+  const SchedulerStats before{GetSchedulerStats()};
+  {
+    const ScopedWorkerTaskStats scoped_worker_task_stats;
+  }
+  const SchedulerStats after{GetSchedulerStats()};
+
+  EXPECT_EQ(before.tasks_executed, after.tasks_executed);
+  EXPECT_EQ(before.busy_time, after.busy_time);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SchedulerStatsTest, WorkerTasksAreAccounted) {
+  using namespace wb::base::deps::marl;
+  using namespace std::chrono_literals;
+
+  constexpr int kWorkerId{kMaxStatsWorkersCount - 1};
+
+  std::thread worker{[]() {
+    const ScopedWorkerStatsRegistration scoped_worker_stats_registration{
+        kWorkerId};
+
+    for (int i{0}; i < 3; ++i) {
+      const ScopedWorkerTaskStats scoped_worker_task_stats;
+      std::this_thread::sleep_for(1ms);
+    }
+
+    const auto running = FindWorkerStats(kWorkerId);
+    ASSERT_TRUE(running.has_value());
+    EXPECT_TRUE(running->is_running);
+  }};
+  worker.join();
+
+  const auto stopped = FindWorkerStats(kWorkerId);
+  ASSERT_TRUE(stopped.has_value());
+  EXPECT_FALSE(stopped->is_running);
+  EXPECT_EQ(3U, stopped->tasks_executed);
+  EXPECT_GE(stopped->busy_time, 3ms);
+  EXPECT_GE(stopped->lifetime, stopped->busy_time);
+#ifdef WB_OS_LINUX
+  // Worker slept in tasks, so switched voluntarily.
+  EXPECT_GE(stopped->scheduling.voluntary_context_switches, 3U);
+  EXPECT_GT(stopped->scheduling.cpu_time, 0ms);
+#endif
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SchedulerStatsTest, NestedTasksAreNotDoubleCounted) {
+  using namespace wb::base::deps::marl;
+  using namespace std::chrono_literals;
+
+  constexpr int kWorkerId{kMaxStatsWorkersCount - 3};
+
+  std::thread worker{[]() {
+    const ScopedWorkerStatsRegistration scoped_worker_stats_registration{
+        kWorkerId};
+
+    // Outer task is blocked on fiber while worker runs inner ones.
+    const ScopedWorkerTaskStats outer_task_stats;
+    for (int i{0}; i < 3; ++i) {
+      const ScopedWorkerTaskStats inner_task_stats;
+      std::this_thread::sleep_for(2ms);
+    }
+  }};
+  worker.join();
+
+  const auto stopped = FindWorkerStats(kWorkerId);
+  ASSERT_TRUE(stopped.has_value());
+  EXPECT_EQ(4U, stopped->tasks_executed);
+  EXPECT_GE(stopped->busy_time, 6ms);
+  EXPECT_GE(stopped->lifetime, stopped->busy_time);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SchedulerStatsTest, SuspendedTasksAreNotCharged) {
+  using namespace wb::base::deps::marl;
+  using namespace std::chrono_literals;
+
+  constexpr int kWorkerId{kMaxStatsWorkersCount - 4};
+
+  std::thread worker{[]() {
+    const ScopedWorkerStatsRegistration scoped_worker_stats_registration{
+        kWorkerId};
+
+    const ScopedWorkerTaskStats outer_task_stats;
+    std::this_thread::sleep_for(2ms);
+    {
+      // Outer task waits, worker runs inner one, then idles.
+      const ScopedWorkerTaskSuspension outer_task_suspension;
+      {
+        const ScopedWorkerTaskStats inner_task_stats;
+        std::this_thread::sleep_for(2ms);
+      }
+      std::this_thread::sleep_for(50ms);
+    }
+    std::this_thread::sleep_for(2ms);
+  }};
+  worker.join();
+
+  const auto stopped = FindWorkerStats(kWorkerId);
+  ASSERT_TRUE(stopped.has_value());
+  EXPECT_EQ(2U, stopped->tasks_executed);
+  EXPECT_GE(stopped->busy_time, 6ms);
+  EXPECT_LT(stopped->busy_time, 50ms);
+  EXPECT_GE(stopped->lifetime, stopped->busy_time + 50ms);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SchedulerStatsTest, SuspensionOutsideTaskIsIgnored) {
+  using namespace wb::base::deps::marl;
+  using namespace std::chrono_literals;
+
+  constexpr int kWorkerId{kMaxStatsWorkersCount - 5};
+
+  std::thread worker{[]() {
+    const ScopedWorkerStatsRegistration scoped_worker_stats_registration{
+        kWorkerId};
+
+    { const ScopedWorkerTaskSuspension no_task_suspension; }
+
+    const ScopedWorkerTaskStats task_stats;
+    std::this_thread::sleep_for(2ms);
+  }};
+  worker.join();
+
+  const auto stopped = FindWorkerStats(kWorkerId);
+  ASSERT_TRUE(stopped.has_value());
+  EXPECT_EQ(1U, stopped->tasks_executed);
+  EXPECT_GE(stopped->busy_time, 2ms);
+}
+
+#ifdef WB_OS_LINUX
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SchedulerStatsTest, RunningWorkerSchedulingIsSampled) {
+  using namespace wb::base::deps::marl;
+  using namespace std::chrono_literals;
+
+  constexpr int kWorkerId{kMaxStatsWorkersCount - 2};
+
+  std::thread worker{[]() {
+    const ScopedWorkerStatsRegistration scoped_worker_stats_registration{
+        kWorkerId};
+
+    // Burn some CPU.
+    const auto deadline = std::chrono::steady_clock::now() + 5ms;
+    while (std::chrono::steady_clock::now() < deadline) {
+    }
+
+    const auto running = FindWorkerStats(kWorkerId);
+    ASSERT_TRUE(running.has_value());
+    EXPECT_GE(running->scheduling.cpu_time, 1ms);
+    EXPECT_GE(GetWorkersScheduling().cpu_time, running->scheduling.cpu_time);
+  }};
+  worker.join();
+}
+#endif
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SchedulerStatsTest, OutOfRangeWorkerIsIgnored) {
+  using namespace wb::base::deps::marl;
+
+  const SchedulerStats before{GetSchedulerStats()};
+
+  std::thread worker{[]() {
+    const ScopedWorkerStatsRegistration scoped_worker_stats_registration{
+        kMaxStatsWorkersCount};
+    const ScopedWorkerTaskStats scoped_worker_task_stats;
+  }};
+  worker.join();
+
+  const SchedulerStats after{GetSchedulerStats()};
+  EXPECT_EQ(before.tasks_executed, after.tasks_executed);
+}
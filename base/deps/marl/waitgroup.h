@@ -12,5 +12,21 @@
 WB_BEGIN_MARL_WARNING_OVERRIDE_SCOPE()
 #include "deps/marl/include/marl/event.h"
 WB_END_MARL_WARNING_OVERRIDE_SCOPE()
+#include "base/deps/marl/scheduler_stats.h"
+
+namespace wb::base::deps::marl {
+
+/**
+ * @brief Blocks until event is signalled.  Worker busy time is not charged
+ * while task waits.
+ * @param event Event.
+ * @return void.
+ */
+inline void Wait(const ::marl::Event& event) {
+  const ScopedWorkerTaskSuspension scoped_worker_task_suspension;
+  event.wait();
+}
+
+}  // namespace wb::base::deps::marl
 
 #endif  // !WB_BASE_DEPS_MARL_EVENT_H_
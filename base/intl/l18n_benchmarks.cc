@@ -0,0 +1,49 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Benchmarks for localized message strings hashing.
+
+#include "l18n.h"
+//
+#include <string>
+#include <string_view>
+
+#include "base/deps/benchmark/benchmark.h"
+
+namespace {
+
+/**
+ * @brief Real message keys of different length.
+ */
+constexpr std::string_view kMessageKeys[]{
+    "Error",
+    "{0} - Error",
+    "See technical details",
+    "Boot Manager - Error",
+    "Can't load whitebox kernel '{0}'.",
+    "Can't get '{0}' entry point from '{1}'.",
+    "Unable to create main '{0}' window.",
+    "Please, check app is installed correctly and you have enough "
+    "permissions to run it."};
+
+}  // namespace
+
+void BM_I18nStringViewHash(benchmark::State& state) {
+  const std::string_view key{
+      kMessageKeys[static_cast<std::size_t>(state.range(0))]};
+  // Prevent constant folding, hash is constexpr.
+  std::string runtime_key{key};
+
+  for ([[maybe_unused]] auto _ : state) {
+    benchmark::DoNotOptimize(runtime_key);
+    benchmark::DoNotOptimize(wb::base::intl::I18nStringViewHash{}(runtime_key));
+  }
+
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          static_cast<std::int64_t>(key.size()));
+  state.SetLabel(std::to_string(key.size()) + " chars");
+}
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+BENCHMARK(BM_I18nStringViewHash)
+    ->DenseRange(0, static_cast<std::int64_t>(std::size(kMessageKeys)) - 1);
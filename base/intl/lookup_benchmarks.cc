@@ -0,0 +1,65 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Benchmarks for looking up localized message strings.
+
+#include "lookup.h"
+//
+#include "l18n.h"
+//
+#include "base/deps/benchmark/benchmark.h"
+
+namespace {
+
+/**
+ * Computes hash for |string|.
+ * @param string String to hash.
+ * @return String hash.
+ */
+[[nodiscard]] WB_ATTRIBUTE_CONST WB_ATTRIBUTE_FORCEINLINE constexpr uint64_t
+hash(std::string_view string) noexcept {
+  return wb::base::intl::I18nStringViewHash{}(string);
+}
+
+}  // namespace
+
+void BM_LookupString(benchmark::State& state) {
+  using namespace wb::base::intl;
+
+  const auto lookup = Lookup::New({"en_US.UTF-8"});
+  if (!lookup) [[unlikely]] {
+    state.SkipWithError("Unable to create en_US.UTF-8 lookup.");
+    return;
+  }
+
+  constexpr std::uint64_t kMessageId{hash("Boot Manager - Error")};
+
+  for ([[maybe_unused]] auto _ : state) {
+    benchmark::DoNotOptimize(lookup->String(kMessageId));
+  }
+}
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+BENCHMARK(BM_LookupString);
+
+void BM_LookupFormat(benchmark::State& state) {
+  using namespace wb::base::intl;
+
+  const auto lookup = Lookup::New({"en_US.UTF-8"});
+  if (!lookup) [[unlikely]] {
+    state.SkipWithError("Unable to create en_US.UTF-8 lookup.");
+    return;
+  }
+
+  constexpr std::uint64_t kMessageId{
+      hash("Can't get '{0}' entry point from '{1}'.")};
+  constexpr std::string_view kEntryPoint{"KernelMain"};
+  constexpr std::string_view kLibraryName{"libwhitebox-kernel.so.1"};
+
+  for ([[maybe_unused]] auto _ : state) {
+    benchmark::DoNotOptimize(lookup->Format(
+        kMessageId, fmt::make_format_args(kEntryPoint, kLibraryName)));
+  }
+}
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+BENCHMARK(BM_LookupFormat);
@@ -19,6 +19,18 @@
 #include "base/intl/lookup_with_fallback.h"
 
 #include "base/deps/g3log/g3log.h"
+#include "base/telemetry/metrics.h"
+
+namespace {
+
+/**
+ * @brief Missed localization strings lookups count.
+ */
+wb::base::telemetry::Counter intl_lookup_misses_counter{
+    "whitebox_intl_lookup_misses",
+    "Localization string lookups which fell back to default string."};
+
+}  // namespace
 
 namespace wb::base::intl {
 
@@ -45,6 +57,7 @@ LookupWithFallback::LookupWithFallback(LookupWithFallback&& l) noexcept
     return *string;
   }
 
+  intl_lookup_misses_counter.Increment();
   G3LOG(WARNING) << "Missed localization string for " << message_id
                  << " message id.";
   return fallback_string_;
@@ -57,6 +70,7 @@ LookupWithFallback::LookupWithFallback(LookupWithFallback&& l) noexcept
     return *string;
   }
 
+  intl_lookup_misses_counter.Increment();
   G3LOG(WARNING) << "Missed localization string for " << message_id
                  << " message id.";
   return fallback_string_;
@@ -0,0 +1,64 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Entry point for benchmarks.
+
+#include <algorithm>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "base/deps/benchmark/benchmark.h"
+#include "base/deps/g3log/scoped_g3log_initializer.h"
+#include "build/static_settings_config.h"
+
+namespace {
+
+/**
+ * @brief Makes JSON default benchmarks output format, so results can be stored
+ * and compared between runs.
+ * @param argc Arguments count.
+ * @param argv Arguments.
+ * @return Arguments with JSON output format if no one specified.
+ */
+[[nodiscard]] std::vector<char *> MakeJsonDefaultOutputFormat(int argc,
+                                                              char *argv[]) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  std::vector<char *> args{argv, argv + argc};
+
+  const bool has_format{std::any_of(
+      args.begin(), args.end(), [](const char *arg) {
+        return std::string_view{arg}.starts_with("--benchmark_format");
+      })};
+  if (!has_format) {
+    static char json_format_arg[] = "--benchmark_format=json";
+    args.emplace_back(json_format_arg);
+  }
+
+  return args;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  std::cerr << "Running main() from " << __FILE__ << '\n';
+
+  // Initialize g3log logging library first as it is used by code under test.
+  const wb::base::deps::g3log::ScopedG3LogInitializer scoped_g3log_initializer{
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-array-to-pointer-decay,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      argv[0], wb::build::settings::kPathToMainLogFile};
+
+  std::vector<char *> args{MakeJsonDefaultOutputFormat(argc, argv)};
+  int args_count{static_cast<int>(args.size())};
+
+  benchmark::Initialize(&args_count, args.data());
+  if (benchmark::ReportUnrecognizedArguments(args_count, args.data())) {
+    return 1;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  return 0;
+}
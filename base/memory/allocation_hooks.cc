@@ -0,0 +1,14 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// New / delete overrides hooks switches.
+
+#include "allocation_hooks.h"
+
+namespace wb::base::memory::internal {
+
+WB_BASE_API constinit std::atomic_uint32_t enabled_allocation_hooks{
+    static_cast<std::uint32_t>(AllocationHooks::kNone)};
+
+}  // namespace wb::base::memory::internal
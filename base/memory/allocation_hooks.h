@@ -0,0 +1,67 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// New / delete overrides hooks switches.  Hooks state lives in whitebox-base,
+// so every module which links it and overrides new / delete feeds single
+// instance.  Modules which do not link whitebox-base are not accounted.
+
+#ifndef WB_BASE_MEMORY_ALLOCATION_HOOKS_H_
+#define WB_BASE_MEMORY_ALLOCATION_HOOKS_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "base/config.h"
+
+namespace wb::base::memory::internal {
+
+/**
+ * @brief New / delete overrides hooks.
+ */
+enum class AllocationHooks : std::uint32_t {
+  /**
+   * @brief No hooks, allocations are not inspected.
+   */
+  kNone = 0U,
+  /**
+   * @brief Per thread allocation stats.
+   */
+  kAllocationStats = 1U << 0U,
+  /**
+   * @brief Sampling heap profiler.
+   */
+  kHeapProfiler = 1U << 1U
+};
+
+/**
+ * @brief Enabled AllocationHooks bits.  Overrides read it on each new /
+ * delete, so usable size is not queried and hooks are not called till some
+ * hook is enabled.
+ */
+WB_BASE_API extern std::atomic_uint32_t enabled_allocation_hooks;
+
+/**
+ * @brief Is |hook| bit set in |hooks|.
+ * @param hooks Enabled hooks.
+ * @param hook Hook.
+ * @return true if set.
+ */
+[[nodiscard]] constexpr bool HasAllocationHook(std::uint32_t hooks,
+                                               AllocationHooks hook) noexcept {
+  return (hooks & static_cast<std::uint32_t>(hook)) != 0U;
+}
+
+/**
+ * @brief Enables allocation hook.
+ * @param hook Hook.
+ * @return void.
+ */
+inline void EnableAllocationHook(AllocationHooks hook) noexcept {
+  enabled_allocation_hooks.fetch_or(static_cast<std::uint32_t>(hook),
+                                    std::memory_order_relaxed);
+}
+
+}  // namespace wb::base::memory::internal
+
+#endif  // !WB_BASE_MEMORY_ALLOCATION_HOOKS_H_
@@ -0,0 +1,85 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per thread heap allocation stats collected by new / delete overrides.
+
+#include "allocation_stats.h"
+
+#include <algorithm>
+
+#include "base/memory/allocation_hooks.h"
+
+namespace {
+
+/**
+ * @brief Current thread allocation stats.  Constant initialized and trivially
+ * destructible, so safe to use from new / delete during thread start / exit.
+ * Defined once in whitebox-base, so allocations of all modules are counted.
+ */
+constinit thread_local wb::base::memory::ThreadAllocationStats
+    thread_allocation_stats{};
+
+}  // namespace
+
+namespace wb::base::memory {
+
+namespace internal {
+
+WB_BASE_API void OnAllocation(std::size_t size) noexcept {
+  auto& stats = thread_allocation_stats;
+
+  ++stats.allocations_count;
+  stats.allocated_bytes += size;
+  stats.live_bytes += static_cast<std::int64_t>(size);
+  stats.peak_live_bytes = std::max(stats.peak_live_bytes, stats.live_bytes);
+}
+
+WB_BASE_API void OnFree(std::size_t size) noexcept {
+  auto& stats = thread_allocation_stats;
+
+  ++stats.frees_count;
+  stats.freed_bytes += size;
+  stats.live_bytes -= static_cast<std::int64_t>(size);
+}
+
+}  // namespace internal
+
+WB_BASE_API void EnableAllocationStats() noexcept {
+  internal::EnableAllocationHook(internal::AllocationHooks::kAllocationStats);
+}
+
+[[nodiscard]] WB_BASE_API bool IsAllocationStatsEnabled() noexcept {
+  return internal::HasAllocationHook(
+      internal::enabled_allocation_hooks.load(std::memory_order_relaxed),
+      internal::AllocationHooks::kAllocationStats);
+}
+
+[[nodiscard]] WB_BASE_API ThreadAllocationStats
+GetThreadAllocationStats() noexcept {
+  return thread_allocation_stats;
+}
+
+[[nodiscard]] WB_BASE_API ThreadAllocationStats
+BeginFrameAllocationStats() noexcept {
+  auto& stats = thread_allocation_stats;
+  // Peak is tracked since frame start.
+  stats.peak_live_bytes = stats.live_bytes;
+  return stats;
+}
+
+[[nodiscard]] WB_BASE_API FrameAllocationStats
+EndFrameAllocationStats(const ThreadAllocationStats& frame_start) noexcept {
+  const ThreadAllocationStats frame_end{thread_allocation_stats};
+
+  return {.allocations_count =
+              frame_end.allocations_count - frame_start.allocations_count,
+          .allocated_bytes =
+              frame_end.allocated_bytes - frame_start.allocated_bytes,
+          .frees_count = frame_end.frees_count - frame_start.frees_count,
+          .peak_bytes = static_cast<std::uint64_t>(
+              std::max(frame_end.peak_live_bytes - frame_start.live_bytes,
+                       std::int64_t{0}))};
+}
+
+}  // namespace wb::base::memory
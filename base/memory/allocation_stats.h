@@ -0,0 +1,135 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per thread heap allocation stats collected by new / delete overrides.
+//
+// Usage example:
+//
+// EnableAllocationStats();
+// ...
+// const ThreadAllocationStats frame_start{BeginFrameAllocationStats()};
+// SimulateWorldStep(...);
+// const FrameAllocationStats frame{EndFrameAllocationStats(frame_start)};
+// G3DCHECK(frame.allocations_count == 0) << "Frame should not allocate.";
+
+#ifndef WB_BASE_MEMORY_ALLOCATION_STATS_H_
+#define WB_BASE_MEMORY_ALLOCATION_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "base/config.h"
+
+namespace wb::base::memory {
+
+/**
+ * @brief Heap allocation stats of the thread since thread start.
+ */
+struct ThreadAllocationStats {
+  /**
+   * @brief Allocations count.
+   */
+  std::uint64_t allocations_count;
+  /**
+   * @brief Allocated usable bytes.
+   */
+  std::uint64_t allocated_bytes;
+  /**
+   * @brief Frees count.
+   */
+  std::uint64_t frees_count;
+  /**
+   * @brief Freed usable bytes.
+   */
+  std::uint64_t freed_bytes;
+  /**
+   * @brief Allocated minus freed bytes by thread.  Can be negative when thread
+   * frees memory allocated by other threads.
+   */
+  std::int64_t live_bytes;
+  /**
+   * @brief Peak of |live_bytes| since thread start or last peak reset.
+   */
+  std::int64_t peak_live_bytes;
+};
+
+/**
+ * @brief Heap allocation stats of a single frame.
+ */
+struct FrameAllocationStats {
+  /**
+   * @brief Allocations count during frame.
+   */
+  std::uint64_t allocations_count;
+  /**
+   * @brief Allocated usable bytes during frame.
+   */
+  std::uint64_t allocated_bytes;
+  /**
+   * @brief Frees count during frame.
+   */
+  std::uint64_t frees_count;
+  /**
+   * @brief Peak live bytes growth during frame.
+   */
+  std::uint64_t peak_bytes;
+};
+
+namespace internal {
+
+/**
+ * @brief Account allocation on current thread.
+ * @param size Allocation usable size.
+ * @return void.
+ */
+WB_BASE_API void OnAllocation(std::size_t size) noexcept;
+
+/**
+ * @brief Account free on current thread.
+ * @param size Freed usable size.
+ * @return void.
+ */
+WB_BASE_API void OnFree(std::size_t size) noexcept;
+
+}  // namespace internal
+
+/**
+ * @brief Enables allocation stats collection by new / delete overrides of all
+ * modules which link whitebox-base.  Allocations made before are not
+ * accounted.
+ * @return void.
+ */
+WB_BASE_API void EnableAllocationStats() noexcept;
+
+/**
+ * @brief Is allocation stats collection enabled.
+ * @return true if enabled.
+ */
+[[nodiscard]] WB_BASE_API bool IsAllocationStatsEnabled() noexcept;
+
+/**
+ * @brief Gets current thread allocation stats.
+ * @return Thread allocation stats.
+ */
+[[nodiscard]] WB_BASE_API ThreadAllocationStats
+GetThreadAllocationStats() noexcept;
+
+/**
+ * @brief Starts frame allocation stats collection on current thread.
+ * @return Thread allocation stats at frame start.
+ */
+[[nodiscard]] WB_BASE_API ThreadAllocationStats
+BeginFrameAllocationStats() noexcept;
+
+/**
+ * @brief Finishes frame allocation stats collection on current thread.
+ * @param frame_start Thread allocation stats at frame start.
+ * @return Frame allocation stats.
+ */
+[[nodiscard]] WB_BASE_API FrameAllocationStats
+EndFrameAllocationStats(const ThreadAllocationStats& frame_start) noexcept;
+
+}  // namespace wb::base::memory
+
+#endif  // !WB_BASE_MEMORY_ALLOCATION_STATS_H_
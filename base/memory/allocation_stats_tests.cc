@@ -0,0 +1,99 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per thread heap allocation stats collected by new / delete overrides.
+
+#include "allocation_stats.h"
+//
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "base/deps/googletest/gtest/gtest.h"
+#include "base/numa_topology.h"
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(AllocationStatsTest, NewDeleteAreAccounted) {
+  using namespace wb::base::memory;
+
+  EnableAllocationStats();
+  EXPECT_TRUE(IsAllocationStatsEnabled());
+
+  const ThreadAllocationStats frame_start{BeginFrameAllocationStats()};
+  {
+    auto value = std::make_unique<std::uint64_t[]>(16);
+    EXPECT_NE(nullptr, value.get());
+  }
+  const FrameAllocationStats frame{EndFrameAllocationStats(frame_start)};
+
+  EXPECT_EQ(1U, frame.allocations_count);
+  EXPECT_GE(frame.allocated_bytes, 16U * sizeof(std::uint64_t));
+  EXPECT_EQ(1U, frame.frees_count);
+  EXPECT_GE(frame.peak_bytes, 16U * sizeof(std::uint64_t));
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(AllocationStatsTest, PeakIsTrackedSinceFrameStart) {
+  using namespace wb::base::memory;
+
+  EnableAllocationStats();
+
+  {
+    // Raise thread peak before frame.
+    std::vector<char> big(1U << 20U);
+    EXPECT_EQ(1U << 20U, big.size());
+  }
+
+  const ThreadAllocationStats frame_start{BeginFrameAllocationStats()};
+  {
+    auto value = std::make_unique<int>(42);
+    EXPECT_NE(nullptr, value.get());
+  }
+  const FrameAllocationStats frame{EndFrameAllocationStats(frame_start)};
+
+  EXPECT_GE(frame.peak_bytes, sizeof(int));
+  EXPECT_LT(frame.peak_bytes, 1U << 20U);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(AllocationStatsTest, OtherThreadsAllocationsAreNotAccounted) {
+  using namespace wb::base::memory;
+
+  EnableAllocationStats();
+
+  std::vector<int>* values{nullptr};
+  std::thread worker{[&values]() { values = new std::vector<int>(64); }};
+  // Thread creation can allocate, so start frame after it.
+  const ThreadAllocationStats frame_start{BeginFrameAllocationStats()};
+  worker.join();
+  const FrameAllocationStats frame{EndFrameAllocationStats(frame_start)};
+
+  EXPECT_EQ(0U, frame.allocations_count);
+
+  delete values;
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(AllocationStatsTest, OtherModulesAllocationsAreAccounted) {
+  using namespace wb::base;
+
+  memory::EnableAllocationStats();
+
+  const memory::ThreadAllocationStats frame_start{
+      memory::BeginFrameAllocationStats()};
+  {
+    // Allocated by whitebox-base, freed by tests executable.
+    const auto cpus = ParseCpuList("0-1023");
+    ASSERT_TRUE(cpus.has_value());
+    EXPECT_EQ(1024U, cpus->size());
+  }
+  const memory::FrameAllocationStats frame{
+      memory::EndFrameAllocationStats(frame_start)};
+
+  EXPECT_GE(frame.allocations_count, 1U);
+  EXPECT_GE(frame.allocated_bytes, 1024U * sizeof(std::uint32_t));
+  EXPECT_EQ(frame.allocations_count, frame.frees_count);
+  EXPECT_GE(frame.peak_bytes, 1024U * sizeof(std::uint32_t));
+}
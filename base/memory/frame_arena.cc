@@ -0,0 +1,182 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per frame linear arena for transient data.
+
+#include "frame_arena.h"
+
+#include <algorithm>
+
+#include "base/deps/g3log/g3log.h"
+#include "base/deps/mimalloc/mimalloc.h"
+
+namespace {
+
+/**
+ * @brief Frame arena thread index of frame thread and unregistered threads.
+ */
+constexpr std::uint32_t kFrameThreadArenaIndex{0U};
+
+/**
+ * @brief Frame arena thread index of threads without sub-arena.
+ */
+constexpr std::uint32_t kNoFrameArenaIndex{
+    wb::base::memory::kMaxFrameArenaWorkersCount + 1U};
+
+/**
+ * @brief Current thread frame arena index.  Workers are 1-based.
+ */
+thread_local std::uint32_t current_frame_arena_index{kFrameThreadArenaIndex};
+
+/**
+ * @brief Chunk sizes are rounded to this.
+ */
+constexpr std::size_t kChunkSizeGranularity{4096U};
+
+/**
+ * @brief Rounds chunk size up to granularity.
+ * @param size Size.
+ * @return Rounded size.
+ */
+[[nodiscard]] constexpr std::size_t RoundUpChunkSize(
+    std::size_t size) noexcept {
+  return (size + kChunkSizeGranularity - 1U) & ~(kChunkSizeGranularity - 1U);
+}
+
+}  // namespace
+
+namespace wb::base::memory {
+
+WB_BASE_API LinearArena::~LinearArena() noexcept { FreeChunks(); }
+
+[[nodiscard]] WB_BASE_API void* LinearArena::AllocateSlow(
+    std::size_t size, std::size_t alignment) noexcept {
+  G3DCHECK(alignment != 0 && (alignment & (alignment - 1U)) == 0)
+      << "Alignment " << alignment << " should be power of 2.";
+
+  // Worst case alignment padding, as chunk start is max_align_t aligned only.
+  const std::size_t required_size{sizeof(Chunk) + size + alignment};
+  if (required_size < size) [[unlikely]] return nullptr;
+
+  const std::size_t chunk_size{
+      RoundUpChunkSize(std::max(chunk_size_, required_size))};
+  void* memory{::mi_malloc_aligned(chunk_size, alignof(Chunk))};
+  if (!memory) [[unlikely]] return nullptr;
+
+  if (chunk_) {
+    previous_chunks_used_bytes_ +=
+        current_ - reinterpret_cast<std::uintptr_t>(chunk_ + 1);
+  }
+
+  chunk_ = ::new (memory) Chunk{.previous = chunk_, .size = chunk_size};
+  current_ = reinterpret_cast<std::uintptr_t>(chunk_ + 1);
+  end_ = reinterpret_cast<std::uintptr_t>(memory) + chunk_size;
+
+  const std::uintptr_t aligned{(current_ + alignment - 1U) & ~(alignment - 1U)};
+  current_ = aligned + size;
+  return reinterpret_cast<void*>(aligned);
+}
+
+WB_BASE_API void LinearArena::Reset() noexcept {
+  const std::size_t used{used_bytes()};
+  high_water_bytes_ = std::max(high_water_bytes_, used);
+
+  if (chunk_ && chunk_->previous) {
+    // Overflowed, grow to fit the whole frame in single chunk next time.
+    chunk_size_ = RoundUpChunkSize(
+        std::max(chunk_size_, sizeof(Chunk) + high_water_bytes_));
+    FreeChunks();
+  } else if (chunk_) {
+    current_ = reinterpret_cast<std::uintptr_t>(chunk_ + 1);
+  }
+
+  previous_chunks_used_bytes_ = 0;
+}
+
+[[nodiscard]] WB_BASE_API std::size_t LinearArena::used_bytes()
+    const noexcept {
+  return chunk_ ? previous_chunks_used_bytes_ +
+                      (current_ - reinterpret_cast<std::uintptr_t>(chunk_ + 1))
+                : 0U;
+}
+
+[[nodiscard]] WB_BASE_API std::size_t LinearArena::chunks_count()
+    const noexcept {
+  std::size_t count{0};
+  for (const Chunk* chunk{chunk_}; chunk; chunk = chunk->previous) ++count;
+  return count;
+}
+
+WB_BASE_API void LinearArena::FreeChunks() noexcept {
+  while (chunk_) {
+    Chunk* previous{chunk_->previous};
+    ::mi_free(chunk_);
+    chunk_ = previous;
+  }
+
+  current_ = 0;
+  end_ = 0;
+}
+
+WB_BASE_API FrameArena::FrameArena() noexcept
+    : stats_{.frame_used_bytes = 0,
+             .high_water_bytes = 0,
+             .frame_overflow_chunks_count = 0,
+             .frames_count = 0},
+      frame_thread_id_{std::this_thread::get_id()} {}
+
+[[nodiscard]] WB_BASE_API LinearArena* FrameArena::ForCurrentThread() noexcept {
+  const std::uint32_t index{current_frame_arena_index};
+
+  if (index == kFrameThreadArenaIndex) {
+    // Unregistered threads should not race with frame thread.
+    return std::this_thread::get_id() == frame_thread_id_
+               ? &thread_arenas_[kFrameThreadArenaIndex].arena
+               : nullptr;
+  }
+
+  return index != kNoFrameArenaIndex ? &thread_arenas_[index].arena : nullptr;
+}
+
+WB_BASE_API void FrameArena::Reset() noexcept {
+  G3DCHECK(std::this_thread::get_id() == frame_thread_id_)
+      << "Frame arena should be reset on frame thread.";
+
+  std::uint64_t used_bytes{0}, overflow_chunks_count{0};
+  for (auto& thread_arena : thread_arenas_) {
+    LinearArena& arena{thread_arena.arena};
+
+    const std::size_t chunks_count{arena.chunks_count()};
+    if (chunks_count == 0) continue;
+
+    used_bytes += arena.used_bytes();
+    overflow_chunks_count += chunks_count - 1U;
+
+    arena.Reset();
+  }
+
+  stats_.frame_used_bytes = used_bytes;
+  stats_.high_water_bytes = std::max(stats_.high_water_bytes, used_bytes);
+  stats_.frame_overflow_chunks_count = overflow_chunks_count;
+  ++stats_.frames_count;
+}
+
+WB_BASE_API ScopedFrameArenaWorker::ScopedFrameArenaWorker(
+    int worker_id) noexcept {
+  if (worker_id < 0 ||
+      worker_id >= static_cast<int>(kMaxFrameArenaWorkersCount)) [[unlikely]] {
+    G3LOG(WARNING) << "Worker #" << worker_id
+                   << " is out of frame arena range, no frame arena for it.";
+    current_frame_arena_index = kNoFrameArenaIndex;
+    return;
+  }
+
+  current_frame_arena_index = static_cast<std::uint32_t>(worker_id) + 1U;
+}
+
+WB_BASE_API ScopedFrameArenaWorker::~ScopedFrameArenaWorker() noexcept {
+  current_frame_arena_index = kFrameThreadArenaIndex;
+}
+
+}  // namespace wb::base::memory
@@ -0,0 +1,329 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per frame linear arena for transient data.  Allocation is a pointer bump,
+// there are no frees, all memory is released at once on frame end.  Frame
+// thread and each scheduler worker have own sub-arena, so allocations never
+// lock.
+//
+// Usage example:
+//
+// FrameArena frame_arena;
+// ...
+// LinearArena* arena{frame_arena.ForCurrentThread()};
+// auto contacts = arena->NewArray<Contact>(contacts_count);
+// ...
+// // Frame end, no tasks use arena.
+// frame_arena.Reset();
+
+#ifndef WB_BASE_MEMORY_FRAME_ARENA_H_
+#define WB_BASE_MEMORY_FRAME_ARENA_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "base/config.h"
+#include "base/macroses.h"
+#include "build/compiler_config.h"
+
+namespace wb::base::memory {
+
+/**
+ * @brief Default linear arena chunk size.
+ */
+inline constexpr std::size_t kDefaultLinearArenaChunkSize{64U * 1024U};
+
+/**
+ * @brief Max scheduler workers count frame arena has sub-arenas for.
+ */
+inline constexpr std::uint32_t kMaxFrameArenaWorkersCount{256U};
+
+/**
+ * @brief Single threaded linear (bump) arena.  When chunk is over, new chunk
+ * is chained, and on reset arena grows to fit the whole high-water mark in
+ * single chunk, so steady state frames never touch heap.
+ */
+class WB_BASE_API LinearArena {
+ public:
+  /**
+   * @brief Creates arena with default chunk size.  Does not allocate till
+   * first allocation.
+   */
+  LinearArena() noexcept : LinearArena{kDefaultLinearArenaChunkSize} {}
+
+  /**
+   * @brief Creates arena.  Does not allocate till first allocation.
+   * @param chunk_size Initial chunk size.
+   */
+  explicit LinearArena(std::size_t chunk_size) noexcept
+      : chunk_{nullptr},
+        current_{0},
+        end_{0},
+        chunk_size_{chunk_size},
+        previous_chunks_used_bytes_{0},
+        high_water_bytes_{0} {}
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(LinearArena);
+
+  /**
+   * @brief Releases all chunks.
+   */
+  ~LinearArena() noexcept;
+
+  /**
+   * @brief Allocates memory till next reset.
+   * @param size Size.
+   * @param alignment Alignment, power of 2.
+   * @return Memory or nullptr when out of memory.
+   */
+  [[nodiscard]] void* Allocate(
+      std::size_t size,
+      std::size_t alignment = alignof(std::max_align_t)) noexcept {
+    const std::uintptr_t aligned{(current_ + alignment - 1U) &
+                                 ~(alignment - 1U)};
+    // Empty arena has zero end, so goes to slow path.
+    if (aligned >= current_ && aligned < end_ && size <= end_ - aligned)
+        [[likely]] {
+      current_ = aligned + size;
+      return reinterpret_cast<void*>(aligned);
+    }
+
+    return AllocateSlow(size, alignment);
+  }
+
+  /**
+   * @brief Creates object till next reset.  Destructor is never called, so
+   * object should be trivially destructible.
+   * @tparam T Object type.
+   * @tparam TArgs Object constructor arguments types.
+   * @param args Object constructor arguments.
+   * @return Object or nullptr when out of memory.
+   */
+  template <typename T, typename... TArgs>
+    requires std::is_trivially_destructible_v<T>
+  [[nodiscard]] T* New(TArgs&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, TArgs...>) {
+    void* memory{Allocate(sizeof(T), alignof(T))};
+    return memory ? ::new (memory) T{std::forward<TArgs>(args)...} : nullptr;
+  }
+
+  /**
+   * @brief Creates value initialized array till next reset.
+   * @tparam T Array item type.
+   * @param count Items count.
+   * @return Array or empty span when out of memory.
+   */
+  template <typename T>
+    requires std::is_trivially_destructible_v<T> &&
+             std::is_nothrow_default_constructible_v<T>
+  [[nodiscard]] std::span<T> NewArray(std::size_t count) noexcept {
+    if (count > SIZE_MAX / sizeof(T)) [[unlikely]] return {};
+
+    void* memory{Allocate(count * sizeof(T), alignof(T))};
+    if (!memory) [[unlikely]] return {};
+
+    T* items{static_cast<T*>(memory)};
+    for (std::size_t i{0}; i < count; ++i) ::new (items + i) T{};
+    return {items, count};
+  }
+
+  /**
+   * @brief Releases all allocations.  Merges chained chunks into single one.
+   * @return void.
+   */
+  void Reset() noexcept;
+
+  /**
+   * @brief Gets bytes used since last reset, including alignment.
+   * @return Used bytes.
+   */
+  [[nodiscard]] std::size_t used_bytes() const noexcept;
+
+  /**
+   * @brief Gets max used bytes between resets.
+   * @return High-water mark bytes.
+   */
+  [[nodiscard]] std::size_t high_water_bytes() const noexcept {
+    return high_water_bytes_;
+  }
+
+  /**
+   * @brief Gets chained chunks count since last reset.
+   * @return Chunks count.
+   */
+  [[nodiscard]] std::size_t chunks_count() const noexcept;
+
+ private:
+  /**
+   * @brief Chunk header, placed at chunk start.
+   */
+  struct alignas(std::max_align_t) Chunk {
+    /**
+     * @brief Previous chunk.
+     */
+    Chunk* previous;
+    /**
+     * @brief Chunk size including header.
+     */
+    std::size_t size;
+  };
+
+  /**
+   * @brief Current chunk.
+   */
+  Chunk* chunk_;
+  /**
+   * @brief Current chunk free space start.
+   */
+  std::uintptr_t current_;
+  /**
+   * @brief Current chunk end.
+   */
+  std::uintptr_t end_;
+  /**
+   * @brief Next chunk size.
+   */
+  std::size_t chunk_size_;
+  /**
+   * @brief Bytes used in previous chunks since last reset.
+   */
+  std::size_t previous_chunks_used_bytes_;
+  /**
+   * @brief Max used bytes between resets.
+   */
+  std::size_t high_water_bytes_;
+
+  /**
+   * @brief Chains new chunk and allocates from it.
+   * @param size Size.
+   * @param alignment Alignment.
+   * @return Memory or nullptr when out of memory.
+   */
+  [[nodiscard]] void* AllocateSlow(std::size_t size,
+                                   std::size_t alignment) noexcept;
+
+  /**
+   * @brief Frees all chunks.
+   * @return void.
+   */
+  void FreeChunks() noexcept;
+};
+
+/**
+ * @brief Frame arena stats.
+ */
+struct FrameArenaStats {
+  /**
+   * @brief Bytes used by all threads during last frame.
+   */
+  std::uint64_t frame_used_bytes;
+  /**
+   * @brief Max bytes used by all threads during single frame.
+   */
+  std::uint64_t high_water_bytes;
+  /**
+   * @brief Chunks chained during last frame.  Should be 0 in steady state.
+   */
+  std::uint64_t frame_overflow_chunks_count;
+  /**
+   * @brief Frames since arena creation.
+   */
+  std::uint64_t frames_count;
+};
+
+/**
+ * @brief Per frame arena with sub-arena per thread.  Frame thread is the one
+ * which created arena, workers should be registered via
+ * ScopedFrameArenaWorker.
+ */
+class WB_BASE_API FrameArena {
+ public:
+  /**
+   * @brief Creates frame arena owned by current thread.  Does not allocate
+   * chunks till first allocation.
+   */
+  FrameArena() noexcept;
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(FrameArena);
+
+  ~FrameArena() noexcept = default;
+
+  /**
+   * @brief Gets current thread sub-arena.  Use it only during current frame
+   * and on current thread.
+   * @return Sub-arena or nullptr when current thread is neither frame thread
+   * nor registered worker.
+   */
+  [[nodiscard]] LinearArena* ForCurrentThread() noexcept;
+
+  /**
+   * @brief Releases all frame allocations of all threads.  Call on frame
+   * thread when no tasks use arena.
+   * @return void.
+   */
+  void Reset() noexcept;
+
+  /**
+   * @brief Gets frame arena stats.
+   * @return Stats.
+   */
+  [[nodiscard]] FrameArenaStats GetStats() const noexcept { return stats_; }
+
+ private:
+  /**
+   * @brief Thread sub-arena.  Cache line sized to prevent false sharing.
+   */
+  struct alignas(64) ThreadArena {
+    /**
+     * @brief Arena.
+     */
+    LinearArena arena;
+    WB_ATTRIBUTE_UNUSED_FIELD std::byte pad_[64U - sizeof(LinearArena)];
+  };
+
+  /**
+   * @brief Sub-arenas.  Frame thread is first, then workers by id.
+   */
+  std::array<ThreadArena, kMaxFrameArenaWorkersCount + 1U> thread_arenas_;
+  /**
+   * @brief Stats.
+   */
+  FrameArenaStats stats_;
+  /**
+   * @brief Frame thread id.
+   */
+  std::thread::id frame_thread_id_;
+  WB_ATTRIBUTE_UNUSED_FIELD std::byte
+      pad_[64U - sizeof(stats_) - sizeof(frame_thread_id_)];
+};
+
+/**
+ * @brief Registers current thread as frame arena worker in scope.
+ */
+class WB_BASE_API ScopedFrameArenaWorker {
+ public:
+  /**
+   * @brief Registers current thread as worker.
+   * @param worker_id Worker id.  Workers out of kMaxFrameArenaWorkersCount
+   * get no sub-arena.
+   */
+  explicit ScopedFrameArenaWorker(int worker_id) noexcept;
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(ScopedFrameArenaWorker);
+
+  /**
+   * @brief Unregisters current thread as worker.
+   */
+  ~ScopedFrameArenaWorker() noexcept;
+};
+
+}  // namespace wb::base::memory
+
+#endif  // !WB_BASE_MEMORY_FRAME_ARENA_H_
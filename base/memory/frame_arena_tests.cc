@@ -0,0 +1,141 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per frame linear arena for transient data.
+
+#include "frame_arena.h"
+//
+#include <cstdint>
+#include <thread>
+
+#include "base/deps/googletest/gtest/gtest.h"
+
+namespace {
+
+/**
+ * @brief Test transient object.
+ */
+struct Contact {
+  /**
+   * @brief Contact body id.
+   */
+  std::uint32_t body_id;
+  /**
+   * @brief Contact depth.
+   */
+  float depth;
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(LinearArenaTest, AllocationsAreAlignedAndSequential) {
+  using namespace wb::base::memory;
+
+  LinearArena arena;
+
+  auto* first = arena.New<Contact>(1U, 0.5F);
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(1U, first->body_id);
+  EXPECT_EQ(0.5F, first->depth);
+
+  void* aligned{arena.Allocate(1U, 64U)};
+  ASSERT_NE(nullptr, aligned);
+  EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(aligned) % 64U);
+
+  auto contacts = arena.NewArray<Contact>(16U);
+  ASSERT_EQ(16U, contacts.size());
+  EXPECT_EQ(0U, contacts[15].body_id);
+  EXPECT_GT(static_cast<void*>(contacts.data()), aligned);
+
+  EXPECT_EQ(1U, arena.chunks_count());
+  EXPECT_GE(arena.used_bytes(), sizeof(Contact) * 17U + 1U);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(LinearArenaTest, OverflowChainsAndResetGrowsToFit) {
+  using namespace wb::base::memory;
+
+  LinearArena arena{4096U};
+
+  for (int i{0}; i < 4; ++i) {
+    ASSERT_NE(nullptr, arena.Allocate(3000U));
+  }
+  EXPECT_EQ(4U, arena.chunks_count());
+  EXPECT_EQ(12000U, arena.used_bytes());
+
+  arena.Reset();
+  EXPECT_EQ(0U, arena.used_bytes());
+  EXPECT_EQ(12000U, arena.high_water_bytes());
+
+  // Whole frame fits in single chunk now.
+  for (int i{0}; i < 4; ++i) {
+    ASSERT_NE(nullptr, arena.Allocate(3000U));
+  }
+  EXPECT_EQ(1U, arena.chunks_count());
+
+  // Large allocation gets own chunk.
+  EXPECT_NE(nullptr, arena.Allocate(1024U * 1024U));
+  EXPECT_EQ(2U, arena.chunks_count());
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(LinearArenaTest, SteadyStateFramesDoNotTouchHeap) {
+  using namespace wb::base::memory;
+
+  LinearArena arena;
+  // Warm up.
+  void* frame_start{arena.Allocate(1024U)};
+  ASSERT_NE(nullptr, frame_start);
+  arena.Reset();
+
+  for (int frame{0}; frame < 8; ++frame) {
+    // Same chunk is reused each frame.
+    EXPECT_EQ(frame_start, arena.Allocate(1024U));
+    for (int i{0}; i < 64; ++i) {
+      ASSERT_NE(nullptr, arena.New<Contact>(static_cast<std::uint32_t>(i),
+                                            1.0F));
+    }
+    EXPECT_EQ(1U, arena.chunks_count());
+    arena.Reset();
+  }
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(FrameArenaTest, ThreadsGetOwnSubArenas) {
+  using namespace wb::base::memory;
+
+  FrameArena frame_arena;
+
+  LinearArena* frame_thread_arena{frame_arena.ForCurrentThread()};
+  ASSERT_NE(nullptr, frame_thread_arena);
+  ASSERT_NE(nullptr, frame_thread_arena->Allocate(100U, 4U));
+
+  LinearArena* worker_arena{nullptr};
+  LinearArena* unregistered_arena{frame_thread_arena};
+  std::thread worker{[&]() {
+    unregistered_arena = frame_arena.ForCurrentThread();
+
+    const ScopedFrameArenaWorker scoped_frame_arena_worker{3};
+    worker_arena = frame_arena.ForCurrentThread();
+    ASSERT_NE(nullptr, worker_arena);
+    ASSERT_NE(nullptr, worker_arena->Allocate(200U, 4U));
+  }};
+  worker.join();
+
+  EXPECT_EQ(nullptr, unregistered_arena);
+  EXPECT_NE(frame_thread_arena, worker_arena);
+
+  frame_arena.Reset();
+
+  const FrameArenaStats stats{frame_arena.GetStats()};
+  EXPECT_EQ(300U, stats.frame_used_bytes);
+  EXPECT_EQ(300U, stats.high_water_bytes);
+  EXPECT_EQ(0U, stats.frame_overflow_chunks_count);
+  EXPECT_EQ(1U, stats.frames_count);
+
+  frame_arena.Reset();
+  EXPECT_EQ(0U, frame_arena.GetStats().frame_used_bytes);
+  EXPECT_EQ(300U, frame_arena.GetStats().high_water_bytes);
+}
@@ -0,0 +1,297 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Generational handle table.  Subsystems reference objects of other
+// subsystems (entities, assets, sounds) by 32-bit index + 32-bit generation
+// handles instead of raw / shared pointers.  Lookup is indexed load plus
+// generation compare, so stale handles are detected in O(1).  Objects are
+// kept dense, so systems can iterate them linearly.
+//
+// Usage example:
+//
+// HandleTable<Sound> sounds;
+// const Handle<Sound> explosion{sounds.Emplace(explosion_wav)};
+// ...
+// if (Sound* sound{sounds.Get(explosion)}) sound->Play();
+// ...
+// for (Sound& sound : sounds.values()) sound.Update(dt);
+// ...
+// sounds.Erase(explosion);
+
+#ifndef WB_BASE_MEMORY_HANDLE_TABLE_H_
+#define WB_BASE_MEMORY_HANDLE_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/deps/g3log/g3log.h"
+#include "base/macroses.h"
+#include "build/compiler_config.h"
+
+namespace wb::base::memory {
+
+/**
+ * @brief Handle to object in handle table.
+ * @tparam T Object type, so handles of different tables do not mix.
+ */
+template <typename T>
+struct Handle {
+  /**
+   * @brief Slot index.
+   */
+  std::uint32_t index{std::numeric_limits<std::uint32_t>::max()};
+  /**
+   * @brief Slot generation.  Incremented each time slot is freed.
+   */
+  std::uint32_t generation{0U};
+
+  /**
+   * @brief Is handle not null?  Null handle never refers to object, but not
+   * null one can be stale.
+   * @return true if not null.
+   */
+  [[nodiscard]] constexpr explicit operator bool() const noexcept {
+    return index != std::numeric_limits<std::uint32_t>::max();
+  }
+
+  [[nodiscard]] constexpr bool operator==(const Handle&) const noexcept =
+      default;
+};
+
+/**
+ * @brief Generational handle table.  Not thread safe.
+ * @tparam T Object type.  Should be nothrow move constructible and assignable,
+ * as objects are moved on erase to keep storage dense.
+ */
+template <typename T>
+class HandleTable {
+  static_assert(std::is_nothrow_move_constructible_v<T> &&
+                    std::is_nothrow_move_assignable_v<T>,
+                "T should be nothrow movable.");
+
+  /**
+   * @brief Slot index in free list means no next free slot.
+   */
+  static constexpr std::uint32_t kNoSlot{
+      std::numeric_limits<std::uint32_t>::max()};
+
+  /**
+   * @brief Slot.  Live slot points to dense object, free one to next free
+   * slot.
+   */
+  struct Slot {
+    /**
+     * @brief Dense object index for live slot, next free slot index for free
+     * one.
+     */
+    std::uint32_t dense_or_next_free_index;
+    /**
+     * @brief Slot generation.
+     */
+    std::uint32_t generation;
+  };
+
+ public:
+  /**
+   * @brief Creates handle table.
+   * @param capacity Objects count to reserve space for.
+   */
+  explicit HandleTable(std::size_t capacity = 0U) {
+    slots_.reserve(capacity);
+    values_.reserve(capacity);
+    dense_slots_.reserve(capacity);
+  }
+
+  HandleTable(HandleTable&&) noexcept = default;
+  HandleTable& operator=(HandleTable&&) noexcept = default;
+
+  WB_NO_COPY_CTOR_AND_ASSIGNMENT(HandleTable);
+
+  ~HandleTable() noexcept = default;
+
+  /**
+   * @brief Creates object in table.
+   * @tparam Args Object constructor arguments.
+   * @param args Object constructor arguments.
+   * @return Object handle.
+   */
+  template <typename... Args>
+  [[nodiscard]] Handle<T> Emplace(Args&&... args) {
+    G3DCHECK(values_.size() < kNoSlot) << "Handle table is full.";
+
+    values_.emplace_back(std::forward<Args>(args)...);
+
+    const auto dense_index = static_cast<std::uint32_t>(values_.size() - 1);
+    std::uint32_t slot_index;
+
+    if (free_slot_index_ != kNoSlot) {
+      slot_index = free_slot_index_;
+      free_slot_index_ = slots_[slot_index].dense_or_next_free_index;
+    } else {
+      slot_index = static_cast<std::uint32_t>(slots_.size());
+      try {
+        slots_.emplace_back(Slot{kNoSlot, 0U});
+      } catch (...) {
+        values_.pop_back();
+        throw;
+      }
+    }
+
+    try {
+      dense_slots_.emplace_back(slot_index);
+    } catch (...) {
+      values_.pop_back();
+      slots_[slot_index].dense_or_next_free_index = free_slot_index_;
+      free_slot_index_ = slot_index;
+      throw;
+    }
+
+    Slot& slot{slots_[slot_index]};
+    slot.dense_or_next_free_index = dense_index;
+
+    return Handle<T>{.index = slot_index, .generation = slot.generation};
+  }
+
+  /**
+   * @brief Erases object.  Last dense object is moved into erased one place.
+   * @param handle Object handle.
+   * @return true if erased, false if handle is null or stale.
+   */
+  bool Erase(Handle<T> handle) noexcept {
+    if (!Contains(handle)) return false;
+
+    Slot& slot{slots_[handle.index]};
+    const std::uint32_t dense_index{slot.dense_or_next_free_index};
+    const auto last_dense_index =
+        static_cast<std::uint32_t>(values_.size() - 1);
+
+    if (dense_index != last_dense_index) {
+      values_[dense_index] = std::move(values_[last_dense_index]);
+      dense_slots_[dense_index] = dense_slots_[last_dense_index];
+      slots_[dense_slots_[dense_index]].dense_or_next_free_index = dense_index;
+    }
+
+    values_.pop_back();
+    dense_slots_.pop_back();
+
+    // Slot with exhausted generations is retired, so handles never alias.
+    if (++slot.generation != std::numeric_limits<std::uint32_t>::max()) {
+      slot.dense_or_next_free_index = free_slot_index_;
+      free_slot_index_ = handle.index;
+    } else {
+      slot.dense_or_next_free_index = kNoSlot;
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Does handle refer to live object?
+   * @param handle Object handle.
+   * @return true if object is live, false if handle is null or stale.
+   */
+  [[nodiscard]] bool Contains(Handle<T> handle) const noexcept {
+    return handle.index < slots_.size() &&
+           slots_[handle.index].generation == handle.generation &&
+           slots_[handle.index].dense_or_next_free_index < values_.size() &&
+           dense_slots_[slots_[handle.index].dense_or_next_free_index] ==
+               handle.index;
+  }
+
+  /**
+   * @brief Gets object.
+   * @param handle Object handle.
+   * @return Object or nullptr if handle is null or stale.
+   */
+  [[nodiscard]] T* Get(Handle<T> handle) noexcept {
+    return Contains(handle)
+               ? &values_[slots_[handle.index].dense_or_next_free_index]
+               : nullptr;
+  }
+
+  /**
+   * @brief Gets object.
+   * @param handle Object handle.
+   * @return Object or nullptr if handle is null or stale.
+   */
+  [[nodiscard]] const T* Get(Handle<T> handle) const noexcept {
+    return Contains(handle)
+               ? &values_[slots_[handle.index].dense_or_next_free_index]
+               : nullptr;
+  }
+
+  /**
+   * @brief Gets handle of dense object.
+   * @param dense_index Dense object index, less than size().
+   * @return Object handle.
+   */
+  [[nodiscard]] Handle<T> GetHandle(std::size_t dense_index) const noexcept {
+    G3DCHECK(dense_index < values_.size());
+
+    const std::uint32_t slot_index{dense_slots_[dense_index]};
+    return Handle<T>{.index = slot_index,
+                     .generation = slots_[slot_index].generation};
+  }
+
+  /**
+   * @brief Gets dense objects.  Order changes on erase.
+   * @return Objects.
+   */
+  [[nodiscard]] std::span<T> values() noexcept { return values_; }
+
+  /**
+   * @brief Gets dense objects.  Order changes on erase.
+   * @return Objects.
+   */
+  [[nodiscard]] std::span<const T> values() const noexcept { return values_; }
+
+  /**
+   * @brief Gets live objects count.
+   * @return Live objects count.
+   */
+  [[nodiscard]] std::size_t size() const noexcept { return values_.size(); }
+
+  /**
+   * @brief Is table empty?
+   * @return true if no live objects.
+   */
+  [[nodiscard]] bool empty() const noexcept { return values_.empty(); }
+
+  /**
+   * @brief Erases all objects.  All handles become stale.
+   * @return void.
+   */
+  void Clear() noexcept {
+    while (!values_.empty()) Erase(GetHandle(values_.size() - 1));
+  }
+
+ private:
+  /**
+   * @brief Slots, indexed by handle index.
+   */
+  std::vector<Slot> slots_;
+  /**
+   * @brief Dense objects.
+   */
+  std::vector<T> values_;
+  /**
+   * @brief Slot index per dense object.
+   */
+  std::vector<std::uint32_t> dense_slots_;
+  /**
+   * @brief Free slots list head.
+   */
+  std::uint32_t free_slot_index_{kNoSlot};
+  WB_ATTRIBUTE_UNUSED_FIELD std::byte
+      pad_[sizeof(void*) - sizeof(free_slot_index_)];
+};
+
+}  // namespace wb::base::memory
+
+#endif  // !WB_BASE_MEMORY_HANDLE_TABLE_H_
@@ -0,0 +1,115 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Generational handle table.
+
+#include "handle_table.h"
+//
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/deps/googletest/gtest/gtest.h"
+
+namespace {
+
+/**
+ * @brief Test asset.
+ */
+struct Asset {
+  /**
+   * @brief Asset path.
+   */
+  std::string path;
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(HandleTableTest, EmplaceGetErase) {
+  using namespace wb::base::memory;
+
+  HandleTable<Asset> assets{4U};
+  EXPECT_TRUE(assets.empty());
+  EXPECT_EQ(nullptr, assets.Get(Handle<Asset>{}));
+  EXPECT_FALSE(Handle<Asset>{});
+
+  const Handle<Asset> crate{assets.Emplace("crate.mdl")};
+  const Handle<Asset> barrel{assets.Emplace("barrel.mdl")};
+  EXPECT_TRUE(crate);
+  EXPECT_NE(crate, barrel);
+  EXPECT_EQ(2U, assets.size());
+
+  ASSERT_NE(nullptr, assets.Get(crate));
+  EXPECT_EQ("crate.mdl", assets.Get(crate)->path);
+  ASSERT_NE(nullptr, assets.Get(barrel));
+  EXPECT_EQ("barrel.mdl", assets.Get(barrel)->path);
+
+  EXPECT_TRUE(assets.Erase(crate));
+  EXPECT_FALSE(assets.Erase(crate));
+  EXPECT_FALSE(assets.Contains(crate));
+  EXPECT_EQ(nullptr, assets.Get(crate));
+
+  // Last object is moved into erased place.
+  ASSERT_NE(nullptr, assets.Get(barrel));
+  EXPECT_EQ("barrel.mdl", assets.Get(barrel)->path);
+  EXPECT_EQ(1U, assets.size());
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(HandleTableTest, ReusedSlotInvalidatesStaleHandle) {
+  using namespace wb::base::memory;
+
+  HandleTable<int> values;
+
+  const Handle<int> first{values.Emplace(1)};
+  EXPECT_TRUE(values.Erase(first));
+
+  const Handle<int> second{values.Emplace(2)};
+  // Same slot, new generation.
+  EXPECT_EQ(first.index, second.index);
+  EXPECT_NE(first.generation, second.generation);
+
+  EXPECT_EQ(nullptr, values.Get(first));
+  ASSERT_NE(nullptr, values.Get(second));
+  EXPECT_EQ(2, *values.Get(second));
+
+  values.Clear();
+  EXPECT_TRUE(values.empty());
+  EXPECT_EQ(nullptr, values.Get(second));
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(HandleTableTest, DenseValuesMatchHandles) {
+  using namespace wb::base::memory;
+
+  HandleTable<int> values{64U};
+  std::vector<Handle<int>> handles;
+
+  for (int i{0}; i < 64; ++i) handles.emplace_back(values.Emplace(i));
+  // Erase every third.
+  for (std::size_t i{0}; i < handles.size(); i += 3) {
+    EXPECT_TRUE(values.Erase(handles[i]));
+  }
+
+  EXPECT_EQ(42U, values.size());
+  EXPECT_EQ(42U, values.values().size());
+
+  int sum{0};
+  for (std::size_t i{0}; i < values.size(); ++i) {
+    const int value{values.values()[i]};
+    sum += value;
+
+    // Dense index maps back to handle of the same object.
+    const Handle<int> handle{values.GetHandle(i)};
+    EXPECT_EQ(handles[static_cast<std::size_t>(value)], handle);
+    EXPECT_EQ(&values.values()[i], values.Get(handle));
+  }
+
+  int expected_sum{0};
+  for (int i{0}; i < 64; ++i) {
+    if (i % 3 != 0) expected_sum += i;
+  }
+  EXPECT_EQ(expected_sum, sum);
+}
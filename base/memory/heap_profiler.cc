@@ -0,0 +1,700 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Sampling heap profiler.
+
+#include "heap_profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+
+#include "base/deps/fmt/core.h"
+#include "base/deps/g3log/g3log.h"
+#include "base/memory/allocation_hooks.h"
+#include "build/build_config.h"
+#include "build/compiler_config.h"
+
+#ifdef WB_OS_POSIX
+#include <cxxabi.h>    // abi::__cxa_demangle
+#include <dlfcn.h>     // dladdr
+#include <execinfo.h>  // backtrace
+
+#include <cstdlib>  // std::free
+#endif
+
+#ifdef WB_OS_WIN
+#include "base/win/windows_light.h"  // RtlCaptureStackBackTrace
+#endif
+
+#ifdef WB_COMPILER_MSVC
+#include <intrin.h>  // _ReturnAddress
+#endif
+
+namespace {
+
+/**
+ * @brief Frames to skip in captured stack when allocation function frame is
+ * not found: stack capture, sampler, allocation hook and operator new.
+ */
+constexpr std::uint32_t kHeapSampleSkipFramesCount{4U};
+
+/**
+ * @brief Max leading frames searched for allocation function frame.
+ */
+constexpr std::uint32_t kMaxHeapSampleSkipFramesCount{8U};
+
+/**
+ * @brief Bytes thread allocates till its first sample.
+ */
+constexpr std::int64_t kThreadStartHeapSamplingInterval{1024 * 1024};
+
+/**
+ * @brief Max probes to find live sample slot.  Bounds free cost, samples
+ * which can't find slot are dropped.
+ */
+constexpr std::uint32_t kMaxLiveSampleProbesCount{16U};
+
+/**
+ * @brief Frames count to log per allocation site.
+ */
+constexpr std::size_t kLoggedHeapSiteFramesCount{4U};
+
+/**
+ * @brief Max mean sampling interval, so drawn intervals never overflow.
+ */
+constexpr std::uint64_t kMaxHeapSamplingInterval{std::uint64_t{1} << 40U};
+
+/**
+ * @brief Allocation site slot.
+ */
+struct HeapSiteSlot {
+  /**
+   * @brief Allocation stack hash.  0 when slot is free.
+   */
+  std::atomic_uint64_t stack_hash;
+  /**
+   * @brief Allocation stack.  Valid when |is_ready|.
+   */
+  std::array<void*, wb::base::memory::kMaxHeapProfileFramesCount> frames;
+  /**
+   * @brief Estimated allocated bytes.
+   */
+  std::atomic_uint64_t allocated_bytes;
+  /**
+   * @brief Samples count.
+   */
+  std::atomic_uint64_t samples_count;
+  /**
+   * @brief Estimated live bytes.
+   */
+  std::atomic_uint64_t live_bytes;
+  /**
+   * @brief Live samples count.
+   */
+  std::atomic_uint64_t live_samples_count;
+  /**
+   * @brief Allocation stack frames count.  Valid when |is_ready|.
+   */
+  std::uint32_t frames_count;
+  /**
+   * @brief Are |frames| written.
+   */
+  std::atomic_bool is_ready;
+  WB_ATTRIBUTE_UNUSED_FIELD std::byte pad_[3];
+};
+
+/**
+ * @brief Live sample.
+ */
+struct HeapLiveSample {
+  /**
+   * @brief Estimated bytes sample stands for.
+   */
+  std::uint64_t weight;
+  /**
+   * @brief Allocation site index.
+   */
+  std::uint32_t site_index;
+  WB_ATTRIBUTE_UNUSED_FIELD std::byte pad_[4];
+};
+
+/**
+ * @brief Allocation sites open addressing hash table.  Slots are never freed,
+ * so lookups do not lock.
+ */
+std::array<HeapSiteSlot, wb::base::memory::kMaxHeapProfileSitesCount>
+    heap_sites;
+
+/**
+ * @brief Live samples addresses open addressing hash table.  nullptr when
+ * slot is free.
+ */
+std::array<std::atomic<void*>,
+           wb::base::memory::kMaxHeapProfileLiveSamplesCount>
+    live_sample_addresses;
+
+/**
+ * @brief Live samples.  Same index as in |live_sample_addresses|.
+ */
+std::array<HeapLiveSample, wb::base::memory::kMaxHeapProfileLiveSamplesCount>
+    live_samples;
+
+/**
+ * @brief Marks live sample slot as claimed by sampler, but not written yet.
+ */
+std::byte claimed_live_sample_marker;
+
+/**
+ * @brief Mean allocated bytes between samples.
+ */
+std::atomic_uint64_t heap_sampling_interval_bytes{0};
+
+/**
+ * @brief Profiling start time since steady clock epoch, ns.
+ */
+std::atomic_int64_t heap_profiling_start_ns{0};
+
+/**
+ * @brief Captured samples count.
+ */
+std::atomic_uint64_t heap_samples_count{0};
+
+/**
+ * @brief Dropped samples count.
+ */
+std::atomic_uint64_t dropped_heap_samples_count{0};
+
+/**
+ * @brief Live samples count.
+ */
+std::atomic_uint64_t live_heap_samples_count{0};
+
+/**
+ * @brief Bytes current thread allocates till next sample.  Constant
+ * initialized and trivially destructible, so safe to use from new / delete
+ * during thread start / exit.
+ */
+constinit thread_local std::int64_t bytes_till_heap_sample{
+    kThreadStartHeapSamplingInterval};
+
+/**
+ * @brief Is current thread sampling now.  Stack capture can allocate.
+ */
+constinit thread_local bool is_sampling_heap{false};
+
+/**
+ * @brief Current thread sampling intervals random generator state.
+ */
+constinit thread_local std::uint64_t heap_sampling_random_state{0};
+
+/**
+ * @brief Draws exponentially distributed bytes till next sample, so samples
+ * form Poisson process over allocated bytes.
+ * @param mean Mean bytes between samples.
+ * @return Bytes till next sample.
+ */
+[[nodiscard]] std::int64_t NextHeapSamplingInterval(
+    std::uint64_t mean) noexcept {
+  auto& state = heap_sampling_random_state;
+  if (state == 0) [[unlikely]] {
+    // Threads should not sample in lockstep.
+    state = (reinterpret_cast<std::uintptr_t>(&state) ^
+             static_cast<std::uint64_t>(
+                 std::chrono::steady_clock::now().time_since_epoch().count())) |
+            1U;
+  }
+
+  // xorshift64*.
+  state ^= state >> 12U;
+  state ^= state << 25U;
+  state ^= state >> 27U;
+  const std::uint64_t random{state * 0x2545F4914F6CDD1DULL};
+
+  // Uniform in (0, 1].
+  const double uniform{static_cast<double>((random >> 11U) + 1U) * 0x1.0p-53};
+  return static_cast<std::int64_t>(-std::log(uniform) *
+                                   static_cast<double>(mean)) +
+         1;
+}
+
+/**
+ * @brief Gets bytes sample of |size| stands for.  Allocation of |size| is
+ * sampled with probability 1 - e^(-size / mean), so weight is size divided by
+ * it.
+ * @param size Allocation size.
+ * @param mean Mean bytes between samples.
+ * @return Estimated bytes.
+ */
+[[nodiscard]] std::uint64_t GetHeapSampleWeight(std::size_t size,
+                                                std::uint64_t mean) noexcept {
+  const double probability{-std::expm1(-static_cast<double>(size) /
+                                       static_cast<double>(mean))};
+  return probability > 0.0
+             ? static_cast<std::uint64_t>(static_cast<double>(size) /
+                                          probability)
+             : size;
+}
+
+/**
+ * @brief Captures current stack above allocation function.
+ * @param allocation_return_address Return address into allocation function
+ * (operator new, etc.) which called allocation hook.  Frames up to allocation
+ * function are skipped, so inlining and tail calls in between do not shift
+ * sites.
+ * @param frames Frames.
+ * @return Captured frames count.
+ */
+[[nodiscard]] WB_ATTRIBUTE_NOINLINE std::uint32_t CaptureHeapSampleStack(
+    const void* allocation_return_address,
+    std::array<void*, wb::base::memory::kMaxHeapProfileFramesCount>&
+        frames) noexcept {
+  std::array<void*, wb::base::memory::kMaxHeapProfileFramesCount +
+                        kMaxHeapSampleSkipFramesCount>
+      all_frames;
+#if defined(WB_OS_POSIX)
+  const int captured_frames_count{::backtrace(
+      all_frames.data(), static_cast<int>(all_frames.size()))};
+  const auto all_frames_count =
+      static_cast<std::uint32_t>(std::max(captured_frames_count, 0));
+#elif defined(WB_OS_WIN)
+  const std::uint32_t all_frames_count{::RtlCaptureStackBackTrace(
+      0, static_cast<DWORD>(all_frames.size()), all_frames.data(), nullptr)};
+#else
+#error "Please, define stack capture for your platform."
+#endif
+
+  std::uint32_t skip_frames_count{kHeapSampleSkipFramesCount};
+  const std::uint32_t search_frames_count{
+      std::min(all_frames_count, kMaxHeapSampleSkipFramesCount)};
+  for (std::uint32_t i{0}; i < search_frames_count; ++i) {
+    if (all_frames[i] == allocation_return_address) {
+      skip_frames_count = i + 1;
+      break;
+    }
+  }
+
+  if (all_frames_count <= skip_frames_count) [[unlikely]] return 0;
+
+  const std::uint32_t frames_count{
+      std::min(all_frames_count - skip_frames_count,
+               static_cast<std::uint32_t>(frames.size()))};
+  std::copy_n(all_frames.begin() + skip_frames_count, frames_count,
+              frames.begin());
+  return frames_count;
+}
+
+
+/**
+ * @brief Hashes stack.
+ * @param frames Frames.
+ * @param frames_count Frames count.
+ * @return Non zero stack hash.
+ */
+[[nodiscard]] std::uint64_t HashHeapSampleStack(
+    const std::array<void*, wb::base::memory::kMaxHeapProfileFramesCount>&
+        frames,
+    std::uint32_t frames_count) noexcept {
+  // FNV-1a over frame addresses.
+  std::uint64_t hash{0xcbf29ce484222325ULL};
+  for (std::uint32_t i{0}; i < frames_count; ++i) {
+    hash ^= reinterpret_cast<std::uintptr_t>(frames[i]);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash != 0 ? hash : 1U;
+}
+
+/**
+ * @brief Finds or inserts allocation site slot.  Does not allocate or lock.
+ * @param frames Allocation stack.
+ * @param frames_count Allocation stack frames count.
+ * @return Site index or kMaxHeapProfileSitesCount when table is full.
+ */
+[[nodiscard]] std::uint32_t FindOrInsertHeapSite(
+    const std::array<void*, wb::base::memory::kMaxHeapProfileFramesCount>&
+        frames,
+    std::uint32_t frames_count) noexcept {
+  using wb::base::memory::kMaxHeapProfileSitesCount;
+
+  const std::uint64_t hash{HashHeapSampleStack(frames, frames_count)};
+  const auto start = static_cast<std::uint32_t>(hash %
+                                                kMaxHeapProfileSitesCount);
+
+  for (std::uint32_t i{0}; i < kMaxHeapProfileSitesCount; ++i) {
+    const std::uint32_t index{(start + i) % kMaxHeapProfileSitesCount};
+    auto& slot = heap_sites[index];
+
+    std::uint64_t slot_hash{slot.stack_hash.load(std::memory_order_acquire)};
+    if (slot_hash == hash) return index;
+
+    if (slot_hash == 0) {
+      if (slot.stack_hash.compare_exchange_strong(slot_hash, hash,
+                                                  std::memory_order_acq_rel)) {
+        slot.frames = frames;
+        slot.frames_count = frames_count;
+        slot.is_ready.store(true, std::memory_order_release);
+        return index;
+      }
+      // Other thread inserted same site at this slot.
+      if (slot_hash == hash) return index;
+    }
+  }
+
+  return kMaxHeapProfileSitesCount;
+}
+
+/**
+ * @brief Gets live sample slot start index for address.
+ * @param p Address.
+ * @return Start index.
+ */
+[[nodiscard]] std::uint32_t GetLiveSampleStartIndex(const void* p) noexcept {
+  constexpr int kIndexBits{
+      std::countr_zero(wb::base::memory::kMaxHeapProfileLiveSamplesCount)};
+  static_assert(std::has_single_bit(
+      wb::base::memory::kMaxHeapProfileLiveSamplesCount));
+
+  // Fibonacci hashing, low address bits are zero due to alignment.
+  return static_cast<std::uint32_t>(
+      ((static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(p)) >>
+        4U) *
+       0x9E3779B97F4A7C15ULL) >>
+      (64 - kIndexBits));
+}
+
+/**
+ * @brief Inserts live sample.  Does not allocate or lock.
+ * @param p Sampled memory.
+ * @param sample Sample.
+ * @return true if inserted, false when no free slot.
+ */
+[[nodiscard]] bool InsertLiveHeapSample(void* p,
+                                        const HeapLiveSample& sample) noexcept {
+  using wb::base::memory::kMaxHeapProfileLiveSamplesCount;
+
+  const std::uint32_t start{GetLiveSampleStartIndex(p)};
+  for (std::uint32_t i{0}; i < kMaxLiveSampleProbesCount; ++i) {
+    const std::uint32_t index{(start + i) &
+                              (kMaxHeapProfileLiveSamplesCount - 1)};
+    auto& address = live_sample_addresses[index];
+
+    void* expected{nullptr};
+    if (address.compare_exchange_strong(expected, &claimed_live_sample_marker,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      live_samples[index] = sample;
+      address.store(p, std::memory_order_release);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Samples heap allocation and draws next sampling interval.
+ * @param p Allocated memory.
+ * @param size Allocation usable size.
+ * @param allocation_return_address Return address into allocation function.
+ * @return void.
+ */
+WB_ATTRIBUTE_NOINLINE void SampleHeapAllocation(
+    void* p, std::size_t size,
+    const void* allocation_return_address) noexcept {
+  const std::uint64_t mean{
+      heap_sampling_interval_bytes.load(std::memory_order_relaxed)};
+  bytes_till_heap_sample = NextHeapSamplingInterval(mean);
+
+  // Stack capture may allocate, do not sample own allocations.
+  if (is_sampling_heap) [[unlikely]] return;
+  is_sampling_heap = true;
+
+  std::array<void*, wb::base::memory::kMaxHeapProfileFramesCount> frames;
+  const std::uint32_t frames_count{
+      CaptureHeapSampleStack(allocation_return_address, frames)};
+  const std::uint32_t site_index{FindOrInsertHeapSite(frames, frames_count)};
+
+  if (site_index < wb::base::memory::kMaxHeapProfileSitesCount) [[likely]] {
+    auto& site = heap_sites[site_index];
+    const std::uint64_t weight{GetHeapSampleWeight(size, mean)};
+
+    site.allocated_bytes.fetch_add(weight, std::memory_order_relaxed);
+    site.samples_count.fetch_add(1, std::memory_order_relaxed);
+    heap_samples_count.fetch_add(1, std::memory_order_relaxed);
+
+    // Update live stats before publishing sample, so free never underflows.
+    site.live_bytes.fetch_add(weight, std::memory_order_relaxed);
+    site.live_samples_count.fetch_add(1, std::memory_order_relaxed);
+    live_heap_samples_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (!InsertLiveHeapSample(
+            p, HeapLiveSample{.weight = weight,
+                              .site_index = site_index,
+                              .pad_ = {}})) [[unlikely]] {
+      site.live_bytes.fetch_sub(weight, std::memory_order_relaxed);
+      site.live_samples_count.fetch_sub(1, std::memory_order_relaxed);
+      live_heap_samples_count.fetch_sub(1, std::memory_order_relaxed);
+      dropped_heap_samples_count.fetch_add(1, std::memory_order_relaxed);
+    }
+  } else {
+    dropped_heap_samples_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  is_sampling_heap = false;
+}
+
+/**
+ * @brief Releases live sample if memory is sampled.  Does not allocate or
+ * lock.
+ * @param p Memory to free.
+ * @return void.
+ */
+void ReleaseHeapSample(void* p) noexcept {
+  using wb::base::memory::kMaxHeapProfileLiveSamplesCount;
+
+  if (live_heap_samples_count.load(std::memory_order_relaxed) == 0) return;
+
+  const std::uint32_t start{GetLiveSampleStartIndex(p)};
+  for (std::uint32_t i{0}; i < kMaxLiveSampleProbesCount; ++i) {
+    const std::uint32_t index{(start + i) &
+                              (kMaxHeapProfileLiveSamplesCount - 1)};
+    auto& address = live_sample_addresses[index];
+
+    if (address.load(std::memory_order_acquire) == p) {
+      // Memory is freed by single thread, so slot can't change under us.
+      const HeapLiveSample sample{live_samples[index]};
+      address.store(nullptr, std::memory_order_release);
+
+      auto& site = heap_sites[sample.site_index];
+      site.live_bytes.fetch_sub(sample.weight, std::memory_order_relaxed);
+      site.live_samples_count.fetch_sub(1, std::memory_order_relaxed);
+      live_heap_samples_count.fetch_sub(1, std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Symbolizes frame return address.
+ * @param address Frame return address.
+ * @return Symbol.
+ */
+[[nodiscard]] std::string SymbolizeHeapSampleFrame(void* address) {
+#ifdef WB_OS_POSIX
+  Dl_info info{};
+  // Return address may point past function end, use call instruction.
+  if (::dladdr(static_cast<char*>(address) - 1, &info) != 0 &&
+      info.dli_sname) {
+    int status{0};
+    char* demangled{
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status)};
+    std::string symbol{status == 0 && demangled ? demangled : info.dli_sname};
+    std::free(demangled);  // NOLINT(cppcoreguidelines-no-malloc)
+    return symbol;
+  }
+#endif
+
+  return fmt::format("{0}", address);
+}
+
+/**
+ * @brief Gets heap profiling time.
+ * @return Time since profiling start.
+ */
+[[nodiscard]] std::chrono::nanoseconds GetHeapProfilingTime() noexcept {
+  const std::int64_t start_ns{
+      heap_profiling_start_ns.load(std::memory_order_relaxed)};
+  if (start_ns == 0) return std::chrono::nanoseconds{0};
+
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()) -
+         std::chrono::nanoseconds{start_ns};
+}
+
+/**
+ * @brief Logs allocation sites table.
+ * @param sites Allocation sites.
+ * @param top_sites_count Max sites count to log.
+ * @param profiling_time Time since profiling start.
+ * @param order Sites order.
+ * @return void.
+ */
+void LogHeapProfileSites(
+    const std::vector<wb::base::memory::HeapProfileSite>& sites,
+    std::size_t top_sites_count, std::chrono::nanoseconds profiling_time,
+    wb::base::memory::HeapProfileOrder order) {
+  const auto to_mib = [](std::uint64_t bytes) noexcept {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+  };
+  const double profiling_seconds{
+      std::max(std::chrono::duration<double>{profiling_time}.count(), 1e-9)};
+
+  std::string table{fmt::format("{:>4} {:>12} {:>10} {:>12} {:>10}  {}\n",
+                                "rank", "live MiB", "live", "alloc MiB",
+                                "MiB/s", "site")};
+
+  const std::size_t sites_count{std::min(top_sites_count, sites.size())};
+  for (std::size_t i{0}; i < sites_count; ++i) {
+    const auto& site = sites[i];
+
+    std::string stack;
+    const std::size_t frames_count{
+        std::min(site.stack.size(), kLoggedHeapSiteFramesCount)};
+    for (std::size_t j{0}; j < frames_count; ++j) {
+      if (j != 0) stack += " <- ";
+      stack += site.stack[j];
+    }
+
+    table += fmt::format(
+        "{:>4} {:>12.3f} {:>10} {:>12.3f} {:>10.3f}  {}\n", i + 1,
+        to_mib(site.live_bytes), site.live_samples_count,
+        to_mib(site.allocated_bytes),
+        to_mib(site.allocated_bytes) / profiling_seconds, stack);
+  }
+
+  G3LOG(INFO) << "Heap allocation sites (top " << sites_count << " of "
+              << sites.size() << " by "
+              << (order == wb::base::memory::HeapProfileOrder::kLiveBytes
+                      ? "live bytes"
+                      : "allocation rate")
+              << "):\n"
+              << table;
+}
+
+}  // namespace
+
+namespace wb::base::memory {
+
+namespace internal {
+
+WB_ATTRIBUTE_NOINLINE WB_BASE_API void OnHeapProfilerAllocation(
+    void* p, std::size_t size) noexcept {
+  // Only thread local counter is touched on fast path.
+  bytes_till_heap_sample -= static_cast<std::int64_t>(size);
+  if (bytes_till_heap_sample >= 0) [[likely]] return;
+
+  // Draws next sampling interval.  May be tail call, so stack is cut at
+  // allocation function, not at fixed depth.
+#ifdef WB_COMPILER_MSVC
+  SampleHeapAllocation(p, size, _ReturnAddress());
+#else
+  SampleHeapAllocation(p, size, __builtin_return_address(0));
+#endif
+}
+
+WB_BASE_API void OnHeapProfilerFree(void* p) noexcept {
+  ReleaseHeapSample(p);
+}
+
+}  // namespace internal
+
+WB_BASE_API void EnableHeapProfiling(
+    std::uint64_t sampling_interval_bytes) noexcept {
+  G3DCHECK(sampling_interval_bytes > 0U);
+
+  const std::uint64_t mean{std::clamp(sampling_interval_bytes,
+                                      std::uint64_t{1},
+                                      kMaxHeapSamplingInterval)};
+  heap_sampling_interval_bytes.store(mean, std::memory_order_relaxed);
+
+  static const bool is_started{[]() noexcept {
+#ifdef WB_OS_POSIX
+    // backtrace may load libgcc_s on first call, which allocates, so warm it
+    // up before sampling.
+    std::array<void*, 4> warm_up_frames;
+    ::backtrace(warm_up_frames.data(),
+                static_cast<int>(warm_up_frames.size()));
+#endif
+
+    heap_profiling_start_ns.store(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count(),
+        std::memory_order_relaxed);
+    return true;
+  }()};
+  G3DCHECK(is_started);
+
+  // Other threads pick up new interval on their next sample.
+  bytes_till_heap_sample = NextHeapSamplingInterval(mean);
+  internal::EnableAllocationHook(internal::AllocationHooks::kHeapProfiler);
+}
+
+[[nodiscard]] WB_BASE_API bool IsHeapProfilingEnabled() noexcept {
+  return internal::HasAllocationHook(
+      internal::enabled_allocation_hooks.load(std::memory_order_relaxed),
+      internal::AllocationHooks::kHeapProfiler);
+}
+
+[[nodiscard]] WB_BASE_API HeapProfilerStats GetHeapProfilerStats() noexcept {
+  return {.profiling_time = GetHeapProfilingTime(),
+          .samples_count = heap_samples_count.load(std::memory_order_relaxed),
+          .dropped_samples_count =
+              dropped_heap_samples_count.load(std::memory_order_relaxed),
+          .live_samples_count =
+              live_heap_samples_count.load(std::memory_order_relaxed)};
+}
+
+[[nodiscard]] WB_BASE_API std::vector<HeapProfileSite> GetHeapProfileSites(
+    HeapProfileOrder order) {
+  std::vector<HeapProfileSite> sites;
+
+  for (const auto& slot : heap_sites) {
+    if (!slot.is_ready.load(std::memory_order_acquire)) continue;
+
+    const std::uint64_t samples_count{
+        slot.samples_count.load(std::memory_order_relaxed)};
+    // Inserted, but not sampled yet.
+    if (samples_count == 0) continue;
+
+    std::vector<std::string> stack;
+    stack.reserve(slot.frames_count);
+    for (std::uint32_t i{0}; i < slot.frames_count; ++i) {
+      stack.emplace_back(SymbolizeHeapSampleFrame(slot.frames[i]));
+    }
+
+    sites.emplace_back(HeapProfileSite{
+        .stack = std::move(stack),
+        .allocated_bytes = slot.allocated_bytes.load(std::memory_order_relaxed),
+        .live_bytes = slot.live_bytes.load(std::memory_order_relaxed),
+        .samples_count = samples_count,
+        .live_samples_count =
+            slot.live_samples_count.load(std::memory_order_relaxed)});
+  }
+
+  std::sort(sites.begin(), sites.end(),
+            [order](const HeapProfileSite& left,
+                    const HeapProfileSite& right) noexcept {
+              return order == HeapProfileOrder::kLiveBytes
+                         ? left.live_bytes > right.live_bytes
+                         : left.allocated_bytes > right.allocated_bytes;
+            });
+
+  return sites;
+}
+
+WB_BASE_API void LogHeapProfile(std::size_t top_sites_count) {
+  const HeapProfilerStats stats{GetHeapProfilerStats()};
+  if (stats.samples_count == 0) {
+    G3LOG(INFO) << "No heap allocation samples recorded.";
+    return;
+  }
+
+  G3LOG(INFO) << "Heap profiler captured " << stats.samples_count
+              << " samples (" << stats.live_samples_count << " live, "
+              << stats.dropped_samples_count << " dropped) in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     stats.profiling_time)
+                     .count()
+              << "ms.";
+
+  for (const HeapProfileOrder order :
+       {HeapProfileOrder::kLiveBytes, HeapProfileOrder::kAllocatedBytes}) {
+    LogHeapProfileSites(GetHeapProfileSites(order), top_sites_count,
+                        stats.profiling_time, order);
+  }
+}
+
+}  // namespace wb::base::memory
@@ -0,0 +1,175 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Sampling heap profiler.  New / delete overrides sample one allocation per
+// ~N allocated bytes (Poisson process over bytes, so large allocations are
+// sampled more often and every byte has the same chance), capture short stack
+// and keep live samples table.  Reports top allocation sites by estimated live
+// bytes and by allocation rate.  Complements aggregate-only heap allocator
+// statistics.
+//
+// Usage example:
+//
+// EnableHeapProfiling(512U * 1024U);
+// ...
+// LogHeapProfile(16U);
+
+#ifndef WB_BASE_MEMORY_HEAP_PROFILER_H_
+#define WB_BASE_MEMORY_HEAP_PROFILER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/config.h"
+
+namespace wb::base::memory {
+
+/**
+ * @brief Max allocation sites count.  Samples of new sites above limit are
+ * dropped.
+ */
+inline constexpr std::uint32_t kMaxHeapProfileSitesCount{4096U};
+
+/**
+ * @brief Max live samples count.  Power of 2.  Samples above limit are
+ * dropped.
+ */
+inline constexpr std::uint32_t kMaxHeapProfileLiveSamplesCount{65536U};
+
+/**
+ * @brief Max captured allocation stack depth.  Deeper stacks are truncated to
+ * leaf frames.
+ */
+inline constexpr std::uint32_t kMaxHeapProfileFramesCount{16U};
+
+/**
+ * @brief Heap allocation site stats.  Bytes are estimated from samples.
+ */
+struct HeapProfileSite {
+  /**
+   * @brief Symbolized allocation stack, from allocation site to root.
+   */
+  std::vector<std::string> stack;
+  /**
+   * @brief Estimated allocated bytes since profiling start.
+   */
+  std::uint64_t allocated_bytes;
+  /**
+   * @brief Estimated live bytes.
+   */
+  std::uint64_t live_bytes;
+  /**
+   * @brief Samples count since profiling start.
+   */
+  std::uint64_t samples_count;
+  /**
+   * @brief Live samples count.
+   */
+  std::uint64_t live_samples_count;
+};
+
+/**
+ * @brief Heap profile sites order.
+ */
+enum class HeapProfileOrder : std::uint8_t {
+  /**
+   * @brief By estimated live bytes.
+   */
+  kLiveBytes,
+  /**
+   * @brief By estimated allocated bytes, so allocation rate.
+   */
+  kAllocatedBytes
+};
+
+/**
+ * @brief Heap profiler stats.
+ */
+struct HeapProfilerStats {
+  /**
+   * @brief Time since profiling start.
+   */
+  std::chrono::nanoseconds profiling_time;
+  /**
+   * @brief Captured samples count.
+   */
+  std::uint64_t samples_count;
+  /**
+   * @brief Samples dropped as sites or live samples table was full.
+   */
+  std::uint64_t dropped_samples_count;
+  /**
+   * @brief Live samples count.
+   */
+  std::uint64_t live_samples_count;
+};
+
+namespace internal {
+
+/**
+ * @brief Samples heap allocation when enough bytes are allocated by current
+ * thread.  Called by new / delete overrides when profiling is enabled.
+ * Sampled stack starts at caller of function which calls hook, so call it
+ * from allocation function directly.
+ * @param p Allocated memory.
+ * @param size Allocation usable size.
+ * @return void.
+ */
+WB_BASE_API void OnHeapProfilerAllocation(void* p, std::size_t size) noexcept;
+
+/**
+ * @brief Releases heap sample if memory is sampled.  Called by new / delete
+ * overrides when profiling is enabled.
+ * @param p Memory to free.
+ * @return void.
+ */
+WB_BASE_API void OnHeapProfilerFree(void* p) noexcept;
+
+}  // namespace internal
+
+/**
+ * @brief Enables heap profiling for all modules which link whitebox-base.
+ * Allocations made before are not tracked.  Other threads pick up new
+ * sampling interval on their next sample.  Can be called again to change
+ * sampling interval.
+ * @param sampling_interval_bytes Mean allocated bytes between samples.
+ * @return void.
+ */
+WB_BASE_API void EnableHeapProfiling(
+    std::uint64_t sampling_interval_bytes) noexcept;
+
+/**
+ * @brief Is heap profiling enabled.
+ * @return true if enabled.
+ */
+[[nodiscard]] WB_BASE_API bool IsHeapProfilingEnabled() noexcept;
+
+/**
+ * @brief Gets heap profiler stats.
+ * @return Heap profiler stats.
+ */
+[[nodiscard]] WB_BASE_API HeapProfilerStats GetHeapProfilerStats() noexcept;
+
+/**
+ * @brief Gets allocation sites stats, ranked by |order|.  Symbolizes stacks,
+ * so slow.
+ * @param order Sites order.
+ * @return Allocation sites stats.
+ */
+[[nodiscard]] WB_BASE_API std::vector<HeapProfileSite> GetHeapProfileSites(
+    HeapProfileOrder order);
+
+/**
+ * @brief Logs top allocation sites by live bytes and by allocation rate.
+ * @param top_sites_count Max sites count to log per table.
+ * @return void.
+ */
+WB_BASE_API void LogHeapProfile(std::size_t top_sites_count);
+
+}  // namespace wb::base::memory
+
+#endif  // !WB_BASE_MEMORY_HEAP_PROFILER_H_
@@ -0,0 +1,180 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Sampling heap profiler.
+
+#include "heap_profiler.h"
+//
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "base/deps/googletest/gtest/gtest.h"
+#include "base/numa_topology.h"
+#include "build/compiler_config.h"
+
+namespace wb::base::tests_internal {
+
+/**
+ * @brief Allocates block with operator new.  Exported, so profiler can
+ * symbolize it.
+ * @param size Block size.
+ * @return Block.
+ */
+WB_ATTRIBUTE_DLL_EXPORT std::byte* AllocateHeapProfilerBlock(std::size_t size);
+
+[[gnu::noinline]] WB_ATTRIBUTE_DLL_EXPORT std::byte* AllocateHeapProfilerBlock(
+    std::size_t size) {
+  auto* block = new std::byte[size];
+  // Work after new, so it is not tail call and this frame stays on stack.
+  block[0] = std::byte{1};
+  return block;
+}
+
+}  // namespace wb::base::tests_internal
+
+namespace {
+
+/**
+ * @brief Memory for fake allocations.  Not from operator new, so not sampled
+ * by allocators overrides.
+ */
+alignas(std::max_align_t) std::array<std::byte, 1024U * 1024U> fake_heap;
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(HeapProfilerTest, SampledAllocationsAreTrackedTillFree) {
+  using namespace wb::base::memory;
+
+  constexpr std::size_t kAllocationSize{4096U};
+  constexpr std::size_t kAllocationsCount{256U};
+
+  std::vector<std::unique_ptr<std::byte[]>> allocations;
+  allocations.reserve(kAllocationsCount);
+
+  // Mean interval is far less than allocation size, so each one is sampled.
+  EnableHeapProfiling(64U);
+  EXPECT_TRUE(IsHeapProfilingEnabled());
+
+  const HeapProfilerStats before{GetHeapProfilerStats()};
+
+  // Real operator new of tests executable feeds profiler in whitebox-base.
+  for (std::size_t i{0}; i < kAllocationsCount; ++i) {
+    allocations.emplace_back(std::make_unique<std::byte[]>(kAllocationSize));
+  }
+
+  const HeapProfilerStats allocated{GetHeapProfilerStats()};
+  EXPECT_GE(allocated.samples_count, before.samples_count + kAllocationsCount);
+  EXPECT_GE(allocated.live_samples_count,
+            before.live_samples_count + kAllocationsCount);
+  EXPECT_GT(allocated.profiling_time.count(), 0);
+
+  const auto sites = GetHeapProfileSites(HeapProfileOrder::kLiveBytes);
+  ASSERT_FALSE(sites.empty());
+  // All allocations come from single site.
+  EXPECT_GE(sites.front().live_samples_count, kAllocationsCount);
+  EXPECT_GE(sites.front().live_bytes, kAllocationsCount * kAllocationSize);
+  EXPECT_FALSE(sites.front().stack.empty());
+
+  LogHeapProfile(4U);
+
+  const HeapProfilerStats logged{GetHeapProfilerStats()};
+  allocations.clear();
+
+  const HeapProfilerStats freed{GetHeapProfilerStats()};
+  EXPECT_LE(freed.live_samples_count,
+            logged.live_samples_count - kAllocationsCount);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(HeapProfilerTest, TopFrameIsAllocatingFunction) {
+  using namespace wb::base;
+
+  // Far more live bytes than other sites, so site is the top one.
+  constexpr std::size_t kBlockSize{64U * 1024U};
+  constexpr std::size_t kBlocksCount{256U};
+
+  std::vector<std::unique_ptr<std::byte[]>> blocks;
+  blocks.reserve(kBlocksCount);
+
+  memory::EnableHeapProfiling(64U);
+
+  for (std::size_t i{0}; i < kBlocksCount; ++i) {
+    blocks.emplace_back(tests_internal::AllocateHeapProfilerBlock(kBlockSize));
+  }
+
+  const auto sites = memory::GetHeapProfileSites(
+      memory::HeapProfileOrder::kLiveBytes);
+  ASSERT_FALSE(sites.empty());
+  ASSERT_FALSE(sites.front().stack.empty());
+  // Neither profiler nor operator new frames are in sampled stack.
+  EXPECT_NE(std::string::npos,
+            sites.front().stack.front().find("AllocateHeapProfilerBlock"))
+      << sites.front().stack.front();
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(HeapProfilerTest, OtherModulesAllocationsAreSampled) {
+  using namespace wb::base;
+
+  memory::EnableHeapProfiling(64U);
+
+  const memory::HeapProfilerStats before{memory::GetHeapProfilerStats()};
+  {
+    // Allocated by whitebox-base, freed by tests executable.
+    const auto cpus = ParseCpuList("0-1023");
+    ASSERT_TRUE(cpus.has_value());
+
+    const memory::HeapProfilerStats allocated{memory::GetHeapProfilerStats()};
+    EXPECT_GT(allocated.samples_count, before.samples_count);
+    EXPECT_GT(allocated.live_samples_count, before.live_samples_count);
+  }
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(HeapProfilerTest, SampledBytesEstimateAllocatedBytes) {
+  using namespace wb::base::memory;
+
+  constexpr std::size_t kSmallAllocationSize{16U};
+  // ~1000 samples, so estimate is within few percent.
+  constexpr std::size_t kSmallAllocationsCount{256U * 1024U};
+  EnableHeapProfiling(4096U);
+
+  const auto before = GetHeapProfileSites(HeapProfileOrder::kAllocatedBytes);
+  const std::uint64_t allocated_before{std::accumulate(
+      before.begin(), before.end(), std::uint64_t{0},
+      [](std::uint64_t sum, const HeapProfileSite& site) noexcept {
+        return sum + site.allocated_bytes;
+      })};
+
+  for (std::size_t i{0}; i < kSmallAllocationsCount; ++i) {
+    void* p{&fake_heap[(i * kSmallAllocationSize) % fake_heap.size()]};
+    internal::OnHeapProfilerAllocation(p, kSmallAllocationSize);
+    internal::OnHeapProfilerFree(p);
+  }
+
+  const auto after = GetHeapProfileSites(HeapProfileOrder::kAllocatedBytes);
+  const std::uint64_t allocated_after{std::accumulate(
+      after.begin(), after.end(), std::uint64_t{0},
+      [](std::uint64_t sum, const HeapProfileSite& site) noexcept {
+        return sum + site.allocated_bytes;
+      })};
+
+  const auto expected =
+      static_cast<double>(kSmallAllocationsCount * kSmallAllocationSize);
+  EXPECT_NEAR(expected,
+              static_cast<double>(allocated_after - allocated_before),
+              expected * 0.2);
+
+  EXPECT_TRUE(std::is_sorted(after.begin(), after.end(),
+                             [](const auto& left, const auto& right) noexcept {
+                               return left.allocated_bytes >
+                                      right.allocated_bytes;
+                             }));
+}
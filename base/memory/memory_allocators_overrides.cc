@@ -2,6 +2,154 @@
 // Use of this source code is governed by a 3-Clause BSD license that can be
 // found in the LICENSE file.
 //
-// Mimalloc memory allocators overrides.
+// Mimalloc memory allocators overrides.  Same as mimalloc-new-delete.h, but
+// account per thread allocation stats, see base/memory/allocation_stats.h, and
+// sample allocations for heap profiler, see base/memory/heap_profiler.h.
+//
+// Stats live in whitebox-base, so only targets which link it define
+// WB_MEMORY_ALLOCATION_HOOKS and account allocations.
+
+#include <cstddef>
+#include <new>
+
+#include "base/deps/mimalloc/mimalloc.h"
+#include "build/compiler_config.h"
+
+#ifdef WB_MEMORY_ALLOCATION_HOOKS
+#include <atomic>
+#include <cstdint>
+
+#include "base/memory/allocation_hooks.h"
+#include "base/memory/allocation_stats.h"
+#include "base/memory/heap_profiler.h"
+#endif
+
+namespace {
+
+/**
+ * @brief Account allocation.
+ * @param p Allocated memory.
+ * @return Allocated memory.
+ */
+WB_ATTRIBUTE_FORCEINLINE inline void* Allocated(void* p) noexcept {
+#ifdef WB_MEMORY_ALLOCATION_HOOKS
+  using namespace wb::base::memory::internal;
+
+  // Usable size is not queried till some hook is enabled.
+  const std::uint32_t hooks{
+      enabled_allocation_hooks.load(std::memory_order_relaxed)};
+  if (p && hooks != 0U) [[unlikely]] {
+    const std::size_t size{::mi_usable_size(p)};
+
+    if (HasAllocationHook(hooks, AllocationHooks::kAllocationStats)) {
+      OnAllocation(size);
+    }
+    if (HasAllocationHook(hooks, AllocationHooks::kHeapProfiler)) {
+      OnHeapProfilerAllocation(p, size);
+    }
+  }
+#endif
+  return p;
+}
+
+/**
+ * @brief Account free.
+ * @param p Memory to free.
+ * @return Memory to free.
+ */
+WB_ATTRIBUTE_FORCEINLINE inline void* Freed(void* p) noexcept {
+#ifdef WB_MEMORY_ALLOCATION_HOOKS
+  using namespace wb::base::memory::internal;
+
+  const std::uint32_t hooks{
+      enabled_allocation_hooks.load(std::memory_order_relaxed)};
+  if (p && hooks != 0U) [[unlikely]] {
+    if (HasAllocationHook(hooks, AllocationHooks::kAllocationStats)) {
+      OnFree(::mi_usable_size(p));
+    }
+    if (HasAllocationHook(hooks, AllocationHooks::kHeapProfiler)) {
+      OnHeapProfilerFree(p);
+    }
+  }
+#endif
+  return p;
+}
+
+}  // namespace
+
+WB_MSVC_BEGIN_WARNING_OVERRIDE_SCOPE()
+  WB_MSVC_DISABLE_WARNING(4100)
+  WB_MSVC_DISABLE_WARNING(4559)  // 'operator new' : redefinition; the function
+                                 // gains __declspec(restrict)
+  WB_GCC_BEGIN_WARNING_OVERRIDE_SCOPE()
+    WB_GCC_DISABLE_SUGGEST_MALLOC_ATTRIBUTE_WARNING()
+
+void operator delete(void* p) noexcept { ::mi_free(Freed(p)); }
+void operator delete[](void* p) noexcept { ::mi_free(Freed(p)); }
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  ::mi_free(Freed(p));
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  ::mi_free(Freed(p));
+}
+
+void* operator new(std::size_t n) noexcept(false) {
+  return Allocated(::mi_new(n));
+}
+void* operator new[](std::size_t n) noexcept(false) {
+  return Allocated(::mi_new(n));
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+  return Allocated(::mi_new_nothrow(n));
+}
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept {
+  return Allocated(::mi_new_nothrow(n));
+}
+
+void operator delete(void* p, std::size_t n) noexcept {
+  ::mi_free_size(Freed(p), n);
+}
+void operator delete[](void* p, std::size_t n) noexcept {
+  ::mi_free_size(Freed(p), n);
+}
+
+void operator delete(void* p, std::align_val_t al) noexcept {
+  ::mi_free_aligned(Freed(p), static_cast<std::size_t>(al));
+}
+void operator delete[](void* p, std::align_val_t al) noexcept {
+  ::mi_free_aligned(Freed(p), static_cast<std::size_t>(al));
+}
+void operator delete(void* p, std::size_t n, std::align_val_t al) noexcept {
+  ::mi_free_size_aligned(Freed(p), n, static_cast<std::size_t>(al));
+}
+void operator delete[](void* p, std::size_t n, std::align_val_t al) noexcept {
+  ::mi_free_size_aligned(Freed(p), n, static_cast<std::size_t>(al));
+}
+void operator delete(void* p, std::align_val_t al,
+                     const std::nothrow_t&) noexcept {
+  ::mi_free_aligned(Freed(p), static_cast<std::size_t>(al));
+}
+void operator delete[](void* p, std::align_val_t al,
+                       const std::nothrow_t&) noexcept {
+  ::mi_free_aligned(Freed(p), static_cast<std::size_t>(al));
+}
+
+void* operator new(std::size_t n, std::align_val_t al) noexcept(false) {
+  return Allocated(::mi_new_aligned(n, static_cast<std::size_t>(al)));
+}
+void* operator new[](std::size_t n, std::align_val_t al) noexcept(false) {
+  return Allocated(::mi_new_aligned(n, static_cast<std::size_t>(al)));
+}
+void* operator new(std::size_t n, std::align_val_t al,
+                   const std::nothrow_t&) noexcept {
+  return Allocated(::mi_new_aligned_nothrow(n, static_cast<std::size_t>(al)));
+}
+void* operator new[](std::size_t n, std::align_val_t al,
+                     const std::nothrow_t&) noexcept {
+  return Allocated(::mi_new_aligned_nothrow(n, static_cast<std::size_t>(al)));
+}
 
-#include "base/deps/mimalloc/mimalloc-new-delete.h"
+  WB_GCC_END_WARNING_OVERRIDE_SCOPE()
+WB_MSVC_END_WARNING_OVERRIDE_SCOPE()
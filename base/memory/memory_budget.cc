@@ -0,0 +1,249 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per subsystem memory budgets.
+
+#include "memory_budget.h"
+
+#include <cerrno>  // ENOMEM.
+#include <mutex>
+#include <new>
+
+#include "base/deps/g3log/g3log.h"
+#include "base/telemetry/metrics.h"
+
+namespace {
+
+/**
+ * @brief Soft limit crossings count.  Registered on startup, so counting never
+ * allocates.
+ */
+wb::base::telemetry::Counter memory_budget_pressure_events_counter{
+    "whitebox_memory_budget_pressure_events",
+    "Memory budget soft limit crossings."};
+
+/**
+ * @brief Hard limit failures count.
+ */
+wb::base::telemetry::Counter memory_budget_hard_limit_failures_counter{
+    "whitebox_memory_budget_hard_limit_failures",
+    "Memory budget charges failed due to hard limit."};
+
+/**
+ * @brief Registered budgets.
+ */
+struct MemoryBudgetRegistry {
+  /**
+   * @brief Guards budgets list.
+   */
+  std::mutex mutex;
+  /**
+   * @brief Budgets list head.
+   */
+  wb::base::memory::MemoryBudget* head{nullptr};
+};
+
+/**
+ * @brief Gets budgets registry.
+ * @return Budgets registry.
+ */
+[[nodiscard]] MemoryBudgetRegistry& GetMemoryBudgetRegistry() noexcept {
+  // Budgets can be defined at namespace scope in other translation units.
+  static MemoryBudgetRegistry registry;
+  return registry;
+}
+
+/**
+ * @brief Bytes to MiB.
+ * @param bytes Bytes.
+ * @return MiB.
+ */
+[[nodiscard]] constexpr double ToMiB(std::uint64_t bytes) noexcept {
+  return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+}  // namespace
+
+namespace wb::base::memory {
+
+WB_BASE_API MemoryBudget::MemoryBudget(const char* name,
+                                       MemoryBudgetLimits limits,
+                                       MemoryPressureHandler pressure_handler,
+                                       void* pressure_context) noexcept
+    : name_{name},
+      limits_{limits},
+      pressure_handler_{pressure_handler},
+      pressure_context_{pressure_context},
+      next_{nullptr},
+      used_bytes_{0U},
+      peak_bytes_{0U},
+      pressure_events_count_{0U},
+      hard_limit_failures_count_{0U} {
+  G3DCHECK(!!name_);
+  G3DCHECK(limits_.soft_limit_bytes <= limits_.hard_limit_bytes);
+
+  auto& registry = GetMemoryBudgetRegistry();
+  const std::scoped_lock lock{registry.mutex};
+
+  next_ = registry.head;
+  registry.head = this;
+}
+
+WB_BASE_API MemoryBudget::~MemoryBudget() noexcept {
+  auto& registry = GetMemoryBudgetRegistry();
+  const std::scoped_lock lock{registry.mutex};
+
+  for (MemoryBudget** it{&registry.head}; *it; it = &(*it)->next_) {
+    if (*it == this) {
+      *it = next_;
+      break;
+    }
+  }
+}
+
+[[nodiscard]] WB_BASE_API std::error_code MemoryBudget::Charge(
+    std::size_t size) noexcept {
+  std::uint64_t old_used_bytes{used_bytes_.load(std::memory_order_relaxed)};
+  std::uint64_t new_used_bytes;
+
+  do {
+    new_used_bytes = old_used_bytes + size;
+
+    if (new_used_bytes > limits_.hard_limit_bytes) [[unlikely]] {
+      OnHardLimitFailure(size);
+      return std2::posix_last_error_code(ENOMEM);
+    }
+  } while (!used_bytes_.compare_exchange_weak(old_used_bytes, new_used_bytes,
+                                              std::memory_order_relaxed));
+
+  OnUsedBytesChanged(old_used_bytes, new_used_bytes);
+  return std2::ok_code;
+}
+
+WB_BASE_API void MemoryBudget::Release(std::size_t size) noexcept {
+  [[maybe_unused]] const std::uint64_t old_used_bytes{
+      used_bytes_.fetch_sub(size, std::memory_order_relaxed)};
+  G3DCHECK(old_used_bytes >= size);
+}
+
+WB_BASE_API std::error_code MemoryBudget::Update(
+    std::uint64_t used_bytes) noexcept {
+  const std::uint64_t old_used_bytes{
+      used_bytes_.exchange(used_bytes, std::memory_order_relaxed)};
+
+  OnUsedBytesChanged(old_used_bytes, used_bytes);
+
+  if (used_bytes > limits_.hard_limit_bytes) [[unlikely]] {
+    // Report on crossing only, heap stats are sampled each frame.
+    if (old_used_bytes <= limits_.hard_limit_bytes) {
+      OnHardLimitFailure(used_bytes - old_used_bytes);
+    }
+    return std2::posix_last_error_code(ENOMEM);
+  }
+
+  return std2::ok_code;
+}
+
+[[nodiscard]] WB_BASE_API MemoryBudgetStats
+MemoryBudget::GetStats() const noexcept {
+  return MemoryBudgetStats{
+      .name = name_,
+      .limits = limits_,
+      .used_bytes = used_bytes_.load(std::memory_order_relaxed),
+      .peak_bytes = peak_bytes_.load(std::memory_order_relaxed),
+      .pressure_events_count =
+          pressure_events_count_.load(std::memory_order_relaxed),
+      .hard_limit_failures_count =
+          hard_limit_failures_count_.load(std::memory_order_relaxed)};
+}
+
+WB_BASE_API void MemoryBudget::OnUsedBytesChanged(
+    std::uint64_t old_used_bytes, std::uint64_t new_used_bytes) noexcept {
+  std::uint64_t peak_bytes{peak_bytes_.load(std::memory_order_relaxed)};
+  while (peak_bytes < new_used_bytes &&
+         !peak_bytes_.compare_exchange_weak(peak_bytes, new_used_bytes,
+                                            std::memory_order_relaxed)) {
+  }
+
+  // Edge triggered, so subsystem is not flooded while above soft limit.  Drop
+  // below soft limit re-arms event.
+  if (old_used_bytes <= limits_.soft_limit_bytes &&
+      new_used_bytes > limits_.soft_limit_bytes) [[unlikely]] {
+    pressure_events_count_.fetch_add(1U, std::memory_order_relaxed);
+    memory_budget_pressure_events_counter.Increment();
+
+    if (pressure_handler_) pressure_handler_(GetStats(), pressure_context_);
+  }
+}
+
+WB_BASE_API void MemoryBudget::OnHardLimitFailure(
+    std::uint64_t requested_bytes) noexcept {
+  hard_limit_failures_count_.fetch_add(1U, std::memory_order_relaxed);
+  memory_budget_hard_limit_failures_counter.Increment();
+
+  const MemoryBudgetStats stats{GetStats()};
+  G3LOG(WARNING) << "Memory budget '" << stats.name << "' hard limit of "
+                 << ToMiB(stats.limits.hard_limit_bytes)
+                 << " MiB exceeded: " << ToMiB(stats.used_bytes)
+                 << " MiB used, " << requested_bytes << " bytes requested.";
+
+  LogMemoryBudgetsReport();
+}
+
+[[nodiscard]] WB_BASE_API void* BudgetedMemoryResource::do_allocate(
+    std::size_t size, std::size_t alignment) {
+  if (budget_.Charge(size)) [[unlikely]] throw std::bad_alloc{};
+
+  try {
+    return upstream_->allocate(size, alignment);
+  } catch (...) {
+    budget_.Release(size);
+    throw;
+  }
+}
+
+WB_BASE_API void BudgetedMemoryResource::do_deallocate(void* memory,
+                                                       std::size_t size,
+                                                       std::size_t alignment) {
+  upstream_->deallocate(memory, size, alignment);
+  budget_.Release(size);
+}
+
+[[nodiscard]] WB_BASE_API bool BudgetedMemoryResource::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+[[nodiscard]] WB_BASE_API std::vector<MemoryBudgetStats>
+GetMemoryBudgetsStats() {
+  std::vector<MemoryBudgetStats> budgets_stats;
+
+  auto& registry = GetMemoryBudgetRegistry();
+  const std::scoped_lock lock{registry.mutex};
+
+  for (const MemoryBudget* it{registry.head}; it; it = it->next_) {
+    budgets_stats.emplace_back(it->GetStats());
+  }
+
+  return budgets_stats;
+}
+
+WB_BASE_API void LogMemoryBudgetsReport() noexcept {
+  auto& registry = GetMemoryBudgetRegistry();
+  const std::scoped_lock lock{registry.mutex};
+
+  for (const MemoryBudget* it{registry.head}; it; it = it->next_) {
+    const MemoryBudgetStats stats{it->GetStats()};
+
+    G3LOG(INFO) << "Memory budget '" << stats.name
+                << "': used " << ToMiB(stats.used_bytes) << " MiB, peak "
+                << ToMiB(stats.peak_bytes) << " MiB, soft limit "
+                << ToMiB(stats.limits.soft_limit_bytes) << " MiB, hard limit "
+                << ToMiB(stats.limits.hard_limit_bytes) << " MiB, "
+                << stats.pressure_events_count << " pressure events, "
+                << stats.hard_limit_failures_count << " hard limit failures.";
+  }
+}
+
+}  // namespace wb::base::memory
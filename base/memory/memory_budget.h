@@ -0,0 +1,277 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per subsystem memory budgets.  Budget is charged either by tagged
+// allocations (see BudgetedMemoryResource) or by sampled heap stats (see
+// MemoryBudget::Update).  Crossing soft limit raises pressure event, so
+// subsystem can trim caches before memory is exhausted.  Charges above hard
+// limit fail fast with budgets report instead of stalling in new handler.
+//
+// Usage example:
+//
+// MemoryBudget textures_budget{
+//     "Textures",
+//     {.soft_limit_bytes = 768U * 1024U * 1024U,
+//      .hard_limit_bytes = 1024U * 1024U * 1024U},
+//     OnTexturesMemoryPressure, &texture_cache};
+// BudgetedMemoryResource textures_resource{textures_budget,
+//                                          &assets_heap_resource};
+// std::pmr::vector<std::byte> texels{&textures_resource};
+// ...
+// // Per heap stats.
+// ui_budget.Update(ui_heap->GetStats().committed_bytes);
+
+#ifndef WB_BASE_MEMORY_MEMORY_BUDGET_H_
+#define WB_BASE_MEMORY_MEMORY_BUDGET_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "base/config.h"
+#include "base/macroses.h"
+#include "base/std2/system_error_ext.h"
+#include "build/compiler_config.h"
+
+namespace wb::base::memory {
+
+/**
+ * @brief Memory budget limits.
+ */
+struct MemoryBudgetLimits {
+  /**
+   * @brief Usage above raises memory pressure event.
+   */
+  std::uint64_t soft_limit_bytes;
+  /**
+   * @brief Charges above fail.
+   */
+  std::uint64_t hard_limit_bytes;
+};
+
+/**
+ * @brief Memory budget stats.
+ */
+struct MemoryBudgetStats {
+  /**
+   * @brief Budget name.
+   */
+  const char* name;
+  /**
+   * @brief Budget limits.
+   */
+  MemoryBudgetLimits limits;
+  /**
+   * @brief Used bytes.
+   */
+  std::uint64_t used_bytes;
+  /**
+   * @brief Peak used bytes.
+   */
+  std::uint64_t peak_bytes;
+  /**
+   * @brief Soft limit crossings count.
+   */
+  std::uint64_t pressure_events_count;
+  /**
+   * @brief Charges failed due to hard limit.
+   */
+  std::uint64_t hard_limit_failures_count;
+};
+
+/**
+ * @brief Memory pressure handler.  Called on thread which crossed soft limit,
+ * so should be quick, ex. schedule cache trimming.
+ * @param stats Budget stats.
+ * @param context Handler context.
+ * @return void.
+ */
+using MemoryPressureHandler = void (*)(const MemoryBudgetStats& stats,
+                                       void* context) noexcept;
+
+/**
+ * @brief Gets stats of all registered budgets.
+ * @return Budgets stats.
+ */
+[[nodiscard]] WB_BASE_API std::vector<MemoryBudgetStats>
+GetMemoryBudgetsStats();
+
+/**
+ * @brief Logs used bytes and limits of all registered budgets.
+ * @return void.
+ */
+WB_BASE_API void LogMemoryBudgetsReport() noexcept;
+
+/**
+ * @brief Subsystem memory budget.  Thread safe.
+ */
+class WB_BASE_API MemoryBudget {
+ public:
+  /**
+   * @brief Creates and registers budget for lifetime.
+   * @param name Budget name.  Should outlive budget.
+   * @param limits Budget limits.
+   * @param pressure_handler Handler for soft limit crossing.  Can be nullptr.
+   * @param pressure_context Pressure handler context.
+   */
+  MemoryBudget(const char* name, MemoryBudgetLimits limits,
+               MemoryPressureHandler pressure_handler = nullptr,
+               void* pressure_context = nullptr) noexcept;
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(MemoryBudget);
+
+  /**
+   * @brief Unregisters budget.
+   */
+  ~MemoryBudget() noexcept;
+
+  /**
+   * @brief Charges allocation to budget.
+   * @param size Allocation size.
+   * @return ok_code or ENOMEM when hard limit would be exceeded.  Budgets
+   * report is logged on failure.
+   */
+  [[nodiscard]] std::error_code Charge(std::size_t size) noexcept;
+
+  /**
+   * @brief Releases allocation from budget.
+   * @param size Allocation size.
+   * @return void.
+   */
+  void Release(std::size_t size) noexcept;
+
+  /**
+   * @brief Sets used bytes from sampled heap stats.  Raises pressure event on
+   * soft limit crossing, logs budgets report on hard limit crossing.
+   * @param used_bytes Used bytes.
+   * @return ok_code or ENOMEM when hard limit is exceeded.
+   */
+  std::error_code Update(std::uint64_t used_bytes) noexcept;
+
+  /**
+   * @brief Gets budget stats.
+   * @return Budget stats.
+   */
+  [[nodiscard]] MemoryBudgetStats GetStats() const noexcept;
+
+ private:
+  friend std::vector<MemoryBudgetStats> GetMemoryBudgetsStats();
+  friend void LogMemoryBudgetsReport() noexcept;
+
+  /**
+   * @brief Budget name.
+   */
+  const char* name_;
+  /**
+   * @brief Budget limits.
+   */
+  const MemoryBudgetLimits limits_;
+  /**
+   * @brief Pressure handler.
+   */
+  const MemoryPressureHandler pressure_handler_;
+  /**
+   * @brief Pressure handler context.
+   */
+  void* const pressure_context_;
+  /**
+   * @brief Next registered budget.  Guarded by registry mutex.
+   */
+  MemoryBudget* next_;
+  /**
+   * @brief Used bytes.
+   */
+  std::atomic_uint64_t used_bytes_;
+  /**
+   * @brief Peak used bytes.
+   */
+  std::atomic_uint64_t peak_bytes_;
+  /**
+   * @brief Soft limit crossings count.
+   */
+  std::atomic_uint64_t pressure_events_count_;
+  /**
+   * @brief Charges failed due to hard limit.
+   */
+  std::atomic_uint64_t hard_limit_failures_count_;
+
+  /**
+   * @brief Handles used bytes change.
+   * @param old_used_bytes Used bytes before change.
+   * @param new_used_bytes Used bytes after change.
+   * @return void.
+   */
+  void OnUsedBytesChanged(std::uint64_t old_used_bytes,
+                          std::uint64_t new_used_bytes) noexcept;
+
+  /**
+   * @brief Handles hard limit failure.
+   * @param requested_bytes Bytes which exceed hard limit.
+   * @return void.
+   */
+  void OnHardLimitFailure(std::uint64_t requested_bytes) noexcept;
+};
+
+/**
+ * @brief Memory resource which charges allocations to budget.
+ */
+class WB_BASE_API BudgetedMemoryResource final
+    : public std::pmr::memory_resource {
+ public:
+  /**
+   * @brief Creates memory resource.
+   * @param budget Budget to charge.  Should outlive resource.
+   * @param upstream Upstream memory resource.  Should outlive resource.
+   */
+  BudgetedMemoryResource(MemoryBudget& budget,
+                         std::pmr::memory_resource* upstream) noexcept
+      : budget_{budget}, upstream_{upstream} {}
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(BudgetedMemoryResource);
+
+  ~BudgetedMemoryResource() noexcept override = default;
+
+ private:
+  /**
+   * @brief Budget.
+   */
+  MemoryBudget& budget_;
+  /**
+   * @brief Upstream memory resource.
+   */
+  std::pmr::memory_resource* upstream_;
+
+  /**
+   * @brief Charges budget and allocates memory from upstream.
+   * @param size Size.
+   * @param alignment Alignment.
+   * @return Memory.  Throws std::bad_alloc when hard limit is exceeded.
+   */
+  [[nodiscard]] void* do_allocate(std::size_t size,
+                                  std::size_t alignment) override;
+
+  /**
+   * @brief Frees memory to upstream and releases budget.
+   * @param memory Memory.
+   * @param size Size.
+   * @param alignment Alignment.
+   * @return void.
+   */
+  void do_deallocate(void* memory, std::size_t size,
+                     std::size_t alignment) override;
+
+  /**
+   * @brief Is memory resource the same?
+   * @param other Memory resource.
+   * @return true if the same, false otherwise.
+   */
+  [[nodiscard]] bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override;
+};
+
+}  // namespace wb::base::memory
+
+#endif  // !WB_BASE_MEMORY_MEMORY_BUDGET_H_
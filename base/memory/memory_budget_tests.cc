@@ -0,0 +1,136 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per subsystem memory budgets.
+
+#include "memory_budget.h"
+//
+#include <algorithm>
+#include <cerrno>  // ENOMEM.
+#include <cstring>
+#include <new>
+
+#include "base/deps/googletest/gtest/gtest.h"
+#include "base/std2/memory_resource_ext.h"
+
+namespace {
+
+/**
+ * @brief Records memory pressure events.
+ * @param stats Budget stats.
+ * @param context Pressure events count.
+ * @return void.
+ */
+void CountMemoryPressure(const wb::base::memory::MemoryBudgetStats& stats,
+                         void* context) noexcept {
+  EXPECT_GT(stats.used_bytes, stats.limits.soft_limit_bytes);
+  ++*static_cast<int*>(context);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MemoryBudgetTest, ChargeRaisesPressureOnceAndFailsAtHardLimit) {
+  using namespace wb::base::memory;
+
+  int pressure_events_count{0};
+  MemoryBudget budget{"Test",
+                      {.soft_limit_bytes = 100U, .hard_limit_bytes = 200U},
+                      CountMemoryPressure,
+                      &pressure_events_count};
+
+  EXPECT_EQ(wb::base::std2::ok_code, budget.Charge(100U));
+  EXPECT_EQ(0, pressure_events_count);
+
+  EXPECT_EQ(wb::base::std2::ok_code, budget.Charge(50U));
+  EXPECT_EQ(1, pressure_events_count);
+
+  // Edge triggered.
+  EXPECT_EQ(wb::base::std2::ok_code, budget.Charge(50U));
+  EXPECT_EQ(1, pressure_events_count);
+
+  EXPECT_EQ(wb::base::std2::posix_last_error_code(ENOMEM),
+            budget.Charge(1U));
+
+  // Re-armed below soft limit.
+  budget.Release(150U);
+  EXPECT_EQ(wb::base::std2::ok_code, budget.Charge(60U));
+  EXPECT_EQ(2, pressure_events_count);
+  budget.Release(110U);
+
+  const MemoryBudgetStats stats{budget.GetStats()};
+  EXPECT_STREQ("Test", stats.name);
+  EXPECT_EQ(0U, stats.used_bytes);
+  EXPECT_EQ(200U, stats.peak_bytes);
+  EXPECT_EQ(2U, stats.pressure_events_count);
+  EXPECT_EQ(1U, stats.hard_limit_failures_count);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MemoryBudgetTest, UpdateTracksSampledHeapStats) {
+  using namespace wb::base::memory;
+
+  MemoryBudget budget{"Heap",
+                      {.soft_limit_bytes = 1024U, .hard_limit_bytes = 2048U}};
+
+  EXPECT_EQ(wb::base::std2::ok_code, budget.Update(512U));
+  EXPECT_EQ(wb::base::std2::ok_code, budget.Update(1500U));
+  EXPECT_EQ(wb::base::std2::posix_last_error_code(ENOMEM),
+            budget.Update(4096U));
+  // Still above hard limit, but reported once.
+  EXPECT_EQ(wb::base::std2::posix_last_error_code(ENOMEM),
+            budget.Update(3000U));
+  EXPECT_EQ(wb::base::std2::ok_code, budget.Update(256U));
+
+  const MemoryBudgetStats stats{budget.GetStats()};
+  EXPECT_EQ(256U, stats.used_bytes);
+  EXPECT_EQ(4096U, stats.peak_bytes);
+  EXPECT_EQ(1U, stats.pressure_events_count);
+  EXPECT_EQ(1U, stats.hard_limit_failures_count);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MemoryBudgetTest, BudgetsAreRegisteredForLifetime) {
+  using namespace wb::base::memory;
+
+  const auto has_budget = [](const char* name) {
+    const auto stats = GetMemoryBudgetsStats();
+    return std::ranges::any_of(stats, [name](const MemoryBudgetStats& s) {
+      return std::strcmp(s.name, name) == 0;
+    });
+  };
+
+  {
+    const MemoryBudget budget{
+        "Scoped", {.soft_limit_bytes = 1U, .hard_limit_bytes = 2U}};
+    EXPECT_TRUE(has_budget("Scoped"));
+
+    LogMemoryBudgetsReport();
+  }
+
+  EXPECT_FALSE(has_budget("Scoped"));
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MemoryBudgetTest, BudgetedMemoryResourceFailsFastAtHardLimit) {
+  using namespace wb::base::memory;
+
+  MemoryBudget budget{"Containers",
+                      {.soft_limit_bytes = 512U, .hard_limit_bytes = 1024U}};
+  BudgetedMemoryResource resource{budget, std::pmr::new_delete_resource()};
+
+  {
+    wb::base::std2::pmr::vector<std::byte> bytes{&resource};
+    bytes.reserve(600U);
+    EXPECT_EQ(600U, budget.GetStats().used_bytes);
+    EXPECT_EQ(1U, budget.GetStats().pressure_events_count);
+
+    EXPECT_THROW(bytes.reserve(2048U), std::bad_alloc);
+    // Failed charge is not accounted.
+    EXPECT_EQ(600U, budget.GetStats().used_bytes);
+  }
+
+  EXPECT_EQ(0U, budget.GetStats().used_bytes);
+  EXPECT_EQ(1U, budget.GetStats().hard_limit_failures_count);
+}
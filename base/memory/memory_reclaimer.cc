@@ -0,0 +1,112 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Prioritized memory reclaim callbacks.
+
+#include "memory_reclaimer.h"
+
+#include <mutex>
+
+#include "base/deps/g3log/g3log.h"
+
+namespace {
+
+/**
+ * @brief Registered reclaimers.
+ */
+struct MemoryReclaimerRegistry {
+  /**
+   * @brief Guards reclaimers list.
+   */
+  std::mutex mutex;
+  /**
+   * @brief Reclaimers list head, sorted by priority.
+   */
+  wb::base::memory::ScopedMemoryReclaimer* head{nullptr};
+};
+
+/**
+ * @brief Is current thread running reclaim callbacks.  Registry mutex is held
+ * meanwhile, so callbacks must not reclaim, register or unregister.
+ */
+thread_local bool is_current_thread_reclaiming{false};
+
+/**
+ * @brief Gets reclaimers registry.
+ * @return Reclaimers registry.
+ */
+[[nodiscard]] MemoryReclaimerRegistry& GetMemoryReclaimerRegistry() noexcept {
+  // Reclaimers can be defined at namespace scope in other translation units.
+  static MemoryReclaimerRegistry registry;
+  return registry;
+}
+
+}  // namespace
+
+namespace wb::base::memory {
+
+WB_BASE_API ScopedMemoryReclaimer::ScopedMemoryReclaimer(
+    MemoryReclaimPriority priority, MemoryReclaimCallback callback,
+    void* context) noexcept
+    : callback_{callback},
+      context_{context},
+      next_{nullptr},
+      priority_{priority} {
+  G3DCHECK(!!callback_);
+  G3DCHECK(!is_current_thread_reclaiming)
+      << "Reclaim callback registers reclaimer, deadlock.";
+
+  auto& registry = GetMemoryReclaimerRegistry();
+  const std::scoped_lock lock{registry.mutex};
+
+  // After reclaimers of same priority, so registration order is kept.
+  ScopedMemoryReclaimer** it{&registry.head};
+  while (*it && (*it)->priority_ <= priority_) it = &(*it)->next_;
+
+  next_ = *it;
+  *it = this;
+}
+
+WB_BASE_API ScopedMemoryReclaimer::~ScopedMemoryReclaimer() noexcept {
+  G3DCHECK(!is_current_thread_reclaiming)
+      << "Reclaim callback unregisters reclaimer, deadlock.";
+
+  auto& registry = GetMemoryReclaimerRegistry();
+  const std::scoped_lock lock{registry.mutex};
+
+  for (ScopedMemoryReclaimer** it{&registry.head}; *it; it = &(*it)->next_) {
+    if (*it == this) {
+      *it = next_;
+      break;
+    }
+  }
+}
+
+WB_BASE_API std::size_t ReclaimMemory(std::size_t wanted_bytes) noexcept {
+  // Callback allocated and new failure handler reclaims again.  Registry mutex
+  // is held, so nothing more can be reclaimed without deadlock.
+  G3DCHECK(!is_current_thread_reclaiming)
+      << "Reclaim callback reclaims memory, should not allocate.";
+  if (is_current_thread_reclaiming) [[unlikely]] return 0;
+
+  // Mutex is held while callbacks run, so reclaimer is not destroyed while
+  // its callback releases memory.  Copying list outside would allocate.
+  auto& registry = GetMemoryReclaimerRegistry();
+  const std::scoped_lock lock{registry.mutex};
+
+  is_current_thread_reclaiming = true;
+
+  std::size_t reclaimed_bytes{0};
+  for (const ScopedMemoryReclaimer* it{registry.head};
+       it && reclaimed_bytes < wanted_bytes; it = it->next_) {
+    reclaimed_bytes += it->callback_(wanted_bytes - reclaimed_bytes,
+                                     it->context_);
+  }
+
+  is_current_thread_reclaiming = false;
+
+  return reclaimed_bytes;
+}
+
+}  // namespace wb::base::memory
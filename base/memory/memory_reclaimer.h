@@ -0,0 +1,119 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Prioritized memory reclaim callbacks.  Subsystems which hold caches (decoded
+// images, object pools, streaming buffers) register reclaimers, and new
+// failure handler asks them to release memory before sleeping and retrying
+// allocation.  This turns out of memory stalls into cache evictions.
+//
+// Usage example:
+//
+// std::size_t ReclaimDecodedImages(std::size_t wanted_bytes,
+//                                  void* context) noexcept {
+//   return static_cast<ImageCache*>(context)->Evict(wanted_bytes);
+// }
+// ...
+// const ScopedMemoryReclaimer image_cache_reclaimer{
+//     MemoryReclaimPriority::kCache, ReclaimDecodedImages, &image_cache};
+
+#ifndef WB_BASE_MEMORY_MEMORY_RECLAIMER_H_
+#define WB_BASE_MEMORY_MEMORY_RECLAIMER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "base/config.h"
+#include "base/macroses.h"
+#include "build/compiler_config.h"
+
+namespace wb::base::memory {
+
+/**
+ * @brief Memory reclaim priority.  Lower priorities are asked first.
+ */
+enum class MemoryReclaimPriority : std::uint8_t {
+  /**
+   * @brief Memory which can be released for free, ex. pools free slots.
+   */
+  kFree = 0U,
+  /**
+   * @brief Caches which are cheap to rebuild.
+   */
+  kCache = 1U,
+  /**
+   * @brief Data which is expensive to restore, ex. streamed in assets.
+   */
+  kExpensive = 2U
+};
+
+/**
+ * @brief Memory reclaim callback.  Called from new failure handler with
+ * reclaimers registry locked, so should free memory only, never allocate, and
+ * never register or unregister reclaimers.  Debug builds check it, reclaim
+ * from callback returns 0 in release builds.
+ * @param wanted_bytes Bytes wanted to be reclaimed.
+ * @param context Reclaimer context.
+ * @return Actually released bytes.
+ */
+using MemoryReclaimCallback = std::size_t (*)(std::size_t wanted_bytes,
+                                              void* context) noexcept;
+
+/**
+ * @brief Asks registered reclaimers to release memory, lower priorities first,
+ * until wanted bytes are released or all reclaimers are asked.  Never
+ * allocates.
+ * @param wanted_bytes Bytes wanted to be reclaimed.
+ * @return Actually released bytes.
+ */
+WB_BASE_API std::size_t ReclaimMemory(std::size_t wanted_bytes) noexcept;
+
+/**
+ * @brief Registers memory reclaim callback in scope.
+ */
+class WB_BASE_API ScopedMemoryReclaimer {
+ public:
+  /**
+   * @brief Registers reclaimer.
+   * @param priority Reclaim priority.
+   * @param callback Reclaim callback.
+   * @param context Reclaim callback context.
+   */
+  ScopedMemoryReclaimer(MemoryReclaimPriority priority,
+                        MemoryReclaimCallback callback,
+                        void* context = nullptr) noexcept;
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(ScopedMemoryReclaimer);
+
+  /**
+   * @brief Unregisters reclaimer.
+   */
+  ~ScopedMemoryReclaimer() noexcept;
+
+ private:
+  friend std::size_t ReclaimMemory(std::size_t wanted_bytes) noexcept;
+
+  /**
+   * @brief Reclaim callback.
+   */
+  const MemoryReclaimCallback callback_;
+  /**
+   * @brief Reclaim callback context.
+   */
+  void* const context_;
+  /**
+   * @brief Next reclaimer of same or higher priority.  Guarded by registry
+   * mutex.
+   */
+  ScopedMemoryReclaimer* next_;
+  /**
+   * @brief Reclaim priority.
+   */
+  const MemoryReclaimPriority priority_;
+  WB_ATTRIBUTE_UNUSED_FIELD std::byte pad_[sizeof(char*) -
+                                           sizeof(priority_)];
+};
+
+}  // namespace wb::base::memory
+
+#endif  // !WB_BASE_MEMORY_MEMORY_RECLAIMER_H_
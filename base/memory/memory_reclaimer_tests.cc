@@ -0,0 +1,147 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Prioritized memory reclaim callbacks.
+
+#include "memory_reclaimer.h"
+//
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "base/deps/googletest/gtest/gtest.h"
+
+namespace {
+
+/**
+ * @brief Test cache.
+ */
+struct Cache {
+  /**
+   * @brief Cache id.
+   */
+  int id;
+  /**
+   * @brief Cached bytes.
+   */
+  std::size_t cached_bytes;
+  /**
+   * @brief Ids of reclaimed caches in reclaim order.
+   */
+  std::vector<int>* reclaim_order;
+};
+
+/**
+ * @brief Evicts test cache.
+ * @param wanted_bytes Bytes wanted to be reclaimed.
+ * @param context Cache.
+ * @return Released bytes.
+ */
+std::size_t EvictCache(std::size_t wanted_bytes, void* context) noexcept {
+  auto* cache = static_cast<Cache*>(context);
+  const std::size_t released_bytes{std::min(wanted_bytes, cache->cached_bytes)};
+
+  cache->cached_bytes -= released_bytes;
+  cache->reclaim_order->push_back(cache->id);
+
+  return released_bytes;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MemoryReclaimerTest, ReclaimsLowerPrioritiesFirstUntilEnough) {
+  using namespace wb::base::memory;
+
+  std::vector<int> reclaim_order;
+  reclaim_order.reserve(8U);
+
+  Cache assets{1, 1000U, &reclaim_order};
+  Cache images{2, 300U, &reclaim_order};
+  Cache pool{3, 100U, &reclaim_order};
+  Cache glyphs{4, 200U, &reclaim_order};
+
+  const ScopedMemoryReclaimer assets_reclaimer{
+      MemoryReclaimPriority::kExpensive, EvictCache, &assets};
+  const ScopedMemoryReclaimer images_reclaimer{MemoryReclaimPriority::kCache,
+                                               EvictCache, &images};
+  const ScopedMemoryReclaimer pool_reclaimer{MemoryReclaimPriority::kFree,
+                                             EvictCache, &pool};
+  const ScopedMemoryReclaimer glyphs_reclaimer{MemoryReclaimPriority::kCache,
+                                               EvictCache, &glyphs};
+
+  // Free memory first, then caches in registration order.
+  EXPECT_EQ(500U, ReclaimMemory(500U));
+  EXPECT_EQ((std::vector<int>{3, 2, 4}), reclaim_order);
+  EXPECT_EQ(0U, pool.cached_bytes);
+  EXPECT_EQ(0U, images.cached_bytes);
+  EXPECT_EQ(100U, glyphs.cached_bytes);
+  EXPECT_EQ(1000U, assets.cached_bytes);
+
+  reclaim_order.clear();
+
+  // Expensive data is released last.
+  EXPECT_EQ(1100U, ReclaimMemory(2000U));
+  EXPECT_EQ((std::vector<int>{3, 2, 4, 1}), reclaim_order);
+  EXPECT_EQ(0U, assets.cached_bytes);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MemoryReclaimerTest, UnregistersOnScopeExit) {
+  using namespace wb::base::memory;
+
+  std::vector<int> reclaim_order;
+  reclaim_order.reserve(8U);
+
+  Cache images{1, 300U, &reclaim_order};
+
+  {
+    const ScopedMemoryReclaimer images_reclaimer{MemoryReclaimPriority::kCache,
+                                                 EvictCache, &images};
+  }
+
+  EXPECT_EQ(0U, ReclaimMemory(100U));
+  EXPECT_TRUE(reclaim_order.empty());
+  EXPECT_EQ(300U, images.cached_bytes);
+}
+
+#ifdef NDEBUG
+namespace {
+
+/**
+ * @brief Reclaims memory from reclaim callback, as allocating callback would
+ * via new failure handler.
+ * @param wanted_bytes Bytes wanted to be reclaimed.
+ * @param context Reentrant reclaimed bytes.
+ * @return Released bytes.
+ */
+std::size_t ReclaimReentrant(std::size_t wanted_bytes, void* context) noexcept {
+  *static_cast<std::size_t*>(context) =
+      wb::base::memory::ReclaimMemory(wanted_bytes);
+  return 0U;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MemoryReclaimerTest, ReentrantReclaimDoesNotDeadlock) {
+  using namespace wb::base::memory;
+
+  std::vector<int> reclaim_order;
+  reclaim_order.reserve(8U);
+
+  std::size_t reentrant_reclaimed_bytes{1U};
+  Cache images{1, 300U, &reclaim_order};
+
+  const ScopedMemoryReclaimer reentrant_reclaimer{
+      MemoryReclaimPriority::kFree, ReclaimReentrant,
+      &reentrant_reclaimed_bytes};
+  const ScopedMemoryReclaimer images_reclaimer{MemoryReclaimPriority::kCache,
+                                               EvictCache, &images};
+
+  EXPECT_EQ(100U, ReclaimMemory(100U));
+  EXPECT_EQ(0U, reentrant_reclaimed_bytes);
+  EXPECT_EQ(std::vector<int>{1}, reclaim_order);
+}
+#endif
@@ -0,0 +1,42 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// std::pmr::memory_resource adapters over subsystem heaps and linear arenas.
+
+#include "memory_resources.h"
+
+#include <new>
+
+namespace wb::base::memory {
+
+[[nodiscard]] WB_BASE_API void* SubsystemHeapMemoryResource::do_allocate(
+    std::size_t size, std::size_t alignment) {
+  void* memory{heap_.Allocate(size, alignment)};
+  if (!memory) [[unlikely]] throw std::bad_alloc{};
+  return memory;
+}
+
+WB_BASE_API void SubsystemHeapMemoryResource::do_deallocate(
+    void* memory, std::size_t, std::size_t) noexcept {
+  SubsystemHeap::Free(memory);
+}
+
+[[nodiscard]] WB_BASE_API bool SubsystemHeapMemoryResource::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+[[nodiscard]] WB_BASE_API void* LinearArenaMemoryResource::do_allocate(
+    std::size_t size, std::size_t alignment) {
+  void* memory{arena_.Allocate(size, alignment)};
+  if (!memory) [[unlikely]] throw std::bad_alloc{};
+  return memory;
+}
+
+[[nodiscard]] WB_BASE_API bool LinearArenaMemoryResource::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+}  // namespace wb::base::memory
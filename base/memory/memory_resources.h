@@ -0,0 +1,135 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// std::pmr::memory_resource adapters over subsystem heaps and linear arenas,
+// so standard containers can place storage in the right heap / arena without
+// custom container code.
+//
+// Usage example:
+//
+// LinearArena* arena{frame_arena.ForCurrentThread()};
+// LinearArenaMemoryResource arena_resource{*arena};
+// std2::pmr::vector<Contact> contacts{&arena_resource};
+// ...
+// // Pool of small blocks over subsystem heap.
+// SubsystemHeapMemoryResource ui_resource{*ui_heap};
+// std::pmr::unsynchronized_pool_resource ui_pool{&ui_resource};
+// std2::pmr::unordered_map<std::uint64_t, std2::pmr::string> labels{&ui_pool};
+
+#ifndef WB_BASE_MEMORY_MEMORY_RESOURCES_H_
+#define WB_BASE_MEMORY_MEMORY_RESOURCES_H_
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "base/config.h"
+#include "base/macroses.h"
+#include "base/memory/frame_arena.h"
+#include "base/memory/subsystem_heap.h"
+
+namespace wb::base::memory {
+
+/**
+ * @brief Memory resource over subsystem heap.  Allocates on heap owner thread
+ * only, deallocates on any thread.
+ */
+class WB_BASE_API SubsystemHeapMemoryResource final
+    : public std::pmr::memory_resource {
+ public:
+  /**
+   * @brief Creates memory resource.
+   * @param heap Subsystem heap.  Should outlive resource.
+   */
+  explicit SubsystemHeapMemoryResource(SubsystemHeap& heap) noexcept
+      : heap_{heap} {}
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(SubsystemHeapMemoryResource);
+
+  ~SubsystemHeapMemoryResource() noexcept override = default;
+
+ private:
+  /**
+   * @brief Subsystem heap.
+   */
+  SubsystemHeap& heap_;
+
+  /**
+   * @brief Allocates memory from heap.
+   * @param size Size.
+   * @param alignment Alignment.
+   * @return Memory.  Throws std::bad_alloc when out of memory.
+   */
+  [[nodiscard]] void* do_allocate(std::size_t size,
+                                  std::size_t alignment) override;
+
+  /**
+   * @brief Frees memory.
+   * @param memory Memory.
+   * @param size Size.
+   * @param alignment Alignment.
+   * @return void.
+   */
+  void do_deallocate(void* memory, std::size_t size,
+                     std::size_t alignment) noexcept override;
+
+  /**
+   * @brief Is memory resource the same?
+   * @param other Memory resource.
+   * @return true if the same, false otherwise.
+   */
+  [[nodiscard]] bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override;
+};
+
+/**
+ * @brief Monotonic memory resource over linear arena.  Deallocation is no-op,
+ * memory is released on arena reset.
+ */
+class WB_BASE_API LinearArenaMemoryResource final
+    : public std::pmr::memory_resource {
+ public:
+  /**
+   * @brief Creates memory resource.
+   * @param arena Linear arena.  Should outlive resource.
+   */
+  explicit LinearArenaMemoryResource(LinearArena& arena) noexcept
+      : arena_{arena} {}
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(LinearArenaMemoryResource);
+
+  ~LinearArenaMemoryResource() noexcept override = default;
+
+ private:
+  /**
+   * @brief Linear arena.
+   */
+  LinearArena& arena_;
+
+  /**
+   * @brief Allocates memory from arena.
+   * @param size Size.
+   * @param alignment Alignment.
+   * @return Memory.  Throws std::bad_alloc when out of memory.
+   */
+  [[nodiscard]] void* do_allocate(std::size_t size,
+                                  std::size_t alignment) override;
+
+  /**
+   * @brief Does nothing, memory is released on arena reset.
+   * @return void.
+   */
+  void do_deallocate(void*, std::size_t, std::size_t) noexcept override {}
+
+  /**
+   * @brief Is memory resource the same?
+   * @param other Memory resource.
+   * @return true if the same, false otherwise.
+   */
+  [[nodiscard]] bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override;
+};
+
+}  // namespace wb::base::memory
+
+#endif  // !WB_BASE_MEMORY_MEMORY_RESOURCES_H_
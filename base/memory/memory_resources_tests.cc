@@ -0,0 +1,138 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// std::pmr::memory_resource adapters over subsystem heaps and linear arenas.
+
+#include "memory_resources.h"
+//
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "base/deps/googletest/gtest/gtest.h"
+#include "base/memory/allocation_stats.h"
+#include "base/memory/heap_profiler.h"
+#include "base/std2/memory_resource_ext.h"
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MemoryResourcesTest, LinearArenaBacksContainers) {
+  using namespace wb::base::memory;
+  namespace pmr = wb::base::std2::pmr;
+
+  LinearArena arena;
+  LinearArenaMemoryResource arena_resource{arena};
+
+  {
+    pmr::vector<std::uint32_t> ids{&arena_resource};
+    for (std::uint32_t i{0}; i < 100U; ++i) ids.push_back(i);
+
+    pmr::string name{"transient string longer than small buffer",
+                     &arena_resource};
+
+    EXPECT_EQ(99U, ids.back());
+    EXPECT_EQ('t', name.front());
+    EXPECT_GE(arena.used_bytes(), 100U * sizeof(std::uint32_t));
+  }
+
+  // Deallocation is no-op, memory goes away on reset.
+  EXPECT_GT(arena.used_bytes(), 0U);
+  arena.Reset();
+  EXPECT_EQ(0U, arena.used_bytes());
+
+  EXPECT_TRUE(arena_resource.is_equal(arena_resource));
+  EXPECT_FALSE(arena_resource.is_equal(*std::pmr::new_delete_resource()));
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MemoryResourcesTest, SubsystemHeapBacksContainers) {
+  using namespace wb::base::memory;
+  namespace pmr = wb::base::std2::pmr;
+
+  auto intl_heap = SubsystemHeap::New("Intl");
+  ASSERT_TRUE(intl_heap.has_value());
+
+  SubsystemHeapMemoryResource heap_resource{*intl_heap};
+
+  {
+    pmr::unordered_map<std::uint64_t, pmr::string> messages{&heap_resource};
+    messages.emplace(1U, "Hello, world, message long enough to allocate");
+
+    const auto& message = messages.at(1U);
+    EXPECT_TRUE(intl_heap->Owns(message.data()));
+    // Allocator propagates to nested containers.
+    EXPECT_EQ(&heap_resource, message.get_allocator().resource());
+    EXPECT_GT(intl_heap->GetStats().blocks_count, 0U);
+  }
+
+  EXPECT_EQ(0U, intl_heap->GetStats().blocks_count);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MemoryResourcesTest, PoolOverSubsystemHeap) {
+  using namespace wb::base::memory;
+  namespace pmr = wb::base::std2::pmr;
+
+  auto ui_heap = SubsystemHeap::New("UI");
+  ASSERT_TRUE(ui_heap.has_value());
+
+  SubsystemHeapMemoryResource heap_resource{*ui_heap};
+  std::pmr::unsynchronized_pool_resource pool{&heap_resource};
+
+  {
+    pmr::map<std::uint32_t, std::uint32_t> widgets{&pool};
+    for (std::uint32_t i{0}; i < 256U; ++i) widgets.emplace(i, i * 2U);
+
+    EXPECT_EQ(510U, widgets.at(255U));
+    // Pool chunks come from heap.
+    EXPECT_GT(ui_heap->GetStats().blocks_count, 0U);
+  }
+
+  pool.release();
+  EXPECT_EQ(0U, ui_heap->GetStats().blocks_count);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MemoryResourcesTest, SubsystemHeapAllocationsAreBalanced) {
+  using namespace wb::base::memory;
+
+  constexpr std::size_t kBlockSize{4096U};
+  constexpr std::size_t kBlocksCount{64U};
+
+  auto assets_heap = SubsystemHeap::New("Assets");
+  ASSERT_TRUE(assets_heap.has_value());
+
+  SubsystemHeapMemoryResource heap_resource{*assets_heap};
+  std::array<void*, kBlocksCount> blocks;
+
+  EnableAllocationStats();
+  // Mean interval is far less than block size, so each block is sampled.
+  EnableHeapProfiling(64U);
+
+  const ThreadAllocationStats before_stats{GetThreadAllocationStats()};
+  const HeapProfilerStats before_profile{GetHeapProfilerStats()};
+
+  for (auto& block : blocks) {
+    block = heap_resource.allocate(kBlockSize, alignof(std::max_align_t));
+  }
+
+  const HeapProfilerStats allocated_profile{GetHeapProfilerStats()};
+  EXPECT_GE(allocated_profile.live_samples_count,
+            before_profile.live_samples_count + kBlocksCount);
+
+  for (void* block : blocks) {
+    heap_resource.deallocate(block, kBlockSize, alignof(std::max_align_t));
+  }
+
+  // Each allocation has its free, so no live bytes or samples are left.
+  const ThreadAllocationStats after_stats{GetThreadAllocationStats()};
+  EXPECT_GE(after_stats.allocations_count - before_stats.allocations_count,
+            kBlocksCount);
+  EXPECT_GE(after_stats.frees_count - before_stats.frees_count, kBlocksCount);
+  EXPECT_EQ(before_stats.live_bytes, after_stats.live_bytes);
+
+  const HeapProfilerStats after_profile{GetHeapProfilerStats()};
+  EXPECT_EQ(before_profile.live_samples_count,
+            after_profile.live_samples_count);
+  EXPECT_EQ(0U, assets_heap->GetStats().blocks_count);
+}
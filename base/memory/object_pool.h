@@ -0,0 +1,561 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Fixed size object pool (slab allocator).  Objects live in big slabs, free
+// slots are chained into intrusive free list, so allocation and deallocation
+// are a few instructions and objects of the same type stay dense in memory.
+//
+// Usage example:
+//
+// ObjectPool<Entity> entities;
+// Entity* entity{entities.New(entity_id)};
+// ...
+// entities.Delete(entity);
+//
+// Thread safe pool with per thread cache:
+//
+// ObjectPool<Packet, ObjectPoolThreading::kThreadSafe> packets;
+// ...
+// // On each thread.
+// ObjectPool<Packet, ObjectPoolThreading::kThreadSafe>::LocalCache cache{
+//     packets};
+// Packet* packet{cache.New()};
+// ...
+// cache.Delete(packet);
+
+#ifndef WB_BASE_MEMORY_OBJECT_POOL_H_
+#define WB_BASE_MEMORY_OBJECT_POOL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "base/deps/g3log/g3log.h"
+#include "base/deps/mimalloc/mimalloc.h"
+#include "base/macroses.h"
+#include "build/compiler_config.h"
+
+namespace wb::base::memory {
+
+/**
+ * @brief Default objects count per object pool slab.
+ */
+inline constexpr std::size_t kDefaultObjectPoolSlabObjectsCount{256U};
+
+/**
+ * @brief Max objects count object pool local cache keeps.
+ */
+inline constexpr std::size_t kObjectPoolLocalCacheObjectsCount{64U};
+
+/**
+ * @brief Byte freed object pool slots are filled with in debug builds.
+ */
+inline constexpr std::byte kObjectPoolFreedSlotByte{0xDD};
+
+/**
+ * @brief Object pool threading model.
+ */
+enum class ObjectPoolThreading : std::uint8_t {
+  /**
+   * @brief Pool is used by single thread, no locks.
+   */
+  kSingleThreaded = 0U,
+  /**
+   * @brief Pool is shared by threads, use local caches to amortize locking.
+   */
+  kThreadSafe = 1U
+};
+
+/**
+ * @brief Object pool stats.
+ */
+struct ObjectPoolStats {
+  /**
+   * @brief Objects count pool can hold without allocating new slab.
+   */
+  std::uint64_t capacity;
+  /**
+   * @brief Objects count given out by pool, including ones held by local
+   * caches.
+   */
+  std::uint64_t live_objects_count;
+  /**
+   * @brief Allocated slabs count.
+   */
+  std::uint64_t slabs_count;
+  /**
+   * @brief Objects allocations count.  Local caches report own allocations on
+   * refill / flush.
+   */
+  std::uint64_t allocations_count;
+  /**
+   * @brief Objects deallocations count.  Local caches report own
+   * deallocations on refill / flush.
+   */
+  std::uint64_t frees_count;
+};
+
+/**
+ * @brief Fixed size object pool.
+ * @tparam T Object type.
+ * @tparam threading Threading model.
+ */
+template <typename T,
+          ObjectPoolThreading threading = ObjectPoolThreading::kSingleThreaded>
+class ObjectPool {
+  /**
+   * @brief Free list slot.  Free slot stores next free slot pointer in object
+   * storage.
+   */
+  union Slot {
+    /**
+     * @brief Next free slot.
+     */
+    Slot* next;
+    /**
+     * @brief Object storage.
+     */
+    alignas(T) std::byte storage[sizeof(T)];
+  };
+
+  /**
+   * @brief Slab header, placed at slab start.
+   */
+  struct alignas(Slot) Slab {
+    /**
+     * @brief Next slab.
+     */
+    Slab* next;
+  };
+
+  /**
+   * @brief Lock for single threaded pool.  Pointer sized to not pad pool.
+   */
+  struct NoLock {
+    void lock() noexcept {}
+    void unlock() noexcept {}
+
+    WB_ATTRIBUTE_UNUSED_FIELD std::byte pad_[sizeof(void*)];
+  };
+
+  static constexpr bool kIsThreadSafe{threading ==
+                                      ObjectPoolThreading::kThreadSafe};
+
+  using Lock = std::conditional_t<kIsThreadSafe, std::mutex, NoLock>;
+
+ public:
+  /**
+   * @brief Creates pool.  Does not allocate till first object allocation.
+   * @param slab_objects_count Objects count per slab.
+   */
+  explicit ObjectPool(std::size_t slab_objects_count =
+                          kDefaultObjectPoolSlabObjectsCount) noexcept
+      : free_slot_{nullptr},
+        slab_{nullptr},
+        slab_objects_count_{std::max(slab_objects_count, std::size_t{1})},
+        stats_{.capacity = 0,
+               .live_objects_count = 0,
+               .slabs_count = 0,
+               .allocations_count = 0,
+               .frees_count = 0},
+        lock_{} {}
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(ObjectPool);
+
+  /**
+   * @brief Releases all slabs.  All objects should be deleted at this point.
+   */
+  ~ObjectPool() noexcept {
+    G3DCHECK(stats_.live_objects_count == 0)
+        << "Object pool destroyed with " << stats_.live_objects_count
+        << " live objects.";
+
+    FreeSlabs();
+  }
+
+  /**
+   * @brief Creates object.  When object constructor throws, slot is returned
+   * to pool and exception is rethrown.
+   * @tparam TArgs Object constructor arguments types.
+   * @param args Object constructor arguments.
+   * @return Object or nullptr when out of memory.
+   */
+  template <typename... TArgs>
+  [[nodiscard]] T* New(TArgs&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, TArgs...>) {
+    Slot* slot;
+    {
+      const std::scoped_lock lock{lock_};
+
+      slot = PopSlots(1U);
+      if (!slot) [[unlikely]] return nullptr;
+
+      ++stats_.allocations_count;
+    }
+
+    if constexpr (std::is_nothrow_constructible_v<T, TArgs...>) {
+      return Construct(slot, std::forward<TArgs>(args)...);
+    } else {
+      try {
+        return Construct(slot, std::forward<TArgs>(args)...);
+      } catch (...) {
+        const std::scoped_lock lock{lock_};
+
+        PushSlots(slot, slot, 1U);
+        --stats_.allocations_count;
+        throw;
+      }
+    }
+  }
+
+  /**
+   * @brief Destroys object.
+   * @param object Object allocated by this pool or nullptr.
+   * @return void.
+   */
+  void Delete(T* object) noexcept {
+    if (!object) [[unlikely]] return;
+
+    Slot* slot{Destroy(object)};
+
+    const std::scoped_lock lock{lock_};
+
+    PushSlots(slot, slot, 1U);
+    ++stats_.frees_count;
+  }
+
+  /**
+   * @brief Releases all objects at once without calling destructors, so only
+   * for trivially destructible objects.  No local caches should exist.
+   * @return void.
+   */
+  void ReleaseAll() noexcept
+    requires std::is_trivially_destructible_v<T>
+  {
+    const std::scoped_lock lock{lock_};
+
+    stats_.frees_count += stats_.live_objects_count;
+    stats_.live_objects_count = 0;
+
+    FreeSlabs();
+  }
+
+  /**
+   * @brief Gets pool stats.
+   * @return Stats.
+   */
+  [[nodiscard]] ObjectPoolStats GetStats() const noexcept {
+    const std::scoped_lock lock{lock_};
+    return stats_;
+  }
+
+  /**
+   * @brief Thread local cache of thread safe pool.  Allocates and frees
+   * without locks and exchanges slots with pool in batches.  Use on single
+   * thread only.
+   */
+  class LocalCache {
+   public:
+    /**
+     * @brief Creates cache.
+     * @param pool Pool to cache.  Should outlive cache.
+     */
+    explicit LocalCache(ObjectPool& pool) noexcept
+      requires kIsThreadSafe
+        : pool_{pool},
+          free_slot_{nullptr},
+          free_slots_count_{0},
+          allocations_count_{0},
+          frees_count_{0} {}
+
+    WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(LocalCache);
+
+    /**
+     * @brief Returns cached slots to pool.
+     */
+    ~LocalCache() noexcept { Flush(free_slots_count_); }
+
+    /**
+     * @brief Creates object.  When object constructor throws, slot is
+     * returned to cache and exception is rethrown.
+     * @tparam TArgs Object constructor arguments types.
+     * @param args Object constructor arguments.
+     * @return Object or nullptr when out of memory.
+     */
+    template <typename... TArgs>
+    [[nodiscard]] T* New(TArgs&&... args) noexcept(
+        std::is_nothrow_constructible_v<T, TArgs...>) {
+      if (!free_slot_) [[unlikely]] {
+        Refill();
+        if (!free_slot_) [[unlikely]] return nullptr;
+      }
+
+      Slot* slot{free_slot_};
+      free_slot_ = slot->next;
+      --free_slots_count_;
+      ++allocations_count_;
+
+      if constexpr (std::is_nothrow_constructible_v<T, TArgs...>) {
+        return Construct(slot, std::forward<TArgs>(args)...);
+      } else {
+        try {
+          return Construct(slot, std::forward<TArgs>(args)...);
+        } catch (...) {
+          slot->next = free_slot_;
+          free_slot_ = slot;
+          ++free_slots_count_;
+          --allocations_count_;
+          throw;
+        }
+      }
+    }
+
+    /**
+     * @brief Destroys object.
+     * @param object Object allocated by cached pool or nullptr.
+     * @return void.
+     */
+    void Delete(T* object) noexcept {
+      if (!object) [[unlikely]] return;
+
+      Slot* slot{Destroy(object)};
+      slot->next = free_slot_;
+      free_slot_ = slot;
+      ++free_slots_count_;
+      ++frees_count_;
+
+      if (free_slots_count_ > kObjectPoolLocalCacheObjectsCount) [[unlikely]] {
+        // Keep half of cache to not bounce slots on alloc / free patterns.
+        Flush(free_slots_count_ - kObjectPoolLocalCacheObjectsCount / 2U);
+      }
+    }
+
+   private:
+    /**
+     * @brief Cached pool.
+     */
+    ObjectPool& pool_;
+    /**
+     * @brief Cached free slots.
+     */
+    Slot* free_slot_;
+    /**
+     * @brief Cached free slots count.
+     */
+    std::size_t free_slots_count_;
+    /**
+     * @brief Allocations not yet reported to pool.
+     */
+    std::uint64_t allocations_count_;
+    /**
+     * @brief Frees not yet reported to pool.
+     */
+    std::uint64_t frees_count_;
+
+    /**
+     * @brief Gets batch of free slots from pool.
+     * @return void.
+     */
+    void Refill() noexcept {
+      constexpr std::size_t kBatchSize{kObjectPoolLocalCacheObjectsCount /
+                                       2U};
+
+      const std::scoped_lock lock{pool_.lock_};
+
+      free_slot_ = pool_.PopSlots(kBatchSize);
+      if (free_slot_) [[likely]] free_slots_count_ = kBatchSize;
+
+      ReportStats();
+    }
+
+    /**
+     * @brief Returns cached free slots to pool.
+     * @param count Slots count to return.
+     * @return void.
+     */
+    void Flush(std::size_t count) noexcept {
+      Slot* first{free_slot_};
+      Slot* last{nullptr};
+      for (std::size_t i{0}; i < count; ++i) {
+        last = free_slot_;
+        free_slot_ = free_slot_->next;
+      }
+      free_slots_count_ -= count;
+
+      const std::scoped_lock lock{pool_.lock_};
+
+      if (last) pool_.PushSlots(first, last, count);
+
+      ReportStats();
+    }
+
+    /**
+     * @brief Reports cache stats to pool.  Pool lock should be held.
+     * @return void.
+     */
+    void ReportStats() noexcept {
+      pool_.stats_.allocations_count += allocations_count_;
+      pool_.stats_.frees_count += frees_count_;
+
+      allocations_count_ = 0;
+      frees_count_ = 0;
+    }
+  };
+
+ private:
+  /**
+   * @brief Free slots list.
+   */
+  Slot* free_slot_;
+  /**
+   * @brief Slabs list.
+   */
+  Slab* slab_;
+  /**
+   * @brief Objects count per slab.
+   */
+  const std::size_t slab_objects_count_;
+  /**
+   * @brief Stats.
+   */
+  ObjectPoolStats stats_;
+  /**
+   * @brief Free list lock.
+   */
+  mutable Lock lock_;
+
+  /**
+   * @brief Constructs object in slot.
+   * @tparam TArgs Object constructor arguments types.
+   * @param slot Slot.
+   * @param args Object constructor arguments.
+   * @return Object.
+   */
+  template <typename... TArgs>
+  [[nodiscard]] static T* Construct(Slot* slot, TArgs&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, TArgs...>) {
+    return ::new (static_cast<void*>(slot->storage))
+        T{std::forward<TArgs>(args)...};
+  }
+
+  /**
+   * @brief Destroys object and poisons its slot in debug builds.
+   * @param object Object.
+   * @return Object slot.
+   */
+  [[nodiscard]] static Slot* Destroy(T* object) noexcept {
+    object->~T();
+
+    auto* slot = reinterpret_cast<Slot*>(object);
+#ifndef NDEBUG
+    std::memset(slot, static_cast<int>(kObjectPoolFreedSlotByte),
+                sizeof(Slot));
+#endif
+    return slot;
+  }
+
+  /**
+   * @brief Pops free slots, allocates new slab when needed.  Lock should be
+   * held.
+   * @param count Slots count.
+   * @return First of count chained slots or nullptr when out of memory.
+   */
+  [[nodiscard]] Slot* PopSlots(std::size_t count) noexcept {
+    Slot* first{nullptr};
+    Slot* last{nullptr};
+    for (std::size_t i{0}; i < count; ++i) {
+      if (!free_slot_ && !AllocateSlab()) [[unlikely]] {
+        // Put back what was popped.
+        if (last) {
+          last->next = free_slot_;
+          free_slot_ = first;
+        }
+        return nullptr;
+      }
+
+      Slot* slot{free_slot_};
+      free_slot_ = slot->next;
+      slot->next = nullptr;
+
+      if (last) {
+        last->next = slot;
+      } else {
+        first = slot;
+      }
+      last = slot;
+    }
+
+    stats_.live_objects_count += count;
+    return first;
+  }
+
+  /**
+   * @brief Pushes chained free slots.  Lock should be held.
+   * @param first First slot.
+   * @param last Last slot.
+   * @param count Slots count.
+   * @return void.
+   */
+  void PushSlots(Slot* first, Slot* last, std::size_t count) noexcept {
+    G3DCHECK(stats_.live_objects_count >= count)
+        << "Object pool received more objects than gave out.";
+
+    last->next = free_slot_;
+    free_slot_ = first;
+    stats_.live_objects_count -= count;
+  }
+
+  /**
+   * @brief Allocates slab and chains its slots into free list.  Lock should
+   * be held.
+   * @return true if allocated, false when out of memory.
+   */
+  [[nodiscard]] bool AllocateSlab() noexcept {
+    const std::size_t size{sizeof(Slab) + sizeof(Slot) * slab_objects_count_};
+    void* memory{::mi_malloc_aligned(size, alignof(Slab))};
+    if (!memory) [[unlikely]] return false;
+
+    slab_ = ::new (memory) Slab{.next = slab_};
+
+    // Chain slots in address order, so objects allocated in a row are dense.
+    auto* slots = reinterpret_cast<Slot*>(slab_ + 1);
+#ifndef NDEBUG
+    std::memset(slots, static_cast<int>(kObjectPoolFreedSlotByte),
+                sizeof(Slot) * slab_objects_count_);
+#endif
+    for (std::size_t i{slab_objects_count_}; i > 0; --i) {
+      slots[i - 1U].next = free_slot_;
+      free_slot_ = &slots[i - 1U];
+    }
+
+    stats_.capacity += slab_objects_count_;
+    ++stats_.slabs_count;
+    return true;
+  }
+
+  /**
+   * @brief Frees all slabs.
+   * @return void.
+   */
+  void FreeSlabs() noexcept {
+    while (slab_) {
+      Slab* next{slab_->next};
+      ::mi_free(slab_);
+      slab_ = next;
+    }
+
+    free_slot_ = nullptr;
+    stats_.capacity = 0;
+    stats_.slabs_count = 0;
+  }
+};
+
+}  // namespace wb::base::memory
+
+#endif  // !WB_BASE_MEMORY_OBJECT_POOL_H_
@@ -0,0 +1,105 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Benchmarks for fixed size object pool vs general purpose allocator.
+
+#include "object_pool.h"
+//
+#include <cstdint>
+#include <vector>
+
+#include "base/deps/benchmark/benchmark.h"
+
+namespace {
+
+/**
+ * @brief Benchmark object, input event sized.
+ */
+struct Event {
+  /**
+   * @brief Event time.
+   */
+  std::uint64_t time;
+  /**
+   * @brief Event payload.
+   */
+  std::uint64_t payload[5]{};
+};
+
+}  // namespace
+
+void BM_ObjectPoolNewDelete(benchmark::State& state) {
+  using namespace wb::base::memory;
+
+  // Objects churned per frame.
+  const auto objects_count{static_cast<std::size_t>(state.range(0))};
+  ObjectPool<Event> pool;
+  std::vector<Event*> events(objects_count);
+
+  for ([[maybe_unused]] auto _ : state) {
+    for (std::size_t i{0}; i < objects_count; ++i) {
+      events[i] = pool.New(i);
+    }
+    for (Event* event : events) {
+      benchmark::DoNotOptimize(event->time);
+      pool.Delete(event);
+    }
+  }
+
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          state.range(0));
+}
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+BENCHMARK(BM_ObjectPoolNewDelete)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_ObjectPoolLocalCacheNewDelete(benchmark::State& state) {
+  using namespace wb::base::memory;
+
+  using EventPool = ObjectPool<Event, ObjectPoolThreading::kThreadSafe>;
+
+  const auto objects_count{static_cast<std::size_t>(state.range(0))};
+  EventPool pool;
+  std::vector<Event*> events(objects_count);
+
+  {
+    EventPool::LocalCache cache{pool};
+
+    for ([[maybe_unused]] auto _ : state) {
+      for (std::size_t i{0}; i < objects_count; ++i) {
+        events[i] = cache.New(i);
+      }
+      for (Event* event : events) {
+        benchmark::DoNotOptimize(event->time);
+        cache.Delete(event);
+      }
+    }
+  }
+
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          state.range(0));
+}
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+BENCHMARK(BM_ObjectPoolLocalCacheNewDelete)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_GlobalNewDelete(benchmark::State& state) {
+  const auto objects_count{static_cast<std::size_t>(state.range(0))};
+  std::vector<Event*> events(objects_count);
+
+  for ([[maybe_unused]] auto _ : state) {
+    for (std::size_t i{0}; i < objects_count; ++i) {
+      // NOLINTNEXTLINE(cppcoreguidelines-owning-memory): Benchmark baseline.
+      events[i] = new Event{i};
+    }
+    for (Event* event : events) {
+      benchmark::DoNotOptimize(event->time);
+      // NOLINTNEXTLINE(cppcoreguidelines-owning-memory): Benchmark baseline.
+      delete event;
+    }
+  }
+
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          state.range(0));
+}
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+BENCHMARK(BM_GlobalNewDelete)->RangeMultiplier(8)->Range(8, 4096);
@@ -0,0 +1,234 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Fixed size object pool.
+
+#include "object_pool.h"
+//
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/deps/googletest/gtest/gtest.h"
+
+namespace {
+
+/**
+ * @brief Test entity.
+ */
+struct Entity {
+  /**
+   * @brief Entity id.
+   */
+  std::uint64_t id;
+  /**
+   * @brief Entity name.
+   */
+  std::string name;
+};
+
+/**
+ * @brief Test packet.
+ */
+struct Packet {
+  /**
+   * @brief Packet sequence number.
+   */
+  std::uint32_t sequence;
+  /**
+   * @brief Packet payload.
+   */
+  std::byte payload[60]{};
+};
+
+/**
+ * @brief Test object which constructor throws on request.
+ */
+struct ThrowingObject {
+  /**
+   * @brief Creates object.
+   * @param should_throw Should constructor throw.
+   */
+  explicit ThrowingObject(bool should_throw) : value{42U} {
+    if (should_throw) throw std::runtime_error{"ThrowingObject"};
+  }
+
+  /**
+   * @brief Value.
+   */
+  std::uint64_t value;
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ObjectPoolTest, NewDeleteReusesSlots) {
+  using namespace wb::base::memory;
+
+  ObjectPool<Entity> pool{4U};
+
+  Entity* first{pool.New(1U, std::string{"first"})};
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(1U, first->id);
+  EXPECT_EQ("first", first->name);
+
+  Entity* second{pool.New(2U, std::string{"second"})};
+  ASSERT_NE(nullptr, second);
+  // Dense, in address order.
+  EXPECT_LT(static_cast<void*>(first), static_cast<void*>(second));
+
+  pool.Delete(first);
+  // Last freed slot is reused first.
+  EXPECT_EQ(first, pool.New(3U, std::string{"third"}));
+
+  pool.Delete(first);
+  pool.Delete(second);
+  pool.Delete(nullptr);
+
+  const ObjectPoolStats stats{pool.GetStats()};
+  EXPECT_EQ(4U, stats.capacity);
+  EXPECT_EQ(0U, stats.live_objects_count);
+  EXPECT_EQ(1U, stats.slabs_count);
+  EXPECT_EQ(3U, stats.allocations_count);
+  EXPECT_EQ(3U, stats.frees_count);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ObjectPoolTest, GrowsBySlabs) {
+  using namespace wb::base::memory;
+
+  ObjectPool<Packet> pool{8U};
+
+  std::vector<Packet*> packets;
+  for (std::uint32_t i{0}; i < 20U; ++i) {
+    Packet* packet{pool.New(i)};
+    ASSERT_NE(nullptr, packet);
+    EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(packet) % alignof(Packet));
+    packets.push_back(packet);
+  }
+
+  for (std::uint32_t i{0}; i < 20U; ++i) {
+    EXPECT_EQ(i, packets[i]->sequence);
+  }
+
+  ObjectPoolStats stats{pool.GetStats()};
+  EXPECT_EQ(24U, stats.capacity);
+  EXPECT_EQ(20U, stats.live_objects_count);
+  EXPECT_EQ(3U, stats.slabs_count);
+
+  pool.ReleaseAll();
+
+  stats = pool.GetStats();
+  EXPECT_EQ(0U, stats.capacity);
+  EXPECT_EQ(0U, stats.live_objects_count);
+  EXPECT_EQ(0U, stats.slabs_count);
+  EXPECT_EQ(20U, stats.frees_count);
+
+  // Usable after release.
+  Packet* packet{pool.New(42U)};
+  ASSERT_NE(nullptr, packet);
+  EXPECT_EQ(42U, packet->sequence);
+  pool.Delete(packet);
+}
+
+#ifndef NDEBUG
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ObjectPoolTest, PoisonsFreedSlotsInDebug) {
+  using namespace wb::base::memory;
+
+  ObjectPool<Packet> pool{2U};
+
+  Packet* packet{pool.New(7U)};
+  ASSERT_NE(nullptr, packet);
+  pool.Delete(packet);
+
+  // Slot start holds free list link, the rest is poisoned.
+  const auto* bytes = reinterpret_cast<const std::byte*>(packet);
+  for (std::size_t i{sizeof(void*)}; i < sizeof(Packet); ++i) {
+    EXPECT_EQ(kObjectPoolFreedSlotByte, bytes[i]) << "Byte " << i;
+  }
+}
+#endif
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ObjectPoolTest, LocalCachesShareThreadSafePool) {
+  using namespace wb::base::memory;
+
+  using PacketPool = ObjectPool<Packet, ObjectPoolThreading::kThreadSafe>;
+  PacketPool pool{32U};
+
+  constexpr std::uint32_t kPacketsCount{1000U};
+  const auto worker = [&pool]() {
+    PacketPool::LocalCache cache{pool};
+    std::vector<Packet*> packets;
+
+    for (int round{0}; round < 4; ++round) {
+      for (std::uint32_t i{0}; i < kPacketsCount; ++i) {
+        Packet* packet{cache.New(i)};
+        ASSERT_NE(nullptr, packet);
+        packets.push_back(packet);
+      }
+
+      for (std::uint32_t i{0}; i < kPacketsCount; ++i) {
+        ASSERT_EQ(i, packets[i]->sequence);
+        cache.Delete(packets[i]);
+      }
+      packets.clear();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i{0}; i < 4; ++i) threads.emplace_back(worker);
+  for (auto& thread : threads) thread.join();
+
+  const ObjectPoolStats stats{pool.GetStats()};
+  EXPECT_EQ(0U, stats.live_objects_count);
+  EXPECT_EQ(4U * 4U * kPacketsCount, stats.allocations_count);
+  EXPECT_EQ(4U * 4U * kPacketsCount, stats.frees_count);
+  EXPECT_GE(stats.capacity, kPacketsCount);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ObjectPoolTest, ThrowingConstructorReturnsSlot) {
+  using namespace wb::base::memory;
+
+  using ThrowingObjectPool =
+      ObjectPool<ThrowingObject, ObjectPoolThreading::kThreadSafe>;
+
+  ThrowingObjectPool pool{4U};
+
+  ThrowingObject* object{pool.New(false)};
+  ASSERT_NE(nullptr, object);
+  pool.Delete(object);
+
+  EXPECT_THROW(static_cast<void>(pool.New(true)), std::runtime_error);
+
+  ObjectPoolStats stats{pool.GetStats()};
+  EXPECT_EQ(0U, stats.live_objects_count);
+  EXPECT_EQ(1U, stats.allocations_count);
+
+  // Slot is reused.
+  EXPECT_EQ(object, pool.New(false));
+  pool.Delete(object);
+
+  {
+    ThrowingObjectPool::LocalCache cache{pool};
+
+    ThrowingObject* cached{cache.New(false)};
+    ASSERT_NE(nullptr, cached);
+    cache.Delete(cached);
+
+    EXPECT_THROW(static_cast<void>(cache.New(true)), std::runtime_error);
+    // Slot is back in cache.
+    EXPECT_EQ(cached, cache.New(false));
+    cache.Delete(cached);
+  }
+
+  stats = pool.GetStats();
+  EXPECT_EQ(0U, stats.live_objects_count);
+  EXPECT_EQ(4U, stats.allocations_count);
+  EXPECT_EQ(4U, stats.frees_count);
+}
@@ -0,0 +1,208 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Named mimalloc heap per subsystem.
+
+#include "subsystem_heap.h"
+
+#include "base/deps/g3log/g3log.h"
+#include "base/deps/mimalloc/mimalloc.h"
+
+#ifdef WB_MEMORY_ALLOCATION_HOOKS
+#include <atomic>
+#include <cstdint>
+
+#include "base/memory/allocation_hooks.h"
+#include "base/memory/allocation_stats.h"
+#include "base/memory/heap_profiler.h"
+#endif
+
+namespace {
+
+/**
+ * @brief Accumulates heap area into stats.
+ * @param area Heap area.
+ * @param arg Stats.
+ * @return true to continue visiting.
+ */
+bool AccumulateHeapAreaStats(const mi_heap_t*, const mi_heap_area_t* area,
+                             void*, std::size_t, void* arg) noexcept {
+  auto* stats = static_cast<wb::base::memory::SubsystemHeapStats*>(arg);
+
+  stats->committed_bytes += area->committed;
+  stats->used_bytes += area->used * area->block_size;
+  stats->blocks_count += area->used;
+  return true;
+}
+
+#ifdef WB_MEMORY_ALLOCATION_HOOKS
+/**
+ * @brief Accounts heap block allocation like new / delete overrides do.
+ * @param p Allocated memory.
+ * @return void.
+ */
+void OnHeapBlockAllocated(void* p) noexcept {
+  using namespace wb::base::memory::internal;
+
+  const std::uint32_t hooks{
+      enabled_allocation_hooks.load(std::memory_order_relaxed)};
+  if (p && hooks != 0U) [[unlikely]] {
+    const std::size_t size{::mi_usable_size(p)};
+
+    if (HasAllocationHook(hooks, AllocationHooks::kAllocationStats)) {
+      OnAllocation(size);
+    }
+    if (HasAllocationHook(hooks, AllocationHooks::kHeapProfiler)) {
+      OnHeapProfilerAllocation(p, size);
+    }
+  }
+}
+
+/**
+ * @brief Accounts heap block free like delete override does.
+ * @param p Memory to free.
+ * @param hooks Enabled allocation hooks.
+ * @return void.
+ */
+void OnHeapBlockFreed(void* p, std::uint32_t hooks) noexcept {
+  using namespace wb::base::memory::internal;
+
+  if (HasAllocationHook(hooks, AllocationHooks::kAllocationStats)) {
+    OnFree(::mi_usable_size(p));
+  }
+  if (HasAllocationHook(hooks, AllocationHooks::kHeapProfiler)) {
+    OnHeapProfilerFree(p);
+  }
+}
+
+/**
+ * @brief Accounts heap block free, so blocks released at once do not stay
+ * live in allocation stats and heap profiler.
+ * @param block Heap block or nullptr for area itself.
+ * @param arg Enabled allocation hooks.
+ * @return true to continue visiting.
+ */
+bool OnHeapBlockReleased(const mi_heap_t*, const mi_heap_area_t*,
+                         void* block, std::size_t, void* arg) noexcept {
+  if (block) OnHeapBlockFreed(block, *static_cast<const std::uint32_t*>(arg));
+  return true;
+}
+#endif
+
+}  // namespace
+
+namespace wb::base::memory {
+
+[[nodiscard]] WB_BASE_API std2::result<SubsystemHeap> SubsystemHeap::New(
+    const char* name) noexcept {
+  G3DCHECK(!!name);
+
+  mi_heap_t* heap{::mi_heap_new()};
+  if (!heap) [[unlikely]] {
+    return std2::result<SubsystemHeap>{std::unexpect,
+                                       std2::posix_last_error_code(ENOMEM)};
+  }
+
+  return std2::result<SubsystemHeap>{SubsystemHeap{heap, name}};
+}
+
+WB_BASE_API SubsystemHeap::SubsystemHeap(mi_heap_t* heap,
+                                         const char* name) noexcept
+    : heap_{heap}, name_{name}, owner_thread_id_{std::this_thread::get_id()} {
+  G3DCHECK(!!heap_);
+}
+
+WB_BASE_API SubsystemHeap::SubsystemHeap(SubsystemHeap&& h) noexcept
+    : heap_{std::exchange(h.heap_, nullptr)},
+      name_{h.name_},
+      owner_thread_id_{h.owner_thread_id_} {}
+
+WB_BASE_API SubsystemHeap::~SubsystemHeap() noexcept {
+  if (!heap_) return;
+
+  G3DCHECK(std::this_thread::get_id() == owner_thread_id_)
+      << "Heap " << name_ << " should be deleted on owner thread.";
+  G3DCHECK(::mi_heap_get_default() != heap_)
+      << "Heap " << name_ << " should not be current when deleted.";
+
+  ::mi_heap_delete(heap_);
+}
+
+[[nodiscard]] WB_BASE_API std::error_code SubsystemHeap::ReleaseAll() noexcept {
+  G3DCHECK(!!heap_);
+  G3DCHECK(std::this_thread::get_id() == owner_thread_id_)
+      << "Heap " << name_ << " should be released on owner thread.";
+  G3DCHECK(::mi_heap_get_default() != heap_)
+      << "Heap " << name_ << " should not be current when released.";
+
+#ifdef WB_MEMORY_ALLOCATION_HOOKS
+  // mi_heap_destroy bypasses delete, so account live blocks frees here.  Walks
+  // heap only when some hook is enabled.
+  std::uint32_t hooks{
+      internal::enabled_allocation_hooks.load(std::memory_order_relaxed)};
+  if (hooks != 0U) [[unlikely]] {
+    ::mi_heap_visit_blocks(heap_, true, &OnHeapBlockReleased, &hooks);
+  }
+#endif
+
+  ::mi_heap_destroy(heap_);
+
+  heap_ = ::mi_heap_new();
+  return heap_ ? std2::ok_code : std2::posix_last_error_code(ENOMEM);
+}
+
+[[nodiscard]] WB_BASE_API void* SubsystemHeap::Allocate(
+    std::size_t size, std::size_t alignment) noexcept {
+  G3DCHECK(!!heap_);
+  G3DCHECK(std::this_thread::get_id() == owner_thread_id_)
+      << "Heap " << name_ << " should be allocated from on owner thread.";
+
+  void* memory{::mi_heap_malloc_aligned(heap_, size, alignment)};
+#ifdef WB_MEMORY_ALLOCATION_HOOKS
+  // Accounted like operator new, so ReleaseAll frees are balanced.
+  OnHeapBlockAllocated(memory);
+#endif
+  return memory;
+}
+
+WB_BASE_API void SubsystemHeap::Free(void* memory) noexcept {
+#ifdef WB_MEMORY_ALLOCATION_HOOKS
+  const std::uint32_t hooks{
+      internal::enabled_allocation_hooks.load(std::memory_order_relaxed)};
+  if (memory && hooks != 0U) [[unlikely]] OnHeapBlockFreed(memory, hooks);
+#endif
+
+  ::mi_free(memory);
+}
+
+[[nodiscard]] WB_BASE_API bool SubsystemHeap::Owns(
+    const void* memory) const noexcept {
+  return heap_ && ::mi_heap_check_owned(heap_, memory);
+}
+
+[[nodiscard]] WB_BASE_API SubsystemHeapStats
+SubsystemHeap::GetStats() const noexcept {
+  SubsystemHeapStats stats{
+      .committed_bytes = 0, .used_bytes = 0, .blocks_count = 0};
+
+  if (heap_) {
+    ::mi_heap_visit_blocks(heap_, false, &AccumulateHeapAreaStats, &stats);
+  }
+  return stats;
+}
+
+WB_BASE_API ScopedCurrentHeap::ScopedCurrentHeap(SubsystemHeap& heap) noexcept
+    : previous_heap_{nullptr} {
+  G3DCHECK(!!heap.heap_);
+  G3DCHECK(std::this_thread::get_id() == heap.owner_thread_id_)
+      << "Heap " << heap.name_ << " should be current on owner thread only.";
+
+  previous_heap_ = ::mi_heap_set_default(heap.heap_);
+}
+
+WB_BASE_API ScopedCurrentHeap::~ScopedCurrentHeap() noexcept {
+  ::mi_heap_set_default(previous_heap_);
+}
+
+}  // namespace wb::base::memory
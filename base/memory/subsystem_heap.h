@@ -0,0 +1,183 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Named mimalloc heap per subsystem (assets, simulation, UI, intl, etc.).
+// Subsystem allocations stay together, which improves locality, and whole
+// subsystem memory can be released at once on teardown instead of millions of
+// frees.
+//
+// Usage example:
+//
+// auto assets_heap = SubsystemHeap::New("Assets");
+// ...
+// {
+//   // All operator new calls on this thread go to assets heap.
+//   const ScopedCurrentHeap scoped_current_heap{*assets_heap};
+//   LoadLevelAssets(level);
+// }
+// ...
+// // Level unload, assets are trivially destructible.
+// const std::error_code rc{assets_heap->ReleaseAll()};
+
+#ifndef WB_BASE_MEMORY_SUBSYSTEM_HEAP_H_
+#define WB_BASE_MEMORY_SUBSYSTEM_HEAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "base/config.h"
+#include "base/macroses.h"
+#include "base/std2/system_error_ext.h"
+
+extern "C" {
+struct mi_heap_s;
+}
+
+namespace wb::base::memory {
+
+/**
+ * @brief Subsystem heap stats.
+ */
+struct SubsystemHeapStats {
+  /**
+   * @brief Heap committed bytes.
+   */
+  std::uint64_t committed_bytes;
+  /**
+   * @brief Heap bytes in live blocks.
+   */
+  std::uint64_t used_bytes;
+  /**
+   * @brief Heap live blocks count.
+   */
+  std::uint64_t blocks_count;
+};
+
+/**
+ * @brief Named mimalloc heap.  mimalloc heaps are thread local, so heap
+ * should be allocated from on thread which created it only.  Memory from heap
+ * can be freed on any thread.
+ */
+class WB_BASE_API SubsystemHeap {
+ public:
+  /**
+   * @brief Creates subsystem heap owned by current thread.
+   * @param name Heap name.  Should outlive heap.
+   * @return Subsystem heap or ENOMEM error.
+   */
+  [[nodiscard]] static std2::result<SubsystemHeap> New(
+      const char* name) noexcept;
+
+  SubsystemHeap(SubsystemHeap&& h) noexcept;
+  SubsystemHeap& operator=(SubsystemHeap&&) noexcept = delete;
+
+  WB_NO_COPY_CTOR_AND_ASSIGNMENT(SubsystemHeap);
+
+  /**
+   * @brief Deletes heap.  Live blocks are not freed, but moved to owner thread
+   * default heap.
+   */
+  ~SubsystemHeap() noexcept;
+
+  /**
+   * @brief Frees all heap blocks at once.  Destructors are not called, so
+   * only for trivially destructible objects or ones which own heap memory
+   * only.  Heap should not be current on owner thread.  When allocation
+   * stats or heap profiling are enabled, walks live blocks to account their
+   * frees, so release is slower.
+   * @return Error code.
+   */
+  [[nodiscard]] std::error_code ReleaseAll() noexcept;
+
+  /**
+   * @brief Allocates memory from heap.  Call on owner thread only.  Accounted
+   * in allocation stats and heap profiler like operator new.
+   * @param size Size.
+   * @param alignment Alignment, power of 2.
+   * @return Memory or nullptr when out of memory.  Free with Free.
+   */
+  [[nodiscard]] void* Allocate(std::size_t size,
+                               std::size_t alignment) noexcept;
+
+  /**
+   * @brief Frees memory allocated by Allocate.  Can be called on any thread.
+   * Accounted in allocation stats and heap profiler like operator delete.
+   * @param memory Memory or nullptr.
+   * @return void.
+   */
+  static void Free(void* memory) noexcept;
+
+  /**
+   * @brief Is memory allocated from this heap?
+   * @param memory Memory.
+   * @return true if memory is in heap, false otherwise.
+   */
+  [[nodiscard]] bool Owns(const void* memory) const noexcept;
+
+  /**
+   * @brief Gets heap stats.  Walks heap pages, so not for hot paths.
+   * @return Heap stats.
+   */
+  [[nodiscard]] SubsystemHeapStats GetStats() const noexcept;
+
+  /**
+   * @brief Gets heap name.
+   * @return Heap name.
+   */
+  [[nodiscard]] const char* name() const noexcept { return name_; }
+
+ private:
+  friend class ScopedCurrentHeap;
+
+  /**
+   * @brief mimalloc heap.
+   */
+  mi_heap_s* heap_;
+  /**
+   * @brief Heap name.
+   */
+  const char* name_;
+  /**
+   * @brief Thread which owns heap.
+   */
+  std::thread::id owner_thread_id_;
+
+  /**
+   * @brief Creates subsystem heap.
+   * @param heap mimalloc heap.
+   * @param name Heap name.
+   */
+  SubsystemHeap(mi_heap_s* heap, const char* name) noexcept;
+};
+
+/**
+ * @brief Routes current thread operator new / malloc to subsystem heap in
+ * scope.  Scopes can be nested.
+ */
+class WB_BASE_API ScopedCurrentHeap {
+ public:
+  /**
+   * @brief Makes subsystem heap current thread default.
+   * @param heap Subsystem heap owned by current thread.
+   */
+  explicit ScopedCurrentHeap(SubsystemHeap& heap) noexcept;
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(ScopedCurrentHeap);
+
+  /**
+   * @brief Restores previous current thread default heap.
+   */
+  ~ScopedCurrentHeap() noexcept;
+
+ private:
+  /**
+   * @brief Previous current thread default heap.
+   */
+  mi_heap_s* previous_heap_;
+};
+
+}  // namespace wb::base::memory
+
+#endif  // !WB_BASE_MEMORY_SUBSYSTEM_HEAP_H_
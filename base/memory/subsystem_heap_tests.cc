@@ -0,0 +1,153 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Named mimalloc heap per subsystem.
+
+#include "subsystem_heap.h"
+//
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/deps/googletest/gtest/gtest.h"
+#include "base/memory/allocation_stats.h"
+#include "base/memory/heap_profiler.h"
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SubsystemHeapTest, ScopedCurrentHeapRoutesNew) {
+  using namespace wb::base::memory;
+
+  auto assets_heap = SubsystemHeap::New("Assets");
+  ASSERT_TRUE(assets_heap.has_value());
+  EXPECT_STREQ("Assets", assets_heap->name());
+
+  auto ui_heap = SubsystemHeap::New("UI");
+  ASSERT_TRUE(ui_heap.has_value());
+
+  std::unique_ptr<int> asset, ui, other;
+  {
+    const ScopedCurrentHeap scoped_assets_heap{*assets_heap};
+    asset = std::make_unique<int>(1);
+
+    {
+      const ScopedCurrentHeap scoped_ui_heap{*ui_heap};
+      ui = std::make_unique<int>(2);
+    }
+
+    other = std::make_unique<int>(3);
+  }
+  auto outside = std::make_unique<int>(4);
+
+  EXPECT_TRUE(assets_heap->Owns(asset.get()));
+  EXPECT_TRUE(assets_heap->Owns(other.get()));
+  EXPECT_FALSE(assets_heap->Owns(ui.get()));
+  EXPECT_TRUE(ui_heap->Owns(ui.get()));
+  EXPECT_FALSE(assets_heap->Owns(outside.get()));
+  EXPECT_FALSE(ui_heap->Owns(outside.get()));
+
+  const SubsystemHeapStats stats{assets_heap->GetStats()};
+  EXPECT_EQ(2U, stats.blocks_count);
+  EXPECT_GE(stats.used_bytes, 2U * sizeof(int));
+  EXPECT_GE(stats.committed_bytes, stats.used_bytes);
+
+  // Freed on any heap.
+  asset.reset();
+  ui.reset();
+  EXPECT_EQ(1U, assets_heap->GetStats().blocks_count);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SubsystemHeapTest, ReleaseAllFreesAtOnce) {
+  using namespace wb::base::memory;
+
+  auto simulation_heap = SubsystemHeap::New("Simulation");
+  ASSERT_TRUE(simulation_heap.has_value());
+
+  // Reserve outside of heap scope, so blocks vector survives release.
+  std::vector<std::byte*> blocks;
+  blocks.reserve(1000U);
+  {
+    const ScopedCurrentHeap scoped_simulation_heap{*simulation_heap};
+    for (int i{0}; i < 1000; ++i) blocks.push_back(new std::byte[64]);
+  }
+
+  EXPECT_EQ(1000U, simulation_heap->GetStats().blocks_count);
+
+  // Teardown without 1000 deletes.
+  EXPECT_EQ(wb::base::std2::ok_code, simulation_heap->ReleaseAll());
+  EXPECT_EQ(0U, simulation_heap->GetStats().blocks_count);
+
+  // Heap is usable after release.
+  {
+    const ScopedCurrentHeap scoped_simulation_heap{*simulation_heap};
+    auto block = std::make_unique<std::string>(64, 'x');
+    EXPECT_TRUE(simulation_heap->Owns(block.get()));
+  }
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SubsystemHeapTest, ReleaseAllAccountsFrees) {
+  using namespace wb::base::memory;
+
+  constexpr std::size_t kBlockSize{4096U};
+  constexpr std::size_t kBlocksCount{128U};
+
+  auto assets_heap = SubsystemHeap::New("Assets");
+  ASSERT_TRUE(assets_heap.has_value());
+
+  // Reserve outside of heap scope, so blocks vector survives release.
+  std::vector<void*> blocks;
+  blocks.reserve(kBlocksCount);
+
+  EnableAllocationStats();
+  // Mean interval is far less than block size, so each block is sampled.
+  EnableHeapProfiling(64U);
+
+  {
+    const ScopedCurrentHeap scoped_assets_heap{*assets_heap};
+    for (std::size_t i{0}; i < kBlocksCount / 2; ++i) {
+      blocks.push_back(new std::byte[kBlockSize]);
+    }
+  }
+  for (std::size_t i{0}; i < kBlocksCount / 2; ++i) {
+    blocks.push_back(assets_heap->Allocate(kBlockSize, alignof(int)));
+    ASSERT_NE(nullptr, blocks.back());
+  }
+
+  const HeapProfilerStats allocated_profile{GetHeapProfilerStats()};
+  ASSERT_GE(allocated_profile.live_samples_count, kBlocksCount);
+
+  const ThreadAllocationStats allocated_stats{GetThreadAllocationStats()};
+
+  EXPECT_EQ(wb::base::std2::ok_code, assets_heap->ReleaseAll());
+
+  // Blocks released at once are not live anymore.
+  const ThreadAllocationStats released_stats{GetThreadAllocationStats()};
+  EXPECT_GE(released_stats.frees_count,
+            allocated_stats.frees_count + kBlocksCount);
+  EXPECT_GE(released_stats.freed_bytes,
+            allocated_stats.freed_bytes + kBlocksCount * kBlockSize);
+
+  const HeapProfilerStats released_profile{GetHeapProfilerStats()};
+  EXPECT_LE(released_profile.live_samples_count,
+            allocated_profile.live_samples_count - kBlocksCount);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SubsystemHeapTest, DeleteKeepsLiveBlocks) {
+  using namespace wb::base::memory;
+
+  std::unique_ptr<int> survivor;
+  {
+    auto intl_heap = SubsystemHeap::New("Intl");
+    ASSERT_TRUE(intl_heap.has_value());
+
+    const ScopedCurrentHeap scoped_intl_heap{*intl_heap};
+    survivor = std::make_unique<int>(42);
+  }
+
+  // Moved to default heap, still valid.
+  EXPECT_EQ(42, *survivor);
+}
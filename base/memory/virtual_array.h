@@ -0,0 +1,285 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Growable array over reserved virtual memory.  Max capacity is reserved up
+// front and pages are committed on growth, so elements never move: addresses
+// are stable and growth never copies.  For large growing tables, ex. entity
+// storage and asset registries.
+//
+// Usage example:
+//
+// auto entities = VirtualArray<Entity>::New(1'000'000);
+// ...
+// Entity* entity{entities->EmplaceBack(entity_id)};
+// if (!entity) { /* Out of reserved range or memory. */ }
+
+#ifndef WB_BASE_MEMORY_VIRTUAL_ARRAY_H_
+#define WB_BASE_MEMORY_VIRTUAL_ARRAY_H_
+
+#include <algorithm>
+#include <cerrno>  // EINVAL.
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "base/deps/g3log/g3log.h"
+#include "base/macroses.h"
+#include "base/memory/virtual_memory.h"
+#include "base/std2/system_error_ext.h"
+
+namespace wb::base::memory {
+
+/**
+ * @brief Min bytes committed per virtual array growth, so commit syscalls are
+ * amortized.
+ */
+inline constexpr std::size_t kVirtualArrayMinCommitSize{64U * 1024U};
+
+/**
+ * @brief Growable array with stable element addresses.  Not thread safe.
+ * @tparam T Element type.
+ */
+template <typename T>
+class VirtualArray {
+ public:
+  /**
+   * @brief Creates array.  Reserves address space for max size, commits
+   * nothing.
+   * @param max_size Max elements count.
+   * @return Array or error.
+   */
+  [[nodiscard]] static std2::result<VirtualArray> New(
+      std::size_t max_size) noexcept {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "Over-aligned elements are not supported.");
+
+    if (max_size == 0 ||
+        max_size > std::numeric_limits<std::size_t>::max() / sizeof(T))
+        [[unlikely]] {
+      return std2::result<VirtualArray>{std::unexpect,
+                                        std2::posix_last_error_code(EINVAL)};
+    }
+
+    auto memory = VirtualMemory::Reserve(max_size * sizeof(T));
+    if (!memory.has_value()) [[unlikely]] {
+      return std2::result<VirtualArray>{std::unexpect, memory.error()};
+    }
+
+    return std2::result<VirtualArray>{
+        VirtualArray{std::move(*memory), max_size}};
+  }
+
+  VirtualArray(VirtualArray&& a) noexcept
+      : memory_{std::move(a.memory_)},
+        max_size_{a.max_size_},
+        size_{std::exchange(a.size_, 0U)},
+        committed_size_{std::exchange(a.committed_size_, 0U)} {}
+  VirtualArray& operator=(VirtualArray&&) noexcept = delete;
+
+  WB_NO_COPY_CTOR_AND_ASSIGNMENT(VirtualArray);
+
+  /**
+   * @brief Destroys elements and releases memory.
+   */
+  ~VirtualArray() noexcept { Clear(); }
+
+  /**
+   * @brief Creates element at end.
+   * @tparam Args Element constructor arguments.
+   * @param args Element constructor arguments.
+   * @return Element or nullptr when max size is reached or out of memory.
+   */
+  template <typename... Args>
+  [[nodiscard]] T* EmplaceBack(Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, Args...>) {
+    if (size_ == committed_size_ && !Grow(size_ + 1)) [[unlikely]] {
+      return nullptr;
+    }
+
+    T* element{std::construct_at(data() + size_, std::forward<Args>(args)...)};
+    ++size_;
+    return element;
+  }
+
+  /**
+   * @brief Destroys last element.
+   * @return void.
+   */
+  void PopBack() noexcept {
+    G3DCHECK(size_ > 0U);
+
+    std::destroy_at(data() + --size_);
+  }
+
+  /**
+   * @brief Commits memory for elements count up front.
+   * @param size Elements count.
+   * @return true if committed, false when over max size or out of memory.
+   */
+  [[nodiscard]] bool Reserve(std::size_t size) noexcept {
+    return size <= committed_size_ || Grow(size);
+  }
+
+  /**
+   * @brief Destroys all elements.  Memory stays committed for reuse.
+   * @return void.
+   */
+  void Clear() noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      std::destroy_n(data(), size_);
+    }
+    size_ = 0U;
+  }
+
+  /**
+   * @brief Destroys all elements and returns committed memory to OS.
+   * @return Error code.
+   */
+  [[nodiscard]] std::error_code ShrinkToZero() noexcept {
+    Clear();
+
+    const std::size_t committed_bytes{CommittedBytes(committed_size_)};
+    if (committed_bytes == 0U) return std2::ok_code;
+
+    const std::error_code rc{memory_.Decommit(0U, committed_bytes)};
+    if (!rc) [[likely]] committed_size_ = 0U;
+    return rc;
+  }
+
+  [[nodiscard]] T& operator[](std::size_t index) noexcept {
+    G3DCHECK(index < size_);
+    return data()[index];
+  }
+
+  [[nodiscard]] const T& operator[](std::size_t index) const noexcept {
+    G3DCHECK(index < size_);
+    return data()[index];
+  }
+
+  [[nodiscard]] T* data() noexcept {
+    return reinterpret_cast<T*>(memory_.data());
+  }
+
+  [[nodiscard]] const T* data() const noexcept {
+    return reinterpret_cast<const T*>(memory_.data());
+  }
+
+  [[nodiscard]] T* begin() noexcept { return data(); }
+  [[nodiscard]] T* end() noexcept { return data() + size_; }
+  [[nodiscard]] const T* begin() const noexcept { return data(); }
+  [[nodiscard]] const T* end() const noexcept { return data() + size_; }
+
+  /**
+   * @brief Gets elements.
+   * @return Elements.
+   */
+  [[nodiscard]] std::span<T> values() noexcept { return {data(), size_}; }
+
+  /**
+   * @brief Gets elements.
+   * @return Elements.
+   */
+  [[nodiscard]] std::span<const T> values() const noexcept {
+    return {data(), size_};
+  }
+
+  /**
+   * @brief Gets elements count.
+   * @return Elements count.
+   */
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+  /**
+   * @brief Is array empty?
+   * @return true if no elements.
+   */
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0U; }
+
+  /**
+   * @brief Gets elements count array holds without committing memory.
+   * @return Committed elements count.
+   */
+  [[nodiscard]] std::size_t capacity() const noexcept {
+    return committed_size_;
+  }
+
+  /**
+   * @brief Gets max elements count.
+   * @return Max elements count.
+   */
+  [[nodiscard]] std::size_t max_size() const noexcept { return max_size_; }
+
+ private:
+  /**
+   * @brief Reserved memory.
+   */
+  VirtualMemory memory_;
+  /**
+   * @brief Max elements count.
+   */
+  std::size_t max_size_;
+  /**
+   * @brief Elements count.
+   */
+  std::size_t size_;
+  /**
+   * @brief Committed elements count.
+   */
+  std::size_t committed_size_;
+
+  /**
+   * @brief Creates array.
+   * @param memory Reserved memory.
+   * @param max_size Max elements count.
+   */
+  VirtualArray(VirtualMemory&& memory, std::size_t max_size) noexcept
+      : memory_{std::move(memory)},
+        max_size_{max_size},
+        size_{0U},
+        committed_size_{0U} {}
+
+  /**
+   * @brief Gets page aligned bytes for elements count.
+   * @param size Elements count.
+   * @return Page aligned bytes.
+   */
+  [[nodiscard]] static std::size_t CommittedBytes(std::size_t size) noexcept {
+    const std::size_t page_size{VirtualMemory::GetPageSize()};
+    return (size * sizeof(T) + page_size - 1) & ~(page_size - 1);
+  }
+
+  /**
+   * @brief Commits memory for at least elements count.
+   * @param size Elements count.
+   * @return true if committed, false when over max size or out of memory.
+   */
+  [[nodiscard]] bool Grow(std::size_t size) noexcept {
+    if (size > max_size_) [[unlikely]] return false;
+
+    const std::size_t committed_bytes{CommittedBytes(committed_size_)};
+    // Geometric growth, so commits count is logarithmic.
+    const std::size_t new_committed_bytes{std::min(
+        memory_.size(),
+        std::max({CommittedBytes(size), committed_bytes * 2U,
+                  CommittedBytes(kVirtualArrayMinCommitSize / sizeof(T))}))};
+
+    const std::error_code rc{memory_.Commit(
+        committed_bytes, new_committed_bytes - committed_bytes)};
+    if (rc) [[unlikely]] {
+      G3PLOG_E(WARNING, rc) << "Unable to commit " << new_committed_bytes
+                            << " bytes of virtual array memory: ";
+      return false;
+    }
+
+    committed_size_ = std::min(max_size_, new_committed_bytes / sizeof(T));
+    return true;
+  }
+};
+
+}  // namespace wb::base::memory
+
+#endif  // !WB_BASE_MEMORY_VIRTUAL_ARRAY_H_
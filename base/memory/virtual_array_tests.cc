@@ -0,0 +1,109 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Growable array over reserved virtual memory.
+
+#include "virtual_array.h"
+//
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/deps/googletest/gtest/gtest.h"
+
+namespace {
+
+/**
+ * @brief Test entity.
+ */
+struct Entity {
+  /**
+   * @brief Entity id.
+   */
+  std::uint64_t id;
+  /**
+   * @brief Entity name.
+   */
+  std::string name;
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(VirtualArrayTest, GrowsWithStableAddresses) {
+  using namespace wb::base::memory;
+
+  auto entities = VirtualArray<Entity>::New(100'000U);
+  ASSERT_TRUE(entities.has_value());
+  EXPECT_TRUE(entities->empty());
+  EXPECT_EQ(0U, entities->capacity());
+  EXPECT_EQ(100'000U, entities->max_size());
+
+  Entity* first{entities->EmplaceBack(0U, std::string{"first"})};
+  ASSERT_NE(nullptr, first);
+  EXPECT_GT(entities->capacity(), 0U);
+
+  std::vector<Entity*> addresses{first};
+  for (std::uint64_t i{1}; i < 50'000U; ++i) {
+    Entity* entity{entities->EmplaceBack(i, std::to_string(i))};
+    ASSERT_NE(nullptr, entity);
+    addresses.push_back(entity);
+  }
+
+  // Elements never move.
+  EXPECT_EQ(first, entities->data());
+  EXPECT_EQ("first", first->name);
+  for (std::size_t i{1}; i < addresses.size(); ++i) {
+    ASSERT_EQ(&(*entities)[i], addresses[i]);
+    ASSERT_EQ(i, addresses[i]->id);
+  }
+
+  EXPECT_EQ(50'000U, entities->size());
+  EXPECT_GE(entities->capacity(), entities->size());
+
+  entities->PopBack();
+  EXPECT_EQ(49'999U, entities->size());
+  EXPECT_EQ(49'998U, entities->values().back().id);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(VirtualArrayTest, FailsOverMaxSize) {
+  using namespace wb::base::memory;
+
+  auto values = VirtualArray<std::uint32_t>::New(3U);
+  ASSERT_TRUE(values.has_value());
+
+  EXPECT_NE(nullptr, values->EmplaceBack(1U));
+  EXPECT_NE(nullptr, values->EmplaceBack(2U));
+  EXPECT_NE(nullptr, values->EmplaceBack(3U));
+  EXPECT_EQ(nullptr, values->EmplaceBack(4U));
+  EXPECT_FALSE(values->Reserve(4U));
+  EXPECT_EQ(3U, values->size());
+
+  EXPECT_EQ(std::error_code(EINVAL, std::generic_category()),
+            VirtualArray<std::uint32_t>::New(0U).error());
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(VirtualArrayTest, ShrinkToZeroReturnsZeroedPages) {
+  using namespace wb::base::memory;
+
+  auto values = VirtualArray<std::uint64_t>::New(1U << 20U);
+  ASSERT_TRUE(values.has_value());
+  ASSERT_TRUE(values->Reserve(1024U));
+  EXPECT_GE(values->capacity(), 1024U);
+
+  for (std::uint64_t i{0}; i < 1024U; ++i) {
+    ASSERT_NE(nullptr, values->EmplaceBack(i + 1));
+  }
+
+  EXPECT_EQ(wb::base::std2::ok_code, values->ShrinkToZero());
+  EXPECT_TRUE(values->empty());
+  EXPECT_EQ(0U, values->capacity());
+
+  // Recommitted pages are zeroed.
+  ASSERT_TRUE(values->Reserve(1024U));
+  EXPECT_EQ(0U, *reinterpret_cast<const std::uint64_t*>(values->data()));
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Reserved virtual memory range.  Address space is reserved up front, and
+// pages are committed on demand, so memory at range start never moves.
+
+#ifndef WB_BASE_MEMORY_VIRTUAL_MEMORY_H_
+#define WB_BASE_MEMORY_VIRTUAL_MEMORY_H_
+
+#include <cstddef>
+
+#include "base/config.h"
+#include "base/macroses.h"
+#include "base/std2/system_error_ext.h"
+
+namespace wb::base::memory {
+
+/**
+ * @brief Reserved virtual memory range.  Reserved pages can not be accessed
+ * till committed.
+ */
+class WB_BASE_API VirtualMemory {
+ public:
+  /**
+   * @brief Reserves address space.  Does not commit memory.
+   * @param size Size, rounded up to page size.
+   * @return Reserved range or error.
+   */
+  [[nodiscard]] static std2::result<VirtualMemory> Reserve(
+      std::size_t size) noexcept;
+
+  VirtualMemory(VirtualMemory&& m) noexcept;
+  VirtualMemory& operator=(VirtualMemory&&) noexcept = delete;
+
+  WB_NO_COPY_CTOR_AND_ASSIGNMENT(VirtualMemory);
+
+  /**
+   * @brief Releases range.
+   */
+  ~VirtualMemory() noexcept;
+
+  /**
+   * @brief Commits pages, so they can be read and written.  New pages are
+   * zeroed.
+   * @param offset Offset from range start, page aligned.
+   * @param size Size, page aligned.
+   * @return Error code.
+   */
+  [[nodiscard]] std::error_code Commit(std::size_t offset,
+                                       std::size_t size) noexcept;
+
+  /**
+   * @brief Decommits pages, so memory is returned to OS.  Range stays
+   * reserved.
+   * @param offset Offset from range start, page aligned.
+   * @param size Size, page aligned.
+   * @return Error code.
+   */
+  [[nodiscard]] std::error_code Decommit(std::size_t offset,
+                                         std::size_t size) noexcept;
+
+  /**
+   * @brief Gets range start.
+   * @return Range start.
+   */
+  [[nodiscard]] std::byte* data() const noexcept { return memory_; }
+
+  /**
+   * @brief Gets reserved size.
+   * @return Reserved size.
+   */
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+  /**
+   * @brief Gets OS page size, commit granularity.
+   * @return Page size.
+   */
+  [[nodiscard]] static std::size_t GetPageSize() noexcept;
+
+ private:
+  /**
+   * @brief Range start.
+   */
+  std::byte* memory_;
+  /**
+   * @brief Reserved size.
+   */
+  std::size_t size_;
+
+  /**
+   * @brief Creates range.
+   * @param memory Range start.
+   * @param size Reserved size.
+   */
+  VirtualMemory(std::byte* memory, std::size_t size) noexcept;
+};
+
+}  // namespace wb::base::memory
+
+#endif  // !WB_BASE_MEMORY_VIRTUAL_MEMORY_H_
@@ -0,0 +1,104 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Reserved virtual memory range.
+
+#include "virtual_memory.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>  // EINVAL.
+#include <utility>
+
+#include "base/deps/g3log/g3log.h"
+#include "base/posix/memory_map_flags.h"
+#include "base/posix/system_error_ext.h"
+
+namespace wb::base::memory {
+
+[[nodiscard]] WB_BASE_API std2::result<VirtualMemory> VirtualMemory::Reserve(
+    std::size_t size) noexcept {
+  using namespace posix;
+
+  const std::size_t page_size{GetPageSize()};
+  size = (size + page_size - 1) & ~(page_size - 1);
+
+  if (size == 0) [[unlikely]] {
+    return std2::result<VirtualMemory>{std::unexpect,
+                                       std2::posix_last_error_code(EINVAL)};
+  }
+
+  // Not accessible, so no physical memory or swap is charged till commit.
+  void* memory{::mmap(nullptr, size,
+                      underlying_cast(MemoryMapProtectionFlags::kNone),
+                      underlying_cast(MemoryMapShareFlags::kPrivate |
+                                      MemoryMapShareFlags::kAnonymous
+#ifdef WB_OS_LINUX
+                                      | MemoryMapShareFlags::kNoReserve
+#endif
+                                      ),
+                      -1, 0)};
+  if (memory == MAP_FAILED) [[unlikely]] {
+    return std2::result<VirtualMemory>{std::unexpect,
+                                       std2::system_last_error_code()};
+  }
+
+  return std2::result<VirtualMemory>{
+      VirtualMemory{static_cast<std::byte*>(memory), size}};
+}
+
+WB_BASE_API VirtualMemory::VirtualMemory(std::byte* memory,
+                                         std::size_t size) noexcept
+    : memory_{memory}, size_{size} {
+  G3DCHECK(!!memory_);
+}
+
+WB_BASE_API VirtualMemory::VirtualMemory(VirtualMemory&& m) noexcept
+    : memory_{std::exchange(m.memory_, nullptr)},
+      size_{std::exchange(m.size_, 0U)} {}
+
+WB_BASE_API VirtualMemory::~VirtualMemory() noexcept {
+  if (!memory_) return;
+
+  const std::error_code rc{posix::get_error(::munmap(memory_, size_))};
+  G3PLOGE2_IF(WARNING, rc) << "Unable to release reserved virtual memory.";
+}
+
+[[nodiscard]] WB_BASE_API std::error_code VirtualMemory::Commit(
+    std::size_t offset, std::size_t size) noexcept {
+  using namespace posix;
+
+  G3DCHECK(offset % GetPageSize() == 0 && size % GetPageSize() == 0);
+  G3DCHECK(offset <= size_ && size <= size_ - offset);
+
+  constexpr auto kReadWrite =
+      MemoryMapProtectionFlags::kRead | MemoryMapProtectionFlags::kWrite;
+  return get_error(
+      ::mprotect(memory_ + offset, size, underlying_cast(kReadWrite)));
+}
+
+[[nodiscard]] WB_BASE_API std::error_code VirtualMemory::Decommit(
+    std::size_t offset, std::size_t size) noexcept {
+  using namespace posix;
+
+  G3DCHECK(offset % GetPageSize() == 0 && size % GetPageSize() == 0);
+  G3DCHECK(offset <= size_ && size <= size_ - offset);
+
+  // Drop pages, so next commit gets zeroed ones.
+  std::error_code rc{
+      get_error(::madvise(memory_ + offset, size, MADV_DONTNEED))};
+  if (rc) [[unlikely]] return rc;
+
+  constexpr auto kNone = MemoryMapProtectionFlags::kNone;
+  return get_error(::mprotect(memory_ + offset, size, underlying_cast(kNone)));
+}
+
+[[nodiscard]] WB_BASE_API std::size_t VirtualMemory::GetPageSize() noexcept {
+  static const auto page_size =
+      static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  return page_size;
+}
+
+}  // namespace wb::base::memory
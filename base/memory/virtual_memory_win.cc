@@ -0,0 +1,84 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Reserved virtual memory range.
+
+#include "virtual_memory.h"
+
+#include <cerrno>  // EINVAL.
+#include <utility>
+
+#include "base/deps/g3log/g3log.h"
+#include "base/win/system_error_ext.h"
+#include "base/win/windows_light.h"
+
+namespace wb::base::memory {
+
+[[nodiscard]] WB_BASE_API std2::result<VirtualMemory> VirtualMemory::Reserve(
+    std::size_t size) noexcept {
+  const std::size_t page_size{GetPageSize()};
+  size = (size + page_size - 1) & ~(page_size - 1);
+
+  if (size == 0) [[unlikely]] {
+    return std2::result<VirtualMemory>{std::unexpect,
+                                       std2::posix_last_error_code(EINVAL)};
+  }
+
+  // Not accessible, so no commit charge till commit.
+  void* memory{::VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS)};
+  if (!memory) [[unlikely]] {
+    return std2::result<VirtualMemory>{std::unexpect,
+                                       std2::system_last_error_code()};
+  }
+
+  return std2::result<VirtualMemory>{
+      VirtualMemory{static_cast<std::byte*>(memory), size}};
+}
+
+WB_BASE_API VirtualMemory::VirtualMemory(std::byte* memory,
+                                         std::size_t size) noexcept
+    : memory_{memory}, size_{size} {
+  G3DCHECK(!!memory_);
+}
+
+WB_BASE_API VirtualMemory::VirtualMemory(VirtualMemory&& m) noexcept
+    : memory_{std::exchange(m.memory_, nullptr)},
+      size_{std::exchange(m.size_, 0U)} {}
+
+WB_BASE_API VirtualMemory::~VirtualMemory() noexcept {
+  if (!memory_) return;
+
+  const std::error_code rc{
+      win::get_error(::VirtualFree(memory_, 0, MEM_RELEASE))};
+  G3PLOGE2_IF(WARNING, rc) << "Unable to release reserved virtual memory.";
+}
+
+[[nodiscard]] WB_BASE_API std::error_code VirtualMemory::Commit(
+    std::size_t offset, std::size_t size) noexcept {
+  G3DCHECK(offset % GetPageSize() == 0 && size % GetPageSize() == 0);
+  G3DCHECK(offset <= size_ && size <= size_ - offset);
+
+  return ::VirtualAlloc(memory_ + offset, size, MEM_COMMIT, PAGE_READWRITE)
+             ? std2::ok_code
+             : std2::system_last_error_code();
+}
+
+[[nodiscard]] WB_BASE_API std::error_code VirtualMemory::Decommit(
+    std::size_t offset, std::size_t size) noexcept {
+  G3DCHECK(offset % GetPageSize() == 0 && size % GetPageSize() == 0);
+  G3DCHECK(offset <= size_ && size <= size_ - offset);
+
+  return win::get_error(::VirtualFree(memory_ + offset, size, MEM_DECOMMIT));
+}
+
+[[nodiscard]] WB_BASE_API std::size_t VirtualMemory::GetPageSize() noexcept {
+  static const std::size_t page_size{[]() noexcept {
+    SYSTEM_INFO system_info;
+    ::GetSystemInfo(&system_info);
+    return static_cast<std::size_t>(system_info.dwPageSize);
+  }()};
+  return page_size;
+}
+
+}  // namespace wb::base::memory
@@ -0,0 +1,131 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// NUMA topology discovery.
+
+#include "numa_topology.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+
+#include "build/build_config.h"
+
+#ifdef WB_OS_LINUX
+#include <filesystem>
+#include <fstream>
+#include <string>
+#endif
+
+namespace {
+
+/**
+ * @brief Parses CPU number.
+ * @param value CPU number string.
+ * @param cpu CPU.
+ * @return true if parsed.
+ */
+[[nodiscard]] bool ParseCpu(std::string_view value,
+                            std::uint32_t& cpu) noexcept {
+  const char* end{value.data() + value.size()};
+  const auto [ptr, ec] = std::from_chars(value.data(), end, cpu);
+  return ec == std::errc{} && ptr == end;
+}
+
+}  // namespace
+
+namespace wb::base {
+
+[[nodiscard]] WB_BASE_API std2::result<std::vector<std::uint32_t>>
+ParseCpuList(std::string_view cpu_list) {
+  using result = std2::result<std::vector<std::uint32_t>>;
+
+  // sysfs lists end with new line.
+  while (!cpu_list.empty() &&
+         (cpu_list.back() == '\n' || cpu_list.back() == ' ')) {
+    cpu_list.remove_suffix(1);
+  }
+
+  std::vector<std::uint32_t> cpus;
+
+  while (!cpu_list.empty()) {
+    const std::size_t comma{cpu_list.find(',')};
+    const std::string_view range{cpu_list.substr(0, comma)};
+    cpu_list = comma == std::string_view::npos ? std::string_view{}
+                                               : cpu_list.substr(comma + 1);
+
+    const std::size_t dash{range.find('-')};
+    std::uint32_t first_cpu, last_cpu;
+    if (!ParseCpu(range.substr(0, dash), first_cpu)) [[unlikely]] {
+      return result{std::unexpect, std2::posix_last_error_code(EINVAL)};
+    }
+    if (dash == std::string_view::npos) {
+      last_cpu = first_cpu;
+    } else if (!ParseCpu(range.substr(dash + 1), last_cpu) ||
+               last_cpu < first_cpu) [[unlikely]] {
+      return result{std::unexpect, std2::posix_last_error_code(EINVAL)};
+    }
+    // Bounds range, so loop ends and malformed lists do not exhaust memory.
+    if (last_cpu >= kMaxCpusCount) [[unlikely]] {
+      return result{std::unexpect, std2::posix_last_error_code(EINVAL)};
+    }
+
+    for (std::uint32_t cpu{first_cpu}; cpu <= last_cpu; ++cpu) {
+      cpus.emplace_back(cpu);
+    }
+  }
+
+  std::ranges::sort(cpus);
+  return cpus;
+}
+
+[[nodiscard]] WB_BASE_API std2::result<std::vector<NumaNode>>
+GetNumaTopology() {
+  using result = std2::result<std::vector<NumaNode>>;
+
+#ifdef WB_OS_LINUX
+  constexpr std::string_view kNodePrefix{"node"};
+
+  std::error_code rc;
+  std::filesystem::directory_iterator it{"/sys/devices/system/node", rc};
+  if (rc) [[unlikely]] return result{std::unexpect, rc};
+
+  std::vector<NumaNode> nodes;
+
+  for (const std::filesystem::directory_entry& entry : it) {
+    const std::string name{entry.path().filename().string()};
+
+    std::uint32_t node_id;
+    if (!name.starts_with(kNodePrefix) ||
+        !ParseCpu(std::string_view{name}.substr(kNodePrefix.size()),
+                  node_id)) {
+      continue;
+    }
+
+    std::ifstream cpu_list_file{entry.path() / "cpulist"};
+    std::string cpu_list;
+    if (!std::getline(cpu_list_file, cpu_list)) [[unlikely]] {
+      return result{std::unexpect, std2::posix_last_error_code(EIO)};
+    }
+
+    auto cpus = ParseCpuList(cpu_list);
+    if (!cpus.has_value()) [[unlikely]] {
+      return result{std::unexpect, cpus.error()};
+    }
+
+    // Memory only node.
+    if (cpus->empty()) continue;
+
+    nodes.emplace_back(
+        NumaNode{.cpus = std::move(*cpus), .id = node_id, .pad_ = {}});
+  }
+
+  std::ranges::sort(nodes, {}, &NumaNode::id);
+  return nodes;
+#else
+  return result{std::unexpect, std2::posix_last_error_code(ENOSYS)};
+#endif
+}
+
+}  // namespace wb::base
@@ -0,0 +1,62 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// NUMA topology discovery.  Linux topology is read from sysfs, so no libnuma
+// dependency.  Other platforms report no topology, so callers degrade to
+// single node behavior.
+
+#ifndef WB_BASE_NUMA_TOPOLOGY_H_
+#define WB_BASE_NUMA_TOPOLOGY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "base/config.h"
+#include "base/std2/system_error_ext.h"
+#include "build/compiler_config.h"
+
+namespace wb::base {
+
+/**
+ * @brief Max logical CPUs count.  Linux default NR_CPUS upper bound.
+ */
+inline constexpr std::uint32_t kMaxCpusCount{4096U};
+
+/**
+ * @brief NUMA node.
+ */
+struct NumaNode {
+  /**
+   * @brief Node logical CPUs, ascending.
+   */
+  std::vector<std::uint32_t> cpus;
+  /**
+   * @brief Node id.
+   */
+  std::uint32_t id;
+  WB_ATTRIBUTE_UNUSED_FIELD std::byte pad_[sizeof(char*) - sizeof(id)];
+};
+
+/**
+ * @brief Parses Linux CPU list, ex. "0-3,8,10-11".
+ * @param cpu_list CPU list.
+ * @return CPUs or EINVAL error.  CPUs >= kMaxCpusCount are EINVAL.
+ */
+[[nodiscard]] WB_BASE_API std2::result<std::vector<std::uint32_t>>
+ParseCpuList(std::string_view cpu_list);
+
+/**
+ * @brief Gets NUMA nodes which have CPUs, by node id.  Memory only nodes are
+ * skipped.
+ * @return NUMA nodes or error.  ENOSYS when platform has no NUMA topology
+ * discovery.
+ */
+[[nodiscard]] WB_BASE_API std2::result<std::vector<NumaNode>>
+GetNumaTopology();
+
+}  // namespace wb::base
+
+#endif  // !WB_BASE_NUMA_TOPOLOGY_H_
@@ -0,0 +1,65 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// NUMA topology discovery.
+
+#include "numa_topology.h"
+//
+#include <cerrno>
+#include <cstdint>
+#include <vector>
+
+#include "base/deps/googletest/gtest/gtest.h"
+#include "build/build_config.h"
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(NumaTopologyTest, ParseCpuList) {
+  using namespace wb::base;
+
+  auto cpus = ParseCpuList("0-3,8,10-11\n");
+  ASSERT_TRUE(cpus.has_value());
+  EXPECT_EQ((std::vector<std::uint32_t>{0, 1, 2, 3, 8, 10, 11}), *cpus);
+
+  cpus = ParseCpuList("16-17,2");
+  ASSERT_TRUE(cpus.has_value());
+  EXPECT_EQ((std::vector<std::uint32_t>{2, 16, 17}), *cpus);
+
+  // Memory only node.
+  cpus = ParseCpuList("\n");
+  ASSERT_TRUE(cpus.has_value());
+  EXPECT_TRUE(cpus->empty());
+
+  const std::error_code invalid{EINVAL, std::generic_category()};
+  EXPECT_EQ(invalid, ParseCpuList("3-1").error());
+  EXPECT_EQ(invalid, ParseCpuList("1,a").error());
+  EXPECT_EQ(invalid, ParseCpuList("1-").error());
+  EXPECT_EQ(invalid, ParseCpuList("0-4294967295").error());
+  EXPECT_EQ(invalid, ParseCpuList("4096").error());
+
+  cpus = ParseCpuList("4095");
+  ASSERT_TRUE(cpus.has_value());
+  EXPECT_EQ((std::vector<std::uint32_t>{kMaxCpusCount - 1}), *cpus);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(NumaTopologyTest, GetNumaTopology) {
+  using namespace wb::base;
+
+  const auto nodes = GetNumaTopology();
+
+#ifdef WB_OS_LINUX
+  // Containers may hide sysfs node directory.
+  if (!nodes.has_value()) GTEST_SKIP() << nodes.error().message();
+
+  std::uint32_t previous_node_id{0};
+  for (const NumaNode& node : *nodes) {
+    EXPECT_FALSE(node.cpus.empty());
+    if (&node != &nodes->front()) EXPECT_LT(previous_node_id, node.id);
+    previous_node_id = node.id;
+  }
+#else
+  ASSERT_FALSE(nodes.has_value());
+  EXPECT_EQ(std::error_code(ENOSYS, std::generic_category()), nodes.error());
+#endif
+}
@@ -0,0 +1,37 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Benchmarks for character set.
+
+#include "character_set.h"
+//
+#include <array>
+#include <cstddef>
+
+#include "base/deps/benchmark/benchmark.h"
+
+void BM_CharacterSetHasChar(benchmark::State& state) {
+  using namespace wb::base::parsers;
+
+  constexpr CharacterSet kBreakSet{"{}()':"};
+
+  // All possible chars, so both hits and misses are measured.
+  std::array<char, 256> chars;
+  for (std::size_t i{0}; i < chars.size(); ++i) {
+    chars[i] = static_cast<char>(i);
+  }
+
+  for ([[maybe_unused]] auto _ : state) {
+    std::size_t hits{0};
+    for (const char ch : chars) {
+      hits += kBreakSet.HasChar(ch) ? 1U : 0U;
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          static_cast<std::int64_t>(chars.size()));
+}
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+BENCHMARK(BM_CharacterSetHasChar);
@@ -0,0 +1,152 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Benchmarks for simple token parser.
+
+#include "simple_token_parser.h"
+//
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "base/deps/benchmark/benchmark.h"
+
+namespace {
+
+/**
+ * @brief gameinfo.txt like key values.
+ */
+constexpr std::string_view kGameInfoKeyValues{R"("GameInfo"
+{
+	game		"HALF-LIFE 2"
+	title		"HALF-LIFE'"
+	title2		"== episode one =="
+	type		singleplayer_only
+
+	FileSystem
+	{
+		SteamAppId				220		// This will mount all the GCFs we need (240=CS:S, 220=HL2).
+		ToolsAppId				211		// Tools will load this (ie: source SDK caches) to get things like materials\debug, materials\editor, etc.
+
+		//
+		// The code that loads this file automatically does a few things here:
+		//
+		// 1. For each "Game" search path, it adds a "GameBin" path, in <dir>\bin
+		// 2. For each "Game" search path, it adds another "Game" path in front of it with _<langage> at the end.
+		//    For example: c:\hl2\cstrike on a french machine would get a c:\hl2\cstrike_french path added to it.
+		// 3. For the first "Game" search path, it adds a search path called "MOD".
+		// 4. For the first "Game" search path, it adds a search path called "DEFAULT_WRITE_PATH".
+		//
+		SearchPaths
+		{
+			Game				|gameinfo_path|.
+			Game				hl2
+			platform			platform
+		}
+	}
+}
+)"};
+
+/**
+ * @brief Entities lump like key values.
+ */
+constexpr std::string_view kEntitiesKeyValues{R"({
+"world_maxs" "3072 2560 1024"
+"world_mins" "-3072 -3584 -512"
+"skyname" "sky_borealis01"
+"maxpropscreenwidth" "-1"
+"detailvbsp" "detail.vbsp"
+"detailmaterial" "detail/detailsprites"
+"classname" "worldspawn"
+"mapversion" "4104"
+"hammerid" "1"
+}
+{
+"origin" "-1480 -2600 -296"
+"angles" "0 90 0"
+"targetname" "citadel_door_1"
+"spawnflags" "1024"
+"classname" "func_door_rotating"
+"OnFullyOpen" "relay_door_open,Trigger,,0,-1"
+"OnFullyClosed" "relay_door_closed,Trigger,,0.5,-1"
+}
+{
+"origin" "-1212 -2450 -320"
+"targetname" "ammo_crate_smg"
+"AmmoType" "1"
+"model" "models/items/ammocrate_smg1.mdl"
+"classname" "item_ammo_crate"
+}
+)"};
+
+/**
+ * @brief Valve script like statements.
+ */
+constexpr std::string_view kScriptStatements{R"(// Weapon sounds.
+"Weapon_SMG1.Single"
+{
+	"channel"		"CHAN_WEAPON"
+	"volume"		"0.7"
+	"soundlevel"	"SNDLVL_GUNFIRE"
+	"pitch"			"PITCH_NORM"
+	"wave"			")weapons/smg1/smg1_fire1.wav"
+}
+"Weapon_SMG1.Reload"
+{
+	"channel"		"CHAN_ITEM"
+	"volume"		"0.7"
+	"soundlevel"	"SNDLVL_NORM"
+	"rndwave"
+	{
+		"wave"		"weapons/smg1/smg1_reload.wav"
+		"wave"		"weapons/smg1/smg1_reload2.wav"
+	}
+}
+set_volume(0.85) set_pitch(95 105) 'quoted value'
+)"};
+
+/**
+ * @brief Corpora to parse.
+ */
+constexpr std::string_view kCorpora[]{kGameInfoKeyValues, kEntitiesKeyValues,
+                                      kScriptStatements};
+
+/**
+ * @brief Corpora names.
+ */
+constexpr const char* kCorporaNames[]{"gameinfo", "entities", "script"};
+
+}  // namespace
+
+void BM_ParseTokenCorpus(benchmark::State& state) {
+  using namespace wb::base::parsers;
+
+  const auto corpus_index{static_cast<std::size_t>(state.range(0))};
+  const std::string corpus{kCorpora[corpus_index]};
+  constexpr CharacterSet kBreakSet{"{}()'"};
+
+  std::size_t tokens_count{0};
+  for ([[maybe_unused]] auto _ : state) {
+    std::string_view data{corpus};
+    std::size_t tokens{0};
+
+    while (!data.empty()) {
+      const st::ParsedToken token{st::ParseToken(data, kBreakSet)};
+      benchmark::DoNotOptimize(token.current_token);
+
+      tokens += token.current_token.empty() ? 0U : 1U;
+      data = token.next_token;
+    }
+
+    tokens_count = tokens;
+  }
+
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          static_cast<std::int64_t>(corpus.size()));
+  state.counters["tokens"] = static_cast<double>(tokens_count);
+  state.SetLabel(kCorporaNames[corpus_index]);
+}
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+BENCHMARK(BM_ParseTokenCorpus)
+    ->DenseRange(0, static_cast<std::int64_t>(std::size(kCorpora)) - 1);
@@ -0,0 +1,84 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per thread Linux perf_event_open counters.
+
+#include "perf_event_counters_unix.h"
+//
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include "base/deps/googletest/gtest/gtest.h"
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(PerfEventCountersTest, NoCopyConstructorAndAssignment) {
+  static_assert(!std::is_copy_constructible_v<wb::base::PerfEventCounters>);
+  static_assert(!std::is_copy_assignable_v<wb::base::PerfEventCounters>);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(PerfEventCountersTest, DerivedMetrics) {
+  using namespace wb::base;
+
+  constexpr PerfEventCountersSample start{.cycles = 1000,
+                                          .instructions = 1000,
+                                          .cache_misses = 10,
+                                          .branch_misses = 5,
+                                          .task_clock_ns = 100,
+                                          .page_faults = 1,
+                                          .context_switches = 0};
+  constexpr PerfEventCountersSample end{.cycles = 3000,
+                                        .instructions = 5000,
+                                        .cache_misses = 30,
+                                        .branch_misses = 25,
+                                        .task_clock_ns = 400,
+                                        .page_faults = 3,
+                                        .context_switches = 1};
+  constexpr PerfEventCountersSample scope{end - start};
+
+  static_assert(GetInstructionsPerCycle(scope) == 2.0);
+  static_assert(GetCacheMissesPerKiloInstructions(scope) == 5.0);
+  static_assert(GetBranchMissesPerKiloInstructions(scope) == 5.0);
+  static_assert(scope.task_clock_ns == 300U);
+  static_assert(scope.page_faults == 2U);
+  static_assert(scope.context_switches == 1U);
+
+  static_assert(GetInstructionsPerCycle(PerfEventCountersSample{}) == 0.0);
+  static_assert(GetCacheMissesPerKiloInstructions(PerfEventCountersSample{}) ==
+                0.0);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(PerfEventCountersTest, ScopeAccumulatesCounters) {
+  using namespace wb::base;
+
+  auto counters = PerfEventCounters::New();
+  // perf_event_open may be forbidden by seccomp or perf_event_paranoid 3.
+  if (!counters.has_value()) {
+    GTEST_SKIP() << "perf_event_open is unavailable: "
+                 << counters.error().message();
+  }
+
+  PerfEventCountersSample total{};
+  for (int i{0}; i < 2; ++i) {
+    const ScopedPerfEventCountersScope scope{*counters, total};
+
+    // Touch fresh memory to produce some work and page faults.
+    constexpr std::size_t kSize{16U * 1024U * 1024U};
+    auto memory = std::make_unique<std::byte[]>(kSize);
+    for (std::size_t j{0}; j < kSize; j += 4096U) {
+      memory[j] = std::byte{1};
+    }
+    EXPECT_EQ(std::byte{1}, memory[0]);
+  }
+
+  EXPECT_GT(total.task_clock_ns, 0U);
+  EXPECT_GT(total.page_faults, 0U);
+
+  if (counters->HasHardwareCounters()) {
+    EXPECT_GT(total.cycles, 0U);
+    EXPECT_GT(total.instructions, 0U);
+  }
+}
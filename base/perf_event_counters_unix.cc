@@ -0,0 +1,249 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per thread Linux perf_event_open counters.
+
+#include "perf_event_counters_unix.h"
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+#include "base/deps/g3log/g3log.h"
+#include "base/posix/system_error_ext.h"
+
+namespace {
+
+/**
+ * @brief Perf event counter definition.
+ */
+struct PerfEventDefinition {
+  /**
+   * @brief Counter type, PERF_TYPE_*.
+   */
+  std::uint32_t type;
+  /**
+   * @brief Counter config, PERF_COUNT_*.
+   */
+  std::uint64_t config;
+};
+
+/**
+ * @brief Hardware counters, first is group leader.
+ */
+constexpr std::array<PerfEventDefinition, 4U> kHardwareEvents{
+    PerfEventDefinition{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    PerfEventDefinition{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    PerfEventDefinition{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    PerfEventDefinition{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}};
+
+/**
+ * @brief Software counters, first is group leader.
+ */
+constexpr std::array<PerfEventDefinition, 3U> kSoftwareEvents{
+    PerfEventDefinition{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    PerfEventDefinition{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+    PerfEventDefinition{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}};
+
+/**
+ * @brief Opens perf event counter for the current thread.
+ * @param event Counter definition.
+ * @param group_descriptor Group leader descriptor or -1 to create group.
+ * @return Counter descriptor or -1 on failure (errno is set).
+ */
+[[nodiscard]] int OpenPerfEvent(const PerfEventDefinition& event,
+                                int group_descriptor) noexcept {
+  perf_event_attr attributes{};
+  attributes.size = sizeof(attributes);
+  attributes.type = event.type;
+  attributes.config = event.config;
+  attributes.read_format = PERF_FORMAT_GROUP |
+                           PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // Hardware counters are user space only, allowed with perf_event_paranoid
+  // 2.  Software events, like context switches, happen in kernel, so would
+  // always be 0 without it.
+  attributes.exclude_kernel = event.type == PERF_TYPE_HARDWARE ? 1U : 0U;
+  attributes.exclude_hv = 1;
+
+  // Current thread on any CPU.
+  int descriptor{static_cast<int>(
+      ::syscall(SYS_perf_event_open, &attributes, 0, -1, group_descriptor,
+                PERF_FLAG_FD_CLOEXEC))};
+  if (descriptor == -1 && attributes.exclude_kernel == 0U &&
+      (errno == EACCES || errno == EPERM)) [[unlikely]] {
+    // perf_event_paranoid 2 disallows kernel counting, fallback to user space
+    // only, so context switches are 0.
+    attributes.exclude_kernel = 1;
+    descriptor = static_cast<int>(
+        ::syscall(SYS_perf_event_open, &attributes, 0, -1, group_descriptor,
+                  PERF_FLAG_FD_CLOEXEC));
+  }
+  return descriptor;
+}
+
+/**
+ * @brief Closes perf event counters.
+ * @tparam size Counters count.
+ * @param descriptors Counters descriptors.
+ * @return void.
+ */
+template <std::size_t size>
+void ClosePerfEvents(std::array<int, size>& descriptors) noexcept {
+  // Close members before group leader.
+  for (auto it = descriptors.rbegin(); it != descriptors.rend(); ++it) {
+    if (*it != -1) {
+      const std::error_code rc{wb::base::posix::get_error(::close(*it))};
+      G3PLOGE2_IF(WARNING, rc) << "Unable to close perf event counter.";
+      *it = -1;
+    }
+  }
+}
+
+/**
+ * @brief Opens perf event counters group for the current thread.
+ * @tparam size Counters count.
+ * @param events Counters definitions, first is group leader.
+ * @param descriptors Counters descriptors.
+ * @return Error code.
+ */
+template <std::size_t size>
+[[nodiscard]] std::error_code OpenPerfEventsGroup(
+    const std::array<PerfEventDefinition, size>& events,
+    std::array<int, size>& descriptors) noexcept {
+  descriptors.fill(-1);
+
+  for (std::size_t i{0}; i < size; ++i) {
+    descriptors[i] = OpenPerfEvent(events[i], i == 0 ? -1 : descriptors[0]);
+    if (descriptors[i] == -1) [[unlikely]] {
+      const std::error_code rc{wb::base::std2::posix_last_error_code()};
+      ClosePerfEvents(descriptors);
+      return rc;
+    }
+  }
+
+  return wb::base::std2::ok_code;
+}
+
+/**
+ * @brief Reads perf event counters group values.  Values are scaled when
+ * kernel multiplexes counters.
+ * @tparam size Counters count.
+ * @param group_descriptor Group leader descriptor.
+ * @return Counters values, zeros on failure.
+ */
+template <std::size_t size>
+[[nodiscard]] std::array<std::uint64_t, size> ReadPerfEventsGroup(
+    int group_descriptor) noexcept {
+  // See PERF_FORMAT_GROUP read format in perf_event_open(2).
+  struct {
+    std::uint64_t count;
+    std::uint64_t time_enabled;
+    std::uint64_t time_running;
+    std::array<std::uint64_t, size> values;
+  } group{};
+
+  std::array<std::uint64_t, size> values{};
+
+  const ssize_t rc{::read(group_descriptor, &group, sizeof(group))};
+  if (rc != static_cast<ssize_t>(sizeof(group)) || group.count != size)
+      [[unlikely]] {
+    G3PLOG_E(WARNING, wb::base::std2::posix_last_error_code())
+        << "Unable to read perf event counters.";
+    return values;
+  }
+
+  // Group was never scheduled on PMU.
+  if (group.time_running == 0) [[unlikely]] return values;
+
+  const double scale{static_cast<double>(group.time_enabled) /
+                     static_cast<double>(group.time_running)};
+  std::transform(group.values.begin(), group.values.end(), values.begin(),
+                 [scale](std::uint64_t value) noexcept {
+                   return static_cast<std::uint64_t>(
+                       static_cast<double>(value) * scale);
+                 });
+  return values;
+}
+
+}  // namespace
+
+namespace wb::base {
+
+[[nodiscard]] std2::result<PerfEventCounters>
+PerfEventCounters::New() noexcept {
+  std::array<int, kSoftwareCountersCount> software_descriptors;
+  if (const std::error_code rc{
+          OpenPerfEventsGroup(kSoftwareEvents, software_descriptors)};
+      rc) [[unlikely]] {
+    return std2::result<PerfEventCounters>{std::unexpect, rc};
+  }
+
+  std::array<int, kHardwareCountersCount> hardware_descriptors;
+  if (const std::error_code rc{
+          OpenPerfEventsGroup(kHardwareEvents, hardware_descriptors)};
+      rc) [[unlikely]] {
+    G3LOG(INFO) << "Hardware perf event counters are unavailable ("
+                << rc.message() << "), collect software ones only.";
+  }
+
+  return PerfEventCounters{hardware_descriptors, software_descriptors};
+}
+
+PerfEventCounters::PerfEventCounters(
+    std::array<int, kHardwareCountersCount> hardware_descriptors,
+    std::array<int, kSoftwareCountersCount> software_descriptors) noexcept
+    : hardware_descriptors_{hardware_descriptors},
+      software_descriptors_{software_descriptors} {
+  G3DCHECK(software_descriptors_[0] != -1);
+}
+
+PerfEventCounters::PerfEventCounters(PerfEventCounters&& c) noexcept
+    : hardware_descriptors_{c.hardware_descriptors_},
+      software_descriptors_{c.software_descriptors_} {
+  c.hardware_descriptors_.fill(-1);
+  c.software_descriptors_.fill(-1);
+}
+
+PerfEventCounters& PerfEventCounters::operator=(
+    PerfEventCounters&& c) noexcept {
+  std::swap(hardware_descriptors_, c.hardware_descriptors_);
+  std::swap(software_descriptors_, c.software_descriptors_);
+  return *this;
+}
+
+PerfEventCounters::~PerfEventCounters() noexcept {
+  ClosePerfEvents(hardware_descriptors_);
+  ClosePerfEvents(software_descriptors_);
+}
+
+[[nodiscard]] PerfEventCountersSample PerfEventCounters::Read()
+    const noexcept {
+  G3DCHECK(software_descriptors_[0] != -1);
+
+  PerfEventCountersSample sample{};
+
+  if (HasHardwareCounters()) {
+    const auto hardware = ReadPerfEventsGroup<kHardwareCountersCount>(
+        hardware_descriptors_[0]);
+    sample.cycles = hardware[0];
+    sample.instructions = hardware[1];
+    sample.cache_misses = hardware[2];
+    sample.branch_misses = hardware[3];
+  }
+
+  const auto software =
+      ReadPerfEventsGroup<kSoftwareCountersCount>(software_descriptors_[0]);
+  sample.task_clock_ns = software[0];
+  sample.page_faults = software[1];
+  sample.context_switches = software[2];
+
+  return sample;
+}
+
+}  // namespace wb::base
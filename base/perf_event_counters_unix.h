@@ -0,0 +1,247 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Per thread Linux perf_event_open counters.
+//
+// Usage example:
+//
+// auto counters = PerfEventCounters::New();
+// PerfEventCountersSample physics_total{};
+// {
+//   const ScopedPerfEventCountersScope scope{*counters, physics_total};
+//   SimulatePhysics(...);
+// }
+// G3LOG(INFO) << "Physics IPC " << GetInstructionsPerCycle(physics_total);
+
+#ifndef WB_BASE_PERF_EVENT_COUNTERS_UNIX_H_
+#define WB_BASE_PERF_EVENT_COUNTERS_UNIX_H_
+
+#include <array>
+#include <cstdint>
+
+#include "base/config.h"
+#include "base/macroses.h"
+#include "base/std2/system_error_ext.h"
+
+namespace wb::base {
+
+/**
+ * @brief Perf event counters values.  Hardware counters are zero when
+ * hardware PMU access is unavailable.
+ */
+struct PerfEventCountersSample {
+  /**
+   * @brief CPU cycles.  Hardware.
+   */
+  std::uint64_t cycles;
+  /**
+   * @brief Retired instructions.  Hardware.
+   */
+  std::uint64_t instructions;
+  /**
+   * @brief Last level cache misses.  Hardware.
+   */
+  std::uint64_t cache_misses;
+  /**
+   * @brief Mispredicted branches.  Hardware.
+   */
+  std::uint64_t branch_misses;
+  /**
+   * @brief Task clock, ns.  Software.
+   */
+  std::uint64_t task_clock_ns;
+  /**
+   * @brief Page faults.  Software.
+   */
+  std::uint64_t page_faults;
+  /**
+   * @brief Context switches.  Software.
+   */
+  std::uint64_t context_switches;
+
+  /**
+   * @brief Adds |sample| values.
+   * @param sample Sample to add.
+   * @return *this.
+   */
+  constexpr PerfEventCountersSample& operator+=(
+      const PerfEventCountersSample& sample) noexcept {
+    cycles += sample.cycles;
+    instructions += sample.instructions;
+    cache_misses += sample.cache_misses;
+    branch_misses += sample.branch_misses;
+    task_clock_ns += sample.task_clock_ns;
+    page_faults += sample.page_faults;
+    context_switches += sample.context_switches;
+    return *this;
+  }
+};
+
+/**
+ * @brief Counters difference between samples.
+ * @param end End sample.
+ * @param start Start sample.
+ * @return end - start.
+ */
+[[nodiscard]] constexpr PerfEventCountersSample operator-(
+    const PerfEventCountersSample& end,
+    const PerfEventCountersSample& start) noexcept {
+  return {.cycles = end.cycles - start.cycles,
+          .instructions = end.instructions - start.instructions,
+          .cache_misses = end.cache_misses - start.cache_misses,
+          .branch_misses = end.branch_misses - start.branch_misses,
+          .task_clock_ns = end.task_clock_ns - start.task_clock_ns,
+          .page_faults = end.page_faults - start.page_faults,
+          .context_switches = end.context_switches - start.context_switches};
+}
+
+/**
+ * @brief Gets instructions per cycle.
+ * @param sample Counters sample.
+ * @return IPC or 0 if no cycles.
+ */
+[[nodiscard]] constexpr double GetInstructionsPerCycle(
+    const PerfEventCountersSample& sample) noexcept {
+  return sample.cycles != 0 ? static_cast<double>(sample.instructions) /
+                                  static_cast<double>(sample.cycles)
+                            : 0.0;
+}
+
+/**
+ * @brief Gets cache misses per 1000 instructions.
+ * @param sample Counters sample.
+ * @return Cache MPKI or 0 if no instructions.
+ */
+[[nodiscard]] constexpr double GetCacheMissesPerKiloInstructions(
+    const PerfEventCountersSample& sample) noexcept {
+  return sample.instructions != 0
+             ? 1000.0 * static_cast<double>(sample.cache_misses) /
+                   static_cast<double>(sample.instructions)
+             : 0.0;
+}
+
+/**
+ * @brief Gets branch misses per 1000 instructions.
+ * @param sample Counters sample.
+ * @return Branch MPKI or 0 if no instructions.
+ */
+[[nodiscard]] constexpr double GetBranchMissesPerKiloInstructions(
+    const PerfEventCountersSample& sample) noexcept {
+  return sample.instructions != 0
+             ? 1000.0 * static_cast<double>(sample.branch_misses) /
+                   static_cast<double>(sample.instructions)
+             : 0.0;
+}
+
+/**
+ * @brief Perf event counters of the thread which created them.  Hardware
+ * counters (cycles, instructions, cache & branch misses) are optional, as PMU
+ * may be unavailable (virtual machines, containers, perf_event_paranoid).
+ * Software counters (task clock, page faults, context switches) are always
+ * collected.  Hardware counters count user space only, so work with
+ * perf_event_paranoid 2.  Software ones count kernel too when allowed, else
+ * context switches are 0.
+ */
+class WB_BASE_API PerfEventCounters {
+ public:
+  /**
+   * @brief Opens perf event counters for the current thread.
+   * @return Perf event counters or error.
+   */
+  [[nodiscard]] static std2::result<PerfEventCounters> New() noexcept;
+
+  PerfEventCounters(PerfEventCounters&& c) noexcept;
+  PerfEventCounters& operator=(PerfEventCounters&& c) noexcept;
+
+  WB_NO_COPY_CTOR_AND_ASSIGNMENT(PerfEventCounters);
+
+  ~PerfEventCounters() noexcept;
+
+  /**
+   * @brief Are hardware counters available.
+   * @return true if hardware counters are collected.
+   */
+  [[nodiscard]] bool HasHardwareCounters() const noexcept {
+    return hardware_descriptors_[0] != -1;
+  }
+
+  /**
+   * @brief Reads counters values since counters open.  Values are scaled
+   * when kernel multiplexes counters.
+   * @return Counters sample.
+   */
+  [[nodiscard]] PerfEventCountersSample Read() const noexcept;
+
+ private:
+  /**
+   * @brief Hardware counters count.
+   */
+  static constexpr std::size_t kHardwareCountersCount{4U};
+  /**
+   * @brief Software counters count.
+   */
+  static constexpr std::size_t kSoftwareCountersCount{3U};
+
+  /**
+   * @brief Hardware counters descriptors, first is group leader.  -1 when
+   * unavailable.
+   */
+  std::array<int, kHardwareCountersCount> hardware_descriptors_;
+  /**
+   * @brief Software counters descriptors, first is group leader.
+   */
+  std::array<int, kSoftwareCountersCount> software_descriptors_;
+
+  /**
+   * @brief Creates perf event counters.
+   * @param hardware_descriptors Hardware counters descriptors.
+   * @param software_descriptors Software counters descriptors.
+   */
+  PerfEventCounters(
+      std::array<int, kHardwareCountersCount> hardware_descriptors,
+      std::array<int, kSoftwareCountersCount> software_descriptors) noexcept;
+};
+
+/**
+ * @brief Accumulates perf event counters of scope into total.  Should be used
+ * on thread which created counters.
+ */
+class ScopedPerfEventCountersScope {
+ public:
+  /**
+   * @brief Starts counting scope.
+   * @param counters Perf event counters.
+   * @param total Total to add scope counters to.
+   */
+  ScopedPerfEventCountersScope(const PerfEventCounters& counters,
+                               PerfEventCountersSample& total) noexcept
+      : counters_{counters}, total_{total}, start_{counters.Read()} {}
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(ScopedPerfEventCountersScope);
+
+  /**
+   * @brief Adds scope counters to total.
+   */
+  ~ScopedPerfEventCountersScope() noexcept {
+    total_ += counters_.Read() - start_;
+  }
+
+ private:
+  /**
+   * @brief Perf event counters.
+   */
+  const PerfEventCounters& counters_;
+  /**
+   * @brief Total to add scope counters to.
+   */
+  PerfEventCountersSample& total_;
+  /**
+   * @brief Counters at scope start.
+   */
+  const PerfEventCountersSample start_;
+};
+
+}  // namespace wb::base
+
+#endif  // !WB_BASE_PERF_EVENT_COUNTERS_UNIX_H_
@@ -0,0 +1,157 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Publishes / reads live frame telemetry via POSIX shared memory.
+
+#include "frame_telemetry_shared_memory.h"
+
+#include <unistd.h>  // getpid
+
+#include <new>
+#include <utility>
+
+#include "base/deps/fmt/core.h"
+#include "base/deps/g3log/g3log.h"
+
+namespace {
+
+/**
+ * @brief How many times to retry read when publisher keeps writing.
+ */
+constexpr int kMaxReadAttempts{64};
+
+}  // namespace
+
+namespace wb::base::posix {
+
+[[nodiscard]] WB_BASE_API std::string MakeFrameTelemetryObjectName(pid_t pid) {
+  return fmt::format("/whitebox-frame-telemetry-{0}", pid);
+}
+
+[[nodiscard]] std2::result<FrameTelemetryPublisher>
+FrameTelemetryPublisher::New() noexcept {
+  auto object = ScopedSharedMemoryObject::New(
+      MakeFrameTelemetryObjectName(::getpid()),
+      ScopedSharedMemoryObjectFlags::kCreate |
+          ScopedSharedMemoryObjectFlags::kExclusive |
+          ScopedSharedMemoryObjectFlags::kReadWrite,
+      ScopedAccessModeFlags::kOwnerRead | ScopedAccessModeFlags::kOwnerWrite);
+  if (!object.has_value()) [[unlikely]] {
+    return std2::result<FrameTelemetryPublisher>{std::unexpect,
+                                                 object.error()};
+  }
+
+  if (const std::error_code rc{
+          object->TruncateToSize(sizeof(telemetry::FrameTelemetryPage))};
+      rc) [[unlikely]] {
+    return std2::result<FrameTelemetryPublisher>{std::unexpect, rc};
+  }
+
+  auto memory = object->MapMemory<telemetry::FrameTelemetryPage>(
+      MemoryMapProtectionFlags::kRead | MemoryMapProtectionFlags::kWrite,
+      MemoryMapShareFlags::kShared);
+  if (!memory.has_value()) [[unlikely]] {
+    return std2::result<FrameTelemetryPublisher>{std::unexpect,
+                                                 memory.error()};
+  }
+
+  // Shared memory is zero initialized, construct page in place and stamp it.
+  auto* page = new (*memory) telemetry::FrameTelemetryPage{};
+  page->magic = telemetry::kFrameTelemetryMagic;
+  page->version = telemetry::kFrameTelemetryVersion;
+
+  return FrameTelemetryPublisher{std::move(*object), page};
+}
+
+FrameTelemetryPublisher::FrameTelemetryPublisher(
+    ScopedSharedMemoryObject object,
+    telemetry::FrameTelemetryPage* page) noexcept
+    : object_{std::move(object)}, page_{page} {
+  G3DCHECK(!!page_);
+}
+
+FrameTelemetryPublisher::FrameTelemetryPublisher(
+    FrameTelemetryPublisher&& p) noexcept
+    : object_{std::move(p.object_)}, page_{std::exchange(p.page_, nullptr)} {}
+
+FrameTelemetryPublisher& FrameTelemetryPublisher::operator=(
+    FrameTelemetryPublisher&& p) noexcept {
+  std::swap(object_, p.object_);
+  std::swap(page_, p.page_);
+  return *this;
+}
+
+FrameTelemetryPublisher::~FrameTelemetryPublisher() noexcept {
+  if (page_) {
+    const std::error_code rc{ScopedSharedMemoryObject::UnmapMemory(page_)};
+    G3PLOGE2_IF(WARNING, rc) << "Unable to unmap frame telemetry page.";
+  }
+}
+
+[[nodiscard]] std2::result<FrameTelemetryReader> FrameTelemetryReader::New(
+    pid_t pid) noexcept {
+  auto object = ScopedSharedMemoryObject::New(
+      MakeFrameTelemetryObjectName(pid),
+      ScopedSharedMemoryObjectFlags::kReadonly,
+      ScopedAccessModeFlags::kOwnerRead);
+  if (!object.has_value()) [[unlikely]] {
+    return std2::result<FrameTelemetryReader>{std::unexpect, object.error()};
+  }
+
+  auto memory = object->MapMemory<const telemetry::FrameTelemetryPage>(
+      MemoryMapProtectionFlags::kRead, MemoryMapShareFlags::kShared);
+  if (!memory.has_value()) [[unlikely]] {
+    return std2::result<FrameTelemetryReader>{std::unexpect, memory.error()};
+  }
+
+  const auto* page = *memory;
+  if (page->magic != telemetry::kFrameTelemetryMagic ||
+      page->version != telemetry::kFrameTelemetryVersion) [[unlikely]] {
+    const std::error_code rc{ScopedSharedMemoryObject::UnmapMemory(page)};
+    G3PLOGE2_IF(WARNING, rc) << "Unable to unmap frame telemetry page.";
+
+    return std2::result<FrameTelemetryReader>{
+        std::unexpect, std2::posix_last_error_code(EPROTO)};
+  }
+
+  return FrameTelemetryReader{std::move(*object), page};
+}
+
+FrameTelemetryReader::FrameTelemetryReader(
+    ScopedSharedMemoryObject object,
+    const telemetry::FrameTelemetryPage* page) noexcept
+    : object_{std::move(object)}, page_{page} {
+  G3DCHECK(!!page_);
+}
+
+FrameTelemetryReader::FrameTelemetryReader(FrameTelemetryReader&& r) noexcept
+    : object_{std::move(r.object_)}, page_{std::exchange(r.page_, nullptr)} {}
+
+FrameTelemetryReader& FrameTelemetryReader::operator=(
+    FrameTelemetryReader&& r) noexcept {
+  std::swap(object_, r.object_);
+  std::swap(page_, r.page_);
+  return *this;
+}
+
+FrameTelemetryReader::~FrameTelemetryReader() noexcept {
+  if (page_) {
+    const std::error_code rc{ScopedSharedMemoryObject::UnmapMemory(page_)};
+    G3PLOGE2_IF(WARNING, rc) << "Unable to unmap frame telemetry page.";
+  }
+}
+
+[[nodiscard]] std::optional<telemetry::FrameTelemetry>
+FrameTelemetryReader::Read() const noexcept {
+  G3DCHECK(!!page_);
+
+  telemetry::FrameTelemetry telemetry;
+  for (int attempt{0}; attempt < kMaxReadAttempts; ++attempt) {
+    if (page_->telemetry.TryLoad(telemetry)) return telemetry;
+  }
+
+  return std::nullopt;
+}
+
+}  // namespace wb::base::posix
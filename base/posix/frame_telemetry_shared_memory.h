@@ -0,0 +1,126 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Publishes / reads live frame telemetry via POSIX shared memory.
+
+#ifndef WB_BASE_POSIX_FRAME_TELEMETRY_SHARED_MEMORY_H_
+#define WB_BASE_POSIX_FRAME_TELEMETRY_SHARED_MEMORY_H_
+
+#include <sys/types.h>  // pid_t
+
+#include <optional>
+#include <string>
+
+#include "base/config.h"
+#include "base/macroses.h"
+#include "base/posix/scoped_shared_memory_object.h"
+#include "base/std2/system_error_ext.h"
+#include "base/telemetry/frame_telemetry.h"
+
+namespace wb::base::posix {
+
+/**
+ * @brief Makes frame telemetry shared memory object name for process.
+ * @param pid Process id.
+ * @return Shared memory object name.
+ */
+[[nodiscard]] WB_BASE_API std::string MakeFrameTelemetryObjectName(pid_t pid);
+
+/**
+ * @brief Publishes frame telemetry of the current process.  Publish never
+ * blocks, so safe to call from the frame loop.
+ */
+class WB_BASE_API FrameTelemetryPublisher {
+ public:
+  /**
+   * @brief Creates frame telemetry publisher for the current process.
+   * @return Frame telemetry publisher.
+   */
+  [[nodiscard]] static std2::result<FrameTelemetryPublisher> New() noexcept;
+
+  FrameTelemetryPublisher(FrameTelemetryPublisher &&p) noexcept;
+  FrameTelemetryPublisher &operator=(FrameTelemetryPublisher &&p) noexcept;
+
+  WB_NO_COPY_CTOR_AND_ASSIGNMENT(FrameTelemetryPublisher);
+
+  ~FrameTelemetryPublisher() noexcept;
+
+  /**
+   * @brief Publishes frame telemetry.
+   * @param telemetry Frame telemetry.
+   * @return void.
+   */
+  void Publish(const telemetry::FrameTelemetry &telemetry) noexcept {
+    G3DCHECK(!!page_);
+
+    page_->telemetry.Store(telemetry);
+  }
+
+ private:
+  /**
+   * @brief Shared memory object.
+   */
+  ScopedSharedMemoryObject object_;
+  /**
+   * @brief Mapped telemetry page.
+   */
+  telemetry::FrameTelemetryPage *page_;
+
+  /**
+   * @brief Creates frame telemetry publisher.
+   * @param object Shared memory object.
+   * @param page Mapped telemetry page.
+   */
+  FrameTelemetryPublisher(ScopedSharedMemoryObject object,
+                          telemetry::FrameTelemetryPage *page) noexcept;
+};
+
+/**
+ * @brief Reads frame telemetry of other process.
+ */
+class WB_BASE_API FrameTelemetryReader {
+ public:
+  /**
+   * @brief Creates frame telemetry reader.
+   * @param pid Process id to read telemetry of.
+   * @return Frame telemetry reader.
+   */
+  [[nodiscard]] static std2::result<FrameTelemetryReader> New(
+      pid_t pid) noexcept;
+
+  FrameTelemetryReader(FrameTelemetryReader &&r) noexcept;
+  FrameTelemetryReader &operator=(FrameTelemetryReader &&r) noexcept;
+
+  WB_NO_COPY_CTOR_AND_ASSIGNMENT(FrameTelemetryReader);
+
+  ~FrameTelemetryReader() noexcept;
+
+  /**
+   * @brief Reads last published frame telemetry.
+   * @return Frame telemetry or nothing when publisher keeps writing.
+   */
+  [[nodiscard]] std::optional<telemetry::FrameTelemetry> Read() const noexcept;
+
+ private:
+  /**
+   * @brief Shared memory object.
+   */
+  ScopedSharedMemoryObject object_;
+  /**
+   * @brief Mapped telemetry page.
+   */
+  const telemetry::FrameTelemetryPage *page_;
+
+  /**
+   * @brief Creates frame telemetry reader.
+   * @param object Shared memory object.
+   * @param page Mapped telemetry page.
+   */
+  FrameTelemetryReader(ScopedSharedMemoryObject object,
+                       const telemetry::FrameTelemetryPage *page) noexcept;
+};
+
+}  // namespace wb::base::posix
+
+#endif  // !WB_BASE_POSIX_FRAME_TELEMETRY_SHARED_MEMORY_H_
@@ -0,0 +1,74 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Publishes / reads live frame telemetry via POSIX shared memory.
+
+#include "frame_telemetry_shared_memory.h"
+//
+#include <unistd.h>  // getpid
+
+#include <type_traits>
+
+#include "base/deps/googletest/gtest/gtest.h"
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(FrameTelemetrySharedMemoryTest, NoCopyConstructorAndAssignment) {
+  using namespace wb::base::posix;
+
+  static_assert(!std::is_copy_constructible_v<FrameTelemetryPublisher>);
+  static_assert(!std::is_copy_assignable_v<FrameTelemetryPublisher>);
+  static_assert(!std::is_copy_constructible_v<FrameTelemetryReader>);
+  static_assert(!std::is_copy_assignable_v<FrameTelemetryReader>);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(FrameTelemetrySharedMemoryTest, MakeFrameTelemetryObjectName) {
+  using namespace wb::base::posix;
+
+  EXPECT_EQ("/whitebox-frame-telemetry-42", MakeFrameTelemetryObjectName(42));
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(FrameTelemetrySharedMemoryTest, ReaderFailsWithoutPublisher) {
+  using namespace wb::base::posix;
+
+  const auto reader = FrameTelemetryReader::New(::getpid());
+  EXPECT_FALSE(reader.has_value());
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(FrameTelemetrySharedMemoryTest, ReaderReadsPublishedTelemetry) {
+  using namespace wb::base::posix;
+  using namespace wb::base::telemetry;
+
+  auto publisher = FrameTelemetryPublisher::New();
+  ASSERT_TRUE(publisher.has_value());
+
+  const auto reader = FrameTelemetryReader::New(::getpid());
+  ASSERT_TRUE(reader.has_value());
+
+  FrameTelemetry telemetry{};
+  telemetry.frame_index = 3;
+  telemetry.frame_time_ns = 16'666'667;
+  telemetry.input_events_count = 5;
+  publisher->Publish(telemetry);
+
+  const auto read = reader->Read();
+  ASSERT_TRUE(read.has_value());
+  EXPECT_EQ(3U, read->frame_index);
+  EXPECT_EQ(16'666'667, read->frame_time_ns);
+  EXPECT_EQ(5U, read->input_events_count);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(FrameTelemetrySharedMemoryTest, SecondPublisherInProcessFails) {
+  using namespace wb::base::posix;
+
+  const auto publisher = FrameTelemetryPublisher::New();
+  ASSERT_TRUE(publisher.has_value());
+
+  const auto second_publisher = FrameTelemetryPublisher::New();
+  ASSERT_FALSE(second_publisher.has_value());
+  EXPECT_EQ(EEXIST, second_publisher.error().value());
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Memory map flags.
+
+#ifndef WB_BASE_POSIX_MEMORY_MAP_FLAGS_H_
+#define WB_BASE_POSIX_MEMORY_MAP_FLAGS_H_
+
+#include <sys/mman.h>
+
+#include "base/macroses.h"
+#include "build/build_config.h"
+
+namespace wb::base::posix {
+
+/**
+ * Memory map protection flags.
+ */
+enum class MemoryMapProtectionFlags : int {
+  /* Page can not be accessed.  */
+  kNone = PROT_NONE,
+  /* Page can be read.  */
+  kRead = PROT_READ,
+  /* Page can be written.  */
+  kWrite = PROT_WRITE,
+  /* Page can be executed.  */
+  kExecute = PROT_EXEC,
+
+#ifdef WB_OS_LINUX
+  /* Extend change to start of growsdown vma (mprotect only).  */
+  kGrowsDown = PROT_GROWSDOWN,
+  /* Extend change to start of growsup vma (mprotect only).  */
+  kGrowsUp = PROT_GROWSUP
+#endif
+};
+
+/**
+ * Operator|.
+ * @param left Left.
+ * @param right Right.
+ * @return left | right.
+ */
+[[nodiscard]] constexpr MemoryMapProtectionFlags operator|(
+    MemoryMapProtectionFlags left, MemoryMapProtectionFlags right) noexcept {
+  return static_cast<MemoryMapProtectionFlags>(base::underlying_cast(left) |
+                                               base::underlying_cast(right));
+}
+
+/**
+ * Memory map share flags.
+ */
+enum class MemoryMapShareFlags : int {
+  /* Share changes.  */
+  kShared = MAP_SHARED,
+  /* Changes are private.  */
+  kPrivate = MAP_PRIVATE,
+  /* Mapping is not backed by file, contents are zeroed.  */
+  kAnonymous = MAP_ANONYMOUS,
+
+#ifdef WB_OS_LINUX
+  /* Do not reserve swap space for mapping.  */
+  kNoReserve = MAP_NORESERVE
+#endif
+};
+
+/**
+ * Operator|.
+ * @param left Left.
+ * @param right Right.
+ * @return left | right.
+ */
+[[nodiscard]] constexpr MemoryMapShareFlags operator|(
+    MemoryMapShareFlags left, MemoryMapShareFlags right) noexcept {
+  return static_cast<MemoryMapShareFlags>(base::underlying_cast(left) |
+                                          base::underlying_cast(right));
+}
+
+}  // namespace wb::base::posix
+
+#endif  // !WB_BASE_POSIX_MEMORY_MAP_FLAGS_H_
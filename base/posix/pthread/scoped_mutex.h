@@ -10,11 +10,15 @@
 #define _OPEN_SYS_MUTEX_EXT 1
 #include <pthread.h>
 
+#include <cstdint>
+
 #include "base/macroses.h"
 #include "base/deps/g3log/g3log.h"
+#include "base/high_resolution_clock.h"
 #include "base/posix/pthread/scoped_mutex_attribute.h"
 #include "base/posix/system_error_ext.h"
 #include "base/std2/cstring_ext.h"
+#include "base/telemetry/lock_contention_profiler.h"
 
 namespace wb::base::posix {
 
@@ -48,17 +52,25 @@ class ScopedMutex {
     return New(&mutex, mutex_attribute.native_handle());
   }
 
-  ScopedMutex(ScopedMutex&& m) noexcept : mutex_{m.mutex_} {
+  ScopedMutex(ScopedMutex&& m) noexcept
+      : mutex_{m.mutex_},
+        hold_start_time_{m.hold_start_time_},
+        lock_depth_{m.lock_depth_} {
     m.mutex_ = empty_mutex_;
   }
   ScopedMutex& operator=(ScopedMutex&& m) noexcept {
     std::swap(mutex_, m.mutex_);
+    std::swap(hold_start_time_, m.hold_start_time_);
+    std::swap(lock_depth_, m.lock_depth_);
     return *this;
   }
 
   WB_NO_COPY_CTOR_AND_ASSIGNMENT(ScopedMutex);
 
   ~ScopedMutex() noexcept {
+    // Mutex created later at the same address should not inherit stats.
+    telemetry::ForgetLock(native_handle());
+
     // If mutex is initialized (move not occurred).
     if (std2::BitwiseCompare(mutex_, empty_mutex_) != 0) {
       const std::error_code rc{
@@ -72,6 +84,11 @@ class ScopedMutex {
    * Lock mutex.
    */
   void lock() {
+    if (telemetry::IsLockContentionProfilingEnabled()) [[unlikely]] {
+      LockProfiled();
+      return;
+    }
+
     // EINVAL, EAGAIN, EBUSY, EINVAL, EDEADLK(may)
     const std::error_code rc{get_error(::pthread_mutex_lock(native_handle()))};
     if (rc) {
@@ -79,6 +96,8 @@ class ScopedMutex {
           << "Lock mutex " << std::hex << native_handle() << " failed.";
       throw std::system_error{rc};
     }
+
+    ++lock_depth_;
   }
 
   /**
@@ -88,8 +107,15 @@ class ScopedMutex {
   [[nodiscard]] bool try_lock() noexcept {
     // XXX EINVAL, EAGAIN, EBUSY
     const std::error_code rc{get_error(pthread_mutex_trylock(native_handle()))};
-    G3DPLOGE_IF(WARNING, rc ? &rc : nullptr)
+    G3DPLOGE2_IF(WARNING, rc)
         << "Try lock mutex " << std::hex << native_handle() << " failed.";
+    if (!rc) {
+      // Recursive mutex hold starts with outermost lock.
+      if (++lock_depth_ == 1 && telemetry::IsLockContentionProfilingEnabled())
+          [[unlikely]] {
+        hold_start_time_ = HighResolutionClock::now();
+      }
+    }
     return !rc;
   }
 
@@ -97,6 +123,17 @@ class ScopedMutex {
    * Unlock.
    */
   void unlock() {
+    G3DCHECK(lock_depth_ > 0);
+
+    // Recursive mutex hold ends with outermost unlock.  Lock may be taken
+    // before profiling is enabled.
+    if (--lock_depth_ == 0 &&
+        hold_start_time_ != HighResolutionClock::time_point{}) [[unlikely]] {
+      telemetry::RecordLockHold(native_handle(),
+                                HighResolutionClock::now() - hold_start_time_);
+      hold_start_time_ = HighResolutionClock::time_point{};
+    }
+
     // XXX EINVAL, EAGAIN, EPERM
     const std::error_code rc{get_error(pthread_mutex_unlock(native_handle()))};
     G3PLOGE2_IF(WARNING, rc)
@@ -114,6 +151,15 @@ class ScopedMutex {
    * Mutex.
    */
   pthread_mutex_t mutex_;
+  /**
+   * Time when profiled lock is acquired.  Empty when not profiled.
+   */
+  HighResolutionClock::time_point hold_start_time_;
+  /**
+   * Lock depth of owner thread.  Above 1 only for recursive mutex.  Guarded by
+   * mutex itself.
+   */
+  std::uint32_t lock_depth_;
   /**
    * Empty mutex.
    */
@@ -123,7 +169,36 @@ class ScopedMutex {
    * Create scoped mutex.
    * @param mutex Native mutex.
    */
-  explicit ScopedMutex(const pthread_mutex_t& mutex) noexcept : mutex_{mutex} {}
+  explicit ScopedMutex(const pthread_mutex_t& mutex) noexcept
+      : mutex_{mutex}, hold_start_time_{}, lock_depth_{0} {}
+
+  /**
+   * Lock mutex and record contention.
+   */
+  void LockProfiled() {
+    // Uncontended acquisition is not a wait.
+    if (::pthread_mutex_trylock(native_handle()) != 0) {
+      telemetry::BeginLockWait(native_handle());
+
+      const HighResolutionClock::time_point wait_start_time{
+          HighResolutionClock::now()};
+      // EINVAL, EAGAIN, EBUSY, EINVAL, EDEADLK(may)
+      const std::error_code rc{
+          get_error(::pthread_mutex_lock(native_handle()))};
+
+      telemetry::EndLockWait(native_handle(),
+                             HighResolutionClock::now() - wait_start_time);
+
+      if (rc) {
+        G3DPLOG_E(WARNING, rc)
+            << "Lock mutex " << std::hex << native_handle() << " failed.";
+        throw std::system_error{rc};
+      }
+    }
+
+    // Recursive mutex hold starts with outermost lock.
+    if (++lock_depth_ == 1) hold_start_time_ = HighResolutionClock::now();
+  }
 
   /**
    * Create scoped mutex.
@@ -13,9 +13,12 @@
 #include <array>
 #include <climits>
 #include <cstddef>  // byte.
+#include <string>
+#include <type_traits>
 
 #include "base/deps/g3log/g3log.h"
 #include "base/macroses.h"
+#include "base/posix/memory_map_flags.h"
 #include "base/posix/system_error_ext.h"
 #include "base/std2/system_error_ext.h"
 
@@ -139,49 +142,6 @@ enum class ScopedAccessModeFlags : mode_t {
                                             base::underlying_cast(right));
 }
 
-/**
- * Memory map protection flags.
- */
-enum class MemoryMapProtectionFlags : int {
-  /* Page can not be accessed.  */
-  kNone = PROT_NONE,
-  /* Page can be read.  */
-  kRead = PROT_READ,
-  /* Page can be written.  */
-  kWrite = PROT_WRITE,
-  /* Page can be executed.  */
-  kExecute = PROT_EXEC,
-
-#ifdef WB_OS_LINUX
-  /* Extend change to start of growsdown vma (mprotect only).  */
-  kGrowsDown = PROT_GROWSDOWN,
-  /* Extend change to start of growsup vma (mprotect only).  */
-  kGrowsUp = PROT_GROWSUP
-#endif
-};
-
-/**
- * Operator|.
- * @param left Left.
- * @param right Right.
- * @return left | right.
- */
-[[nodiscard]] constexpr MemoryMapProtectionFlags operator|(
-    MemoryMapProtectionFlags left, MemoryMapProtectionFlags right) noexcept {
-  return static_cast<MemoryMapProtectionFlags>(base::underlying_cast(left) |
-                                               base::underlying_cast(right));
-}
-
-/**
- * Memory map share flags.
- */
-enum class MemoryMapShareFlags : int {
-  /* Share changes.  */
-  kShared = MAP_SHARED,
-  /* Changes are private.  */
-  kPrivate = MAP_PRIVATE
-};
-
 /**
  * Scoped shared memory object.
  */
@@ -215,21 +175,28 @@ class ScopedSharedMemoryObject {
 
     const int descriptor{::shm_open(name.c_str(), underlying_cast(open_flags),
                                     underlying_cast(mode_flags))};
+    // Only creator owns object name and unlinks it, openers just close it.
+    const bool is_owner{(open_flags & ScopedSharedMemoryObjectFlags::kCreate) ==
+                        ScopedSharedMemoryObjectFlags::kCreate};
     return descriptor >= 0
                ? std2::result<
                      ScopedSharedMemoryObject>{ScopedSharedMemoryObject{
-                     std::move(name), descriptor}}
+                     std::move(name), descriptor, is_owner}}
                : std2::result<ScopedSharedMemoryObject>{std::unexpect,
                                                         get_error(descriptor)};
   }
 
   ScopedSharedMemoryObject(ScopedSharedMemoryObject &&o) noexcept
-      : name_{std::move(o.name_)}, descriptor_{o.descriptor_} {
+      : name_{std::move(o.name_)},
+        descriptor_{o.descriptor_},
+        is_owner_{o.is_owner_} {
     o.descriptor_ = -1;
+    o.is_owner_ = false;
   }
   ScopedSharedMemoryObject &operator=(ScopedSharedMemoryObject &&o) noexcept {
     std::swap(name_, o.name_);
     std::swap(descriptor_, o.descriptor_);
+    std::swap(is_owner_, o.is_owner_);
     return *this;
   }
 
@@ -239,7 +206,13 @@ class ScopedSharedMemoryObject {
     G3DCHECK((!name_.empty() && descriptor_ >= 0) ||
              (name_.empty() && descriptor_ < 0));
 
-    if (!name_.empty()) {
+    if (descriptor_ >= 0) {
+      const std::error_code rc{get_error(::close(descriptor_))};
+      G3PLOGE2_IF(WARNING, rc) << "Unable to close shared memory object '"
+                               << name_ << "' descriptor.";
+    }
+
+    if (!name_.empty() && is_owner_) {
       const std::error_code rc{get_error(::shm_unlink(name_.c_str()))};
       G3PCHECK_E(!rc, rc) << "Unable to unlink shared memory object '" << name_
                           << "'.";
@@ -280,6 +253,21 @@ class ScopedSharedMemoryObject {
                                    std2::system_last_error_code()};
   }
 
+  /**
+   * Unmap memory mapped by MapMemory.
+   * @tparam T Type of mapped memory.
+   * @param memory Mapped memory.
+   * @return error.
+   */
+  template <typename T>
+  [[nodiscard]] static std::error_code UnmapMemory(T *memory) noexcept {
+    G3DCHECK(!!memory);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    return get_error(::munmap(const_cast<std::remove_const_t<T> *>(memory),
+                              sizeof(T)));
+  }
+
   /**
    * Get native handle.
    * @return Native handle.
@@ -297,17 +285,25 @@ class ScopedSharedMemoryObject {
    * Object descriptor.
    */
   native_handle_type descriptor_;
+  /**
+   * Is object created by us, so should be unlinked on destroy?
+   */
+  bool is_owner_;
 
   WB_ATTRIBUTE_UNUSED_FIELD
-  std::array<std::byte, sizeof(char *) - sizeof(descriptor_)> pad_;
+  std::array<std::byte,
+             sizeof(char *) - sizeof(descriptor_) - sizeof(is_owner_)>
+      pad_;
 
   /**
    * Create shared memory object.
    * @param name Object name.
    * @param descriptor Object descriptor.
+   * @param is_owner Is object created by us.
    */
-  ScopedSharedMemoryObject(std::string &&name, int descriptor) noexcept
-      : name_{std::move(name)}, descriptor_{descriptor} {
+  ScopedSharedMemoryObject(std::string &&name, int descriptor,
+                           bool is_owner) noexcept
+      : name_{std::move(name)}, descriptor_{descriptor}, is_owner_{is_owner} {
     G3DCHECK(!name_.empty());
     G3DCHECK(descriptor >= 0);
   }
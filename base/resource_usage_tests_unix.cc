@@ -0,0 +1,149 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Linux process & thread resource usage.
+
+#include "resource_usage_unix.h"
+//
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+#include "base/deps/googletest/gtest/gtest.h"
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ResourceUsageTest, Delta) {
+  using namespace wb::base;
+
+  constexpr ResourceUsageSample start{.minor_page_faults = 10,
+                                      .major_page_faults = 1};
+  constexpr ResourceUsageSample end{.minor_page_faults = 25,
+                                    .major_page_faults = 3};
+
+  static_assert((end - start).minor_page_faults == 15U);
+  static_assert((end - start).major_page_faults == 2U);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ResourceUsageTest, FirstTouchCausesMinorPageFaultsAndGrowsRss) {
+  using namespace wb::base;
+
+  constexpr std::size_t kPagesCount{256U};
+  const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  const std::size_t size{kPagesCount * page_size};
+
+  void* memory{::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+  ASSERT_NE(MAP_FAILED, memory);
+
+  const auto start_rss = GetResidentSetSizeBytes();
+  const auto start = GetResourceUsage(ResourceUsageScope::kThread);
+  ASSERT_TRUE(start_rss.has_value());
+  ASSERT_TRUE(start.has_value());
+
+  auto* bytes = static_cast<volatile std::byte*>(memory);
+  for (std::size_t i{0}; i < size; i += page_size) bytes[i] = std::byte{1};
+
+  const auto end = GetResourceUsage(ResourceUsageScope::kThread);
+  const auto end_rss = GetResidentSetSizeBytes();
+  ASSERT_TRUE(end.has_value());
+  ASSERT_TRUE(end_rss.has_value());
+
+  // Transparent huge pages may back several pages by single fault.
+  EXPECT_GT((*end - *start).minor_page_faults, 0U);
+  EXPECT_GT(*end_rss, *start_rss);
+
+  const auto process = GetResourceUsage(ResourceUsageScope::kProcess);
+  ASSERT_TRUE(process.has_value());
+  EXPECT_GE(process->minor_page_faults, end->minor_page_faults);
+
+  EXPECT_EQ(0, ::munmap(memory, size));
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ResourceUsageTest, HugePagesBackedBytesFitRss) {
+  using namespace wb::base;
+
+  const auto huge_pages_bytes = GetHugePagesBackedBytes();
+  ASSERT_TRUE(huge_pages_bytes.has_value());
+
+  const auto rss = GetResidentSetSizeBytes();
+  ASSERT_TRUE(rss.has_value());
+
+  // Hugetlbfs pages are not in RSS, but test process has none of them.
+  EXPECT_LE(*huge_pages_bytes, *rss);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ResourceUsageTest, ThreadSchedulingDelta) {
+  using namespace wb::base;
+  using namespace std::chrono_literals;
+
+  constexpr ThreadSchedulingSample start{.cpu_time = 10ms,
+                                         .voluntary_context_switches = 5,
+                                         .involuntary_context_switches = 1};
+  constexpr ThreadSchedulingSample end{.cpu_time = 25ms,
+                                       .voluntary_context_switches = 7,
+                                       .involuntary_context_switches = 4};
+
+  static_assert((end - start).cpu_time == 15ms);
+  static_assert((end - start).voluntary_context_switches == 2U);
+  static_assert((end - start).involuntary_context_switches == 3U);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ResourceUsageTest, SleepingThreadSwitchesVoluntarily) {
+  using namespace wb::base;
+  using namespace std::chrono_literals;
+
+  const auto start = GetCurrentThreadScheduling();
+  ASSERT_TRUE(start.has_value());
+
+  for (int i{0}; i < 5; ++i) std::this_thread::sleep_for(1ms);
+
+  const auto end = GetCurrentThreadScheduling();
+  ASSERT_TRUE(end.has_value());
+
+  EXPECT_GE((*end - *start).voluntary_context_switches, 5U);
+  EXPECT_GE(end->cpu_time, start->cpu_time);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ResourceUsageTest, OtherThreadScheduling) {
+  using namespace wb::base;
+  using namespace std::chrono_literals;
+
+  std::atomic<pid_t> thread_id{0};
+  std::atomic_bool should_stop{false};
+
+  std::thread spinner{[&]() {
+    thread_id.store(::gettid(), std::memory_order_release);
+    while (!should_stop.load(std::memory_order_acquire)) {
+    }
+  }};
+
+  clockid_t cpu_clock_id;
+  ASSERT_EQ(0, ::pthread_getcpuclockid(spinner.native_handle(),
+                                       &cpu_clock_id));
+  while (thread_id.load(std::memory_order_acquire) == 0) {
+    std::this_thread::yield();
+  }
+
+  std::this_thread::sleep_for(20ms);
+
+  const auto scheduling = GetThreadScheduling(thread_id, cpu_clock_id);
+  should_stop.store(true, std::memory_order_release);
+  spinner.join();
+
+  ASSERT_TRUE(scheduling.has_value()) << scheduling.error().message();
+  EXPECT_GT(scheduling->cpu_time, 0ms);
+
+  // No such thread.
+  EXPECT_FALSE(GetThreadScheduling(-1, cpu_clock_id).has_value());
+}
@@ -0,0 +1,220 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Linux process & thread resource usage.  Cheap enough to sample per frame.
+
+#include "resource_usage_unix.h"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <span>
+#include <string_view>
+
+#include "base/posix/system_error_ext.h"
+
+namespace {
+
+/**
+ * @brief Reads small /proc file.  Does not allocate.
+ * @param path File path.
+ * @param buffer Buffer to read to.
+ * @return Read bytes count.
+ */
+[[nodiscard]] wb::base::std2::result<std::size_t> ReadProcFile(
+    const char* path, std::span<char> buffer) noexcept {
+  using namespace wb::base;
+
+  const int fd{::open(path, O_RDONLY | O_CLOEXEC)};
+  if (fd == -1) [[unlikely]] {
+    return std2::result<std::size_t>{std::unexpect,
+                                     std2::posix_last_error_code()};
+  }
+
+  ssize_t read_count;
+  do {
+    read_count = ::read(fd, buffer.data(), buffer.size());
+  } while (read_count == -1 && errno == EINTR);
+
+  const std::error_code read_rc{read_count == -1
+                                    ? std2::posix_last_error_code()
+                                    : std2::ok_code};
+  ::close(fd);
+
+  if (read_rc) [[unlikely]] {
+    return std2::result<std::size_t>{std::unexpect, read_rc};
+  }
+
+  return static_cast<std::size_t>(read_count);
+}
+
+/**
+ * @brief Finds number value of "<key>\t<value>" line in /proc status file.
+ * @param status Status file content.
+ * @param key Key including leading new line and trailing colon.
+ * @param value Value.
+ * @return true if found and parsed.
+ */
+[[nodiscard]] bool FindStatusValue(std::string_view status,
+                                   std::string_view key,
+                                   std::uint64_t& value) noexcept {
+  const std::size_t offset{status.find(key)};
+  if (offset == std::string_view::npos) [[unlikely]] return false;
+
+  const std::size_t value_offset{
+      status.find_first_not_of(" \t", offset + key.size())};
+  if (value_offset == std::string_view::npos) [[unlikely]] return false;
+
+  const auto [ptr, ec] = std::from_chars(status.data() + value_offset,
+                                         status.data() + status.size(), value);
+  return ec == std::errc{};
+}
+
+}  // namespace
+
+namespace wb::base {
+
+[[nodiscard]] WB_BASE_API std2::result<ResourceUsageSample> GetResourceUsage(
+    ResourceUsageScope scope) noexcept {
+  rusage usage{};
+  const std::error_code rc{posix::get_error(::getrusage(
+      scope == ResourceUsageScope::kThread ? RUSAGE_THREAD : RUSAGE_SELF,
+      &usage))};
+  if (rc) [[unlikely]] {
+    return std2::result<ResourceUsageSample>{std::unexpect, rc};
+  }
+
+  return ResourceUsageSample{
+      .minor_page_faults = static_cast<std::uint64_t>(usage.ru_minflt),
+      .major_page_faults = static_cast<std::uint64_t>(usage.ru_majflt)};
+}
+
+[[nodiscard]] WB_BASE_API std2::result<ThreadSchedulingSample>
+GetCurrentThreadScheduling() noexcept {
+  rusage usage{};
+  std::error_code rc{posix::get_error(::getrusage(RUSAGE_THREAD, &usage))};
+  if (rc) [[unlikely]] {
+    return std2::result<ThreadSchedulingSample>{std::unexpect, rc};
+  }
+
+  // rusage CPU time has microseconds resolution, thread CPU clock is precise.
+  timespec cpu_time{};
+  rc = posix::get_error(::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time));
+  if (rc) [[unlikely]] {
+    return std2::result<ThreadSchedulingSample>{std::unexpect, rc};
+  }
+
+  return ThreadSchedulingSample{
+      .cpu_time = std::chrono::seconds{cpu_time.tv_sec} +
+                  std::chrono::nanoseconds{cpu_time.tv_nsec},
+      .voluntary_context_switches = static_cast<std::uint64_t>(usage.ru_nvcsw),
+      .involuntary_context_switches =
+          static_cast<std::uint64_t>(usage.ru_nivcsw)};
+}
+
+[[nodiscard]] WB_BASE_API std2::result<ThreadSchedulingSample>
+GetThreadScheduling(pid_t thread_id, clockid_t cpu_clock_id) noexcept {
+  timespec cpu_time{};
+  const std::error_code rc{
+      posix::get_error(::clock_gettime(cpu_clock_id, &cpu_time))};
+  if (rc) [[unlikely]] {
+    return std2::result<ThreadSchedulingSample>{std::unexpect, rc};
+  }
+
+  // Avoid fmt & std::ifstream, as they allocate.
+  std::array<char, 64> path{"/proc/self/task/"};
+  constexpr std::string_view kStatusSuffix{"/status"};
+  char* const path_last{path.data() + path.size() - kStatusSuffix.size() - 1};
+  char* path_end{path.data() + std::string_view{path.data()}.size()};
+
+  const auto [tid_end, ec] = std::to_chars(path_end, path_last, thread_id);
+  if (ec != std::errc{}) [[unlikely]] {
+    return std2::result<ThreadSchedulingSample>{std::unexpect,
+                                                std::make_error_code(ec)};
+  }
+  path_end = std::copy(kStatusSuffix.begin(), kStatusSuffix.end(), tid_end);
+  *path_end = '\0';
+
+  // Status is ~1.5KiB, context switches are at the end.
+  std::array<char, 4096> status;
+  const auto read_count = ReadProcFile(path.data(), status);
+  if (!read_count.has_value()) [[unlikely]] {
+    return std2::result<ThreadSchedulingSample>{std::unexpect,
+                                                read_count.error()};
+  }
+
+  const std::string_view status_view{status.data(), *read_count};
+  ThreadSchedulingSample sample{
+      .cpu_time = std::chrono::seconds{cpu_time.tv_sec} +
+                  std::chrono::nanoseconds{cpu_time.tv_nsec},
+      .voluntary_context_switches = 0,
+      .involuntary_context_switches = 0};
+  // Leading new line, as nonvoluntary_ctxt_switches ends with the same.
+  if (!FindStatusValue(status_view, "\nvoluntary_ctxt_switches:",
+                       sample.voluntary_context_switches) ||
+      !FindStatusValue(status_view, "\nnonvoluntary_ctxt_switches:",
+                       sample.involuntary_context_switches)) [[unlikely]] {
+    return std2::result<ThreadSchedulingSample>{
+        std::unexpect, std2::posix_last_error_code(EPROTO)};
+  }
+
+  return sample;
+}
+
+[[nodiscard]] WB_BASE_API std2::result<std::uint64_t>
+GetResidentSetSizeBytes() noexcept {
+  // Avoid std::ifstream, as it allocates.
+  // "size resident shared text lib data dt" in pages.
+  std::array<char, 128> statm;
+  const auto read_count = ReadProcFile("/proc/self/statm", statm);
+  if (!read_count.has_value()) [[unlikely]] {
+    return std2::result<std::uint64_t>{std::unexpect, read_count.error()};
+  }
+
+  const char* first{statm.data()};
+  const char* const last{statm.data() + *read_count};
+  // Skip size.
+  while (first != last && *first != ' ') ++first;
+  if (first != last) ++first;
+
+  std::uint64_t resident_pages{0};
+  const auto [ptr, ec] = std::from_chars(first, last, resident_pages);
+  if (ec != std::errc{}) [[unlikely]] {
+    return std2::result<std::uint64_t>{std::unexpect,
+                                       std::make_error_code(ec)};
+  }
+
+  static const auto page_size =
+      static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+  return resident_pages * page_size;
+}
+
+[[nodiscard]] WB_BASE_API std2::result<std::uint64_t>
+GetHugePagesBackedBytes() noexcept {
+  // Rollup is ~1KiB.
+  std::array<char, 4096> smaps;
+  const auto read_count = ReadProcFile("/proc/self/smaps_rollup", smaps);
+  if (!read_count.has_value()) [[unlikely]] {
+    return std2::result<std::uint64_t>{std::unexpect, read_count.error()};
+  }
+
+  const std::string_view smaps_view{smaps.data(), *read_count};
+  std::uint64_t anon_huge_kib{0}, shared_hugetlb_kib{0}, private_hugetlb_kib{0};
+  if (!FindStatusValue(smaps_view, "\nAnonHugePages:", anon_huge_kib) ||
+      !FindStatusValue(smaps_view, "\nShared_Hugetlb:", shared_hugetlb_kib) ||
+      !FindStatusValue(smaps_view, "\nPrivate_Hugetlb:", private_hugetlb_kib))
+      [[unlikely]] {
+    return std2::result<std::uint64_t>{std::unexpect,
+                                       std2::posix_last_error_code(EPROTO)};
+  }
+
+  return (anon_huge_kib + shared_hugetlb_kib + private_hugetlb_kib) * 1024U;
+}
+
+}  // namespace wb::base
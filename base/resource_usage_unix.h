@@ -0,0 +1,190 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Linux process & thread resource usage.  Cheap enough to sample per frame.
+//
+// Usage example:
+//
+// const auto start = GetResourceUsage(ResourceUsageScope::kThread);
+// LoadLevel(...);
+// const auto end = GetResourceUsage(ResourceUsageScope::kThread);
+// G3LOG(INFO) << "Level load major faults "
+//             << (*end - *start).major_page_faults;
+//
+// const auto worker = GetThreadScheduling(worker_thread_id,
+//                                         worker_cpu_clock_id);
+// G3LOG(INFO) << "Worker preempted " << worker->involuntary_context_switches
+//             << " times";
+
+#ifndef WB_BASE_RESOURCE_USAGE_UNIX_H_
+#define WB_BASE_RESOURCE_USAGE_UNIX_H_
+
+#include <sys/types.h>  // pid_t
+#include <time.h>       // clockid_t
+
+#include <chrono>
+#include <cstdint>
+
+#include "base/config.h"
+#include "base/std2/system_error_ext.h"
+
+namespace wb::base {
+
+/**
+ * @brief Whose resource usage to get.
+ */
+enum class ResourceUsageScope : std::uint8_t {
+  /**
+   * @brief All threads of the current process.
+   */
+  kProcess = 0U,
+  /**
+   * @brief Current thread only.
+   */
+  kThread = 1U
+};
+
+/**
+ * @brief Resource usage values.
+ */
+struct ResourceUsageSample {
+  /**
+   * @brief Page faults serviced without any I/O, ex. first touch of a page.
+   */
+  std::uint64_t minor_page_faults;
+  /**
+   * @brief Page faults serviced with I/O, ex. reading page from disk.
+   */
+  std::uint64_t major_page_faults;
+
+  /**
+   * @brief Subtracts |sample| values.
+   * @param sample Sample to subtract.
+   * @return *this.
+   */
+  constexpr ResourceUsageSample& operator-=(
+      const ResourceUsageSample& sample) noexcept {
+    minor_page_faults -= sample.minor_page_faults;
+    major_page_faults -= sample.major_page_faults;
+    return *this;
+  }
+};
+
+/**
+ * @brief Gets resource usage delta between samples.
+ * @param end End sample.
+ * @param start Start sample.
+ * @return Delta.
+ */
+[[nodiscard]] constexpr ResourceUsageSample operator-(
+    ResourceUsageSample end, const ResourceUsageSample& start) noexcept {
+  end -= start;
+  return end;
+}
+
+/**
+ * @brief Gets resource usage since process or thread start.
+ * @param scope Whose resource usage to get.
+ * @return Resource usage.
+ */
+[[nodiscard]] WB_BASE_API std2::result<ResourceUsageSample> GetResourceUsage(
+    ResourceUsageScope scope) noexcept;
+
+/**
+ * @brief Thread OS scheduling values.  CPU time well below wall time with many
+ * voluntary switches means thread is idle, many involuntary switches mean
+ * thread is descheduled while it has work, ex. by co-hosted processes.
+ */
+struct ThreadSchedulingSample {
+  /**
+   * @brief User and system CPU time.
+   */
+  std::chrono::nanoseconds cpu_time;
+  /**
+   * @brief Context switches because thread waited, ex. for lock or I/O.
+   */
+  std::uint64_t voluntary_context_switches;
+  /**
+   * @brief Context switches because thread was preempted, ex. time slice is
+   * over or higher priority thread is runnable.
+   */
+  std::uint64_t involuntary_context_switches;
+
+  /**
+   * @brief Adds |sample| values.
+   * @param sample Sample to add.
+   * @return *this.
+   */
+  constexpr ThreadSchedulingSample& operator+=(
+      const ThreadSchedulingSample& sample) noexcept {
+    cpu_time += sample.cpu_time;
+    voluntary_context_switches += sample.voluntary_context_switches;
+    involuntary_context_switches += sample.involuntary_context_switches;
+    return *this;
+  }
+
+  /**
+   * @brief Subtracts |sample| values.
+   * @param sample Sample to subtract.
+   * @return *this.
+   */
+  constexpr ThreadSchedulingSample& operator-=(
+      const ThreadSchedulingSample& sample) noexcept {
+    cpu_time -= sample.cpu_time;
+    voluntary_context_switches -= sample.voluntary_context_switches;
+    involuntary_context_switches -= sample.involuntary_context_switches;
+    return *this;
+  }
+};
+
+/**
+ * @brief Gets thread scheduling delta between samples.
+ * @param end End sample.
+ * @param start Start sample.
+ * @return Delta.
+ */
+[[nodiscard]] constexpr ThreadSchedulingSample operator-(
+    ThreadSchedulingSample end, const ThreadSchedulingSample& start) noexcept {
+  end -= start;
+  return end;
+}
+
+/**
+ * @brief Gets current thread scheduling since thread start.  Cheap enough to
+ * sample per frame.
+ * @return Thread scheduling.
+ */
+[[nodiscard]] WB_BASE_API std2::result<ThreadSchedulingSample>
+GetCurrentThreadScheduling() noexcept;
+
+/**
+ * @brief Gets scheduling of other thread of the current process since thread
+ * start.  Reads /proc/self/task/<tid>/status, so do not call too often.
+ * @param thread_id Thread id, ex. from gettid.
+ * @param cpu_clock_id Thread CPU clock id, ex. from pthread_getcpuclockid.
+ * @return Thread scheduling.
+ */
+[[nodiscard]] WB_BASE_API std2::result<ThreadSchedulingSample>
+GetThreadScheduling(pid_t thread_id, clockid_t cpu_clock_id) noexcept;
+
+/**
+ * @brief Gets current process resident set size.  Reads /proc/self/statm, so
+ * do not call too often.
+ * @return Resident set size in bytes.
+ */
+[[nodiscard]] WB_BASE_API std2::result<std::uint64_t>
+GetResidentSetSizeBytes() noexcept;
+
+/**
+ * @brief Gets current process memory backed by huge pages, both transparent
+ * and hugetlbfs ones.  Reads /proc/self/smaps_rollup, which walks process
+ * mappings, so do not call per frame.
+ * @return Huge pages backed bytes.
+ */
+[[nodiscard]] WB_BASE_API std2::result<std::uint64_t>
+GetHugePagesBackedBytes() noexcept;
+
+}  // namespace wb::base
+
+#endif  // !WB_BASE_RESOURCE_USAGE_UNIX_H_
@@ -0,0 +1,111 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// In-process statistical stack sampling profiler.
+
+#include "stack_sampling_profiler_unix.h"
+//
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+#include "base/deps/googletest/gtest/gtest.h"
+#include "base/high_resolution_clock.h"
+#include "build/compiler_config.h"
+
+namespace wb::base::tests_internal {
+
+/**
+ * @brief Burns CPU for |duration|.  Exported, so profiler can symbolize it.
+ * @param duration Duration.
+ * @return Some value to prevent optimization.
+ */
+WB_ATTRIBUTE_DLL_EXPORT std::uint64_t BurnCpu(
+    std::chrono::milliseconds duration);
+
+[[gnu::noinline]] WB_ATTRIBUTE_DLL_EXPORT std::uint64_t BurnCpu(
+    std::chrono::milliseconds duration) {
+  const auto end = wb::base::HighResolutionClock::now() + duration;
+
+  volatile std::uint64_t value{0};
+  while (wb::base::HighResolutionClock::now() < end) {
+    for (int i{0}; i < 1000; ++i) value = value + static_cast<unsigned>(i);
+  }
+  return value;
+}
+
+}  // namespace wb::base::tests_internal
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ScopedStackSamplingProfilerTest, NoCopyConstructorAndAssignment) {
+  using namespace wb::base;
+
+  static_assert(!std::is_copy_constructible_v<ScopedStackSamplingProfiler>);
+  static_assert(!std::is_copy_assignable_v<ScopedStackSamplingProfiler>);
+  static_assert(std::is_move_constructible_v<ScopedStackSamplingProfiler>);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ScopedStackSamplingProfilerTest, InvalidIntervalIsRejected) {
+  using namespace wb::base;
+
+  const auto profiler =
+      ScopedStackSamplingProfiler::New(std::chrono::microseconds{0}, "");
+  ASSERT_FALSE(profiler.has_value());
+  EXPECT_EQ(std2::posix_last_error_code(EINVAL), profiler.error());
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(ScopedStackSamplingProfilerTest, WritesFoldedStacks) {
+  using namespace wb::base;
+  using namespace std::chrono_literals;
+
+  const std::filesystem::path folded_path{
+      std::filesystem::temp_directory_path() /
+      "whitebox_stack_sampling_profiler_test.folded"};
+
+  const ScopedStackSamplingThread scoped_stack_sampling_thread{"TestMain"};
+
+  StackSamplingProfilerStats stats{};
+  {
+    auto profiler = ScopedStackSamplingProfiler::New(1ms, folded_path);
+    ASSERT_TRUE(profiler.has_value()) << profiler.error().message();
+
+    // Only single profiler can run at once.
+    const auto other_profiler = ScopedStackSamplingProfiler::New(1ms, "");
+    ASSERT_FALSE(other_profiler.has_value());
+    EXPECT_EQ(std2::posix_last_error_code(EBUSY), other_profiler.error());
+
+    EXPECT_NE(0U, tests_internal::BurnCpu(200ms));
+
+    stats = profiler->GetStats();
+  }
+
+  EXPECT_GT(stats.samples_count, 0U);
+
+  std::ifstream folded{folded_path};
+  ASSERT_TRUE(folded.is_open());
+
+  std::uint64_t folded_samples_count{0};
+  bool has_burn_cpu_frame{false};
+  for (std::string line; std::getline(folded, line);) {
+    EXPECT_TRUE(line.starts_with("TestMain;")) << line;
+
+    const std::size_t count_pos{line.rfind(' ')};
+    ASSERT_NE(std::string::npos, count_pos) << line;
+
+    folded_samples_count += std::stoull(line.substr(count_pos + 1));
+    has_burn_cpu_frame |= line.find("BurnCpu") != std::string::npos;
+  }
+
+  EXPECT_GT(folded_samples_count, 0U);
+  EXPECT_GE(folded_samples_count, stats.samples_count);
+  EXPECT_TRUE(has_burn_cpu_frame);
+
+  std::error_code rc;
+  std::filesystem::remove(folded_path, rc);
+}
@@ -0,0 +1,676 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// In-process statistical stack sampling profiler.
+
+#include "stack_sampling_profiler_unix.h"
+
+#include <cxxabi.h>  // abi::__cxa_demangle
+#include <dlfcn.h>   // dladdr
+#include <execinfo.h>  // backtrace
+#include <pthread.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/deps/fmt/core.h"
+#include "base/deps/g3log/g3log.h"
+#include "base/posix/system_error_ext.h"
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace {
+
+/**
+ * @brief Samples ring size.  Should be enough for all threads between drains.
+ */
+constexpr std::uint32_t kStackSamplesRingSize{4096U};
+
+/**
+ * @brief Frames to skip in backtrace: signal handler and signal trampoline.
+ */
+constexpr int kSkippedFramesCount{2};
+
+/**
+ * @brief How often samples ring is drained.
+ */
+constexpr std::chrono::milliseconds kDrainInterval{50};
+
+/**
+ * @brief Max thread name size including terminating zero.
+ */
+constexpr std::size_t kMaxThreadNameSize{32U};
+
+/**
+ * @brief Stack sample slot states.
+ */
+enum class StackSampleState : std::uint32_t {
+  kEmpty = 0U,
+  kWriting = 1U,
+  kReady = 2U
+};
+
+/**
+ * @brief Stack sample.
+ */
+struct StackSample {
+  /**
+   * @brief Slot state.
+   */
+  std::atomic<StackSampleState> state;
+  /**
+   * @brief Sampled thread index.
+   */
+  std::uint32_t thread_index;
+  /**
+   * @brief Captured frames count.
+   */
+  std::uint32_t frames_count;
+  /**
+   * @brief Captured frames, leaf first.
+   */
+  std::array<void*, wb::base::kMaxStackSampleFramesCount> frames;
+};
+
+/**
+ * @brief Sampled thread.
+ */
+struct SampledThread {
+  /**
+   * @brief Thread name.
+   */
+  std::array<char, kMaxThreadNameSize> name;
+  /**
+   * @brief Thread handle.
+   */
+  pthread_t thread;
+  /**
+   * @brief Kernel thread id.
+   */
+  pid_t tid;
+  /**
+   * @brief Is thread still registered.
+   */
+  bool is_alive;
+  /**
+   * @brief Has sampling timer.
+   */
+  bool has_timer;
+  /**
+   * @brief Sampling timer.
+   */
+  timer_t timer;
+};
+
+/**
+ * @brief Samples ring.  Static, so signal handler never sees freed memory.
+ * Zero pages are not committed until profiler is used.
+ */
+std::array<StackSample, kStackSamplesRingSize> stack_samples_ring;
+
+/**
+ * @brief Next sample slot index.
+ */
+std::atomic_uint64_t next_stack_sample_index{0};
+
+/**
+ * @brief Is sampling active.
+ */
+std::atomic_bool is_sampling{false};
+
+/**
+ * @brief Captured samples count.
+ */
+std::atomic_uint64_t stack_samples_count{0};
+
+/**
+ * @brief Dropped samples count.
+ */
+std::atomic_uint64_t dropped_stack_samples_count{0};
+
+/**
+ * @brief Guards sampled threads and timers.
+ */
+std::mutex sampled_threads_mutex;
+
+/**
+ * @brief Sampled threads.  Slots are never reused.
+ */
+std::array<SampledThread, wb::base::kMaxStackSamplingThreadsCount>
+    sampled_threads;
+
+/**
+ * @brief Registered sampled threads count.
+ */
+std::atomic_uint32_t sampled_threads_count{0};
+
+/**
+ * @brief Sampling interval while profiler runs, zero otherwise.  Guarded by
+ * sampled_threads_mutex.
+ */
+std::chrono::microseconds active_sampling_interval{0};
+
+/**
+ * @brief Is SIGPROF handler installed.  Guarded by sampled_threads_mutex.
+ */
+bool is_sigprof_handler_installed{false};
+
+/**
+ * @brief Current thread index or kMaxStackSamplingThreadsCount when not
+ * sampled.
+ */
+thread_local std::uint32_t current_sampled_thread_index{
+    wb::base::kMaxStackSamplingThreadsCount};
+
+/**
+ * @brief SIGPROF handler.  Async signal safe, does not allocate.
+ * @param signal Signal.
+ * @param info Signal info.
+ * @param context Signal context.
+ * @return void.
+ */
+void StackSamplingSignalHandler(int, siginfo_t*, void*) noexcept {
+  const int saved_errno{errno};
+
+  const std::uint32_t thread_index{current_sampled_thread_index};
+  if (is_sampling.load(std::memory_order_acquire) &&
+      thread_index < wb::base::kMaxStackSamplingThreadsCount) [[likely]] {
+    auto& sample =
+        stack_samples_ring[next_stack_sample_index.fetch_add(
+                               1, std::memory_order_relaxed) %
+                           kStackSamplesRingSize];
+
+    StackSampleState expected_state{StackSampleState::kEmpty};
+    if (sample.state.compare_exchange_strong(
+            expected_state, StackSampleState::kWriting,
+            std::memory_order_acquire, std::memory_order_relaxed)) [[likely]] {
+      std::array<void*,
+                 wb::base::kMaxStackSampleFramesCount + kSkippedFramesCount>
+          frames;
+      const int frames_count{
+          ::backtrace(frames.data(), static_cast<int>(frames.size()))};
+      const int sample_frames_count{
+          frames_count > kSkippedFramesCount
+              ? frames_count - kSkippedFramesCount
+              : 0};
+
+      std::memcpy(sample.frames.data(), frames.data() + kSkippedFramesCount,
+                  static_cast<std::size_t>(sample_frames_count) *
+                      sizeof(void*));
+      sample.thread_index = thread_index;
+      sample.frames_count = static_cast<std::uint32_t>(sample_frames_count);
+      sample.state.store(StackSampleState::kReady, std::memory_order_release);
+
+      stack_samples_count.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      // Drain thread is behind.
+      dropped_stack_samples_count.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  errno = saved_errno;
+}
+
+/**
+ * @brief Creates sampling timer for thread.  Requires sampled_threads_mutex.
+ * @param thread Sampled thread.
+ * @param sampling_interval Thread CPU time between samples.
+ * @return Error code.
+ */
+[[nodiscard]] std::error_code CreateSamplingTimer(
+    SampledThread& thread,
+    std::chrono::microseconds sampling_interval) noexcept {
+  using namespace wb::base;
+
+  G3DCHECK(!thread.has_timer);
+
+  clockid_t thread_cpu_clock;
+  if (const int rc{::pthread_getcpuclockid(thread.thread, &thread_cpu_clock)};
+      rc != 0) [[unlikely]] {
+    return std2::posix_last_error_code(rc);
+  }
+
+  sigevent event{};
+  event.sigev_notify = SIGEV_THREAD_ID;
+  event.sigev_signo = SIGPROF;
+  event.sigev_notify_thread_id = thread.tid;
+
+  if (const std::error_code rc{posix::get_error(
+          ::timer_create(thread_cpu_clock, &event, &thread.timer))};
+      rc) [[unlikely]] {
+    return rc;
+  }
+
+  const auto seconds =
+      std::chrono::duration_cast<std::chrono::seconds>(sampling_interval);
+  const auto nanoseconds =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(sampling_interval -
+                                                           seconds);
+  itimerspec spec{};
+  spec.it_interval.tv_sec = static_cast<time_t>(seconds.count());
+  spec.it_interval.tv_nsec = static_cast<long>(nanoseconds.count());
+  spec.it_value = spec.it_interval;
+
+  if (const std::error_code rc{
+          posix::get_error(::timer_settime(thread.timer, 0, &spec, nullptr))};
+      rc) [[unlikely]] {
+    const std::error_code delete_rc{
+        posix::get_error(::timer_delete(thread.timer))};
+    G3PLOGE2_IF(WARNING, delete_rc) << "Unable to delete sampling timer.";
+    return rc;
+  }
+
+  thread.has_timer = true;
+  return std2::ok_code;
+}
+
+/**
+ * @brief Deletes sampling timer of thread.  Requires sampled_threads_mutex.
+ * @param thread Sampled thread.
+ * @return void.
+ */
+void DeleteSamplingTimer(SampledThread& thread) noexcept {
+  if (thread.has_timer) {
+    const std::error_code rc{
+        wb::base::posix::get_error(::timer_delete(thread.timer))};
+    G3PLOGE2_IF(WARNING, rc) << "Unable to delete sampling timer of thread '"
+                             << thread.name.data() << "'.";
+    thread.has_timer = false;
+  }
+}
+
+/**
+ * @brief Symbolizes frame address.
+ * @param address Frame address.
+ * @return Symbol.
+ */
+[[nodiscard]] std::string SymbolizeAddress(void* address) {
+  Dl_info info{};
+  if (::dladdr(address, &info) == 0) [[unlikely]] {
+    return fmt::format("{0}", address);
+  }
+
+  if (info.dli_sname) {
+    int status{0};
+    char* demangled{
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status)};
+    std::string symbol{status == 0 && demangled ? demangled : info.dli_sname};
+    std::free(demangled);  // NOLINT(cppcoreguidelines-no-malloc)
+    return symbol;
+  }
+
+  const char* module_name{info.dli_fname ? std::strrchr(info.dli_fname, '/')
+                                         : nullptr};
+  module_name = module_name ? module_name + 1
+                            : (info.dli_fname ? info.dli_fname : "?");
+  return fmt::format(
+      "{0}+{1:#x}", module_name,
+      reinterpret_cast<std::uintptr_t>(address) -
+          reinterpret_cast<std::uintptr_t>(info.dli_fbase));
+}
+
+}  // namespace
+
+namespace wb::base {
+
+WB_BASE_API ScopedStackSamplingThread::ScopedStackSamplingThread(
+    const char* thread_name) noexcept
+    : thread_index_{
+          sampled_threads_count.fetch_add(1, std::memory_order_relaxed)} {
+  if (thread_index_ >= kMaxStackSamplingThreadsCount) [[unlikely]] {
+    thread_index_ = kMaxStackSamplingThreadsCount;
+    G3LOG(WARNING) << "Too many threads registered for stack sampling, thread '"
+                   << thread_name << "' is not sampled.";
+    return;
+  }
+
+  const std::scoped_lock lock{sampled_threads_mutex};
+
+  auto& thread = sampled_threads[thread_index_];
+  std::strncpy(thread.name.data(), thread_name, thread.name.size() - 1);
+  thread.thread = ::pthread_self();
+  thread.tid = static_cast<pid_t>(::syscall(SYS_gettid));
+  thread.is_alive = true;
+  thread.has_timer = false;
+
+  // Signal handler reads it, so set before timer.
+  current_sampled_thread_index = thread_index_;
+
+  if (active_sampling_interval.count() > 0) {
+    const std::error_code rc{
+        CreateSamplingTimer(thread, active_sampling_interval)};
+    G3PLOGE2_IF(WARNING, rc) << "Unable to sample thread '" << thread_name
+                             << "'.";
+  }
+}
+
+WB_BASE_API ScopedStackSamplingThread::~ScopedStackSamplingThread() noexcept {
+  if (thread_index_ >= kMaxStackSamplingThreadsCount) [[unlikely]] return;
+
+  const std::scoped_lock lock{sampled_threads_mutex};
+
+  auto& thread = sampled_threads[thread_index_];
+  DeleteSamplingTimer(thread);
+  thread.is_alive = false;
+
+  current_sampled_thread_index = kMaxStackSamplingThreadsCount;
+}
+
+/**
+ * @brief Stack sampling profiler implementation.
+ */
+class ScopedStackSamplingProfiler::Impl final {
+ public:
+  /**
+   * @brief Creates profiler implementation.
+   * @param folded_stacks_path Folded stacks output path.
+   */
+  explicit Impl(std::string folded_stacks_path) noexcept
+      : folded_stacks_path_{std::move(folded_stacks_path)},
+        is_started_{false},
+        is_stop_requested_{false} {}
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(Impl);
+
+  ~Impl() noexcept {
+    Stop();
+
+    {
+      const std::scoped_lock lock{drain_mutex_};
+      is_stop_requested_ = true;
+    }
+    drain_cv_.notify_one();
+
+    if (drain_thread_.joinable()) drain_thread_.join();
+  }
+
+  /**
+   * @brief Starts sampling registered threads.
+   * @param sampling_interval Thread CPU time between samples.
+   * @return Error code.
+   */
+  [[nodiscard]] std::error_code Start(
+      std::chrono::microseconds sampling_interval) noexcept {
+    const std::scoped_lock lock{sampled_threads_mutex};
+
+    if (active_sampling_interval.count() > 0) [[unlikely]] {
+      // Only single profiler at once.
+      return std2::posix_last_error_code(EBUSY);
+    }
+
+    if (!is_sigprof_handler_installed) {
+      // backtrace may load libgcc_s on first call, which is not async signal
+      // safe, so warm it up here.
+      std::array<void*, 4U> warm_up_frames;
+      ::backtrace(warm_up_frames.data(),
+                  static_cast<int>(warm_up_frames.size()));
+
+      struct sigaction action{};
+      action.sa_sigaction = StackSamplingSignalHandler;
+      action.sa_flags = SA_SIGINFO | SA_RESTART;
+      ::sigemptyset(&action.sa_mask);
+
+      // Handler stays installed after stop, as already queued SIGPROF would
+      // terminate process with default action.
+      if (const std::error_code rc{
+              posix::get_error(::sigaction(SIGPROF, &action, nullptr))};
+          rc) [[unlikely]] {
+        return rc;
+      }
+
+      is_sigprof_handler_installed = true;
+    }
+
+    for (auto& sample : stack_samples_ring) {
+      sample.state.store(StackSampleState::kEmpty, std::memory_order_relaxed);
+    }
+    stack_samples_count.store(0, std::memory_order_relaxed);
+    dropped_stack_samples_count.store(0, std::memory_order_relaxed);
+    is_sampling.store(true, std::memory_order_release);
+
+    active_sampling_interval = sampling_interval;
+
+    const std::uint32_t threads_count{std::min(
+        sampled_threads_count.load(std::memory_order_relaxed),
+        kMaxStackSamplingThreadsCount)};
+    for (std::uint32_t i{0}; i < threads_count; ++i) {
+      auto& thread = sampled_threads[i];
+      if (!thread.is_alive) continue;
+
+      const std::error_code rc{CreateSamplingTimer(thread, sampling_interval)};
+      G3PLOGE2_IF(WARNING, rc)
+          << "Unable to sample thread '" << thread.name.data() << "'.";
+    }
+
+    is_started_ = true;
+    drain_thread_ = std::thread{[this]() { DrainLoop(); }};
+    return std2::ok_code;
+  }
+
+  /**
+   * @brief Gets profiler stats.
+   * @return Stats.
+   */
+  [[nodiscard]] StackSamplingProfilerStats GetStats() const noexcept {
+    return {.samples_count =
+                stack_samples_count.load(std::memory_order_relaxed),
+            .dropped_samples_count =
+                dropped_stack_samples_count.load(std::memory_order_relaxed)};
+  }
+
+ private:
+  /**
+   * @brief Folded stack key: thread index, then frames from leaf to root.
+   */
+  using StackKey = std::vector<std::uintptr_t>;
+
+  /**
+   * @brief Folded stacks output path.
+   */
+  const std::string folded_stacks_path_;
+  /**
+   * @brief Samples count per stack.  Accessed by drain thread only.
+   */
+  std::map<StackKey, std::uint64_t> stacks_;
+  /**
+   * @brief Drain thread.
+   */
+  std::thread drain_thread_;
+  /**
+   * @brief Is sampling started by this profiler.  Guarded by
+   * sampled_threads_mutex.
+   */
+  bool is_started_;
+  /**
+   * @brief Guards |is_stop_requested_|.
+   */
+  std::mutex drain_mutex_;
+  /**
+   * @brief Wakes drain thread on stop.
+   */
+  std::condition_variable drain_cv_;
+  /**
+   * @brief Should drain thread stop.
+   */
+  bool is_stop_requested_;
+
+  /**
+   * @brief Stops sampling.
+   * @return void.
+   */
+  void Stop() noexcept {
+    const std::scoped_lock lock{sampled_threads_mutex};
+
+    // Other profiler may run.
+    if (!is_started_) return;
+
+    const std::uint32_t threads_count{std::min(
+        sampled_threads_count.load(std::memory_order_relaxed),
+        kMaxStackSamplingThreadsCount)};
+    for (std::uint32_t i{0}; i < threads_count; ++i) {
+      DeleteSamplingTimer(sampled_threads[i]);
+    }
+
+    is_sampling.store(false, std::memory_order_release);
+    active_sampling_interval = std::chrono::microseconds{0};
+    is_started_ = false;
+  }
+
+  /**
+   * @brief Drains samples ring till stop requested, then writes folded stacks.
+   * @return void.
+   */
+  void DrainLoop() {
+    bool is_stopping{false};
+    while (!is_stopping) {
+      {
+        std::unique_lock lock{drain_mutex_};
+        is_stopping = drain_cv_.wait_for(
+            lock, kDrainInterval, [this]() { return is_stop_requested_; });
+      }
+
+      DrainSamples();
+    }
+
+    WriteFoldedStacks();
+  }
+
+  /**
+   * @brief Moves ready samples from ring to stacks.
+   * @return void.
+   */
+  void DrainSamples() {
+    StackKey key;
+    key.reserve(kMaxStackSampleFramesCount + 1U);
+
+    for (auto& sample : stack_samples_ring) {
+      if (sample.state.load(std::memory_order_acquire) !=
+          StackSampleState::kReady) {
+        continue;
+      }
+
+      key.clear();
+      key.emplace_back(sample.thread_index);
+      for (std::uint32_t i{0}; i < sample.frames_count; ++i) {
+        key.emplace_back(reinterpret_cast<std::uintptr_t>(sample.frames[i]));
+      }
+
+      sample.state.store(StackSampleState::kEmpty, std::memory_order_release);
+
+      ++stacks_[key];
+    }
+  }
+
+  /**
+   * @brief Symbolizes stacks and writes them in folded format:
+   * thread;root;...;leaf count.
+   * @return void.
+   */
+  void WriteFoldedStacks() {
+    std::ofstream folded{folded_stacks_path_, std::ios::out | std::ios::trunc};
+    if (!folded) [[unlikely]] {
+      G3LOG(WARNING) << "Unable to open folded stacks file '"
+                     << folded_stacks_path_ << "', skip writing CPU profile.";
+      return;
+    }
+
+    std::unordered_map<std::uintptr_t, std::string> symbols;
+    const auto symbolize = [&symbols](std::uintptr_t address,
+                                      bool is_leaf) -> const std::string& {
+      // Return addresses point after call, step back into call instruction.
+      const std::uintptr_t call_address{is_leaf ? address : address - 1U};
+      auto it = symbols.find(call_address);
+      if (it == symbols.end()) {
+        it = symbols
+                 .emplace(call_address, SymbolizeAddress(
+                                            reinterpret_cast<void*>(
+                                                call_address)))
+                 .first;
+      }
+      return it->second;
+    };
+
+    std::string line;
+    for (const auto& [key, count] : stacks_) {
+      line.assign(sampled_threads[key[0]].name.data());
+
+      // Root first.
+      for (std::size_t i{key.size() - 1}; i > 0; --i) {
+        line += ';';
+        line += symbolize(key[i], i == 1);
+      }
+
+      folded << line << ' ' << count << '\n';
+    }
+
+    if (!folded) [[unlikely]] {
+      G3LOG(WARNING) << "Unable to write folded stacks file '"
+                     << folded_stacks_path_ << "'.";
+      return;
+    }
+
+    const StackSamplingProfilerStats stats{GetStats()};
+    G3LOG(INFO) << "CPU profile of " << stats.samples_count << " samples ("
+                << stats.dropped_samples_count << " dropped, "
+                << stacks_.size() << " unique stacks) is written to '"
+                << folded_stacks_path_ << "'.";
+  }
+};
+
+[[nodiscard]] std2::result<ScopedStackSamplingProfiler>
+ScopedStackSamplingProfiler::New(std::chrono::microseconds sampling_interval,
+                                 std::string folded_stacks_path) noexcept {
+  if (sampling_interval.count() <= 0) [[unlikely]] {
+    return std2::result<ScopedStackSamplingProfiler>{
+        std::unexpect, std2::posix_last_error_code(EINVAL)};
+  }
+
+  auto impl = std::make_unique<Impl>(std::move(folded_stacks_path));
+  if (const std::error_code rc{impl->Start(sampling_interval)}; rc)
+      [[unlikely]] {
+    return std2::result<ScopedStackSamplingProfiler>{std::unexpect, rc};
+  }
+
+  return ScopedStackSamplingProfiler{std::move(impl)};
+}
+
+ScopedStackSamplingProfiler::ScopedStackSamplingProfiler(
+    un<Impl> impl) noexcept
+    : impl_{std::move(impl)} {
+  G3DCHECK(!!impl_);
+}
+
+ScopedStackSamplingProfiler::ScopedStackSamplingProfiler(
+    ScopedStackSamplingProfiler&& p) noexcept = default;
+
+ScopedStackSamplingProfiler& ScopedStackSamplingProfiler::operator=(
+    ScopedStackSamplingProfiler&& p) noexcept = default;
+
+ScopedStackSamplingProfiler::~ScopedStackSamplingProfiler() noexcept = default;
+
+[[nodiscard]] StackSamplingProfilerStats
+ScopedStackSamplingProfiler::GetStats() const noexcept {
+  G3DCHECK(!!impl_);
+
+  return impl_->GetStats();
+}
+
+}  // namespace wb::base
@@ -0,0 +1,136 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// In-process statistical stack sampling profiler.  Per thread CPU time timers
+// send SIGPROF to registered threads, signal handler captures backtrace into
+// preallocated lock-free ring, separate thread drains ring, symbolizes stacks
+// and writes folded stacks (flamegraph.pl, speedscope, inferno) on stop.
+//
+// Usage example:
+//
+// // Each thread to sample.
+// const ScopedStackSamplingThread scoped_stack_sampling_thread{"Main"};
+// ...
+// auto profiler = ScopedStackSamplingProfiler::New(
+//     std::chrono::microseconds{10'000}, "cpu_profile.folded");
+
+#ifndef WB_BASE_STACK_SAMPLING_PROFILER_UNIX_H_
+#define WB_BASE_STACK_SAMPLING_PROFILER_UNIX_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "base/config.h"
+#include "base/macroses.h"
+#include "base/std2/system_error_ext.h"
+
+namespace wb::base {
+
+/**
+ * @brief Max threads count which can be registered for sampling during process
+ * lifetime.  Threads above limit are not sampled.
+ */
+inline constexpr std::uint32_t kMaxStackSamplingThreadsCount{256U};
+
+/**
+ * @brief Max captured stack depth.  Deeper stacks are truncated to leaf
+ * frames.
+ */
+inline constexpr std::uint32_t kMaxStackSampleFramesCount{64U};
+
+/**
+ * @brief Stack sampling profiler stats.
+ */
+struct StackSamplingProfilerStats {
+  /**
+   * @brief Captured samples count.
+   */
+  std::uint64_t samples_count;
+  /**
+   * @brief Samples dropped as ring was full.
+   */
+  std::uint64_t dropped_samples_count;
+};
+
+/**
+ * @brief Registers current thread for stack sampling in scope.  Thread is
+ * sampled only when profiler is running.  Can be created before or after
+ * profiler start.
+ */
+class WB_BASE_API ScopedStackSamplingThread {
+ public:
+  /**
+   * @brief Registers current thread for stack sampling.
+   * @param thread_name Thread name to use as root frame.  Copied.
+   */
+  explicit ScopedStackSamplingThread(const char* thread_name) noexcept;
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(ScopedStackSamplingThread);
+
+  /**
+   * @brief Unregisters current thread from stack sampling.
+   */
+  ~ScopedStackSamplingThread() noexcept;
+
+ private:
+  /**
+   * @brief Thread slot index or kMaxStackSamplingThreadsCount when no free
+   * slots.  Slots are never reused, so samples are attributed to proper thread
+   * name.
+   */
+  std::uint32_t thread_index_;
+};
+
+/**
+ * @brief Samples registered threads stacks in scope.  Only single profiler can
+ * run at once.
+ */
+class WB_BASE_API ScopedStackSamplingProfiler {
+ public:
+  /**
+   * @brief Starts stack sampling profiler.
+   * @param sampling_interval Thread CPU time between samples.
+   * @param folded_stacks_path Folded stacks output path.
+   * @return Stack sampling profiler or error.
+   */
+  [[nodiscard]] static std2::result<ScopedStackSamplingProfiler> New(
+      std::chrono::microseconds sampling_interval,
+      std::string folded_stacks_path) noexcept;
+
+  ScopedStackSamplingProfiler(ScopedStackSamplingProfiler&& p) noexcept;
+  ScopedStackSamplingProfiler& operator=(
+      ScopedStackSamplingProfiler&& p) noexcept;
+
+  WB_NO_COPY_CTOR_AND_ASSIGNMENT(ScopedStackSamplingProfiler);
+
+  /**
+   * @brief Stops stack sampling profiler and writes folded stacks.
+   */
+  ~ScopedStackSamplingProfiler() noexcept;
+
+  /**
+   * @brief Gets profiler stats.
+   * @return Stats.
+   */
+  [[nodiscard]] StackSamplingProfilerStats GetStats() const noexcept;
+
+ private:
+  class Impl;
+
+  /**
+   * @brief Implementation.
+   */
+  un<Impl> impl_;
+
+  /**
+   * @brief Creates stack sampling profiler.
+   * @param impl Implementation.
+   */
+  explicit ScopedStackSamplingProfiler(un<Impl> impl) noexcept;
+};
+
+}  // namespace wb::base
+
+#endif  // !WB_BASE_STACK_SAMPLING_PROFILER_UNIX_H_
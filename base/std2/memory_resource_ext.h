@@ -0,0 +1,94 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// <memory_resource> extensions.  Polymorphic allocator aware containers, use
+// with base/memory/memory_resources.h adapters.
+
+#ifndef WB_BASE_STD2_MEMORY_RESOURCE_EXT_H_
+#define WB_BASE_STD2_MEMORY_RESOURCE_EXT_H_
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace wb::base::std2::pmr {
+
+/**
+ * @brief Polymorphic allocator.
+ * @tparam T Value type.
+ */
+template <typename T>
+using polymorphic_allocator = std::pmr::polymorphic_allocator<T>;
+
+/**
+ * @brief String with polymorphic allocator.
+ */
+using string = std::pmr::string;
+
+/**
+ * @brief Vector with polymorphic allocator.
+ * @tparam T Value type.
+ */
+template <typename T>
+using vector = std::vector<T, polymorphic_allocator<T>>;
+
+/**
+ * @brief Deque with polymorphic allocator.
+ * @tparam T Value type.
+ */
+template <typename T>
+using deque = std::deque<T, polymorphic_allocator<T>>;
+
+/**
+ * @brief Map with polymorphic allocator.
+ * @tparam TKey Key type.
+ * @tparam TValue Value type.
+ * @tparam TLess Key comparator.
+ */
+template <typename TKey, typename TValue, typename TLess = std::less<TKey>>
+using map = std::map<TKey, TValue, TLess,
+                     polymorphic_allocator<std::pair<const TKey, TValue>>>;
+
+/**
+ * @brief Set with polymorphic allocator.
+ * @tparam TKey Key type.
+ * @tparam TLess Key comparator.
+ */
+template <typename TKey, typename TLess = std::less<TKey>>
+using set = std::set<TKey, TLess, polymorphic_allocator<TKey>>;
+
+/**
+ * @brief Unordered map with polymorphic allocator.
+ * @tparam TKey Key type.
+ * @tparam TValue Value type.
+ * @tparam THash Key hasher.
+ * @tparam TEqual Key equality comparator.
+ */
+template <typename TKey, typename TValue, typename THash = std::hash<TKey>,
+          typename TEqual = std::equal_to<TKey>>
+using unordered_map =
+    std::unordered_map<TKey, TValue, THash, TEqual,
+                       polymorphic_allocator<std::pair<const TKey, TValue>>>;
+
+/**
+ * @brief Unordered set with polymorphic allocator.
+ * @tparam TKey Key type.
+ * @tparam THash Key hasher.
+ * @tparam TEqual Key equality comparator.
+ */
+template <typename TKey, typename THash = std::hash<TKey>,
+          typename TEqual = std::equal_to<TKey>>
+using unordered_set =
+    std::unordered_set<TKey, THash, TEqual, polymorphic_allocator<TKey>>;
+
+}  // namespace wb::base::std2::pmr
+
+#endif  // !WB_BASE_STD2_MEMORY_RESOURCE_EXT_H_
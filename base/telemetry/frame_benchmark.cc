@@ -0,0 +1,312 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Frame benchmark.  Collects frame times and allocations over fixed frames
+// count, stores results as JSON and compares results of two runs.
+
+#include "frame_benchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <type_traits>
+
+#include "base/deps/fmt/core.h"
+
+namespace {
+
+/**
+ * @brief Nanoseconds in millisecond.
+ */
+constexpr double kNsInMs{1'000'000.0};
+
+/**
+ * @brief Mean frame time difference should be above this count of standard
+ * errors to be significant.
+ */
+constexpr double kSignificantStandardErrorsCount{3.0};
+
+/**
+ * @brief Gets nearest rank percentile of sorted values.
+ * @param sorted_values Sorted values.
+ * @param percentile Percentile, [0..100].
+ * @return Percentile value.
+ */
+[[nodiscard]] std::int64_t GetPercentile(
+    const std::vector<std::int64_t>& sorted_values,
+    double percentile) noexcept {
+  if (sorted_values.empty()) return 0;
+
+  const auto rank = static_cast<std::size_t>(
+      std::ceil(percentile / 100.0 * static_cast<double>(sorted_values.size())));
+  return sorted_values[std::clamp(rank, std::size_t{1}, sorted_values.size()) -
+                       1U];
+}
+
+/**
+ * @brief Finds JSON number value by key in flat JSON object.
+ * @tparam T Value type.
+ * @param json JSON.
+ * @param key Key.
+ * @param value Value.
+ * @return true if found and parsed.
+ */
+template <typename T>
+[[nodiscard]] bool FindJsonNumber(std::string_view json, std::string_view key,
+                                  T& value) noexcept {
+  const std::string quoted_key{fmt::format("\"{0}\"", key)};
+
+  std::size_t offset{json.find(quoted_key)};
+  if (offset == std::string_view::npos) return false;
+
+  offset = json.find(':', offset + quoted_key.size());
+  if (offset == std::string_view::npos) return false;
+
+  offset = json.find_first_not_of(" \t\r\n", offset + 1U);
+  if (offset == std::string_view::npos) return false;
+
+  if constexpr (std::is_floating_point_v<T>) {
+    // Floating point std::from_chars is not implemented by all supported
+    // standard libraries, so copy bounded number to null-terminated buffer.
+    std::array<char, 64> number{};
+    const std::size_t number_end_offset{std::min(
+        json.find_first_not_of("+-.0123456789eE", offset), json.size())};
+    const std::size_t number_size{number_end_offset - offset};
+    if (number_size == 0 || number_size >= number.size()) return false;
+
+    std::copy_n(json.data() + offset, number_size, number.data());
+
+    char* number_end{nullptr};
+    errno = 0;
+    const double parsed{std::strtod(number.data(), &number_end)};
+    if (errno != 0 || number_end != number.data() + number_size) return false;
+
+    value = static_cast<T>(parsed);
+    return true;
+  } else {
+    const char* last{json.data() + json.size()};
+    const auto [ptr, ec] = std::from_chars(json.data() + offset, last, value);
+    return ec == std::errc{};
+  }
+}
+
+/**
+ * @brief Gets relative change.
+ * @param baseline Baseline.
+ * @param candidate Candidate.
+ * @return Relative change, %.
+ */
+[[nodiscard]] double GetChangePercent(double baseline,
+                                      double candidate) noexcept {
+  if (baseline == 0.0) return candidate == 0.0 ? 0.0 : 100.0;
+  return (candidate - baseline) / baseline * 100.0;
+}
+
+/**
+ * @brief Compares lower is better metric.
+ * @param name Metric name.
+ * @param baseline Baseline.
+ * @param candidate Candidate.
+ * @param threshold_percent Significant change threshold, %.
+ * @return Comparison.
+ */
+[[nodiscard]] wb::base::telemetry::FrameBenchmarkMetricComparison
+CompareMetric(const char* name, double baseline, double candidate,
+              double threshold_percent) noexcept {
+  using wb::base::telemetry::FrameBenchmarkVerdict;
+
+  const double change_percent{GetChangePercent(baseline, candidate)};
+  const FrameBenchmarkVerdict verdict{
+      std::abs(change_percent) <= threshold_percent
+          ? FrameBenchmarkVerdict::kSame
+          : (change_percent < 0.0 ? FrameBenchmarkVerdict::kBetter
+                                  : FrameBenchmarkVerdict::kWorse)};
+  return {.name = name,
+          .baseline = baseline,
+          .candidate = candidate,
+          .change_percent = change_percent,
+          .threshold_percent = threshold_percent,
+          .verdict = verdict};
+}
+
+}  // namespace
+
+namespace wb::base::telemetry {
+
+WB_BASE_API FrameBenchmark::FrameBenchmark(std::uint32_t frames_count)
+    : allocations_count_{0}, allocated_bytes_{0}, frames_count_{frames_count} {
+  frame_times_ns_.reserve(frames_count);
+}
+
+WB_BASE_API void FrameBenchmark::AddFrame(
+    std::chrono::nanoseconds frame_time, std::uint64_t allocations_count,
+    std::uint64_t allocated_bytes) noexcept {
+  if (IsFinished()) [[unlikely]] return;
+
+  // Reserved, so never allocates.
+  frame_times_ns_.emplace_back(frame_time.count());
+  allocations_count_ += allocations_count;
+  allocated_bytes_ += allocated_bytes;
+}
+
+[[nodiscard]] WB_BASE_API FrameBenchmarkResults FrameBenchmark::Finish(
+    std::uint64_t rss_bytes, std::uint64_t peak_rss_bytes) const {
+  FrameBenchmarkResults results{};
+  results.frames_count = frame_times_ns_.size();
+  results.rss_bytes = rss_bytes;
+  results.peak_rss_bytes = peak_rss_bytes;
+
+  if (frame_times_ns_.empty()) [[unlikely]] return results;
+
+  const auto frames_count = static_cast<double>(frame_times_ns_.size());
+  const double mean_ns{
+      static_cast<double>(std::accumulate(frame_times_ns_.begin(),
+                                          frame_times_ns_.end(),
+                                          std::int64_t{0})) /
+      frames_count};
+
+  double variance_ns{0.0};
+  for (const std::int64_t frame_time_ns : frame_times_ns_) {
+    const double delta{static_cast<double>(frame_time_ns) - mean_ns};
+    variance_ns += delta * delta;
+  }
+  variance_ns /= frames_count;
+
+  std::vector<std::int64_t> sorted_frame_times_ns{frame_times_ns_};
+  std::sort(sorted_frame_times_ns.begin(), sorted_frame_times_ns.end());
+
+  results.frame_time_mean_ms = mean_ns / kNsInMs;
+  results.frame_time_stddev_ms = std::sqrt(variance_ns) / kNsInMs;
+  results.frame_time_p50_ms =
+      static_cast<double>(GetPercentile(sorted_frame_times_ns, 50.0)) /
+      kNsInMs;
+  results.frame_time_p99_ms =
+      static_cast<double>(GetPercentile(sorted_frame_times_ns, 99.0)) /
+      kNsInMs;
+  results.frame_time_max_ms =
+      static_cast<double>(sorted_frame_times_ns.back()) / kNsInMs;
+  results.allocations_per_frame =
+      static_cast<double>(allocations_count_) / frames_count;
+  results.allocated_bytes_per_frame =
+      static_cast<double>(allocated_bytes_) / frames_count;
+
+  return results;
+}
+
+[[nodiscard]] WB_BASE_API std::string FormatFrameBenchmarkResults(
+    const FrameBenchmarkResults& results) {
+  return fmt::format(
+      "{{\n"
+      "  \"version\": {0},\n"
+      "  \"frames_count\": {1},\n"
+      "  \"frame_time_mean_ms\": {2},\n"
+      "  \"frame_time_stddev_ms\": {3},\n"
+      "  \"frame_time_p50_ms\": {4},\n"
+      "  \"frame_time_p99_ms\": {5},\n"
+      "  \"frame_time_max_ms\": {6},\n"
+      "  \"allocations_per_frame\": {7},\n"
+      "  \"allocated_bytes_per_frame\": {8},\n"
+      "  \"rss_bytes\": {9},\n"
+      "  \"peak_rss_bytes\": {10}\n"
+      "}}\n",
+      kFrameBenchmarkResultsVersion, results.frames_count,
+      results.frame_time_mean_ms, results.frame_time_stddev_ms,
+      results.frame_time_p50_ms, results.frame_time_p99_ms,
+      results.frame_time_max_ms, results.allocations_per_frame,
+      results.allocated_bytes_per_frame, results.rss_bytes,
+      results.peak_rss_bytes);
+}
+
+[[nodiscard]] WB_BASE_API std2::result<FrameBenchmarkResults>
+ParseFrameBenchmarkResults(std::string_view json) noexcept {
+  std::uint32_t version{0};
+  if (!FindJsonNumber(json, "version", version)) [[unlikely]] {
+    return std2::result<FrameBenchmarkResults>{
+        std::unexpect, std2::posix_last_error_code(EINVAL)};
+  }
+  if (version != kFrameBenchmarkResultsVersion) [[unlikely]] {
+    return std2::result<FrameBenchmarkResults>{
+        std::unexpect, std2::posix_last_error_code(EPROTO)};
+  }
+
+  FrameBenchmarkResults results{};
+  const bool is_parsed{
+      FindJsonNumber(json, "frames_count", results.frames_count) &&
+      FindJsonNumber(json, "frame_time_mean_ms", results.frame_time_mean_ms) &&
+      FindJsonNumber(json, "frame_time_stddev_ms",
+                     results.frame_time_stddev_ms) &&
+      FindJsonNumber(json, "frame_time_p50_ms", results.frame_time_p50_ms) &&
+      FindJsonNumber(json, "frame_time_p99_ms", results.frame_time_p99_ms) &&
+      FindJsonNumber(json, "frame_time_max_ms", results.frame_time_max_ms) &&
+      FindJsonNumber(json, "allocations_per_frame",
+                     results.allocations_per_frame) &&
+      FindJsonNumber(json, "allocated_bytes_per_frame",
+                     results.allocated_bytes_per_frame) &&
+      FindJsonNumber(json, "rss_bytes", results.rss_bytes) &&
+      FindJsonNumber(json, "peak_rss_bytes", results.peak_rss_bytes)};
+  if (!is_parsed) [[unlikely]] {
+    return std2::result<FrameBenchmarkResults>{
+        std::unexpect, std2::posix_last_error_code(EINVAL)};
+  }
+
+  return results;
+}
+
+[[nodiscard]] WB_BASE_API std::vector<FrameBenchmarkMetricComparison>
+CompareFrameBenchmarkResults(const FrameBenchmarkResults& baseline,
+                             const FrameBenchmarkResults& candidate,
+                             double threshold_percent) {
+  std::vector<FrameBenchmarkMetricComparison> comparisons;
+  comparisons.reserve(8U);
+
+  // Mean difference should be both relatively large and above standard error
+  // of means difference, so few outliers in short runs do not flip verdict.
+  auto mean = CompareMetric("frame_time_mean_ms", baseline.frame_time_mean_ms,
+                            candidate.frame_time_mean_ms, threshold_percent);
+  if (baseline.frames_count > 0 && candidate.frames_count > 0) {
+    const double standard_error_ms{std::sqrt(
+        baseline.frame_time_stddev_ms * baseline.frame_time_stddev_ms /
+            static_cast<double>(baseline.frames_count) +
+        candidate.frame_time_stddev_ms * candidate.frame_time_stddev_ms /
+            static_cast<double>(candidate.frames_count))};
+    if (std::abs(candidate.frame_time_mean_ms - baseline.frame_time_mean_ms) <=
+        kSignificantStandardErrorsCount * standard_error_ms) {
+      mean.verdict = FrameBenchmarkVerdict::kSame;
+    }
+  }
+  comparisons.emplace_back(mean);
+
+  comparisons.emplace_back(CompareMetric(
+      "frame_time_p50_ms", baseline.frame_time_p50_ms,
+      candidate.frame_time_p50_ms, threshold_percent));
+  // Tails are noisier.
+  comparisons.emplace_back(CompareMetric(
+      "frame_time_p99_ms", baseline.frame_time_p99_ms,
+      candidate.frame_time_p99_ms, 2.0 * threshold_percent));
+  comparisons.emplace_back(CompareMetric(
+      "frame_time_max_ms", baseline.frame_time_max_ms,
+      candidate.frame_time_max_ms, 4.0 * threshold_percent));
+  // Allocations are deterministic for scripted workload.
+  comparisons.emplace_back(CompareMetric(
+      "allocations_per_frame", baseline.allocations_per_frame,
+      candidate.allocations_per_frame, threshold_percent));
+  comparisons.emplace_back(CompareMetric(
+      "allocated_bytes_per_frame", baseline.allocated_bytes_per_frame,
+      candidate.allocated_bytes_per_frame, threshold_percent));
+  comparisons.emplace_back(
+      CompareMetric("rss_bytes", static_cast<double>(baseline.rss_bytes),
+                    static_cast<double>(candidate.rss_bytes),
+                    threshold_percent));
+  comparisons.emplace_back(CompareMetric(
+      "peak_rss_bytes", static_cast<double>(baseline.peak_rss_bytes),
+      static_cast<double>(candidate.peak_rss_bytes), threshold_percent));
+
+  return comparisons;
+}
+
+}  // namespace wb::base::telemetry
@@ -0,0 +1,229 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Frame benchmark.  Collects frame times and allocations over fixed frames
+// count, stores results as JSON and compares results of two runs.
+//
+// Usage example:
+//
+// FrameBenchmark benchmark{1000U};
+// while (!benchmark.IsFinished()) {
+//   ...
+//   benchmark.AddFrame(frame_time, allocations_count, allocated_bytes);
+// }
+// const auto results = benchmark.Finish(rss_bytes, peak_rss_bytes);
+// const std::string json{FormatFrameBenchmarkResults(results)};
+
+#ifndef WB_BASE_TELEMETRY_FRAME_BENCHMARK_H_
+#define WB_BASE_TELEMETRY_FRAME_BENCHMARK_H_
+
+#include <chrono>
+#include <cstddef>  // std::byte
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "base/config.h"
+#include "base/std2/system_error_ext.h"
+#include "build/compiler_config.h"
+
+namespace wb::base::telemetry {
+
+/**
+ * @brief Frame benchmark results format version.  Bump when
+ * FrameBenchmarkResults changes.
+ */
+inline constexpr std::uint32_t kFrameBenchmarkResultsVersion{1U};
+
+/**
+ * @brief Frame benchmark results.
+ */
+struct FrameBenchmarkResults {
+  /**
+   * @brief Benchmarked frames count.
+   */
+  std::uint64_t frames_count;
+  /**
+   * @brief Mean frame time, ms.
+   */
+  double frame_time_mean_ms;
+  /**
+   * @brief Frame time standard deviation, ms.
+   */
+  double frame_time_stddev_ms;
+  /**
+   * @brief Median frame time, ms.
+   */
+  double frame_time_p50_ms;
+  /**
+   * @brief 99th percentile frame time, ms.
+   */
+  double frame_time_p99_ms;
+  /**
+   * @brief Max frame time, ms.
+   */
+  double frame_time_max_ms;
+  /**
+   * @brief Mean heap allocations count per frame.
+   */
+  double allocations_per_frame;
+  /**
+   * @brief Mean heap allocated bytes per frame.
+   */
+  double allocated_bytes_per_frame;
+  /**
+   * @brief Resident set size at the end of benchmark, bytes.
+   */
+  std::uint64_t rss_bytes;
+  /**
+   * @brief Peak resident set size, bytes.
+   */
+  std::uint64_t peak_rss_bytes;
+};
+
+/**
+ * @brief Collects frames stats over fixed frames count.
+ */
+class WB_BASE_API FrameBenchmark {
+ public:
+  /**
+   * @brief Creates frame benchmark.  Preallocates frame times storage, so
+   * benchmark does not allocate during frames.
+   * @param frames_count Frames count to benchmark.
+   */
+  explicit FrameBenchmark(std::uint32_t frames_count);
+
+  /**
+   * @brief Records frame.
+   * @param frame_time Frame time.
+   * @param allocations_count Heap allocations count during frame.
+   * @param allocated_bytes Heap allocated bytes during frame.
+   * @return void.
+   */
+  void AddFrame(std::chrono::nanoseconds frame_time,
+                std::uint64_t allocations_count,
+                std::uint64_t allocated_bytes) noexcept;
+
+  /**
+   * @brief Are all frames recorded.
+   * @return true if finished.
+   */
+  [[nodiscard]] bool IsFinished() const noexcept {
+    return frame_times_ns_.size() >= frames_count_;
+  }
+
+  /**
+   * @brief Computes benchmark results.
+   * @param rss_bytes Resident set size at the end of benchmark, bytes.
+   * @param peak_rss_bytes Peak resident set size, bytes.
+   * @return Results.
+   */
+  [[nodiscard]] FrameBenchmarkResults Finish(
+      std::uint64_t rss_bytes, std::uint64_t peak_rss_bytes) const;
+
+ private:
+  /**
+   * @brief Frame times, ns.
+   */
+  std::vector<std::int64_t> frame_times_ns_;
+  /**
+   * @brief Total allocations count.
+   */
+  std::uint64_t allocations_count_;
+  /**
+   * @brief Total allocated bytes.
+   */
+  std::uint64_t allocated_bytes_;
+  /**
+   * @brief Frames count to benchmark.
+   */
+  std::uint64_t frames_count_;
+};
+
+/**
+ * @brief Formats frame benchmark results as JSON.
+ * @param results Results.
+ * @return JSON.
+ */
+[[nodiscard]] WB_BASE_API std::string FormatFrameBenchmarkResults(
+    const FrameBenchmarkResults& results);
+
+/**
+ * @brief Parses frame benchmark results JSON produced by
+ * FormatFrameBenchmarkResults.
+ * @param json JSON.
+ * @return Results or EINVAL on malformed JSON and EPROTO on version mismatch.
+ */
+[[nodiscard]] WB_BASE_API std2::result<FrameBenchmarkResults>
+ParseFrameBenchmarkResults(std::string_view json) noexcept;
+
+/**
+ * @brief Frame benchmark metric change verdict.
+ */
+enum class FrameBenchmarkVerdict : std::uint8_t {
+  /**
+   * @brief Change is within noise.
+   */
+  kSame = 0U,
+  /**
+   * @brief Metric is better, ex. lower frame time.
+   */
+  kBetter = 1U,
+  /**
+   * @brief Metric is worse, ex. higher frame time.
+   */
+  kWorse = 2U
+};
+
+/**
+ * @brief Comparison of single frame benchmark metric.  Lower is better for all
+ * metrics.
+ */
+struct FrameBenchmarkMetricComparison {
+  /**
+   * @brief Metric name.
+   */
+  const char* name;
+  /**
+   * @brief Baseline value.
+   */
+  double baseline;
+  /**
+   * @brief Candidate value.
+   */
+  double candidate;
+  /**
+   * @brief Relative change, %.
+   */
+  double change_percent;
+  /**
+   * @brief Change threshold used, %.
+   */
+  double threshold_percent;
+  /**
+   * @brief Verdict.
+   */
+  FrameBenchmarkVerdict verdict;
+  WB_ATTRIBUTE_UNUSED_FIELD std::byte
+      pad_[sizeof(double) - sizeof(verdict)] = {};
+};
+
+/**
+ * @brief Compares frame benchmark results.  Change is significant when it is
+ * above |threshold_percent|, scaled up for noisy tail metrics.  Mean frame
+ * time change also should be above 3 standard errors of means difference.
+ * @param baseline Baseline results.
+ * @param candidate Candidate results.
+ * @param threshold_percent Min significant relative change, %.
+ * @return Metrics comparisons.
+ */
+[[nodiscard]] WB_BASE_API std::vector<FrameBenchmarkMetricComparison>
+CompareFrameBenchmarkResults(const FrameBenchmarkResults& baseline,
+                             const FrameBenchmarkResults& candidate,
+                             double threshold_percent);
+
+}  // namespace wb::base::telemetry
+
+#endif  // !WB_BASE_TELEMETRY_FRAME_BENCHMARK_H_
@@ -0,0 +1,149 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Frame benchmark.
+
+#include "frame_benchmark.h"
+//
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/deps/googletest/gtest/gtest.h"
+#include "base/memory/allocation_stats.h"
+
+namespace {
+
+/**
+ * @brief Makes benchmark results with frame time stats.
+ * @param mean_ms Mean frame time.
+ * @param stddev_ms Frame time standard deviation.
+ * @return Results.
+ */
+[[nodiscard]] wb::base::telemetry::FrameBenchmarkResults MakeResults(
+    double mean_ms, double stddev_ms) noexcept {
+  return {.frames_count = 1000U,
+          .frame_time_mean_ms = mean_ms,
+          .frame_time_stddev_ms = stddev_ms,
+          .frame_time_p50_ms = mean_ms,
+          .frame_time_p99_ms = 2.0 * mean_ms,
+          .frame_time_max_ms = 3.0 * mean_ms,
+          .allocations_per_frame = 10.0,
+          .allocated_bytes_per_frame = 1024.0,
+          .rss_bytes = 64U * 1024U * 1024U,
+          .peak_rss_bytes = 80U * 1024U * 1024U};
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(FrameBenchmarkTest, ComputesFrameTimeStats) {
+  using namespace wb::base::telemetry;
+  using namespace std::chrono_literals;
+
+  FrameBenchmark benchmark{100U};
+  for (int i{1}; i <= 100; ++i) {
+    EXPECT_FALSE(benchmark.IsFinished());
+    benchmark.AddFrame(std::chrono::milliseconds{i}, 2U, 128U);
+  }
+  EXPECT_TRUE(benchmark.IsFinished());
+
+  // Extra frames are ignored.
+  benchmark.AddFrame(1s, 1000U, 1000U);
+
+  const FrameBenchmarkResults results{benchmark.Finish(4096U, 8192U)};
+  EXPECT_EQ(100U, results.frames_count);
+  EXPECT_DOUBLE_EQ(50.5, results.frame_time_mean_ms);
+  EXPECT_NEAR(28.866, results.frame_time_stddev_ms, 0.001);
+  EXPECT_DOUBLE_EQ(50.0, results.frame_time_p50_ms);
+  EXPECT_DOUBLE_EQ(99.0, results.frame_time_p99_ms);
+  EXPECT_DOUBLE_EQ(100.0, results.frame_time_max_ms);
+  EXPECT_DOUBLE_EQ(2.0, results.allocations_per_frame);
+  EXPECT_DOUBLE_EQ(128.0, results.allocated_bytes_per_frame);
+  EXPECT_EQ(4096U, results.rss_bytes);
+  EXPECT_EQ(8192U, results.peak_rss_bytes);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(FrameBenchmarkTest, AllocatingFramesReportAllocations) {
+  using namespace wb::base;
+  using namespace std::chrono_literals;
+
+  telemetry::FrameBenchmark benchmark{4U};
+  // Same as kernel frame benchmark does.
+  memory::EnableAllocationStats();
+
+  while (!benchmark.IsFinished()) {
+    const memory::ThreadAllocationStats frame_start{
+        memory::BeginFrameAllocationStats()};
+    {
+      std::vector<std::uint64_t> frame_values(256U);
+      EXPECT_EQ(256U, frame_values.size());
+    }
+    const memory::FrameAllocationStats frame{
+        memory::EndFrameAllocationStats(frame_start)};
+
+    benchmark.AddFrame(1ms, frame.allocations_count, frame.allocated_bytes);
+  }
+
+  const telemetry::FrameBenchmarkResults results{benchmark.Finish(0U, 0U)};
+  EXPECT_GE(results.allocations_per_frame, 1.0);
+  EXPECT_GE(results.allocated_bytes_per_frame,
+            256.0 * sizeof(std::uint64_t));
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(FrameBenchmarkTest, ResultsRoundTripViaJson) {
+  using namespace wb::base::telemetry;
+
+  const FrameBenchmarkResults results{MakeResults(16.25, 1.5)};
+  const std::string json{FormatFrameBenchmarkResults(results)};
+
+  const auto parsed = ParseFrameBenchmarkResults(json);
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(results.frames_count, parsed->frames_count);
+  EXPECT_DOUBLE_EQ(results.frame_time_mean_ms, parsed->frame_time_mean_ms);
+  EXPECT_DOUBLE_EQ(results.frame_time_stddev_ms, parsed->frame_time_stddev_ms);
+  EXPECT_DOUBLE_EQ(results.frame_time_p99_ms, parsed->frame_time_p99_ms);
+  EXPECT_DOUBLE_EQ(results.allocations_per_frame,
+                   parsed->allocations_per_frame);
+  EXPECT_EQ(results.peak_rss_bytes, parsed->peak_rss_bytes);
+
+  EXPECT_EQ(EINVAL, ParseFrameBenchmarkResults("{}").error().value());
+  EXPECT_EQ(EPROTO,
+            ParseFrameBenchmarkResults("{\"version\": 0}").error().value());
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(FrameBenchmarkTest, CompareIsNoiseAware) {
+  using namespace wb::base::telemetry;
+
+  // 10% slower, low noise.
+  auto comparisons = CompareFrameBenchmarkResults(
+      MakeResults(10.0, 0.5), MakeResults(11.0, 0.5), 3.0);
+  ASSERT_FALSE(comparisons.empty());
+  EXPECT_STREQ("frame_time_mean_ms", comparisons[0].name);
+  EXPECT_NEAR(10.0, comparisons[0].change_percent, 1e-9);
+  EXPECT_EQ(FrameBenchmarkVerdict::kWorse, comparisons[0].verdict);
+  // p99 threshold is 2x, but 10% is still above.
+  EXPECT_EQ(FrameBenchmarkVerdict::kWorse, comparisons[2].verdict);
+  // Allocations are same.
+  EXPECT_EQ(FrameBenchmarkVerdict::kSame, comparisons[4].verdict);
+
+  // 10% faster, but noise is huge.
+  comparisons = CompareFrameBenchmarkResults(MakeResults(10.0, 30.0),
+                                             MakeResults(9.0, 30.0), 3.0);
+  EXPECT_EQ(FrameBenchmarkVerdict::kSame, comparisons[0].verdict);
+
+  // 10% faster, low noise.
+  comparisons = CompareFrameBenchmarkResults(MakeResults(10.0, 0.5),
+                                             MakeResults(9.0, 0.5), 3.0);
+  EXPECT_EQ(FrameBenchmarkVerdict::kBetter, comparisons[0].verdict);
+
+  // 2% slower is below threshold.
+  comparisons = CompareFrameBenchmarkResults(MakeResults(10.0, 0.01),
+                                             MakeResults(10.2, 0.01), 3.0);
+  EXPECT_EQ(FrameBenchmarkVerdict::kSame, comparisons[0].verdict);
+}
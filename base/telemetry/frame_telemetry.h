@@ -0,0 +1,200 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Live frame telemetry layout.
+
+#ifndef WB_BASE_TELEMETRY_FRAME_TELEMETRY_H_
+#define WB_BASE_TELEMETRY_FRAME_TELEMETRY_H_
+
+#include <cstdint>
+#include <type_traits>
+
+#include "base/telemetry/seqlock.h"
+
+namespace wb::base::telemetry {
+
+/**
+ * @brief Frame telemetry page magic.  'WBFT'.
+ */
+inline constexpr std::uint32_t kFrameTelemetryMagic{0x57424654U};
+
+/**
+ * @brief Frame telemetry layout version.  Bump when FrameTelemetry changes.
+ */
+inline constexpr std::uint32_t kFrameTelemetryVersion{7U};
+
+/**
+ * @brief Telemetry of the last finished frame.
+ */
+struct FrameTelemetry {
+  /**
+   * @brief Frame index since start.
+   */
+  std::uint64_t frame_index;
+  /**
+   * @brief Frame time in nanoseconds.
+   */
+  std::int64_t frame_time_ns;
+  /**
+   * @brief Max frame time since start in nanoseconds.
+   */
+  std::int64_t max_frame_time_ns;
+  /**
+   * @brief Heap committed bytes.
+   */
+  std::uint64_t heap_current_commit_bytes;
+  /**
+   * @brief Heap peak committed bytes.
+   */
+  std::uint64_t heap_peak_commit_bytes;
+  /**
+   * @brief Input events processed during frame.
+   */
+  std::uint32_t input_events_count;
+  /**
+   * @brief Running scheduler workers count.
+   */
+  std::uint32_t workers_count;
+  /**
+   * @brief Tasks executed by all scheduler workers since start.
+   */
+  std::uint64_t workers_tasks_executed;
+  /**
+   * @brief Time all scheduler workers spent executing tasks, ns.
+   */
+  std::int64_t workers_busy_time_ns;
+  /**
+   * @brief Sum of all scheduler workers lifetimes, ns.
+   */
+  std::int64_t workers_lifetime_ns;
+  /**
+   * @brief Heap allocations count made by frame thread during frame.
+   */
+  std::uint64_t frame_allocations_count;
+  /**
+   * @brief Heap bytes allocated by frame thread during frame.
+   */
+  std::uint64_t frame_allocated_bytes;
+  /**
+   * @brief Heap frees count made by frame thread during frame.
+   */
+  std::uint64_t frame_frees_count;
+  /**
+   * @brief Peak heap live bytes growth of frame thread during frame.
+   */
+  std::uint64_t frame_peak_allocated_bytes;
+  /**
+   * @brief CPU cycles of frame thread during frame.  0 when hardware perf
+   * counters are unavailable.
+   */
+  std::uint64_t frame_cycles;
+  /**
+   * @brief Retired instructions of frame thread during frame.  0 when hardware
+   * perf counters are unavailable.
+   */
+  std::uint64_t frame_instructions;
+  /**
+   * @brief Last level cache misses of frame thread during frame.  0 when
+   * hardware perf counters are unavailable.
+   */
+  std::uint64_t frame_cache_misses;
+  /**
+   * @brief Mispredicted branches of frame thread during frame.  0 when hardware
+   * perf counters are unavailable.
+   */
+  std::uint64_t frame_branch_misses;
+  /**
+   * @brief Task clock of frame thread during frame, ns.  Software perf counter,
+   * so available without hardware PMU.
+   */
+  std::uint64_t frame_task_clock_ns;
+  /**
+   * @brief Page faults of frame thread during frame.  Software perf counter.
+   */
+  std::uint64_t frame_perf_page_faults;
+  /**
+   * @brief Context switches of frame thread during frame.  Software perf
+   * counter.  0 when perf_event_paranoid disallows kernel counting.
+   */
+  std::uint64_t frame_context_switches;
+  /**
+   * @brief Minor page faults of frame thread during frame.
+   */
+  std::uint64_t frame_minor_page_faults;
+  /**
+   * @brief Major page faults of frame thread during frame.
+   */
+  std::uint64_t frame_major_page_faults;
+  /**
+   * @brief Minor and major page faults of frame thread during the slowest
+   * frame since start.  Tells whether max frame time hitch is page faults
+   * storm.
+   */
+  std::uint64_t max_frame_time_page_faults;
+  /**
+   * @brief Minor page faults of all process threads since start.
+   */
+  std::uint64_t process_minor_page_faults;
+  /**
+   * @brief Major page faults of all process threads since start.
+   */
+  std::uint64_t process_major_page_faults;
+  /**
+   * @brief Process resident set size, bytes.
+   */
+  std::uint64_t resident_set_bytes;
+  /**
+   * @brief Process peak resident set size since start, bytes.
+   */
+  std::uint64_t peak_resident_set_bytes;
+  /**
+   * @brief Frame thread CPU time since start, ns.
+   */
+  std::int64_t main_thread_cpu_time_ns;
+  /**
+   * @brief Frame thread voluntary context switches since start.
+   */
+  std::uint64_t main_thread_voluntary_context_switches;
+  /**
+   * @brief Frame thread involuntary context switches since start.
+   */
+  std::uint64_t main_thread_involuntary_context_switches;
+  /**
+   * @brief All scheduler workers CPU time since start, ns.  Compare with
+   * workers busy time to see whether workers are descheduled.
+   */
+  std::int64_t workers_cpu_time_ns;
+  /**
+   * @brief All scheduler workers voluntary context switches since start.
+   */
+  std::uint64_t workers_voluntary_context_switches;
+  /**
+   * @brief All scheduler workers involuntary context switches since start.
+   */
+  std::uint64_t workers_involuntary_context_switches;
+};
+
+static_assert(std::is_trivially_copyable_v<FrameTelemetry>);
+
+/**
+ * @brief Frame telemetry page shared between publisher and readers.
+ */
+struct FrameTelemetryPage {
+  /**
+   * @brief Magic, kFrameTelemetryMagic.
+   */
+  std::uint32_t magic;
+  /**
+   * @brief Layout version, kFrameTelemetryVersion.
+   */
+  std::uint32_t version;
+  /**
+   * @brief Telemetry.
+   */
+  SeqLock<FrameTelemetry> telemetry;
+};
+
+}  // namespace wb::base::telemetry
+
+#endif  // !WB_BASE_TELEMETRY_FRAME_TELEMETRY_H_
@@ -0,0 +1,457 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Lock contention profiler.
+
+#include "lock_contention_profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>  // std::hash
+#include <utility>  // std::move
+
+#include "base/deps/abseil/base/internal/cycleclock.h"
+#include "base/deps/abseil/synchronization/mutex.h"
+#include "base/deps/fmt/core.h"
+#include "base/deps/g3log/g3log.h"
+#include "build/build_config.h"
+
+#ifdef WB_OS_POSIX
+#include <dlfcn.h>  // dladdr
+#endif
+
+namespace {
+
+/**
+ * @brief Profiled lock slot.
+ */
+struct ProfiledLockSlot {
+  /**
+   * @brief Lock address.  nullptr when slot was never used, kFreedLockSlot
+   * when lock was forgotten.
+   */
+  std::atomic<const void*> lock;
+  /**
+   * @brief Lock name.  nullptr when not set.
+   */
+  std::atomic<const char*> name;
+  /**
+   * @brief Acquisitions count.
+   */
+  std::atomic_uint64_t acquisitions_count;
+  /**
+   * @brief Contended acquisitions count.
+   */
+  std::atomic_uint64_t contentions_count;
+  /**
+   * @brief Total wait time, ns.
+   */
+  std::atomic_int64_t wait_time_ns;
+  /**
+   * @brief Max wait time, ns.
+   */
+  std::atomic_int64_t max_wait_time_ns;
+  /**
+   * @brief Total hold time, ns.
+   */
+  std::atomic_int64_t hold_time_ns;
+  /**
+   * @brief Current waiters count.
+   */
+  std::atomic_uint32_t waiters_count;
+  /**
+   * @brief Max simultaneous waiters count.
+   */
+  std::atomic_uint32_t max_waiters_count;
+};
+
+/**
+ * @brief Profiled locks open addressing hash table.  Forgotten locks leave
+ * kFreedLockSlot tombstones which are reused by inserts, so lookups do not
+ * lock.
+ */
+std::array<ProfiledLockSlot, wb::base::telemetry::kMaxProfiledLocksCount>
+    profiled_locks;
+
+/**
+ * @brief Freed slot tombstone tag.
+ */
+const char freed_lock_slot_tag{0};
+/**
+ * @brief Key of forgotten slot.  Probing continues past it.
+ */
+const void* const kFreedLockSlot{&freed_lock_slot_tag};
+
+/**
+ * @brief Stats key of all destroyed unnamed locks.
+ */
+constexpr char kDestroyedUnnamedLocksName[]{"<destroyed unnamed locks>"};
+
+/**
+ * @brief Is profiling enabled.
+ */
+std::atomic_bool is_lock_contention_profiling_enabled{false};
+
+/**
+ * @brief Abseil cycle clock ticks per nanosecond.
+ */
+std::atomic<double> abseil_cycles_per_ns{0.0};
+
+/**
+ * @brief Atomically updates |value| to max of it and |candidate|.
+ * @tparam T Value type.
+ * @param value Value.
+ * @param candidate Candidate.
+ * @return void.
+ */
+template <typename T>
+void UpdateMax(std::atomic<T>& value, T candidate) noexcept {
+  T current{value.load(std::memory_order_relaxed)};
+  while (current < candidate &&
+         !value.compare_exchange_weak(current, candidate,
+                                      std::memory_order_relaxed)) {
+  }
+}
+
+/**
+ * @brief Gets lock probe chain start slot index.
+ * @param lock Lock.
+ * @return Slot index.
+ */
+[[nodiscard]] std::size_t GetLockSlotStart(const void* lock) noexcept {
+  return std::hash<const void*>{}(lock) %
+         wb::base::telemetry::kMaxProfiledLocksCount;
+}
+
+/**
+ * @brief Tries to insert lock into slot.
+ * @param slot Slot.
+ * @param expected_lock Expected slot lock, nullptr or kFreedLockSlot.
+ * @param lock Lock.
+ * @return true if slot is taken by lock.
+ */
+[[nodiscard]] bool TryInsertLock(ProfiledLockSlot& slot,
+                                 const void* expected_lock,
+                                 const void* lock) noexcept {
+  return slot.lock.compare_exchange_strong(expected_lock, lock,
+                                           std::memory_order_acq_rel) ||
+         // Other thread inserted same lock at this slot.
+         expected_lock == lock;
+}
+
+/**
+ * @brief Finds or inserts lock slot.  Does not allocate or lock.
+ * @param lock Lock.
+ * @return Lock slot or nullptr when table is full.
+ */
+[[nodiscard]] ProfiledLockSlot* FindOrInsertLockSlot(
+    const void* lock) noexcept {
+  using wb::base::telemetry::kMaxProfiledLocksCount;
+
+  const std::size_t start{GetLockSlotStart(lock)};
+  ProfiledLockSlot* freed_slot{nullptr};
+
+  for (std::size_t i{0}; i < kMaxProfiledLocksCount; ++i) {
+    auto& slot = profiled_locks[(start + i) % kMaxProfiledLocksCount];
+
+    const void* slot_lock{slot.lock.load(std::memory_order_acquire)};
+    if (slot_lock == lock) return &slot;
+
+    if (slot_lock == kFreedLockSlot) {
+      if (!freed_slot) freed_slot = &slot;
+      continue;
+    }
+
+    if (!slot_lock) {
+      // Lock is not in chain, reuse freed slot first to keep chains short.
+      if (freed_slot && TryInsertLock(*freed_slot, kFreedLockSlot, lock)) {
+        return freed_slot;
+      }
+      if (TryInsertLock(slot, nullptr, lock)) return &slot;
+    }
+  }
+
+  return freed_slot && TryInsertLock(*freed_slot, kFreedLockSlot, lock)
+             ? freed_slot
+             : nullptr;
+}
+
+/**
+ * @brief Adds stats of |from| slot to |to| slot.
+ * @param from Source slot.
+ * @param to Destination slot.
+ * @return void.
+ */
+void MergeLockSlot(const ProfiledLockSlot& from,
+                   ProfiledLockSlot& to) noexcept {
+  to.acquisitions_count.fetch_add(
+      from.acquisitions_count.load(std::memory_order_relaxed),
+      std::memory_order_relaxed);
+  to.contentions_count.fetch_add(
+      from.contentions_count.load(std::memory_order_relaxed),
+      std::memory_order_relaxed);
+  to.wait_time_ns.fetch_add(from.wait_time_ns.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+  UpdateMax(to.max_wait_time_ns,
+            from.max_wait_time_ns.load(std::memory_order_relaxed));
+  to.hold_time_ns.fetch_add(from.hold_time_ns.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+  UpdateMax(to.max_waiters_count,
+            from.max_waiters_count.load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Resets slot stats and name, then frees slot for reuse.
+ * @param slot Slot.
+ * @return void.
+ */
+void FreeLockSlot(ProfiledLockSlot& slot) noexcept {
+  slot.name.store(nullptr, std::memory_order_relaxed);
+  slot.acquisitions_count.store(0, std::memory_order_relaxed);
+  slot.contentions_count.store(0, std::memory_order_relaxed);
+  slot.wait_time_ns.store(0, std::memory_order_relaxed);
+  slot.max_wait_time_ns.store(0, std::memory_order_relaxed);
+  slot.hold_time_ns.store(0, std::memory_order_relaxed);
+  slot.waiters_count.store(0, std::memory_order_relaxed);
+  slot.max_waiters_count.store(0, std::memory_order_relaxed);
+  // Inserts see reset stats.
+  slot.lock.store(kFreedLockSlot, std::memory_order_release);
+}
+
+/**
+ * @brief Records contended lock acquisition.
+ * @param slot Lock slot.
+ * @param wait_time_ns Wait time, ns.
+ * @return void.
+ */
+void RecordContention(ProfiledLockSlot& slot,
+                      std::int64_t wait_time_ns) noexcept {
+  slot.contentions_count.fetch_add(1, std::memory_order_relaxed);
+  slot.wait_time_ns.fetch_add(wait_time_ns, std::memory_order_relaxed);
+  UpdateMax(slot.max_wait_time_ns, wait_time_ns);
+}
+
+/**
+ * @brief Abseil mutex tracer hook.  Called when contended mutex is released.
+ * @param message Event name.
+ * @param mutex Mutex.
+ * @param wait_cycles Waiter wait cycles.
+ * @return void.
+ */
+void AbseilMutexTracer(const char*, const void* mutex,
+                       std::int64_t wait_cycles) {
+  if (!is_lock_contention_profiling_enabled.load(std::memory_order_relaxed))
+    return;
+
+  ProfiledLockSlot* slot{FindOrInsertLockSlot(mutex)};
+  if (!slot) [[unlikely]] return;
+
+  const double cycles_per_ns{
+      abseil_cycles_per_ns.load(std::memory_order_relaxed)};
+  const auto wait_time_ns = static_cast<std::int64_t>(
+      cycles_per_ns > 0.0 ? static_cast<double>(wait_cycles) / cycles_per_ns
+                          : 0.0);
+
+  RecordContention(*slot, wait_time_ns);
+  // Abseil does not expose waiters count.
+  UpdateMax(slot->max_waiters_count, 1U);
+}
+
+/**
+ * @brief Gets lock name.
+ * @param lock Lock.
+ * @param name Lock name set by SetLockName.  Optional.
+ * @return Lock name.
+ */
+[[nodiscard]] std::string GetLockName(const void* lock, const char* name) {
+  if (name) return name;
+
+#ifdef WB_OS_POSIX
+  // Global locks can be named by symbols.
+  Dl_info info{};
+  if (::dladdr(lock, &info) != 0 && info.dli_sname && info.dli_saddr == lock) {
+    return info.dli_sname;
+  }
+#endif
+
+  return fmt::format("{0}", lock);
+}
+
+}  // namespace
+
+namespace wb::base::telemetry {
+
+WB_BASE_API void EnableLockContentionProfiling() noexcept {
+  static const bool is_registered{[]() noexcept {
+    abseil_cycles_per_ns.store(
+        absl::base_internal::CycleClock::Frequency() / 1e9,
+        std::memory_order_relaxed);
+    // Mutex profiler hook only gets wait cycles without mutex, so tracer is
+    // enough.
+    absl::RegisterMutexTracer(AbseilMutexTracer);
+    return true;
+  }()};
+  G3DCHECK(is_registered);
+
+  is_lock_contention_profiling_enabled.store(true, std::memory_order_release);
+}
+
+[[nodiscard]] WB_BASE_API bool IsLockContentionProfilingEnabled() noexcept {
+  return is_lock_contention_profiling_enabled.load(std::memory_order_relaxed);
+}
+
+WB_BASE_API void SetLockName(const void* lock, const char* name) noexcept {
+  ProfiledLockSlot* slot{FindOrInsertLockSlot(lock)};
+  if (slot) [[likely]] {
+    slot->name.store(name, std::memory_order_release);
+  }
+}
+
+WB_BASE_API void ForgetLock(const void* lock) noexcept {
+  const std::size_t start{GetLockSlotStart(lock)};
+
+  // Racing inserts may rarely put lock into two slots, so scan whole chain.
+  for (std::size_t i{0}; i < kMaxProfiledLocksCount; ++i) {
+    auto& slot = profiled_locks[(start + i) % kMaxProfiledLocksCount];
+
+    const void* slot_lock{slot.lock.load(std::memory_order_acquire)};
+    if (!slot_lock) return;
+    if (slot_lock != lock) continue;
+
+    if (slot.acquisitions_count.load(std::memory_order_relaxed) != 0 ||
+        slot.contentions_count.load(std::memory_order_relaxed) != 0) {
+      // Name is static string, so it is a unique key of destroyed locks
+      // stats.
+      const char* name{slot.name.load(std::memory_order_acquire)};
+      if (!name) name = kDestroyedUnnamedLocksName;
+
+      ProfiledLockSlot* destroyed_slot{FindOrInsertLockSlot(name)};
+      if (destroyed_slot) [[likely]] {
+        destroyed_slot->name.store(name, std::memory_order_release);
+        MergeLockSlot(slot, *destroyed_slot);
+      }
+    }
+
+    FreeLockSlot(slot);
+  }
+}
+
+WB_BASE_API void BeginLockWait(const void* lock) noexcept {
+  ProfiledLockSlot* slot{FindOrInsertLockSlot(lock)};
+  if (!slot) [[unlikely]] return;
+
+  const std::uint32_t waiters_count{
+      slot->waiters_count.fetch_add(1, std::memory_order_relaxed) + 1U};
+  UpdateMax(slot->max_waiters_count, waiters_count);
+}
+
+WB_BASE_API void EndLockWait(const void* lock,
+                             std::chrono::nanoseconds wait_time) noexcept {
+  ProfiledLockSlot* slot{FindOrInsertLockSlot(lock)};
+  if (!slot) [[unlikely]] return;
+
+  slot->waiters_count.fetch_sub(1, std::memory_order_relaxed);
+  RecordContention(*slot, wait_time.count());
+}
+
+WB_BASE_API void RecordLockHold(const void* lock,
+                                std::chrono::nanoseconds hold_time) noexcept {
+  ProfiledLockSlot* slot{FindOrInsertLockSlot(lock)};
+  if (!slot) [[unlikely]] return;
+
+  slot->acquisitions_count.fetch_add(1, std::memory_order_relaxed);
+  slot->hold_time_ns.fetch_add(hold_time.count(), std::memory_order_relaxed);
+}
+
+[[nodiscard]] WB_BASE_API std::vector<LockContentionStats>
+GetLockContentionStats() {
+  std::vector<LockContentionStats> stats;
+
+  for (const auto& slot : profiled_locks) {
+    const void* lock{slot.lock.load(std::memory_order_acquire)};
+    if (!lock || lock == kFreedLockSlot) continue;
+
+    const std::uint64_t acquisitions_count{
+        slot.acquisitions_count.load(std::memory_order_relaxed)};
+    const std::uint64_t contentions_count{
+        slot.contentions_count.load(std::memory_order_relaxed)};
+    // Only named, never used.
+    if (acquisitions_count == 0 && contentions_count == 0) continue;
+
+    LockContentionStats lock_stats{
+        .lock = lock,
+        .name = GetLockName(lock, slot.name.load(std::memory_order_acquire)),
+        .acquisitions_count = acquisitions_count,
+        .contentions_count = contentions_count,
+        .wait_time = std::chrono::nanoseconds{slot.wait_time_ns.load(
+            std::memory_order_relaxed)},
+        .max_wait_time = std::chrono::nanoseconds{slot.max_wait_time_ns.load(
+            std::memory_order_relaxed)},
+        .hold_time = std::chrono::nanoseconds{slot.hold_time_ns.load(
+            std::memory_order_relaxed)},
+        .max_waiters_count =
+            slot.max_waiters_count.load(std::memory_order_relaxed)};
+
+    // Racing inserts may rarely put lock into two slots.
+    const auto it =
+        std::find_if(stats.begin(), stats.end(),
+                     [lock](const LockContentionStats& other) noexcept {
+                       return other.lock == lock;
+                     });
+    if (it == stats.end()) [[likely]] {
+      stats.emplace_back(std::move(lock_stats));
+      continue;
+    }
+
+    it->acquisitions_count += lock_stats.acquisitions_count;
+    it->contentions_count += lock_stats.contentions_count;
+    it->wait_time += lock_stats.wait_time;
+    it->max_wait_time = std::max(it->max_wait_time, lock_stats.max_wait_time);
+    it->hold_time += lock_stats.hold_time;
+    it->max_waiters_count =
+        std::max(it->max_waiters_count, lock_stats.max_waiters_count);
+  }
+
+  std::sort(stats.begin(), stats.end(),
+            [](const LockContentionStats& left,
+               const LockContentionStats& right) noexcept {
+              return left.wait_time > right.wait_time;
+            });
+
+  return stats;
+}
+
+WB_BASE_API void LogLockContentionStats(std::size_t top_locks_count) {
+  const std::vector<LockContentionStats> stats{GetLockContentionStats()};
+  if (stats.empty()) {
+    G3LOG(INFO) << "No lock contention recorded.";
+    return;
+  }
+
+  const auto to_ms = [](std::chrono::nanoseconds ns) noexcept {
+    return static_cast<double>(ns.count()) / 1'000'000.0;
+  };
+
+  std::string table{fmt::format(
+      "{:>4} {:>12} {:>12} {:>12} {:>12} {:>12} {:>8}  {}\n", "rank",
+      "acquires", "contended", "wait ms", "max wait ms", "hold ms", "waiters",
+      "lock")};
+
+  const std::size_t locks_count{std::min(top_locks_count, stats.size())};
+  for (std::size_t i{0}; i < locks_count; ++i) {
+    const auto& lock = stats[i];
+    table += fmt::format(
+        "{:>4} {:>12} {:>12} {:>12.3f} {:>12.3f} {:>12.3f} {:>8}  {}\n", i + 1,
+        lock.acquisitions_count, lock.contentions_count,
+        to_ms(lock.wait_time), to_ms(lock.max_wait_time),
+        to_ms(lock.hold_time), lock.max_waiters_count, lock.name);
+  }
+
+  G3LOG(INFO) << "Lock contention (top " << locks_count << " of "
+              << stats.size() << " locks by wait time):\n"
+              << table;
+}
+
+}  // namespace wb::base::telemetry
@@ -0,0 +1,153 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Lock contention profiler.  Collects wait time, hold time and contenders
+// count per lock for absl::Mutex (via abseil mutex tracer hook) and
+// posix::ScopedMutex (via explicit instrumentation).  Locks are keyed by
+// address, so short-lived absl::Mutex should be forgotten via ForgetLock before
+// destruction.  posix::ScopedMutex forgets itself.
+//
+// Usage example:
+//
+// EnableLockContentionProfiling();
+// SetLockName(&scene_mutex, "Scene");
+// ...
+// ForgetLock(&scene_mutex);  // Before scene_mutex is destroyed.
+// ...
+// LogLockContentionStats(16U);
+
+#ifndef WB_BASE_TELEMETRY_LOCK_CONTENTION_PROFILER_H_
+#define WB_BASE_TELEMETRY_LOCK_CONTENTION_PROFILER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/config.h"
+
+namespace wb::base::telemetry {
+
+/**
+ * @brief Max profiled locks count.  Locks above limit are not profiled.
+ */
+inline constexpr std::uint32_t kMaxProfiledLocksCount{1024U};
+
+/**
+ * @brief Lock contention stats.
+ */
+struct LockContentionStats {
+  /**
+   * @brief Lock address.  Lock name for stats of destroyed named locks.
+   */
+  const void* lock;
+  /**
+   * @brief Lock name.  Set via SetLockName or symbolized lock address.
+   */
+  std::string name;
+  /**
+   * @brief Acquisitions count.  Instrumented locks only, 0 for absl::Mutex.
+   */
+  std::uint64_t acquisitions_count;
+  /**
+   * @brief Contended acquisitions count.
+   */
+  std::uint64_t contentions_count;
+  /**
+   * @brief Total wait time for lock.
+   */
+  std::chrono::nanoseconds wait_time;
+  /**
+   * @brief Max single wait time for lock.
+   */
+  std::chrono::nanoseconds max_wait_time;
+  /**
+   * @brief Total hold time of lock.  Instrumented locks only, 0 for
+   * absl::Mutex.
+   */
+  std::chrono::nanoseconds hold_time;
+  /**
+   * @brief Max simultaneous waiters count.  Instrumented locks only, 1 for
+   * absl::Mutex if contended.
+   */
+  std::uint32_t max_waiters_count;
+};
+
+/**
+ * @brief Enables lock contention profiling.  Registers abseil mutex tracer
+ * hook on first call.
+ * @return void.
+ */
+WB_BASE_API void EnableLockContentionProfiling() noexcept;
+
+/**
+ * @brief Is lock contention profiling enabled.
+ * @return true if enabled.
+ */
+[[nodiscard]] WB_BASE_API bool IsLockContentionProfilingEnabled() noexcept;
+
+/**
+ * @brief Sets lock name for report.
+ * @param lock Lock.
+ * @param name Lock name.  Should be static string.
+ * @return void.
+ */
+WB_BASE_API void SetLockName(const void* lock, const char* name) noexcept;
+
+/**
+ * @brief Forgets lock before it is destroyed, so lock created later at the
+ * same address starts with fresh stats and name.  Stats of destroyed lock are
+ * merged into stats of destroyed locks with the same name (or of all destroyed
+ * unnamed locks) and its slot is reused.  Does not allocate or lock.
+ * @param lock Lock.
+ * @return void.
+ */
+WB_BASE_API void ForgetLock(const void* lock) noexcept;
+
+/**
+ * @brief Records contender starts waiting for lock.  Does not allocate or
+ * lock.
+ * @param lock Lock.
+ * @return void.
+ */
+WB_BASE_API void BeginLockWait(const void* lock) noexcept;
+
+/**
+ * @brief Records contender finished waiting for lock.  Does not allocate or
+ * lock.
+ * @param lock Lock.
+ * @param wait_time Wait time.
+ * @return void.
+ */
+WB_BASE_API void EndLockWait(const void* lock,
+                             std::chrono::nanoseconds wait_time) noexcept;
+
+/**
+ * @brief Records lock was released.  Does not allocate or lock.
+ * @param lock Lock.
+ * @param hold_time Time lock was held.
+ * @return void.
+ */
+WB_BASE_API void RecordLockHold(const void* lock,
+                                std::chrono::nanoseconds hold_time) noexcept;
+
+/**
+ * @brief Gets contention stats of all profiled locks, ranked by total wait
+ * time.
+ * @return Lock contention stats.
+ */
+[[nodiscard]] WB_BASE_API std::vector<LockContentionStats>
+GetLockContentionStats();
+
+/**
+ * @brief Logs ranked lock contention stats table.
+ * @param top_locks_count Max locks count to log.
+ * @return void.
+ */
+WB_BASE_API void LogLockContentionStats(std::size_t top_locks_count);
+
+}  // namespace wb::base::telemetry
+
+#endif  // !WB_BASE_TELEMETRY_LOCK_CONTENTION_PROFILER_H_
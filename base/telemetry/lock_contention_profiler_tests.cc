@@ -0,0 +1,232 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Lock contention profiler.
+
+#include "lock_contention_profiler.h"
+//
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "base/deps/abseil/synchronization/mutex.h"
+#include "base/deps/googletest/gtest/gtest.h"
+#include "build/build_config.h"
+
+#ifdef WB_OS_POSIX
+#include "base/posix/pthread/scoped_mutex.h"
+#endif
+
+namespace {
+
+/**
+ * @brief Finds lock stats.
+ * @param lock Lock.
+ * @return Lock stats or nullopt.
+ */
+[[nodiscard]] std::optional<wb::base::telemetry::LockContentionStats>
+FindLockStats(const void* lock) {
+  const auto stats = wb::base::telemetry::GetLockContentionStats();
+  const auto it =
+      std::find_if(stats.begin(), stats.end(),
+                   [lock](const auto& s) noexcept { return s.lock == lock; });
+  return it != stats.end() ? std::optional{*it} : std::nullopt;
+}
+
+/**
+ * @brief Makes |threads_count| threads contend for lock.
+ * @tparam TLockedWork Locks and does work.
+ * @param locked_work Locks and does work.
+ * @param threads_count Contenders count.
+ * @return void.
+ */
+template <typename TLockedWork>
+void Contend(TLockedWork locked_work, int threads_count) {
+  std::vector<std::thread> threads;
+  threads.reserve(static_cast<std::size_t>(threads_count));
+
+  for (int i{0}; i < threads_count; ++i) {
+    threads.emplace_back([&locked_work]() {
+      for (int j{0}; j < 4; ++j) locked_work();
+    });
+  }
+
+  for (auto& thread : threads) thread.join();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(LockContentionProfilerTest, AbseilMutexContentionIsRecorded) {
+  using namespace wb::base::telemetry;
+
+  EnableLockContentionProfiling();
+  EXPECT_TRUE(IsLockContentionProfilingEnabled());
+
+  absl::Mutex mutex;
+  SetLockName(&mutex, "TestAbseilMutex");
+
+  Contend(
+      [&mutex]() {
+        const absl::MutexLock lock{&mutex};
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+      },
+      4);
+
+  const auto stats = FindLockStats(&mutex);
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ("TestAbseilMutex", stats->name);
+  EXPECT_GT(stats->contentions_count, 0U);
+  EXPECT_GT(stats->wait_time.count(), 0);
+  EXPECT_GE(stats->wait_time, stats->max_wait_time);
+  EXPECT_EQ(1U, stats->max_waiters_count);
+
+  LogLockContentionStats(8U);
+}
+
+#ifdef WB_OS_POSIX
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(LockContentionProfilerTest, ScopedMutexContentionIsRecorded) {
+  using namespace wb::base;
+  using namespace wb::base::telemetry;
+
+  EnableLockContentionProfiling();
+
+  auto mutex = posix::ScopedMutex::New();
+  ASSERT_TRUE(mutex.has_value());
+
+  Contend(
+      [&mutex]() {
+        const std::lock_guard lock{*mutex};
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+      },
+      4);
+
+  const auto stats = FindLockStats(mutex->native_handle());
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(16U, stats->acquisitions_count);
+  EXPECT_GT(stats->contentions_count, 0U);
+  EXPECT_GT(stats->wait_time.count(), 0);
+  EXPECT_GE(stats->hold_time, std::chrono::milliseconds{2 * 16});
+  EXPECT_GE(stats->max_waiters_count, 1U);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(LockContentionProfilerTest, RecursiveScopedMutexHoldIsOutermost) {
+  using namespace wb::base;
+  using namespace wb::base::telemetry;
+
+  EnableLockContentionProfiling();
+
+  auto attribute = posix::ScopedMutexAttribute::New();
+  ASSERT_TRUE(attribute.has_value());
+  ASSERT_EQ(0, ::pthread_mutexattr_settype(attribute->native_handle(),
+                                           PTHREAD_MUTEX_RECURSIVE));
+
+  auto mutex = posix::ScopedMutex::New(*attribute);
+  ASSERT_TRUE(mutex.has_value());
+
+  {
+    const std::lock_guard outer_lock{*mutex};
+    { const std::lock_guard inner_lock{*mutex}; }
+    std::this_thread::sleep_for(std::chrono::milliseconds{4});
+  }
+
+  const auto stats = FindLockStats(mutex->native_handle());
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(1U, stats->acquisitions_count);
+  EXPECT_GE(stats->hold_time, std::chrono::milliseconds{4});
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(LockContentionProfilerTest, ReusedScopedMutexAddressHasFreshStats) {
+  using namespace wb::base;
+  using namespace wb::base::telemetry;
+
+  EnableLockContentionProfiling();
+
+  constexpr char kDestroyedMutexName[]{"TestDestroyedScopedMutex"};
+  std::optional<posix::ScopedMutex> mutex;
+
+  {
+    auto destroyed_mutex = posix::ScopedMutex::New();
+    ASSERT_TRUE(destroyed_mutex.has_value());
+    mutex.emplace(std::move(*destroyed_mutex));
+  }
+  SetLockName(mutex->native_handle(), kDestroyedMutexName);
+  for (int i{0}; i < 2; ++i) {
+    const std::lock_guard lock{*mutex};
+  }
+  mutex.reset();
+
+  {
+    auto reused_mutex = posix::ScopedMutex::New();
+    ASSERT_TRUE(reused_mutex.has_value());
+    mutex.emplace(std::move(*reused_mutex));
+  }
+  { const std::lock_guard lock{*mutex}; }
+
+  const auto stats = FindLockStats(mutex->native_handle());
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(1U, stats->acquisitions_count);
+  EXPECT_NE(kDestroyedMutexName, stats->name);
+
+  // Destroyed mutex stats are kept under its name.
+  const auto destroyed_stats = FindLockStats(kDestroyedMutexName);
+  ASSERT_TRUE(destroyed_stats.has_value());
+  EXPECT_EQ(kDestroyedMutexName, destroyed_stats->name);
+  EXPECT_EQ(2U, destroyed_stats->acquisitions_count);
+}
+#endif
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(LockContentionProfilerTest, ForgottenAbseilMutexSlotIsReused) {
+  using namespace wb::base::telemetry;
+
+  EnableLockContentionProfiling();
+
+  // Destroyed and recreated at the same address.
+  std::optional<absl::Mutex> mutex{std::in_place};
+  SetLockName(&*mutex, "TestForgottenAbseilMutex");
+  Contend(
+      [&mutex]() {
+        const absl::MutexLock lock{&*mutex};
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+      },
+      4);
+  ASSERT_TRUE(FindLockStats(&*mutex).has_value());
+
+  ForgetLock(&*mutex);
+  mutex.reset();
+  mutex.emplace();
+
+  EXPECT_FALSE(FindLockStats(&*mutex).has_value());
+
+  // Slot does not inherit name.
+  Contend(
+      [&mutex]() {
+        const absl::MutexLock lock{&*mutex};
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+      },
+      4);
+
+  const auto stats = FindLockStats(&*mutex);
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_NE("TestForgottenAbseilMutex", stats->name);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(LockContentionProfilerTest, StatsAreRankedByWaitTime) {
+  using namespace wb::base::telemetry;
+
+  const auto stats = GetLockContentionStats();
+  EXPECT_TRUE(std::is_sorted(stats.begin(), stats.end(),
+                             [](const auto& left, const auto& right) noexcept {
+                               return left.wait_time > right.wait_time;
+                             }));
+}
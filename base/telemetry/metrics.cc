@@ -0,0 +1,529 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Process wide metrics registry with counters, gauges and histograms.
+
+#include "metrics.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "base/deps/fmt/core.h"
+#include "base/deps/g3log/g3log.h"
+#include "build/build_config.h"
+#include "build/compiler_config.h"
+
+#ifdef WB_OS_POSIX
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>  // std::strncpy
+
+#include "base/posix/system_error_ext.h"
+#endif
+
+namespace {
+
+/**
+ * @brief Unix socket export path prefix.
+ */
+constexpr std::string_view kUnixSocketPathPrefix{"unix:"};
+
+/**
+ * @brief Guards registered metrics.
+ */
+std::mutex metrics_mutex;
+
+/**
+ * @brief Next thread shard index.
+ */
+std::atomic_size_t next_metric_shard_index{0};
+
+/**
+ * @brief Gets registered metrics.  Guarded by metrics_mutex.
+ * @return Registered metrics.
+ */
+[[nodiscard]] std::vector<const wb::base::telemetry::Metric*>&
+GetRegisteredMetrics() noexcept {
+  // Constructed by first metric, so outlives all metrics.
+  static std::vector<const wb::base::telemetry::Metric*> metrics;
+  return metrics;
+}
+
+/**
+ * @brief Appends OpenMetrics metric family header.
+ * @param metric Metric.
+ * @param type OpenMetrics type.
+ * @param out Output.
+ * @return void.
+ */
+void AppendMetricHeader(const wb::base::telemetry::Metric& metric,
+                        std::string_view type, std::string& out) {
+  out += fmt::format("# TYPE {0} {1}\n# HELP {0} {2}\n", metric.name(), type,
+                     metric.help());
+}
+
+/**
+ * @brief Appends OpenMetrics histogram.
+ * @param histogram Histogram.
+ * @param out Output.
+ * @return void.
+ */
+void AppendHistogram(const wb::base::telemetry::Histogram& histogram,
+                     std::string& out) {
+  const wb::base::telemetry::HistogramSnapshot snapshot{histogram.Snapshot()};
+
+  AppendMetricHeader(histogram, "histogram", out);
+  for (std::size_t i{0}; i < snapshot.buckets_count; ++i) {
+    out += fmt::format("{0}_bucket{{le=\"{1}\"}} {2}\n", histogram.name(),
+                       snapshot.bucket_bounds[i], snapshot.bucket_counts[i]);
+  }
+  out += fmt::format(
+      "{0}_bucket{{le=\"+Inf\"}} {1}\n{0}_sum {2}\n{0}_count {1}\n",
+      histogram.name(), snapshot.count, snapshot.sum);
+}
+
+}  // namespace
+
+namespace wb::base::telemetry {
+
+Metric::Metric(const char* name, const char* help, MetricType type) noexcept
+    : name_{name}, help_{help}, type_{type} {
+  G3DCHECK(!!name_);
+  G3DCHECK(!!help_);
+
+  const std::scoped_lock lock{metrics_mutex};
+  GetRegisteredMetrics().emplace_back(this);
+}
+
+Metric::~Metric() noexcept {
+  const std::scoped_lock lock{metrics_mutex};
+
+  auto& metrics = GetRegisteredMetrics();
+  metrics.erase(std::remove(metrics.begin(), metrics.end(), this),
+                metrics.end());
+}
+
+[[nodiscard]] std::size_t Metric::GetShardIndex() noexcept {
+  thread_local const std::size_t shard_index{
+      next_metric_shard_index.fetch_add(1, std::memory_order_relaxed) %
+      kMetricShardsCount};
+  return shard_index;
+}
+
+Counter::Counter(const char* name, const char* help) noexcept
+    : Metric{name, help, MetricType::kCounter}, shards_{} {}
+
+[[nodiscard]] std::uint64_t Counter::Value() const noexcept {
+  std::uint64_t value{0};
+  for (const auto& shard : shards_) {
+    value += shard.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+Gauge::Gauge(const char* name, const char* help) noexcept
+    : Metric{name, help, MetricType::kGauge}, value_{0.0} {}
+
+Histogram::Histogram(const char* name, const char* help,
+                     std::initializer_list<double> bucket_bounds) noexcept
+    : Metric{name, help, MetricType::kHistogram},
+      bucket_bounds_{},
+      buckets_count_{std::min(bucket_bounds.size(), kMaxHistogramBucketsCount)},
+      shards_{} {
+  G3DCHECK(bucket_bounds.size() <= kMaxHistogramBucketsCount);
+  G3DCHECK(std::is_sorted(bucket_bounds.begin(), bucket_bounds.end()));
+
+  std::copy_n(bucket_bounds.begin(), buckets_count_, bucket_bounds_.begin());
+}
+
+void Histogram::Observe(double value) noexcept {
+  // Few buckets, linear search is fastest.
+  std::size_t bucket{0};
+  while (bucket < buckets_count_ && value > bucket_bounds_[bucket]) ++bucket;
+
+  auto& shard = shards_[GetShardIndex()];
+  shard.bucket_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+  shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+[[nodiscard]] HistogramSnapshot Histogram::Snapshot() const noexcept {
+  HistogramSnapshot snapshot{};
+  snapshot.bucket_bounds = bucket_bounds_;
+  snapshot.buckets_count = buckets_count_;
+
+  for (const auto& shard : shards_) {
+    for (std::size_t i{0}; i <= buckets_count_; ++i) {
+      snapshot.bucket_counts[i] +=
+          shard.bucket_counts[i].load(std::memory_order_relaxed);
+    }
+    snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+  }
+
+  // OpenMetrics buckets are cumulative.
+  for (std::size_t i{1}; i <= buckets_count_; ++i) {
+    snapshot.bucket_counts[i] += snapshot.bucket_counts[i - 1];
+  }
+  snapshot.count = snapshot.bucket_counts[buckets_count_];
+
+  return snapshot;
+}
+
+[[nodiscard]] WB_BASE_API std::string FormatOpenMetrics() {
+  std::string out;
+
+  const std::scoped_lock lock{metrics_mutex};
+
+  std::vector<const Metric*> metrics{GetRegisteredMetrics()};
+  std::sort(metrics.begin(), metrics.end(),
+            [](const Metric* left, const Metric* right) noexcept {
+              return std::string_view{left->name()} <
+                     std::string_view{right->name()};
+            });
+
+  for (const Metric* metric : metrics) {
+    switch (metric->type()) {
+      case MetricType::kCounter:
+        AppendMetricHeader(*metric, "counter", out);
+        out += fmt::format("{0}_total {1}\n", metric->name(),
+                           static_cast<const Counter*>(metric)->Value());
+        break;
+
+      case MetricType::kGauge:
+        AppendMetricHeader(*metric, "gauge", out);
+        out += fmt::format("{0} {1}\n", metric->name(),
+                           static_cast<const Gauge*>(metric)->Value());
+        break;
+
+      case MetricType::kHistogram:
+        AppendHistogram(*static_cast<const Histogram*>(metric), out);
+        break;
+    }
+  }
+
+  out += "# EOF\n";
+  return out;
+}
+
+/**
+ * @brief Metrics exporter implementation.
+ */
+class ScopedMetricsExporter::Impl final {
+ public:
+  /**
+   * @brief Creates metrics exporter implementation.
+   * @param export_path Export file path or unix:<path>.
+   * @param export_interval File rewrite interval.
+   */
+  Impl(std::string export_path,
+       std::chrono::milliseconds export_interval) noexcept
+      : export_path_{std::move(export_path)},
+        export_interval_{export_interval},
+#ifdef WB_OS_POSIX
+        socket_fd_{-1},
+#endif
+        is_stop_requested_{false} {
+  }
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(Impl);
+
+  ~Impl() noexcept {
+    {
+      const std::scoped_lock lock{export_mutex_};
+      is_stop_requested_ = true;
+    }
+    export_cv_.notify_one();
+
+    const bool is_started{export_thread_.joinable()};
+    if (is_started) export_thread_.join();
+
+#ifdef WB_OS_POSIX
+    if (socket_fd_ != -1) {
+      ::close(socket_fd_);
+      ::unlink(GetUnixSocketPath().data());
+      return;
+    }
+#endif
+
+    // Last metrics are often the most interesting ones.
+    if (is_started) WriteMetricsFile();
+  }
+
+  /**
+   * @brief Starts exporting.
+   * @return Error code.
+   */
+  [[nodiscard]] std::error_code Start() noexcept {
+    if (IsUnixSocket()) {
+#ifdef WB_OS_POSIX
+      if (const std::error_code rc{OpenUnixSocket()}; rc) [[unlikely]] {
+        return rc;
+      }
+#else
+      return std2::posix_last_error_code(ENOTSUP);
+#endif
+    }
+
+    try {
+      export_thread_ = std::thread{[this]() noexcept { Export(); }};
+    } catch (const std::system_error& ex) {
+      return ex.code();
+    }
+
+    G3LOG(INFO) << "Metrics are exported in OpenMetrics format to '"
+                << export_path_ << "'.";
+    return std2::ok_code;
+  }
+
+ private:
+  /**
+   * @brief Export path.
+   */
+  const std::string export_path_;
+  /**
+   * @brief Export interval.
+   */
+  const std::chrono::milliseconds export_interval_;
+  /**
+   * @brief Export thread.
+   */
+  std::thread export_thread_;
+  /**
+   * @brief Guards is_stop_requested_.
+   */
+  std::mutex export_mutex_;
+  /**
+   * @brief Wakes export thread on stop.
+   */
+  std::condition_variable export_cv_;
+#ifdef WB_OS_POSIX
+  /**
+   * @brief Listening Unix socket or -1.
+   */
+  int socket_fd_;
+#endif
+  /**
+   * @brief Is stop requested.
+   */
+  bool is_stop_requested_;
+#ifdef WB_OS_POSIX
+  WB_ATTRIBUTE_UNUSED_FIELD std::byte
+      pad_[sizeof(char*) - sizeof(socket_fd_) - sizeof(is_stop_requested_)];
+#else
+  WB_ATTRIBUTE_UNUSED_FIELD std::byte
+      pad_[sizeof(char*) - sizeof(is_stop_requested_)];
+#endif
+
+  /**
+   * @brief Is export to Unix socket.
+   * @return true if Unix socket.
+   */
+  [[nodiscard]] bool IsUnixSocket() const noexcept {
+    return export_path_.starts_with(kUnixSocketPathPrefix);
+  }
+
+  /**
+   * @brief Export thread.
+   * @return void.
+   */
+  void Export() noexcept {
+#ifdef WB_OS_POSIX
+    if (socket_fd_ != -1) {
+      ServeUnixSocket();
+      return;
+    }
+#endif
+
+    std::unique_lock lock{export_mutex_};
+    while (!export_cv_.wait_for(lock, export_interval_,
+                                [this]() { return is_stop_requested_; })) {
+      lock.unlock();
+      WriteMetricsFile();
+      lock.lock();
+    }
+  }
+
+  /**
+   * @brief Rewrites metrics file.  Writes to temporary file first and renames
+   * it, so scrapers never see partial file.
+   * @return void.
+   */
+  void WriteMetricsFile() noexcept {
+    try {
+      const std::string metrics{FormatOpenMetrics()};
+      const std::string temporary_path{export_path_ + ".tmp"};
+
+      {
+        std::ofstream file{temporary_path, std::ios::out | std::ios::trunc |
+                                               std::ios::binary};
+        file << metrics;
+        if (!file) [[unlikely]] {
+          G3LOG(WARNING) << "Unable to write metrics file '" << temporary_path
+                         << "'.";
+          return;
+        }
+      }
+
+      std::error_code rc;
+      std::filesystem::rename(temporary_path, export_path_, rc);
+      G3PLOGE2_IF(WARNING, rc) << "Unable to rename metrics file '"
+                               << temporary_path << "' to '" << export_path_
+                               << "'.";
+    } catch (const std::exception& ex) {
+      G3LOG(WARNING) << "Unable to export metrics: " << ex.what();
+    }
+  }
+
+#ifdef WB_OS_POSIX
+  /**
+   * @brief Gets Unix socket path.
+   * @return Unix socket path.
+   */
+  [[nodiscard]] std::string_view GetUnixSocketPath() const noexcept {
+    return std::string_view{export_path_}.substr(kUnixSocketPathPrefix.size());
+  }
+
+  /**
+   * @brief Opens listening Unix socket.
+   * @return Error code.
+   */
+  [[nodiscard]] std::error_code OpenUnixSocket() noexcept {
+    const std::string_view socket_path{GetUnixSocketPath()};
+
+    sockaddr_un address{};
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path))
+        [[unlikely]] {
+      return std2::posix_last_error_code(ENAMETOOLONG);
+    }
+
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket_path.data(),
+                 sizeof(address.sun_path) - 1);
+
+    socket_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket_fd_ == -1) [[unlikely]] {
+      return std2::posix_last_error_code();
+    }
+
+    // Stale socket of crashed app.
+    ::unlink(address.sun_path);
+
+    std::error_code rc{posix::get_error(
+        ::bind(socket_fd_, reinterpret_cast<const sockaddr*>(&address),
+               sizeof(address)))};
+    if (!rc) [[likely]] {
+      rc = posix::get_error(::listen(socket_fd_, 4));
+    }
+
+    if (rc) [[unlikely]] {
+      ::close(socket_fd_);
+      socket_fd_ = -1;
+    }
+
+    return rc;
+  }
+
+  /**
+   * @brief Serves metrics to each Unix socket connection till stop.
+   * @return void.
+   */
+  void ServeUnixSocket() noexcept {
+    using namespace std::chrono_literals;
+
+    // Stop is checked between polls.
+    constexpr std::chrono::milliseconds kPollTimeout{100ms};
+
+    while (true) {
+      {
+        const std::scoped_lock lock{export_mutex_};
+        if (is_stop_requested_) break;
+      }
+
+      pollfd poll_fd{.fd = socket_fd_, .events = POLLIN, .revents = 0};
+      const int rc{
+          ::poll(&poll_fd, 1, static_cast<int>(kPollTimeout.count()))};
+      if (rc <= 0 || !(poll_fd.revents & POLLIN)) continue;
+
+      const int client_fd{
+          ::accept4(socket_fd_, nullptr, nullptr, SOCK_CLOEXEC)};
+      if (client_fd == -1) [[unlikely]] {
+        G3PLOG_E(WARNING, std2::posix_last_error_code())
+            << "Unable to accept metrics scraper connection.";
+        continue;
+      }
+
+      SendMetrics(client_fd);
+      ::close(client_fd);
+    }
+  }
+
+  /**
+   * @brief Sends metrics to client.
+   * @param client_fd Client socket.
+   * @return void.
+   */
+  static void SendMetrics(int client_fd) noexcept {
+    try {
+      const std::string metrics{FormatOpenMetrics()};
+
+      std::size_t sent{0};
+      while (sent < metrics.size()) {
+        // Do not die with SIGPIPE when scraper is gone.
+        const ssize_t rc{::send(client_fd, metrics.data() + sent,
+                                metrics.size() - sent, MSG_NOSIGNAL)};
+        if (rc == -1) {
+          if (errno == EINTR) continue;
+
+          G3PLOG_E(WARNING, std2::posix_last_error_code())
+              << "Unable to send metrics to scraper.";
+          return;
+        }
+
+        sent += static_cast<std::size_t>(rc);
+      }
+    } catch (const std::exception& ex) {
+      G3LOG(WARNING) << "Unable to export metrics: " << ex.what();
+    }
+  }
+#endif
+};
+
+[[nodiscard]] std2::result<ScopedMetricsExporter> ScopedMetricsExporter::New(
+    std::string export_path,
+    std::chrono::milliseconds export_interval) noexcept {
+  if (export_path.empty() || export_interval.count() <= 0) [[unlikely]] {
+    return std2::result<ScopedMetricsExporter>{
+        std::unexpect, std2::posix_last_error_code(EINVAL)};
+  }
+
+  auto impl = std::make_unique<Impl>(std::move(export_path), export_interval);
+  if (const std::error_code rc{impl->Start()}; rc) [[unlikely]] {
+    return std2::result<ScopedMetricsExporter>{std::unexpect, rc};
+  }
+
+  return ScopedMetricsExporter{std::move(impl)};
+}
+
+ScopedMetricsExporter::ScopedMetricsExporter(un<Impl> impl) noexcept
+    : impl_{std::move(impl)} {
+  G3DCHECK(!!impl_);
+}
+
+ScopedMetricsExporter::ScopedMetricsExporter(
+    ScopedMetricsExporter&& e) noexcept = default;
+
+ScopedMetricsExporter& ScopedMetricsExporter::operator=(
+    ScopedMetricsExporter&& e) noexcept = default;
+
+ScopedMetricsExporter::~ScopedMetricsExporter() noexcept = default;
+
+}  // namespace wb::base::telemetry
@@ -0,0 +1,378 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Process wide metrics registry with counters, gauges and histograms.  Metrics
+// register themselves on construction and are sharded per thread, so updates
+// from different threads do not contend.  Define metrics at namespace scope,
+// so hot paths never allocate or lock.
+//
+// Usage example:
+//
+// Counter input_events_counter{"whitebox_input_events",
+//                              "Input events processed."};
+// ...
+// input_events_counter.Increment();
+// ...
+// const auto exporter = ScopedMetricsExporter::New("metrics.prom", 1s);
+
+#ifndef WB_BASE_TELEMETRY_METRICS_H_
+#define WB_BASE_TELEMETRY_METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+#include "base/config.h"
+#include "base/macroses.h"
+#include "base/std2/system_error_ext.h"
+#include "build/compiler_config.h"
+
+namespace wb::base::telemetry {
+
+/**
+ * @brief Shards count per metric.  Threads are assigned to shards round-robin.
+ */
+inline constexpr std::size_t kMetricShardsCount{16U};
+
+/**
+ * @brief Metric shard alignment.  Cache line size, so shards of different
+ * threads do not false share.
+ */
+inline constexpr std::size_t kMetricShardAlignment{64U};
+
+/**
+ * @brief Max histogram buckets count excluding +Inf one.
+ */
+inline constexpr std::size_t kMaxHistogramBucketsCount{14U};
+
+/**
+ * @brief Metric type.
+ */
+enum class MetricType : std::uint8_t {
+  /**
+   * @brief Monotonic counter.
+   */
+  kCounter = 0U,
+  /**
+   * @brief Value which goes up and down.
+   */
+  kGauge = 1U,
+  /**
+   * @brief Observations distribution by buckets.
+   */
+  kHistogram = 2U
+};
+
+/**
+ * @brief Metric base.  Registers metric in registry for lifetime.
+ */
+class WB_BASE_API Metric {
+ public:
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(Metric);
+
+  /**
+   * @brief Gets metric name.
+   * @return Metric name.
+   */
+  [[nodiscard]] const char* name() const noexcept { return name_; }
+
+  /**
+   * @brief Gets metric help.
+   * @return Metric help.
+   */
+  [[nodiscard]] const char* help() const noexcept { return help_; }
+
+  /**
+   * @brief Gets metric type.
+   * @return Metric type.
+   */
+  [[nodiscard]] MetricType type() const noexcept { return type_; }
+
+ protected:
+  /**
+   * @brief Registers metric.
+   * @param name Metric name.  Should be static string in OpenMetrics format,
+   * [a-zA-Z_:][a-zA-Z0-9_:]*, without _total suffix for counters.
+   * @param help Metric help.  Should be static string.
+   * @param type Metric type.
+   */
+  Metric(const char* name, const char* help, MetricType type) noexcept;
+
+  /**
+   * @brief Unregisters metric.
+   */
+  ~Metric() noexcept;
+
+  /**
+   * @brief Gets current thread shard index.
+   * @return Shard index.
+   */
+  [[nodiscard]] static std::size_t GetShardIndex() noexcept;
+
+ private:
+  /**
+   * @brief Name.
+   */
+  const char* name_;
+  /**
+   * @brief Help.
+   */
+  const char* help_;
+  /**
+   * @brief Type.
+   */
+  MetricType type_;
+  // Derived metric shards start at cache line boundary.
+  WB_ATTRIBUTE_UNUSED_FIELD std::byte
+      pad_[kMetricShardAlignment - sizeof(name_) - sizeof(help_) -
+           sizeof(type_)];
+};
+
+/**
+ * @brief Monotonic counter.
+ */
+class WB_BASE_API Counter final : public Metric {
+ public:
+  /**
+   * @brief Creates counter.
+   * @param name Counter name without _total suffix.  Static string.
+   * @param help Counter help.  Static string.
+   */
+  Counter(const char* name, const char* help) noexcept;
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(Counter);
+
+  ~Counter() noexcept = default;
+
+  /**
+   * @brief Increments counter.  Does not allocate or lock.
+   * @param delta Increment.
+   * @return void.
+   */
+  void Increment(std::uint64_t delta = 1U) noexcept {
+    shards_[GetShardIndex()].value.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Gets counter value.  Sums all shards.
+   * @return Counter value.
+   */
+  [[nodiscard]] std::uint64_t Value() const noexcept;
+
+ private:
+  /**
+   * @brief Counter shard.
+   */
+  struct alignas(kMetricShardAlignment) Shard {
+    /**
+     * @brief Shard value.
+     */
+    std::atomic_uint64_t value;
+    WB_ATTRIBUTE_UNUSED_FIELD std::byte
+        pad_[kMetricShardAlignment - sizeof(value)];
+  };
+
+  /**
+   * @brief Shards.
+   */
+  std::array<Shard, kMetricShardsCount> shards_;
+};
+
+/**
+ * @brief Value which goes up and down.  Not sharded, as last set value wins.
+ */
+class WB_BASE_API Gauge final : public Metric {
+ public:
+  /**
+   * @brief Creates gauge.
+   * @param name Gauge name.  Static string.
+   * @param help Gauge help.  Static string.
+   */
+  Gauge(const char* name, const char* help) noexcept;
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(Gauge);
+
+  ~Gauge() noexcept = default;
+
+  /**
+   * @brief Sets gauge value.  Does not allocate or lock.
+   * @param value Value.
+   * @return void.
+   */
+  void Set(double value) noexcept {
+    value_.store(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Adds to gauge value.  Does not allocate or lock.
+   * @param delta Value delta.
+   * @return void.
+   */
+  void Add(double delta) noexcept {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Gets gauge value.
+   * @return Gauge value.
+   */
+  [[nodiscard]] double Value() const noexcept {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  /**
+   * @brief Value.  Starts at cache line boundary after metric.
+   */
+  std::atomic<double> value_;
+};
+
+/**
+ * @brief Histogram snapshot.
+ */
+struct HistogramSnapshot {
+  /**
+   * @brief Buckets upper bounds.
+   */
+  std::array<double, kMaxHistogramBucketsCount> bucket_bounds;
+  /**
+   * @brief Cumulative buckets counts, last one is +Inf.
+   */
+  std::array<std::uint64_t, kMaxHistogramBucketsCount + 1U> bucket_counts;
+  /**
+   * @brief Buckets count excluding +Inf one.
+   */
+  std::size_t buckets_count;
+  /**
+   * @brief Observations count.
+   */
+  std::uint64_t count;
+  /**
+   * @brief Observations sum.
+   */
+  double sum;
+};
+
+/**
+ * @brief Observations distribution by buckets.
+ */
+class WB_BASE_API Histogram final : public Metric {
+ public:
+  /**
+   * @brief Creates histogram.
+   * @param name Histogram name.  Static string.
+   * @param help Histogram help.  Static string.
+   * @param bucket_bounds Ascending buckets upper bounds, up to
+   * kMaxHistogramBucketsCount.  +Inf bucket is implicit.
+   */
+  Histogram(const char* name, const char* help,
+            std::initializer_list<double> bucket_bounds) noexcept;
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(Histogram);
+
+  ~Histogram() noexcept = default;
+
+  /**
+   * @brief Records observation.  Does not allocate or lock.
+   * @param value Observed value.
+   * @return void.
+   */
+  void Observe(double value) noexcept;
+
+  /**
+   * @brief Gets histogram snapshot.  Sums all shards.
+   * @return Histogram snapshot.
+   */
+  [[nodiscard]] HistogramSnapshot Snapshot() const noexcept;
+
+ private:
+  /**
+   * @brief Histogram shard.
+   */
+  struct alignas(kMetricShardAlignment) Shard {
+    /**
+     * @brief Non-cumulative buckets counts, last one is +Inf.
+     */
+    std::array<std::atomic_uint64_t, kMaxHistogramBucketsCount + 1U>
+        bucket_counts;
+    /**
+     * @brief Observations sum.
+     */
+    std::atomic<double> sum;
+  };
+
+  /**
+   * @brief Buckets upper bounds.
+   */
+  std::array<double, kMaxHistogramBucketsCount> bucket_bounds_;
+  /**
+   * @brief Buckets count excluding +Inf one.
+   */
+  std::size_t buckets_count_;
+  WB_ATTRIBUTE_UNUSED_FIELD std::byte
+      pad_[kMetricShardAlignment -
+           (sizeof(bucket_bounds_) + sizeof(buckets_count_)) %
+               kMetricShardAlignment];
+  /**
+   * @brief Shards.
+   */
+  std::array<Shard, kMetricShardsCount> shards_;
+};
+
+/**
+ * @brief Formats all registered metrics in OpenMetrics text format.
+ * @return OpenMetrics text.
+ */
+[[nodiscard]] WB_BASE_API std::string FormatOpenMetrics();
+
+/**
+ * @brief Periodically exports registered metrics in OpenMetrics text format to
+ * file or Unix socket.
+ */
+class WB_BASE_API ScopedMetricsExporter {
+ public:
+  /**
+   * @brief Starts metrics exporter.
+   * @param export_path File path to rewrite every |export_interval|, or
+   * unix:<path> to serve metrics on Unix socket (POSIX only).  Each connection
+   * to socket gets current metrics and is closed.
+   * @param export_interval File rewrite interval.
+   * @return Metrics exporter or error.
+   */
+  [[nodiscard]] static std2::result<ScopedMetricsExporter> New(
+      std::string export_path,
+      std::chrono::milliseconds export_interval) noexcept;
+
+  ScopedMetricsExporter(ScopedMetricsExporter&& e) noexcept;
+  ScopedMetricsExporter& operator=(ScopedMetricsExporter&& e) noexcept;
+
+  WB_NO_COPY_CTOR_AND_ASSIGNMENT(ScopedMetricsExporter);
+
+  /**
+   * @brief Stops metrics exporter.  Writes final metrics to file.
+   */
+  ~ScopedMetricsExporter() noexcept;
+
+ private:
+  class Impl;
+
+  /**
+   * @brief Implementation.
+   */
+  un<Impl> impl_;
+
+  /**
+   * @brief Creates metrics exporter.
+   * @param impl Implementation.
+   */
+  explicit ScopedMetricsExporter(un<Impl> impl) noexcept;
+};
+
+}  // namespace wb::base::telemetry
+
+#endif  // !WB_BASE_TELEMETRY_METRICS_H_
@@ -0,0 +1,208 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Process wide metrics registry with counters, gauges and histograms.
+
+#include "metrics.h"
+//
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/deps/googletest/gtest/gtest.h"
+#include "build/build_config.h"
+
+#ifdef WB_OS_POSIX
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace {
+
+/**
+ * @brief Test counter.
+ */
+wb::base::telemetry::Counter test_counter{"whitebox_test_events",
+                                          "Test events."};
+
+/**
+ * @brief Reads file.
+ * @param path File path.
+ * @return File content.
+ */
+[[nodiscard]] std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream file{path, std::ios::in | std::ios::binary};
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MetricsTest, ShardsDoNotFalseShare) {
+  using namespace wb::base::telemetry;
+
+  static_assert(sizeof(Metric) == kMetricShardAlignment);
+  static_assert(sizeof(Counter) ==
+                kMetricShardAlignment * (kMetricShardsCount + 1U));
+  static_assert(sizeof(Histogram) % kMetricShardAlignment == 0U);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MetricsTest, CounterSumsAllThreads) {
+  using namespace wb::base::telemetry;
+
+  Counter counter{"whitebox_test_counter", "Test counter."};
+
+  std::vector<std::thread> threads;
+  for (int i{0}; i < 8; ++i) {
+    threads.emplace_back([&counter]() {
+      for (int j{0}; j < 1000; ++j) counter.Increment();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(8000U, counter.Value());
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MetricsTest, Gauge) {
+  using namespace wb::base::telemetry;
+
+  Gauge gauge{"whitebox_test_gauge", "Test gauge."};
+  EXPECT_EQ(0.0, gauge.Value());
+
+  gauge.Set(2.5);
+  gauge.Add(-1.0);
+  EXPECT_EQ(1.5, gauge.Value());
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MetricsTest, HistogramBucketsAreCumulative) {
+  using namespace wb::base::telemetry;
+
+  Histogram histogram{"whitebox_test_histogram", "Test histogram.",
+                      {1.0, 2.0, 4.0}};
+  histogram.Observe(0.5);
+  histogram.Observe(1.0);
+  histogram.Observe(3.0);
+  histogram.Observe(10.0);
+
+  const HistogramSnapshot snapshot{histogram.Snapshot()};
+  ASSERT_EQ(3U, snapshot.buckets_count);
+  EXPECT_EQ(2U, snapshot.bucket_counts[0]);
+  EXPECT_EQ(2U, snapshot.bucket_counts[1]);
+  EXPECT_EQ(3U, snapshot.bucket_counts[2]);
+  EXPECT_EQ(4U, snapshot.bucket_counts[3]);
+  EXPECT_EQ(4U, snapshot.count);
+  EXPECT_EQ(14.5, snapshot.sum);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MetricsTest, FormatOpenMetrics) {
+  using namespace wb::base::telemetry;
+
+  test_counter.Increment(3U);
+
+  {
+    Histogram histogram{"whitebox_test_latency_seconds", "Test latency.",
+                        {0.5}};
+    histogram.Observe(0.25);
+
+    const std::string metrics{FormatOpenMetrics()};
+    EXPECT_NE(std::string::npos,
+              metrics.find("# TYPE whitebox_test_events counter\n"
+                           "# HELP whitebox_test_events Test events.\n"
+                           "whitebox_test_events_total 3\n"));
+    EXPECT_NE(std::string::npos,
+              metrics.find("whitebox_test_latency_seconds_bucket{le=\"0.5\"} "
+                           "1\nwhitebox_test_latency_seconds_bucket{le=\"+"
+                           "Inf\"} 1\nwhitebox_test_latency_seconds_sum "
+                           "0.25\nwhitebox_test_latency_seconds_count 1\n"));
+    EXPECT_TRUE(metrics.ends_with("# EOF\n"));
+  }
+
+  // Destroyed metrics are unregistered.
+  EXPECT_EQ(std::string::npos,
+            FormatOpenMetrics().find("whitebox_test_latency_seconds"));
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MetricsTest, ExporterRejectsInvalidArguments) {
+  using namespace wb::base::telemetry;
+  using namespace std::chrono_literals;
+
+  EXPECT_EQ(EINVAL, ScopedMetricsExporter::New("", 1s).error().value());
+  EXPECT_EQ(EINVAL,
+            ScopedMetricsExporter::New("metrics.prom", 0ms).error().value());
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MetricsTest, ExporterWritesFile) {
+  using namespace wb::base::telemetry;
+  using namespace std::chrono_literals;
+
+  const std::filesystem::path path{std::filesystem::temp_directory_path() /
+                                   "whitebox_metrics_tests.prom"};
+  std::filesystem::remove(path);
+
+  {
+    auto exporter = ScopedMetricsExporter::New(path.string(), 10ms);
+    ASSERT_TRUE(exporter.has_value());
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_TRUE(std::filesystem::exists(path));
+  }
+
+  // Final metrics are written on stop.
+  const std::string metrics{ReadFile(path)};
+  EXPECT_NE(std::string::npos, metrics.find("whitebox_test_events_total"));
+  EXPECT_TRUE(metrics.ends_with("# EOF\n"));
+
+  std::filesystem::remove(path);
+}
+
+#ifdef WB_OS_POSIX
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(MetricsTest, ExporterServesUnixSocket) {
+  using namespace wb::base::telemetry;
+  using namespace std::chrono_literals;
+
+  const std::string socket_path{
+      (std::filesystem::temp_directory_path() / "whitebox_metrics_tests.sock")
+          .string()};
+
+  auto exporter = ScopedMetricsExporter::New("unix:" + socket_path, 1s);
+  ASSERT_TRUE(exporter.has_value());
+
+  const int fd{::socket(AF_UNIX, SOCK_STREAM, 0)};
+  ASSERT_NE(-1, fd);
+
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socket_path.c_str(),
+               sizeof(address.sun_path) - 1);
+  ASSERT_EQ(0, ::connect(fd, reinterpret_cast<const sockaddr*>(&address),
+                         sizeof(address)));
+
+  std::string metrics;
+  char buffer[256];
+  ssize_t read_count;
+  while ((read_count = ::read(fd, buffer, sizeof(buffer))) > 0) {
+    metrics.append(buffer, static_cast<std::size_t>(read_count));
+  }
+  ::close(fd);
+
+  EXPECT_NE(std::string::npos, metrics.find("whitebox_test_events_total"));
+  EXPECT_TRUE(metrics.ends_with("# EOF\n"));
+}
+#endif
@@ -0,0 +1,94 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Single writer / many readers sequence lock.
+
+#ifndef WB_BASE_TELEMETRY_SEQLOCK_H_
+#define WB_BASE_TELEMETRY_SEQLOCK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>  // std::memcpy
+#include <type_traits>
+
+#include "base/macroses.h"
+
+namespace wb::base::telemetry {
+
+/**
+ * @brief Sequence lock.  Single writer never blocks, readers retry when value
+ * was changed during read.  Value and sequence are stored inline, so lock can
+ * be placed into memory shared between processes.
+ * @tparam T Value type.
+ */
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "T should be trivially copyable to be copied byte by byte.");
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                "Sequence should be lock free to be shared between processes.");
+
+ public:
+  /**
+   * @brief Creates zero value sequence lock.
+   */
+  constexpr SeqLock() noexcept : sequence_{0U}, value_{} {}
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(SeqLock);
+
+  /**
+   * @brief Stores value.  Should be called by single writer only.
+   * @param value Value.
+   * @return void.
+   */
+  void Store(const T &value) noexcept {
+    const std::uint64_t sequence{sequence_.load(std::memory_order_relaxed)};
+
+    // Odd sequence means write is in progress.
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(&value_, &value, sizeof(value_));
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  /**
+   * @brief Try to load consistent value.
+   * @param value Value to load into.
+   * @return true if value is consistent, false if write was in progress.
+   */
+  [[nodiscard]] bool TryLoad(T &value) const noexcept {
+    const std::uint64_t sequence_before{
+        sequence_.load(std::memory_order_acquire)};
+    if (sequence_before & 1U) return false;
+
+    std::memcpy(&value, &value_, sizeof(value));
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return sequence_before == sequence_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get stores count.
+   * @return Stores count.
+   */
+  [[nodiscard]] std::uint64_t StoresCount() const noexcept {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+
+ private:
+  /**
+   * @brief Sequence.  Odd when write is in progress.
+   */
+  std::atomic<std::uint64_t> sequence_;
+  /**
+   * @brief Value.
+   */
+  T value_;
+};
+
+}  // namespace wb::base::telemetry
+
+#endif  // !WB_BASE_TELEMETRY_SEQLOCK_H_
@@ -0,0 +1,97 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Single writer / many readers sequence lock.
+
+#include "seqlock.h"
+//
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+#include "base/deps/googletest/gtest/gtest.h"
+
+namespace {
+
+/**
+ * @brief Value with invariant, all fields should be equal.
+ */
+struct Value {
+  std::uint64_t a;
+  std::uint64_t b;
+  std::uint64_t c;
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SeqLockTest, NoCopyMoveConstructorAndAssignment) {
+  using namespace wb::base::telemetry;
+
+  static_assert(!std::is_copy_constructible_v<SeqLock<Value>>);
+  static_assert(!std::is_copy_assignable_v<SeqLock<Value>>);
+  static_assert(!std::is_move_constructible_v<SeqLock<Value>>);
+  static_assert(!std::is_move_assignable_v<SeqLock<Value>>);
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SeqLockTest, LoadsZeroValueByDefault) {
+  using namespace wb::base::telemetry;
+
+  const SeqLock<Value> lock;
+  Value value{1, 2, 3};
+
+  ASSERT_TRUE(lock.TryLoad(value));
+  EXPECT_EQ(0U, value.a);
+  EXPECT_EQ(0U, value.b);
+  EXPECT_EQ(0U, value.c);
+  EXPECT_EQ(0U, lock.StoresCount());
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SeqLockTest, LoadsStoredValue) {
+  using namespace wb::base::telemetry;
+
+  SeqLock<Value> lock;
+  lock.Store(Value{7, 8, 9});
+
+  Value value{};
+  ASSERT_TRUE(lock.TryLoad(value));
+  EXPECT_EQ(7U, value.a);
+  EXPECT_EQ(8U, value.b);
+  EXPECT_EQ(9U, value.c);
+  EXPECT_EQ(1U, lock.StoresCount());
+}
+
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(SeqLockTest, ReaderNeverSeesTornValue) {
+  using namespace wb::base::telemetry;
+
+  constexpr std::uint64_t kStoresCount{100000U};
+
+  SeqLock<Value> lock;
+  std::atomic_bool is_done{false};
+
+  std::thread writer{[&]() {
+    for (std::uint64_t i{1}; i <= kStoresCount; ++i) {
+      lock.Store(Value{i, i, i});
+    }
+    is_done.store(true, std::memory_order_release);
+  }};
+
+  Value value{};
+  while (!is_done.load(std::memory_order_acquire)) {
+    if (lock.TryLoad(value)) {
+      EXPECT_EQ(value.a, value.b);
+      EXPECT_EQ(value.b, value.c);
+    }
+  }
+
+  writer.join();
+
+  ASSERT_TRUE(lock.TryLoad(value));
+  EXPECT_EQ(kStoresCount, value.a);
+  EXPECT_EQ(kStoresCount, lock.StoresCount());
+}
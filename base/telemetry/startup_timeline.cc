@@ -0,0 +1,281 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Startup timeline tracer.  Records startup phases across app, boot manager
+// and kernel and dumps them to log and Chrome trace event file.
+
+#include "base/telemetry/startup_timeline.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+
+#include "base/deps/fmt/core.h"
+#include "base/deps/g3log/g3log.h"
+#include "base/high_resolution_clock.h"
+
+namespace {
+
+/**
+ * @brief Startup phase slot.
+ */
+struct StartupPhaseSlot {
+  /**
+   * @brief Phase name.  nullptr until slot is filled.
+   */
+  std::atomic<const char*> name;
+  /**
+   * @brief Phase start since clock epoch, ns.
+   */
+  std::atomic_int64_t start_ns;
+  /**
+   * @brief Phase end since clock epoch, ns.  0 when not finished.
+   */
+  std::atomic_int64_t end_ns;
+  /**
+   * @brief Phase nesting depth.
+   */
+  std::atomic_uint32_t depth;
+  /**
+   * @brief Phase thread id.
+   */
+  std::atomic_uint32_t thread_id;
+};
+
+/**
+ * @brief All startup phases.
+ */
+std::array<StartupPhaseSlot, wb::base::telemetry::kMaxStartupPhasesCount>
+    startup_phases_slots;
+
+/**
+ * @brief Used startup phases slots count.
+ */
+std::atomic_uint32_t startup_phases_count{0};
+
+/**
+ * @brief Timeline start since clock epoch, ns.
+ */
+std::atomic_int64_t timeline_start_ns{0};
+
+/**
+ * @brief Is timeline finished.
+ */
+std::atomic_bool is_timeline_finished{false};
+
+/**
+ * @brief Next thread id for trace.
+ */
+std::atomic_uint32_t next_thread_id{1};
+
+/**
+ * @brief Current thread phases nesting depth.
+ */
+thread_local std::uint32_t current_thread_phases_depth{0};
+
+/**
+ * @brief Current thread id for trace.  0 if not assigned yet.
+ */
+thread_local std::uint32_t current_thread_id{0};
+
+/**
+ * @brief Now since clock epoch, ns.
+ * @return Now.
+ */
+[[nodiscard]] std::int64_t NowNs() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             wb::base::HighResolutionClock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief Gets current thread id for trace.
+ * @return Thread id.
+ */
+[[nodiscard]] std::uint32_t GetCurrentThreadId() noexcept {
+  if (current_thread_id == 0) [[unlikely]] {
+    current_thread_id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+  }
+  return current_thread_id;
+}
+
+/**
+ * @brief Nanoseconds to milliseconds.
+ * @param ns Nanoseconds.
+ * @return Milliseconds.
+ */
+[[nodiscard]] constexpr double ToMs(std::chrono::nanoseconds ns) noexcept {
+  return static_cast<double>(ns.count()) / 1'000'000.0;
+}
+
+/**
+ * @brief Logs startup phases summary.
+ * @param phases Startup phases.
+ * @param total Total startup time.
+ * @return void.
+ */
+void LogStartupPhases(
+    const std::vector<wb::base::telemetry::StartupPhase>& phases,
+    std::chrono::nanoseconds total) {
+  std::string summary{
+      fmt::format("{:>12} {:>12}  {}\n", "start ms", "duration ms", "phase")};
+
+  for (const auto& phase : phases) {
+    summary += fmt::format("{:>12.3f} {:>12.3f}  {:>{}}{}{}\n",
+                           ToMs(phase.start), ToMs(phase.duration), "",
+                           phase.depth * 2U, phase.name,
+                           phase.is_finished ? "" : " (running)");
+  }
+
+  summary +=
+      fmt::format("{:>12.3f} {:>12.3f}  {}", 0.0, ToMs(total), "total");
+
+  G3LOG(INFO) << "Startup timeline:\n" << summary;
+}
+
+/**
+ * @brief Writes startup phases as Chrome trace event file.
+ * @param phases Startup phases.
+ * @param trace_path Trace file path.
+ * @return void.
+ */
+void WriteStartupTrace(
+    const std::vector<wb::base::telemetry::StartupPhase>& phases,
+    const std::string& trace_path) {
+  std::ofstream trace{trace_path, std::ios::out | std::ios::trunc};
+  if (!trace) [[unlikely]] {
+    G3LOG(WARNING) << "Unable to open startup trace file '" << trace_path
+                   << "', skip writing startup trace.";
+    return;
+  }
+
+  trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool is_first{true};
+  for (const auto& phase : phases) {
+    trace << (is_first ? "" : ",")
+          << fmt::format(
+                 "\n{{\"name\":\"{0}\",\"cat\":\"startup\",\"ph\":\"X\","
+                 "\"ts\":{1:.3f},\"dur\":{2:.3f},\"pid\":1,\"tid\":{3}}}",
+                 phase.name, static_cast<double>(phase.start.count()) / 1000.0,
+                 static_cast<double>(phase.duration.count()) / 1000.0,
+                 phase.thread_id);
+    is_first = false;
+  }
+
+  trace << "\n]}\n";
+
+  if (!trace) [[unlikely]] {
+    G3LOG(WARNING) << "Unable to write startup trace file '" << trace_path
+                   << "'.";
+    return;
+  }
+
+  G3LOG(INFO) << "Startup trace is written to '" << trace_path << "'.";
+}
+
+}  // namespace
+
+namespace wb::base::telemetry {
+
+namespace internal {
+
+[[nodiscard]] WB_BASE_API std::uint32_t BeginStartupPhase(
+    const char* name) noexcept {
+  if (is_timeline_finished.load(std::memory_order_acquire)) [[unlikely]] {
+    return kInvalidStartupPhaseId;
+  }
+
+  const std::uint32_t phase_id{
+      startup_phases_count.fetch_add(1, std::memory_order_relaxed)};
+  if (phase_id >= kMaxStartupPhasesCount) [[unlikely]] {
+    return kInvalidStartupPhaseId;
+  }
+
+  const std::int64_t now_ns{NowNs()};
+  // First phase starts timeline.
+  std::int64_t expected_start_ns{0};
+  timeline_start_ns.compare_exchange_strong(expected_start_ns, now_ns,
+                                            std::memory_order_relaxed);
+
+  auto& slot = startup_phases_slots[phase_id];
+  slot.start_ns.store(now_ns, std::memory_order_relaxed);
+  slot.end_ns.store(0, std::memory_order_relaxed);
+  slot.depth.store(current_thread_phases_depth++, std::memory_order_relaxed);
+  slot.thread_id.store(GetCurrentThreadId(), std::memory_order_relaxed);
+  // Publish slot.
+  slot.name.store(name, std::memory_order_release);
+
+  return phase_id;
+}
+
+WB_BASE_API void EndStartupPhase(std::uint32_t phase_id) noexcept {
+  G3DCHECK(phase_id < kMaxStartupPhasesCount);
+
+  startup_phases_slots[phase_id].end_ns.store(NowNs(),
+                                              std::memory_order_release);
+
+  if (current_thread_phases_depth > 0) [[likely]] {
+    --current_thread_phases_depth;
+  }
+}
+
+}  // namespace internal
+
+[[nodiscard]] WB_BASE_API std::vector<StartupPhase> GetStartupPhases() {
+  const std::uint32_t phases_count{
+      std::min(startup_phases_count.load(std::memory_order_relaxed),
+               kMaxStartupPhasesCount)};
+  const std::int64_t start_ns{
+      timeline_start_ns.load(std::memory_order_relaxed)};
+
+  std::vector<StartupPhase> phases;
+  phases.reserve(phases_count);
+
+  for (std::uint32_t i{0}; i < phases_count; ++i) {
+    const auto& slot = startup_phases_slots[i];
+    const char* name{slot.name.load(std::memory_order_acquire)};
+    // Not filled yet.
+    if (!name) [[unlikely]] continue;
+
+    const std::int64_t phase_start_ns{
+        slot.start_ns.load(std::memory_order_relaxed)};
+    const std::int64_t phase_end_ns{
+        slot.end_ns.load(std::memory_order_acquire)};
+
+    phases.emplace_back(StartupPhase{
+        .name = name,
+        .start = std::chrono::nanoseconds{phase_start_ns - start_ns},
+        .duration = std::chrono::nanoseconds{
+            phase_end_ns != 0 ? phase_end_ns - phase_start_ns : 0},
+        .depth = slot.depth.load(std::memory_order_relaxed),
+        .thread_id = slot.thread_id.load(std::memory_order_relaxed),
+        .is_finished = phase_end_ns != 0});
+  }
+
+  return phases;
+}
+
+WB_BASE_API void FinishStartupTimeline(const std::string& trace_path) {
+  if (is_timeline_finished.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+
+  const std::int64_t start_ns{
+      timeline_start_ns.load(std::memory_order_relaxed)};
+  const std::chrono::nanoseconds total{start_ns != 0 ? NowNs() - start_ns : 0};
+
+  std::vector<StartupPhase> phases{GetStartupPhases()};
+  // Running phases last till timeline finish.
+  for (auto& phase : phases) {
+    if (!phase.is_finished) phase.duration = total - phase.start;
+  }
+
+  LogStartupPhases(phases, total);
+
+  if (!trace_path.empty()) WriteStartupTrace(phases, trace_path);
+}
+
+}  // namespace wb::base::telemetry
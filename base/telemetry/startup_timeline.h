@@ -0,0 +1,143 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Startup timeline tracer.  Records startup phases across app, boot manager
+// and kernel and dumps them to log and Chrome trace event file.
+//
+// Usage example:
+//
+// {
+//   const ScopedStartupPhase scoped_startup_phase{"CreateIntl"};
+//   ...
+// }
+// ...
+// FinishStartupTimeline("startup_trace.json");
+
+#ifndef WB_BASE_TELEMETRY_STARTUP_TIMELINE_H_
+#define WB_BASE_TELEMETRY_STARTUP_TIMELINE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/config.h"
+#include "base/macroses.h"
+
+namespace wb::base::telemetry {
+
+/**
+ * @brief Max startup phases count.  Phases above limit are ignored.
+ */
+inline constexpr std::uint32_t kMaxStartupPhasesCount{64U};
+
+/**
+ * @brief Startup phase.
+ */
+struct StartupPhase {
+  /**
+   * @brief Phase name.  Static string.
+   */
+  const char* name;
+  /**
+   * @brief Phase start since timeline start.
+   */
+  std::chrono::nanoseconds start;
+  /**
+   * @brief Phase duration.  Zero if phase is not finished.
+   */
+  std::chrono::nanoseconds duration;
+  /**
+   * @brief Phase nesting depth on thread.
+   */
+  std::uint32_t depth;
+  /**
+   * @brief Phase thread id, sequential from 1.
+   */
+  std::uint32_t thread_id;
+  /**
+   * @brief Is phase finished.
+   */
+  bool is_finished;
+};
+
+namespace internal {
+
+/**
+ * @brief Invalid startup phase id.
+ */
+inline constexpr std::uint32_t kInvalidStartupPhaseId{kMaxStartupPhasesCount};
+
+/**
+ * @brief Begins startup phase.  Does not allocate.
+ * @param name Phase name.  Should be static string.
+ * @return Phase id or kInvalidStartupPhaseId if timeline is finished or full.
+ */
+[[nodiscard]] WB_BASE_API std::uint32_t BeginStartupPhase(
+    const char* name) noexcept;
+
+/**
+ * @brief Ends startup phase.  Does not allocate.
+ * @param phase_id Phase id.
+ * @return void.
+ */
+WB_BASE_API void EndStartupPhase(std::uint32_t phase_id) noexcept;
+
+}  // namespace internal
+
+/**
+ * @brief Gets recorded startup phases in start order.
+ * @return Startup phases.
+ */
+[[nodiscard]] WB_BASE_API std::vector<StartupPhase> GetStartupPhases();
+
+/**
+ * @brief Finishes startup timeline.  Logs phases summary and writes Chrome
+ * trace event file (chrome://tracing, ui.perfetto.dev) if |trace_path| is not
+ * empty.  Only first call has effect, phases after it are not recorded.
+ * @param trace_path Trace file path.  Optional.
+ * @return void.
+ */
+WB_BASE_API void FinishStartupTimeline(const std::string& trace_path);
+
+/**
+ * @brief Records startup phase in scope.
+ */
+class ScopedStartupPhase {
+ public:
+  /**
+   * @brief Begins startup phase.
+   * @param name Phase name.  Should be static string.
+   */
+  explicit ScopedStartupPhase(const char* name) noexcept
+      : phase_id_{internal::BeginStartupPhase(name)} {}
+
+  WB_NO_COPY_MOVE_CTOR_AND_ASSIGNMENT(ScopedStartupPhase);
+
+  /**
+   * @brief Ends startup phase if not ended yet.
+   */
+  ~ScopedStartupPhase() noexcept { End(); }
+
+  /**
+   * @brief Ends startup phase before scope end.
+   * @return void.
+   */
+  void End() noexcept {
+    if (phase_id_ != internal::kInvalidStartupPhaseId) {
+      internal::EndStartupPhase(phase_id_);
+      phase_id_ = internal::kInvalidStartupPhaseId;
+    }
+  }
+
+ private:
+  /**
+   * @brief Phase id.
+   */
+  std::uint32_t phase_id_;
+};
+
+}  // namespace wb::base::telemetry
+
+#endif  // !WB_BASE_TELEMETRY_STARTUP_TIMELINE_H_
@@ -0,0 +1,78 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Startup timeline tracer.
+
+#include "startup_timeline.h"
+//
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+#include "base/deps/googletest/gtest/gtest.h"
+
+// Timeline is process wide and finished once, so single test checks all.
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+GTEST_TEST(StartupTimelineTest, RecordsNestedPhasesAndWritesTrace) {
+  using namespace wb::base::telemetry;
+  using namespace std::chrono_literals;
+
+  {
+    const ScopedStartupPhase load_phase{"LoadBootManager"};
+    {
+      ScopedStartupPhase create_phase{"CreateScheduler"};
+      std::this_thread::sleep_for(1ms);
+      create_phase.End();
+      // Second end is noop.
+      create_phase.End();
+    }
+  }
+  const ScopedStartupPhase running_phase{"KernelMain"};
+
+  const auto phases = GetStartupPhases();
+  ASSERT_EQ(3U, phases.size());
+
+  EXPECT_STREQ("LoadBootManager", phases[0].name);
+  EXPECT_EQ(0U, phases[0].depth);
+  EXPECT_TRUE(phases[0].is_finished);
+  EXPECT_GE(phases[0].duration, 1ms);
+
+  EXPECT_STREQ("CreateScheduler", phases[1].name);
+  EXPECT_EQ(1U, phases[1].depth);
+  EXPECT_TRUE(phases[1].is_finished);
+  EXPECT_GE(phases[1].start, phases[0].start);
+  EXPECT_LE(phases[1].duration, phases[0].duration);
+  EXPECT_EQ(phases[0].thread_id, phases[1].thread_id);
+
+  EXPECT_STREQ("KernelMain", phases[2].name);
+  EXPECT_EQ(0U, phases[2].depth);
+  EXPECT_FALSE(phases[2].is_finished);
+
+  const std::string trace_path{
+      (std::filesystem::temp_directory_path() / "wb_startup_trace.json")
+          .string()};
+  FinishStartupTimeline(trace_path);
+
+  {
+    std::ifstream trace_file{trace_path};
+    ASSERT_TRUE(!!trace_file);
+
+    const std::string trace{std::istreambuf_iterator<char>{trace_file},
+                            std::istreambuf_iterator<char>{}};
+    EXPECT_NE(std::string::npos, trace.find("\"traceEvents\""));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"LoadBootManager\""));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"CreateScheduler\""));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"KernelMain\""));
+  }
+
+  std::remove(trace_path.c_str());
+
+  // Phases after finish are not recorded.
+  { const ScopedStartupPhase late_phase{"Late"}; }
+  EXPECT_EQ(3U, GetStartupPhases().size());
+}
@@ -7,6 +7,7 @@
 #ifndef WB_BOOT_MANAGER_COMMAND_LINE_FLAGS_H_
 #define WB_BOOT_MANAGER_COMMAND_LINE_FLAGS_H_
 
+#include <chrono>
 #include <cstddef>  // std::byte
 #include <vector>
 
@@ -29,12 +30,61 @@ struct CommandLineFlags {
    */
   std::string assets_path;
 
+  /**
+   * @brief Startup timeline trace file path.  Empty means no trace file.
+   */
+  std::string startup_trace_path;
+
+  /**
+   * @brief Metrics export file path or unix:<socket path>.  Empty means no
+   * export.
+   */
+  std::string metrics_export_path;
+
+  /**
+   * @brief Metrics export file rewrite interval.
+   */
+  std::chrono::milliseconds metrics_export_interval;
+
+  /**
+   * @brief Frame benchmark results file path.  Empty means no benchmark.
+   * POSIX only.
+   */
+  std::string frame_benchmark_results_path;
+
+#ifdef WB_OS_LINUX
+  /**
+   * @brief CPU profile folded stacks file path.  Empty means CPU profiler is
+   * off.
+   */
+  std::string cpu_profile_path;
+
+  /**
+   * @brief CPU profiler thread CPU time between samples.
+   */
+  std::chrono::microseconds cpu_profile_sampling_interval;
+#endif
+
   /**
    * @brief How many memory cleanup & reallocation attempts to do when out of
    * memory.
    */
   std::uint32_t attempts_to_retry_allocate_memory;
 
+  /**
+   * @brief Frame benchmark frames count.
+   */
+  std::uint32_t frame_benchmark_frames_count;
+
+#ifdef WB_OS_POSIX
+  /**
+   * @brief Inherited file descriptor to write single byte to and close when
+   * first frame is done.  Used by startup benchmark harness.  -1 means no
+   * signal.  POSIX only.
+   */
+  std::int32_t first_frame_signal_fd;
+#endif
+
 #ifdef WB_OS_WIN
   /**
    * @brief Changes minimal resolution (ms) of the Windows periodic timer.
@@ -72,15 +122,23 @@ struct CommandLineFlags {
    */
   bool should_dump_heap_allocator_statistics_on_exit;
 
-#if defined(WB_COMPILER_GCC) || defined(WB_COMPILER_CLANG)
+  /**
+   * @brief Should publish live frame telemetry to the shared memory or not.
+   * POSIX only.
+   */
+  bool should_publish_frame_telemetry;
+
+  /**
+   * @brief Should profile lock contention and log most contended locks on exit
+   * or not.
+   */
+  bool should_profile_lock_contention;
+
   WB_ATTRIBUTE_UNUSED_FIELD std::byte
       pad_[sizeof(char *) - sizeof(insecure_allow_unsigned_module_target) -
-           sizeof(should_dump_heap_allocator_statistics_on_exit)] = {};
-#else
-  WB_ATTRIBUTE_UNUSED_FIELD std::byte
-      pad_[sizeof(int) - sizeof(insecure_allow_unsigned_module_target) -
-           sizeof(should_dump_heap_allocator_statistics_on_exit)] = {};
-#endif
+           sizeof(should_dump_heap_allocator_statistics_on_exit) -
+           sizeof(should_publish_frame_telemetry) -
+           sizeof(should_profile_lock_contention)] = {};
 };
 
 }  // namespace wb::boot_manager
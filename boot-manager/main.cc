@@ -7,18 +7,24 @@
 #include "main.h"
 
 #include <filesystem>
+#include <optional>
 
 #include "app_version_config.h"
 #include "base/deps/abseil/cleanup/cleanup.h"
 #include "base/deps/g3log/g3log.h"
+#include "base/deps/marl/numa_workers.h"
 #include "base/deps/marl/scheduler.h"
 #include "base/deps/marl/scheduler_config.h"
+#include "base/deps/marl/scheduler_stats.h"
 #include "base/intl/l18n.h"
 #include "base/scoped_floating_point_mode.h"
 #include "base/scoped_process_terminate_handler.h"
 #include "base/scoped_shared_library.h"
 #include "base/std2/filesystem_ext.h"
 #include "base/std2/system_error_ext.h"
+#include "base/telemetry/lock_contention_profiler.h"
+#include "base/telemetry/metrics.h"
+#include "base/telemetry/startup_timeline.h"
 #include "build/build_config.h"
 #include "kernel/main.h"
 #include "ui/fatal_dialog.h"
@@ -44,6 +50,10 @@
 #include <gnu/libc-version.h>
 #endif
 
+#ifdef WB_OS_LINUX
+#include "base/stack_sampling_profiler_unix.h"
+#endif
+
 #ifdef WB_OS_POSIX
 #include <unistd.h>
 #endif
@@ -165,6 +175,62 @@ void DumpSystemInformation(
 #endif
 }
 
+/**
+ * @brief Starts metrics exporter when requested.
+ * @param command_line_flags Command line flags.
+ * @return Metrics exporter or nothing.
+ */
+[[nodiscard]] std::optional<wb::base::telemetry::ScopedMetricsExporter>
+MaybeStartMetricsExporter(
+    const wb::boot_manager::CommandLineFlags& command_line_flags) noexcept {
+  using namespace wb::base::telemetry;
+
+  if (command_line_flags.metrics_export_path.empty()) return std::nullopt;
+
+  auto exporter =
+      ScopedMetricsExporter::New(command_line_flags.metrics_export_path,
+                                 command_line_flags.metrics_export_interval);
+  if (!exporter.has_value()) [[unlikely]] {
+    G3PLOG_E(WARNING, exporter.error())
+        << "Unable to export metrics to '"
+        << command_line_flags.metrics_export_path
+        << "', continue without it.";
+    return std::nullopt;
+  }
+
+  return std::optional<ScopedMetricsExporter>{std::move(*exporter)};
+}
+
+#ifdef WB_OS_LINUX
+/**
+ * @brief Starts CPU profiler when requested.
+ * @param command_line_flags Command line flags.
+ * @return CPU profiler or nothing.
+ */
+[[nodiscard]] std::optional<wb::base::ScopedStackSamplingProfiler>
+MaybeStartCpuProfiler(
+    const wb::boot_manager::CommandLineFlags& command_line_flags) noexcept {
+  using namespace wb::base;
+
+  if (command_line_flags.cpu_profile_path.empty()) return std::nullopt;
+
+  auto profiler = ScopedStackSamplingProfiler::New(
+      command_line_flags.cpu_profile_sampling_interval,
+      command_line_flags.cpu_profile_path);
+  if (!profiler.has_value()) [[unlikely]] {
+    G3PLOG_E(WARNING, profiler.error())
+        << "Unable to start CPU profiler, continue without it.";
+    return std::nullopt;
+  }
+
+  G3LOG(INFO) << "CPU profiler samples each "
+              << command_line_flags.cpu_profile_sampling_interval.count()
+              << "us of thread CPU time, profile will be written to '"
+              << command_line_flags.cpu_profile_path << "'.";
+  return std::optional<ScopedStackSamplingProfiler>{std::move(*profiler)};
+}
+#endif
+
 /**
  * @brief Load and run kernel.
  * @param boot_manager_args Boot manager args.
@@ -213,8 +279,10 @@ int KernelStartup(
 #endif
 
   const auto& intl = boot_manager_args.intl;
+  telemetry::ScopedStartupPhase load_kernel_phase{"LoadKernel"};
   const auto kernel_library =
       ScopedSharedLibrary::FromLibraryOnPath(kernel_path, kernel_load_flags);
+  load_kernel_phase.End();
   if (kernel_library.has_value()) [[likely]] {
     using WhiteBoxKernelMain = decltype(&KernelMain);
     // NOLINTNEXTLINE(modernize-avoid-c-arrays)
@@ -267,6 +335,10 @@ extern "C" [[nodiscard]] WB_BOOT_MANAGER_API int BootManagerMain(
     const wb::boot_manager::BootManagerArgs& boot_manager_args) {
   using namespace wb::base;
 
+  // Lasts till the end of startup.
+  const telemetry::ScopedStartupPhase boot_manager_main_phase{
+      "BootManagerMain"};
+
   DumpSystemInformation(boot_manager_args.app_description,
                         boot_manager_args.command_line_flags.assets_path);
 
@@ -448,19 +520,51 @@ extern "C" [[nodiscard]] WB_BOOT_MANAGER_API int BootManagerMain(
   }
 #endif
 
+#ifdef WB_OS_LINUX
+  // Sample main thread and workers.  Profiler should outlive scheduler, so
+  // workers are sampled till the end.
+  const ScopedStackSamplingThread scoped_stack_sampling_thread{"WhiteBox_Main"};
+  const auto cpu_profiler =
+      MaybeStartCpuProfiler(boot_manager_args.command_line_flags);
+#endif
+
+  // Should outlive scheduler, so final metrics include all workers.
+  const auto metrics_exporter =
+      MaybeStartMetricsExporter(boot_manager_args.command_line_flags);
+
   const unsigned logical_cores_num{marl::Thread::numLogicalCPUs()};
-  const marl::Scheduler::Config all_cores_config =
+  marl::Scheduler::Config all_cores_config =
       marl::Scheduler::Config()
           // Use all logical cores.
           .setWorkerThreadCount(static_cast<int>(logical_cores_num))
           // Setup all required thread state stuff.
           .setWorkerThreadStatefulInitializer(
               deps::marl::make_thread_start_state);
+  // Pin workers per NUMA node on multi socket machines.
+  const std::size_t numa_nodes_num{
+      deps::marl::ConfigureNumaAwareWorkers(all_cores_config)};
+
+  // Dump workers utilization when all workers are stopped, so worker threads
+  // count can be tuned.
+  const absl::Cleanup log_scheduler_stats{
+      []() { deps::marl::LogSchedulerStats(); }};
+
+  if (boot_manager_args.command_line_flags.should_profile_lock_contention) {
+    telemetry::EnableLockContentionProfiling();
+  }
+  // Dump most contended locks when all workers are stopped.
+  const absl::Cleanup log_lock_contention_stats{[&boot_manager_args]() {
+    if (boot_manager_args.command_line_flags.should_profile_lock_contention) {
+      telemetry::LogLockContentionStats(16U);
+    }
+  }};
 
+  telemetry::ScopedStartupPhase create_scheduler_phase{"marl::Scheduler"};
   // Create a marl scheduler and bind it to the main thread so we can call
   // marl::schedule()
   marl::Scheduler process_wide_scheduler{all_cores_config};
   process_wide_scheduler.bind();
+  create_scheduler_phase.End();
 
   // Need to unbind scheduler from main thread.  Forgetting to unbind will
   // result in the marl::Scheduler destructor blocking indefinitely.
@@ -468,7 +572,7 @@ extern "C" [[nodiscard]] WB_BOOT_MANAGER_API int BootManagerMain(
       [&]() noexcept { process_wide_scheduler.unbind(); }};
 
   G3LOG(INFO) << "Marl CPU scheduler using " << logical_cores_num
-              << " logical cores.";
+              << " logical cores over " << numa_nodes_num << " NUMA nodes.";
 
   return KernelStartup(boot_manager_args);
 }
\ No newline at end of file
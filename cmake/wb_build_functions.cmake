@@ -325,3 +325,84 @@ function(wb_cxx_test_exe_for_target)
   include(GoogleTest)
   gtest_discover_tests(${tests_target_name})
 endfunction(wb_cxx_test_exe_for_target)
+
+# Creates Google Benchmark executable with benchmarks from target.  Results can
+# be written as JSON via run_<target>_benchmarks target to track hot paths
+# performance across releases.
+#
+# wb_cxx_benchmark_exe_for_target(
+#   TARGET        benchmarking_target
+#   SOURCE_DIR    benchmarks_source_directory
+#   LINK_DEPS?    benchmarks_link_dependencies
+#   RUNTIME_DEPS? benchmarks_runtime_dependencies
+# )
+function(wb_cxx_benchmark_exe_for_target)
+  cmake_parse_arguments(
+    args
+    ""
+    "TARGET;SOURCE_DIR"
+    "LINK_DEPS;RUNTIME_DEPS"
+    ${ARGN}
+  )
+
+  if (NOT args_TARGET OR NOT args_SOURCE_DIR)
+    message(FATAL_ERROR
+      "[benchmarks]: TARGET & SOURCE_DIR arguments are required.")
+  endif()
+
+  set(target_name         ${args_TARGET})
+  set(target_source_dir   ${args_SOURCE_DIR})
+
+  # First find all benchmark sources and header files.
+  wb_auto_sources(header_files "*_benchmarks*.h" "RECURSE" "${target_source_dir}")
+  wb_auto_sources(source_files "*_benchmarks*.cc" "RECURSE" "${target_source_dir}")
+  wb_remove_os_specific_files(${target_source_dir}
+    "${header_files}" "${source_files}" OFF)
+
+  set(benchmarks_target_name "${target_name}_benchmarks")
+  add_executable(${benchmarks_target_name} ${source_files} ${header_files})
+
+  # To see what is actually included.
+  message(STATUS "${benchmarks_target_name} has header files:")
+  foreach (header_file ${header_files})
+    message(STATUS "${header_file}")
+  endforeach()
+
+  message(STATUS "${benchmarks_target_name} has source files:")
+  foreach (source_file ${source_files})
+    message(STATUS "${source_file}")
+  endforeach()
+
+  # Include the root directory.
+  target_include_directories(${benchmarks_target_name}
+    PRIVATE
+      ${WB_ROOT_DIR}
+  )
+
+  # Specify benchmarks compile / link options.
+  wb_apply_compile_options_to_target(${benchmarks_target_name})
+
+  set(target_link_dependencies ${args_LINK_DEPS})
+  set(target_runtime_dependencies ${args_RUNTIME_DEPS})
+
+  set(benchmarks_link_dependencies benchmark::benchmark)
+  list(APPEND benchmarks_link_dependencies ${target_link_dependencies} ${target_name})
+  target_link_libraries(${benchmarks_target_name}
+    PRIVATE ${benchmarks_link_dependencies})
+
+  set(benchmarks_runtime_dependencies "")
+  list(APPEND benchmarks_runtime_dependencies ${target_runtime_dependencies})
+  wb_copy_all_target_dependencies_to_target_bin_dir(${benchmarks_target_name}
+    "${benchmarks_link_dependencies}")
+
+  # Run benchmarks and store results as JSON.
+  add_custom_target(run_${benchmarks_target_name}
+    COMMAND ${benchmarks_target_name}
+      --benchmark_out=${CMAKE_CURRENT_BINARY_DIR}/${benchmarks_target_name}.json
+      --benchmark_out_format=json
+    DEPENDS ${benchmarks_target_name}
+    WORKING_DIRECTORY $<TARGET_FILE_DIR:${benchmarks_target_name}>
+    COMMENT "Running ${benchmarks_target_name}"
+    USES_TERMINAL
+  )
+endfunction(wb_cxx_benchmark_exe_for_target)
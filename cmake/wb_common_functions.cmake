@@ -167,6 +167,12 @@ function(wb_remove_os_specific_files target_source_dir header_files source_files
         "^${target_source_dir}(.*)?_tests(_macos|_unix|_win)?.cc$"
     )
 
+    wb_remove_matches_from_lists(header_files source_files
+      MATCHES
+        "^${target_source_dir}(.*)?_benchmarks(_macos|_unix|_win)?.h$"
+        "^${target_source_dir}(.*)?_benchmarks(_macos|_unix|_win)?.cc$"
+    )
+
     wb_remove_matches_from_lists(header_files source_files
       MATCHES
         "^${target_source_dir}/tests/(.*).h$"
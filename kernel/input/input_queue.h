@@ -10,6 +10,7 @@
 #include <chrono>
 #include <optional>
 #include <queue>
+#include <utility>
 
 #include "base/high_resolution_clock.h"
 #include "base/macroses.h"
@@ -46,7 +47,8 @@ class InputQueue {
    */
   [[nodiscard]] std::optional<InputEvent<T>> Pop() noexcept {
     if (!queue_.empty()) {
-      auto &event = queue_.front();
+      // Move event out before pop, as pop destroys it.
+      std::optional<InputEvent<T>> event{std::move(queue_.front())};
       queue_.pop();
 
       return event;
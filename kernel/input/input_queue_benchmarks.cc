@@ -0,0 +1,42 @@
+// Copyright (c) 2021 The WhiteBox Authors.  All rights reserved.
+// Use of this source code is governed by a 3-Clause BSD license that can be
+// found in the LICENSE file.
+//
+// Benchmarks for input queue.
+
+#include "input_queue.h"
+//
+#include <cstdint>
+
+#include "base/deps/benchmark/benchmark.h"
+#include "hal/drivers/hid/mouse_input.h"
+
+void BM_InputQueueEmplacePop(benchmark::State& state) {
+  using namespace wb::kernel::input;
+  using wb::hal::hid::MouseButtonTransitionState;
+  using wb::hal::hid::MouseInput;
+  using wb::hal::hid::MouseStateFlags;
+
+  // Events burst size per frame.
+  const auto events_count{static_cast<std::int64_t>(state.range(0))};
+  InputQueue<MouseInput> queue;
+
+  for ([[maybe_unused]] auto _ : state) {
+    const InputTimePoint now{wb::base::HighResolutionClock::now()};
+
+    for (std::int64_t i{0}; i < events_count; ++i) {
+      queue.Emplace(now, MouseStateFlags::kMoveRelative,
+                    MouseButtonTransitionState::kNone, 0.0F,
+                    static_cast<long>(i), static_cast<long>(-i));
+    }
+
+    while (auto event = queue.Pop()) {
+      benchmark::DoNotOptimize(event);
+    }
+  }
+
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          events_count);
+}
+// NOLINTNEXTLINE(cert-err58-cpp,cppcoreguidelines-avoid-non-const-global-variables,cppcoreguidelines-owning-memory)
+BENCHMARK(BM_InputQueueEmplacePop)->RangeMultiplier(4)->Range(1, 256);
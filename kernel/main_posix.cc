@@ -6,65 +6,615 @@
 
 #include "build/compiler_config.h"
 
+#include <unistd.h>  // getpid
+
 WB_GCC_BEGIN_WARNING_OVERRIDE_SCOPE()
   // chrono in GCC 13 libcpp have issues with -Wall, need to disable warning.
   // TODO(dimhotepus): When GCC / libcpp versions bumped, check bug is absent.
   WB_GCC_DISABLE_NULL_DEREFERENCE_WARNING()
 #include <chrono>
 WB_GCC_END_WARNING_OVERRIDE_SCOPE()
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <optional>
 #include <thread>
 
 #include "main.h"
 //
 #include "base/deps/fmt/core.h"
 #include "base/deps/g3log/g3log.h"
+#include "base/deps/marl/scheduler_stats.h"
+#include "base/deps/mimalloc/mimalloc.h"
 #include "base/deps/sdl/cursor.h"
 #include "base/deps/sdl/init.h"
 #include "base/deps/sdl/version.h"
 #include "base/deps/sdl/window.h"
 #include "base/deps/sdl_image/sdl_image.h"
+#include "base/high_resolution_clock.h"
 #include "base/intl/l18n.h"
+#include "base/memory/allocation_stats.h"
+#include "base/memory/frame_arena.h"
+#include "base/posix/frame_telemetry_shared_memory.h"
+#include "base/posix/system_error_ext.h"
+#include "base/telemetry/frame_benchmark.h"
+#include "base/telemetry/metrics.h"
+#include "base/telemetry/startup_timeline.h"
+#include "build/build_config.h"
 #include "build/static_settings_config.h"
+#include "kernel/input/input_queue.h"
+#include "kernel/main_simulate_step.h"
 #include "kernel/main_window_posix.h"
 #include "ui/fatal_dialog.h"
 
+#ifdef WB_OS_LINUX
+#include "base/perf_event_counters_unix.h"
+#include "base/resource_usage_unix.h"
+#endif
+
 namespace {
 
+/**
+ * @brief Heap & workers stats are sampled once per this frames count, as it is
+ * not free.
+ */
+constexpr std::uint64_t kSlowTelemetrySampleFramesInterval{32U};
+
+/**
+ * @brief Processed input events count.
+ */
+wb::base::telemetry::Counter input_events_counter{
+    "whitebox_input_events", "Input events processed by main loop."};
+
+/**
+ * @brief Scripted input events pushed per frame in frame benchmark.
+ */
+constexpr int kFrameBenchmarkInputEventsPerFrame{8};
+
+/**
+ * @brief Mouse input queue.
+ */
+using MouseInputQueue = wb::kernel::input::InputQueue<wb::hal::hid::MouseInput>;
+
+/**
+ * @brief Keyboard input queue.
+ */
+using KeyboardInputQueue =
+    wb::kernel::input::InputQueue<wb::hal::hid::KeyboardInput>;
+
+/**
+ * @brief Per frame state of main loop.
+ */
+struct FrameLoop {
+  /**
+   * @brief Mouse input for world simulation step.
+   */
+  MouseInputQueue mouse_input_queue;
+  /**
+   * @brief Keyboard input for world simulation step.
+   */
+  KeyboardInputQueue keyboard_input_queue;
+  /**
+   * @brief Transient per frame simulation data.
+   */
+  wb::base::memory::FrameArena frame_arena;
+};
+
+/**
+ * @brief Polls all pending events and dispatches input to input queues.
+ * @param is_done Set to true when app should quit.
+ * @param frame_loop Frame loop to dispatch input to.
+ * @return Polled input events count.
+ */
+[[nodiscard]] std::uint32_t PollEvents(bool& is_done,
+                                       FrameLoop& frame_loop) noexcept {
+  using namespace wb::hal::hid;
+
+  SDL_Event event;
+  std::uint32_t input_events_count{0};
+
+  while (::SDL_PollEvent(&event) == 1) {
+    ++input_events_count;
+
+    switch (event.type) {
+      case SDL_EVENT_QUIT:
+        is_done = true;
+        break;
+
+      case SDL_EVENT_MOUSE_MOTION:
+        frame_loop.mouse_input_queue.Emplace(
+            wb::base::HighResolutionClock::now(),
+            MouseStateFlags::kMoveRelative, MouseButtonTransitionState::kNone,
+            0.0F, std::lround(event.motion.xrel),
+            std::lround(event.motion.yrel));
+        break;
+
+      case SDL_EVENT_KEY_DOWN:
+      case SDL_EVENT_KEY_UP:
+        frame_loop.keyboard_input_queue.Emplace(
+            wb::base::HighResolutionClock::now(),
+            static_cast<unsigned short>(event.key.scancode),
+            event.type == SDL_EVENT_KEY_DOWN ? KeyboardKeyFlags::kDown
+                                             : KeyboardKeyFlags::kUp,
+            static_cast<unsigned short>(0U));
+        break;
+
+      default:
+        continue;
+    }
+  }
+
+  input_events_counter.Increment(input_events_count);
+  return input_events_count;
+}
+
+/**
+ * @brief Runs frame: dispatches input and simulates world step, which resets
+ * frame arena.
+ * @param time_delta Time since previous frame start.
+ * @param is_done Set to true when app should quit.
+ * @param frame_loop Frame loop.
+ * @return Polled input events count.
+ */
+[[nodiscard]] std::uint32_t RunFrame(
+    wb::base::HighResolutionClockDuration time_delta, bool& is_done,
+    FrameLoop& frame_loop) noexcept {
+  const std::uint32_t input_events_count{PollEvents(is_done, frame_loop)};
+
+  // No render path on POSIX yet, so simulation step is whole frame work.
+  wb::kernel::SimulateWorldStep(time_delta, frame_loop.mouse_input_queue,
+                                frame_loop.keyboard_input_queue,
+                                frame_loop.frame_arena);
+  return input_events_count;
+}
+
+/**
+ * @brief Logs frame arena usage at main loop end.
+ * @param frame_loop Frame loop.
+ * @return void.
+ */
+void LogFrameArenaStats(const FrameLoop& frame_loop) noexcept {
+  const auto frame_arena_stats = frame_loop.frame_arena.GetStats();
+  G3LOG(INFO) << "Frame arena high-water mark "
+              << frame_arena_stats.high_water_bytes << " bytes over "
+              << frame_arena_stats.frames_count << " frames.";
+}
+
+/**
+ * @brief Update frame telemetry with the last frame data.
+ * @param frame_time Last frame time.
+ * @param input_events_count Input events processed during last frame.
+ * @param allocation_stats Heap allocation stats of last frame.
+ * @param telemetry Frame telemetry to update.
+ * @return void.
+ */
+void UpdateFrameTelemetry(
+    wb::base::HighResolutionClockDuration frame_time,
+    std::uint32_t input_events_count,
+    const wb::base::memory::FrameAllocationStats& allocation_stats,
+    wb::base::telemetry::FrameTelemetry& telemetry) noexcept {
+  const std::int64_t frame_time_ns{
+      std::chrono::duration_cast<std::chrono::nanoseconds>(frame_time)
+          .count()};
+
+  ++telemetry.frame_index;
+  telemetry.frame_time_ns = frame_time_ns;
+  telemetry.max_frame_time_ns =
+      std::max(telemetry.max_frame_time_ns, frame_time_ns);
+  telemetry.input_events_count = input_events_count;
+  telemetry.frame_allocations_count = allocation_stats.allocations_count;
+  telemetry.frame_allocated_bytes = allocation_stats.allocated_bytes;
+  telemetry.frame_frees_count = allocation_stats.frees_count;
+  telemetry.frame_peak_allocated_bytes = allocation_stats.peak_bytes;
+
+  if (telemetry.frame_index % kSlowTelemetrySampleFramesInterval == 1U) {
+    std::size_t current_commit{0}, peak_commit{0};
+    ::mi_process_info(nullptr, nullptr, nullptr, nullptr, nullptr,
+                      &current_commit, &peak_commit, nullptr);
+
+    telemetry.heap_current_commit_bytes = current_commit;
+    telemetry.heap_peak_commit_bytes = peak_commit;
+
+    const wb::base::deps::marl::SchedulerStats scheduler_stats{
+        wb::base::deps::marl::GetSchedulerStats()};
+
+    telemetry.workers_count = scheduler_stats.running_workers_count;
+    telemetry.workers_tasks_executed = scheduler_stats.tasks_executed;
+    telemetry.workers_busy_time_ns = scheduler_stats.busy_time.count();
+    telemetry.workers_lifetime_ns = scheduler_stats.lifetime.count();
+  }
+}
+
+#ifdef WB_OS_LINUX
+/**
+ * @brief Update frame telemetry with the last frame perf counters.
+ * @param perf_counters Perf counters of last frame.
+ * @param telemetry Frame telemetry to update.
+ * @return void.
+ */
+void UpdateFramePerfCounters(
+    const wb::base::PerfEventCountersSample& perf_counters,
+    wb::base::telemetry::FrameTelemetry& telemetry) noexcept {
+  telemetry.frame_cycles = perf_counters.cycles;
+  telemetry.frame_instructions = perf_counters.instructions;
+  telemetry.frame_cache_misses = perf_counters.cache_misses;
+  telemetry.frame_branch_misses = perf_counters.branch_misses;
+  telemetry.frame_task_clock_ns = perf_counters.task_clock_ns;
+  telemetry.frame_perf_page_faults = perf_counters.page_faults;
+  telemetry.frame_context_switches = perf_counters.context_switches;
+}
+
+/**
+ * @brief Update frame telemetry with the last frame page faults, process
+ * memory usage and threads scheduling.
+ * @param frame_resource_usage Frame thread resource usage of last frame.
+ * @param telemetry Frame telemetry to update.
+ * @return void.
+ */
+void UpdateFrameResourceUsage(
+    const wb::base::ResourceUsageSample& frame_resource_usage,
+    wb::base::telemetry::FrameTelemetry& telemetry) noexcept {
+  using namespace wb::base;
+
+  telemetry.frame_minor_page_faults = frame_resource_usage.minor_page_faults;
+  telemetry.frame_major_page_faults = frame_resource_usage.major_page_faults;
+  // Max frame time is already updated, so this frame is the slowest one.
+  if (telemetry.frame_time_ns == telemetry.max_frame_time_ns) {
+    telemetry.max_frame_time_page_faults =
+        frame_resource_usage.minor_page_faults +
+        frame_resource_usage.major_page_faults;
+  }
+
+  if (telemetry.frame_index % kSlowTelemetrySampleFramesInterval == 1U) {
+    const auto process_resource_usage =
+        GetResourceUsage(ResourceUsageScope::kProcess);
+    if (process_resource_usage.has_value()) [[likely]] {
+      telemetry.process_minor_page_faults =
+          process_resource_usage->minor_page_faults;
+      telemetry.process_major_page_faults =
+          process_resource_usage->major_page_faults;
+    }
+
+    const auto resident_set_bytes = GetResidentSetSizeBytes();
+    if (resident_set_bytes.has_value()) [[likely]] {
+      telemetry.resident_set_bytes = *resident_set_bytes;
+      telemetry.peak_resident_set_bytes =
+          std::max(telemetry.peak_resident_set_bytes, *resident_set_bytes);
+    }
+
+    const auto main_thread_scheduling = GetCurrentThreadScheduling();
+    if (main_thread_scheduling.has_value()) [[likely]] {
+      telemetry.main_thread_cpu_time_ns =
+          main_thread_scheduling->cpu_time.count();
+      telemetry.main_thread_voluntary_context_switches =
+          main_thread_scheduling->voluntary_context_switches;
+      telemetry.main_thread_involuntary_context_switches =
+          main_thread_scheduling->involuntary_context_switches;
+    }
+
+    const ThreadSchedulingSample workers_scheduling{
+        deps::marl::GetWorkersScheduling()};
+    telemetry.workers_cpu_time_ns = workers_scheduling.cpu_time.count();
+    telemetry.workers_voluntary_context_switches =
+        workers_scheduling.voluntary_context_switches;
+    telemetry.workers_involuntary_context_switches =
+        workers_scheduling.involuntary_context_switches;
+  }
+}
+
+/**
+ * @brief Gets frame thread resource usage or zeros on failure.
+ * @return Frame thread resource usage.
+ */
+[[nodiscard]] wb::base::ResourceUsageSample GetFrameResourceUsage() noexcept {
+  using namespace wb::base;
+
+  // getrusage(RUSAGE_THREAD) can't fail for valid arguments.
+  return GetResourceUsage(ResourceUsageScope::kThread)
+      .value_or(ResourceUsageSample{});
+}
+
+/**
+ * @brief Opens frame thread perf counters when frame telemetry is published.
+ * @param telemetry_publisher Frame telemetry publisher.  Optional.
+ * @return Perf counters or nothing.
+ */
+[[nodiscard]] std::optional<wb::base::PerfEventCounters>
+MaybeCreatePerfEventCounters(
+    const wb::base::posix::FrameTelemetryPublisher*
+        telemetry_publisher) noexcept {
+  using namespace wb::base;
+
+  if (!telemetry_publisher) return std::nullopt;
+
+  auto counters = PerfEventCounters::New();
+  if (!counters.has_value()) [[unlikely]] {
+    G3PLOG_E(WARNING, counters.error())
+        << "Unable to open perf event counters, continue without them.";
+    return std::nullopt;
+  }
+
+  return std::optional<PerfEventCounters>{std::move(*counters)};
+}
+#endif
+
+/**
+ * @brief Signals first frame to startup benchmark harness.  Writes single byte
+ * to inherited file descriptor and closes it.
+ * @param first_frame_signal_fd File descriptor.
+ * @return void.
+ */
+void SignalFirstFrame(int first_frame_signal_fd) noexcept {
+  using namespace wb::base;
+
+  constexpr char kFirstFrameSignal{'F'};
+
+  ssize_t rc;
+  do {
+    rc = ::write(first_frame_signal_fd, &kFirstFrameSignal,
+                 sizeof(kFirstFrameSignal));
+  } while (rc == -1 && errno == EINTR);
+
+  const std::error_code write_rc{rc == -1 ? std2::posix_last_error_code()
+                                           : std2::ok_code};
+  G3PLOGE2_IF(WARNING, write_rc)
+      << "Unable to signal first frame to fd " << first_frame_signal_fd
+      << ".";
+
+  const std::error_code close_rc{
+      posix::get_error(::close(first_frame_signal_fd))};
+  G3PLOGE2_IF(WARNING, close_rc)
+      << "Unable to close first frame signal fd " << first_frame_signal_fd
+      << ".";
+}
+
 /**
  * @brief Run app message loop.
+ * @param telemetry_publisher Frame telemetry publisher.  Optional.
+ * @param first_frame_signal_fd File descriptor to signal first frame to.  -1
+ * means no signal.
  * @return App exit code.
  */
-[[nodiscard]] int DispatchMessages() noexcept {
-  SDL_Event event;
+[[nodiscard]] int DispatchMessages(
+    wb::base::posix::FrameTelemetryPublisher* telemetry_publisher,
+    int first_frame_signal_fd) noexcept {
+  using namespace wb::base;
+
   bool is_done{false};
 
+  // Allocation stats are published with telemetry only.
+  if (telemetry_publisher) memory::EnableAllocationStats();
+
+  FrameLoop frame_loop;
+  telemetry::FrameTelemetry frame_telemetry{};
+  HighResolutionClock::time_point frame_start_time{HighResolutionClock::now()};
+  HighResolutionClock::time_point simulate_start_time{frame_start_time};
+  memory::ThreadAllocationStats frame_start_allocation_stats{
+      memory::BeginFrameAllocationStats()};
+#ifdef WB_OS_LINUX
+  const std::optional<PerfEventCounters> perf_event_counters{
+      MaybeCreatePerfEventCounters(telemetry_publisher)};
+  PerfEventCountersSample frame_start_perf_counters{
+      perf_event_counters.has_value() ? perf_event_counters->Read()
+                                      : PerfEventCountersSample{}};
+  ResourceUsageSample frame_start_resource_usage{GetFrameResourceUsage()};
+#endif
+
   while (!is_done) {
-    while (::SDL_PollEvent(&event) == 1) {
-      switch (event.type) {
-        case SDL_EVENT_QUIT:
-          is_done = true;
-          break;
-
-        default:
-          continue;
-      }
+    const HighResolutionClock::time_point now_time{HighResolutionClock::now()};
+    const std::uint32_t input_events_count{
+        RunFrame(now_time - simulate_start_time, is_done, frame_loop)};
+    simulate_start_time = now_time;
+
+    // First frame is presented once events are polled, do not count frame
+    // pacing sleep into startup time.
+    if (first_frame_signal_fd != -1) [[unlikely]] {
+      SignalFirstFrame(first_frame_signal_fd);
+      first_frame_signal_fd = -1;
     }
 
     // TODO(dimhotepus): Do smth when no events.
     using namespace std::chrono_literals;
     std::this_thread::sleep_for(5ms);
+
+    if (telemetry_publisher) {
+      const HighResolutionClock::time_point frame_end_time{
+          HighResolutionClock::now()};
+
+      UpdateFrameTelemetry(
+          frame_end_time - frame_start_time, input_events_count,
+          memory::EndFrameAllocationStats(frame_start_allocation_stats),
+          frame_telemetry);
+#ifdef WB_OS_LINUX
+      if (perf_event_counters.has_value()) {
+        const PerfEventCountersSample frame_end_perf_counters{
+            perf_event_counters->Read()};
+        UpdateFramePerfCounters(
+            frame_end_perf_counters - frame_start_perf_counters,
+            frame_telemetry);
+        frame_start_perf_counters = frame_end_perf_counters;
+      }
+
+      const ResourceUsageSample frame_end_resource_usage{
+          GetFrameResourceUsage()};
+      UpdateFrameResourceUsage(
+          frame_end_resource_usage - frame_start_resource_usage,
+          frame_telemetry);
+      frame_start_resource_usage = frame_end_resource_usage;
+#endif
+      telemetry_publisher->Publish(frame_telemetry);
+
+      frame_start_time = frame_end_time;
+      frame_start_allocation_stats = memory::BeginFrameAllocationStats();
+    }
   }
 
+  LogFrameArenaStats(frame_loop);
+
   return 0;
 }
 
+/**
+ * @brief Pushes deterministic scripted input for frame benchmark.  Mouse moves
+ * along the circle.  Goes through SDL queue, so frame dispatches it like real
+ * input.
+ * @param frame_index Frame index.
+ * @return void.
+ */
+void PushFrameBenchmarkInput(std::uint64_t frame_index) noexcept {
+  constexpr float kRadius{100.0F};
+  constexpr float kStep{0.01F};
+
+  for (int i{0}; i < kFrameBenchmarkInputEventsPerFrame; ++i) {
+    const float angle{
+        static_cast<float>(frame_index * kFrameBenchmarkInputEventsPerFrame +
+                           static_cast<std::uint64_t>(i)) *
+        kStep};
+
+    SDL_Event event{};
+    event.type = SDL_EVENT_MOUSE_MOTION;
+    event.motion.x = kRadius + kRadius * std::cos(angle);
+    event.motion.y = kRadius + kRadius * std::sin(angle);
+    event.motion.xrel = -kRadius * kStep * std::sin(angle);
+    event.motion.yrel = kRadius * kStep * std::cos(angle);
+
+    [[maybe_unused]] const bool is_pushed{::SDL_PushEvent(&event)};
+  }
+}
+
+/**
+ * @brief Runs frame benchmark with scripted input and writes results.  Frames
+ * run the same path as main loop, without frame pacing.
+ * @param command_line_flags Command line flags.
+ * @return App exit code.
+ */
+[[nodiscard]] int RunFrameBenchmark(
+    const wb::boot_manager::CommandLineFlags& command_line_flags) noexcept {
+  using namespace wb::base;
+
+  const std::string& results_path{
+      command_line_flags.frame_benchmark_results_path};
+  int first_frame_signal_fd{command_line_flags.first_frame_signal_fd};
+
+  try {
+    telemetry::FrameBenchmark benchmark{
+        command_line_flags.frame_benchmark_frames_count};
+    memory::EnableAllocationStats();
+
+    bool is_done{false};
+    std::uint64_t frame_index{0};
+    FrameLoop frame_loop;
+    HighResolutionClock::time_point frame_start_time{
+        HighResolutionClock::now()};
+    HighResolutionClockDuration previous_frame_time{0};
+    memory::ThreadAllocationStats frame_start_allocation_stats{
+        memory::BeginFrameAllocationStats()};
+
+    // No frame pacing, measure work only.
+    while (!is_done && !benchmark.IsFinished()) {
+      PushFrameBenchmarkInput(frame_index++);
+      [[maybe_unused]] const std::uint32_t input_events_count{
+          RunFrame(previous_frame_time, is_done, frame_loop)};
+
+      const HighResolutionClock::time_point frame_end_time{
+          HighResolutionClock::now()};
+      previous_frame_time = frame_end_time - frame_start_time;
+      const memory::FrameAllocationStats allocation_stats{
+          memory::EndFrameAllocationStats(frame_start_allocation_stats)};
+
+      benchmark.AddFrame(previous_frame_time,
+                         allocation_stats.allocations_count,
+                         allocation_stats.allocated_bytes);
+
+      // Out of frame time, so signal cost is not measured.
+      if (first_frame_signal_fd != -1) [[unlikely]] {
+        SignalFirstFrame(first_frame_signal_fd);
+        first_frame_signal_fd = -1;
+      }
+
+      frame_start_time = frame_end_time;
+      frame_start_allocation_stats = memory::BeginFrameAllocationStats();
+    }
+
+    LogFrameArenaStats(frame_loop);
+
+    std::size_t current_rss{0}, peak_rss{0};
+    ::mi_process_info(nullptr, nullptr, nullptr, &current_rss, &peak_rss,
+                      nullptr, nullptr, nullptr);
+
+    const telemetry::FrameBenchmarkResults results{
+        benchmark.Finish(current_rss, peak_rss)};
+
+    std::ofstream results_file{results_path, std::ios::out | std::ios::trunc};
+    results_file << telemetry::FormatFrameBenchmarkResults(results);
+    if (!results_file) [[unlikely]] {
+      G3LOG(WARNING) << "Unable to write frame benchmark results to '"
+                     << results_path << "'.";
+      return 1;
+    }
+
+    G3LOG(INFO) << "Frame benchmark of " << results.frames_count
+                << " frames: mean " << results.frame_time_mean_ms
+                << "ms, p99 " << results.frame_time_p99_ms << "ms, "
+                << results.allocations_per_frame
+                << " allocations per frame.  Results are written to '"
+                << results_path << "'.";
+    return 0;
+  } catch (const std::exception& ex) {
+    G3LOG(WARNING) << "Frame benchmark failed: " << ex.what();
+
+    // Close without signal, so parent sees EOF instead of waiting forever.
+    if (first_frame_signal_fd != -1) [[unlikely]] {
+      const std::error_code close_rc{
+          posix::get_error(::close(first_frame_signal_fd))};
+      G3PLOGE2_IF(WARNING, close_rc)
+          << "Unable to close first frame signal fd " << first_frame_signal_fd
+          << ".";
+    }
+    return 1;
+  }
+}
+
+/**
+ * @brief Creates frame telemetry publisher when requested.
+ * @param command_line_flags Command line flags.
+ * @return Frame telemetry publisher or nothing.
+ */
+[[nodiscard]] std::optional<wb::base::posix::FrameTelemetryPublisher>
+MaybeCreateFrameTelemetryPublisher(
+    const wb::boot_manager::CommandLineFlags& command_line_flags) noexcept {
+  using namespace wb::base::posix;
+
+  if (!command_line_flags.should_publish_frame_telemetry) return std::nullopt;
+
+  auto publisher = FrameTelemetryPublisher::New();
+  if (!publisher.has_value()) [[unlikely]] {
+    G3PLOG_E(WARNING, publisher.error())
+        << "Unable to publish frame telemetry, continue without it.";
+    return std::nullopt;
+  }
+
+  G3LOG(INFO) << "Frame telemetry is published to '"
+              << MakeFrameTelemetryObjectName(::getpid()) << "'.";
+  return std::optional<FrameTelemetryPublisher>{std::move(*publisher)};
+}
+
 /**
  * @brief Make window flags.
+ * @param is_headless Is window offscreen, so without graphics context.
  * @return Window flags.
  */
-[[nodiscard]] constexpr wb::sdl::WindowFlags MakeWindowFlags() noexcept {
+[[nodiscard]] constexpr wb::sdl::WindowFlags MakeWindowFlags(
+    bool is_headless) noexcept {
   using namespace wb::sdl;
 
+  if (is_headless) {
+    return WindowFlags::kResizable | WindowFlags::kHidden |
+           WindowFlags::kAllowHighDpi;
+  }
+
   // TODO(dimhotepus): kAllowHighDpi handling at least on Mac.
   // Hidden by default, as we check either it is second instance or not and show
   // only if not.
@@ -128,15 +678,30 @@ extern "C" [[nodiscard]] WB_WHITEBOX_KERNEL_API int KernelMain(
   using namespace wb::base;
   using namespace wb::kernel;
 
+  // Lasts till the end of startup.
+  const telemetry::ScopedStartupPhase kernel_main_phase{"KernelMain"};
+
   const auto& intl = kernel_args.intl;
   const auto& command_line_flags = kernel_args.command_line_flags;
+  // Benchmark runs offscreen, so results do not depend on display & compositor.
+  const bool is_frame_benchmark{
+      !command_line_flags.frame_benchmark_results_path.empty()};
+  if (is_frame_benchmark) {
+    if (!::SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen")) [[unlikely]] {
+      G3LOG(WARNING) << "Unable to use SDL offscreen video driver for frame "
+                        "benchmark: "
+                     << ::SDL_GetError();
+    }
+  }
 
   using namespace wb::sdl;
 
   const int compiled_sdl_version{GetCompileTimeVersion()},
       linked_sdl_version{GetLinkTimeVersion()};
+  telemetry::ScopedStartupPhase sdl_initializer_phase{"SDLInitializer"};
   const auto sdl_initializer = SDLInitializer::New(SDLInitializerFlags::kAudio |
                                                    SDLInitializerFlags::kVideo);
+  sdl_initializer_phase.End();
   if (!sdl_initializer.has_value()) [[unlikely]] {
     return wb::ui::FatalDialog(
         intl::l18n_fmt(intl, "{0} - Error", kernel_args.app_description), {},
@@ -166,11 +731,13 @@ extern "C" [[nodiscard]] WB_WHITEBOX_KERNEL_API int KernelMain(
   G3LOG(INFO) << "SDL image versions: build " << SDL_IMAGE_VERSION
               << ", runtime " << ::IMG_Version() << '.';
 
-  const WindowFlags window_flags{MakeWindowFlags()};
+  const WindowFlags window_flags{MakeWindowFlags(is_frame_benchmark)};
 
+  telemetry::ScopedStartupPhase main_window_phase{"MainWindow::New"};
   const auto window_result = MainWindow::New(
       kernel_args.app_description, command_line_flags.main_window_width,
       command_line_flags.main_window_height, window_flags, intl);
+  main_window_phase.End();
   if (window_result.has_value()) [[likely]] {
     G3LOG(INFO) << "SDL graphics context: "
                 << GetWindowGraphicsContext(window_flags) << ".";
@@ -180,7 +747,17 @@ extern "C" [[nodiscard]] WB_WHITEBOX_KERNEL_API int KernelMain(
     // cursor.
     wait_cursor_while_app_starts.reset();
 
-    return DispatchMessages();
+    telemetry::FinishStartupTimeline(command_line_flags.startup_trace_path);
+
+    if (is_frame_benchmark) return RunFrameBenchmark(command_line_flags);
+
+    auto frame_telemetry_publisher =
+        MaybeCreateFrameTelemetryPublisher(command_line_flags);
+
+    return DispatchMessages(frame_telemetry_publisher.has_value()
+                                ? &*frame_telemetry_publisher
+                                : nullptr,
+                            command_line_flags.first_frame_signal_fd);
   }
 
   const auto error = window_result.error();
@@ -11,7 +11,8 @@ namespace wb::kernel {
 void SimulateWorldStep(
     base::HighResolutionClockDuration time_delta,
     input::InputQueue<hal::hid::MouseInput>& mouse_input_queue,
-    input::InputQueue<hal::hid::KeyboardInput>& keyboard_input_queue) noexcept {
+    input::InputQueue<hal::hid::KeyboardInput>& keyboard_input_queue,
+    base::memory::FrameArena& frame_arena) noexcept {
   (void)time_delta;
 
   // Get input from HID, network, AI.
@@ -29,6 +30,9 @@ void SimulateWorldStep(
   while (keyboard_input.has_value()) {
     keyboard_input = keyboard_input_queue.Pop();
   }
+
+  // Transient step data is not used after step end.
+  frame_arena.Reset();
 }
 
 }  // namespace wb::kernel
@@ -9,6 +9,7 @@
 
 #include <chrono>
 
+#include "base/memory/frame_arena.h"
 #include "hal/drivers/hid/keyboard_input.h"
 #include "hal/drivers/hid/mouse_input.h"
 #include "kernel/input/input_queue.h"
@@ -20,12 +21,13 @@ namespace wb::kernel {
  * @param time_delta How much time elapsed since last run?
  * @param mouse_input_queue Mouse input queue.
  * @param keyboard_input_queue Keyboard input queue.
+ * @param frame_arena Frame arena for transient step data.  Reset on step end.
  */
 void SimulateWorldStep(
     base::HighResolutionClockDuration time_delta,
     input::InputQueue<hal::hid::MouseInput>& mouse_input_queue,
-    input::InputQueue<hal::hid::KeyboardInput>&
-        keyboard_input_queue) noexcept;
+    input::InputQueue<hal::hid::KeyboardInput>& keyboard_input_queue,
+    base::memory::FrameArena& frame_arena) noexcept;
 
 }  // namespace wb::kernel
 
@@ -8,6 +8,8 @@
 #include "base/deps/g3log/g3log.h"
 #include "base/high_resolution_clock.h"
 #include "base/intl/l18n.h"
+#include "base/memory/frame_arena.h"
+#include "base/telemetry/startup_timeline.h"
 #include "base/win/windows_light.h"
 #include "kernel/input/input_queue.h"
 #include "kernel/main_simulate_step.h"
@@ -72,6 +74,8 @@ namespace {
   using namespace wb::ui::win;
 
   PeekMessageDispatcher msg_dispatcher;
+  // Transient per frame simulation data.
+  wb::base::memory::FrameArena frame_arena;
   auto loop_iteration_start_time = wb::base::HighResolutionClock::now();
 
   // Main message app loop.
@@ -96,9 +100,14 @@ namespace {
     loop_iteration_start_time = now_time;
 
     wb::kernel::SimulateWorldStep(delta_time, mouse_input_queue,
-                                  keyboard_input_queue);
+                                  keyboard_input_queue, frame_arena);
   }
 
+  const auto frame_arena_stats = frame_arena.GetStats();
+  G3LOG(INFO) << "Frame arena high-water mark "
+              << frame_arena_stats.high_water_bytes << " bytes over "
+              << frame_arena_stats.frames_count << " frames.";
+
   G3LOG_IF(WARNING, exit_code != 0)
       << "Main window '" << main_window_name
       << "' message dispatch thread exited with non success code " << exit_code;
@@ -124,6 +133,9 @@ extern "C" [[nodiscard]] WB_WHITEBOX_KERNEL_API int KernelMain(
   using namespace wb::base;
   using namespace wb::kernel;
 
+  // Lasts till the end of startup.
+  const telemetry::ScopedStartupPhase kernel_main_phase{"KernelMain"};
+
   const auto& intl = kernel_args.intl;
   const auto& command_line_flags = kernel_args.command_line_flags;
 
@@ -140,9 +152,11 @@ extern "C" [[nodiscard]] WB_WHITEBOX_KERNEL_API int KernelMain(
   input::InputQueue<MouseInput> mouse_input_queue;
   input::InputQueue<KeyboardInput> keyboard_input_queue;
 
+  telemetry::ScopedStartupPhase main_window_phase{"MainWindow::New"};
   auto window_result =
       BaseWindow::New<MainWindow>(window_definition, window_class_style, intl,
                                   mouse_input_queue, keyboard_input_queue);
+  main_window_phase.End();
   if (MainWindow* window =
           window_result
               .transform(
@@ -154,6 +168,8 @@ extern "C" [[nodiscard]] WB_WHITEBOX_KERNEL_API int KernelMain(
     // Send WM_PAINT directly to draw first time.
     window->Update();
 
+    telemetry::FinishStartupTimeline(command_line_flags.startup_trace_path);
+
     return DispatchMessages(window_definition.name, mouse_input_queue,
                             keyboard_input_queue);
   }
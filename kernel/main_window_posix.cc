@@ -10,6 +10,7 @@
 
 #include "base/intl/l18n.h"
 #include "base/scoped_app_instance_manager.h"
+#include "base/telemetry/startup_timeline.h"
 #include "build/static_settings_config.h"
 #include "ui/static_settings_config.h"
 
@@ -45,8 +46,10 @@ sdl::result<MainWindow> MainWindow::New(
     const std::string window_icon_name{MakeWindowIconName(title)};
     auto window = std::move(sdl_window.value());
 
+    telemetry::ScopedStartupPhase window_icon_phase{"Surface::FromImage"};
     const auto window_icon_result =
         Surface::FromImage(window_icon_name.c_str());
+    window_icon_phase.End();
     if (window_icon_result.has_value()) [[likely]] {
       window.SetIcon(window_icon_result.value());
     } else {